@@ -0,0 +1,158 @@
+/*
+ * admit.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: Kyle Harper
+ * Description: See admit.h.  Every search hit and every list__add() records an access, so the hot paths only ever do a few
+ *              relaxed atomic adds.  Counters are a byte each rather than packed nibbles; the sketch is small enough either way.
+ */
+
+/* Include Headers */
+#include <jemalloc/jemalloc.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "admit.h"
+
+
+/* Extern the error codes we'll use. */
+extern const int E_OK;
+extern const int E_NO_MEMORY;
+
+
+/* Double hashing:  one 64-bit mix of the ID gives two 32-bit halves, and probe i is h1 + i * h2.  Rows use probes 0 through
+ * ADMIT_ROWS - 1; the doorkeeper uses the next two. */
+#define ADMIT_PROBE(hash, i) ((uint32_t)(hash) + (uint32_t)(i) * ((uint32_t)((hash) >> 32) | 1))
+
+
+
+/* admit__hash
+ * Mixes an ID so sequential IDs spread over the whole sketch.  This is splitmix64's finalizer.
+ */
+uint64_t admit__hash(bufferid_t id) {
+  uint64_t hash = (uint64_t)id * 0x9E3779B97F4A7C15ull;
+  hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+  hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+  return hash ^ (hash >> 31);
+}
+
+
+/* admit__initialize
+ * Builds a filter for a tier that holds up to max_bytes worth of buffers.  expected_size is a guess at the average buffer size,
+ * used to size the sketch and the sample period, same as ghost__initialize().
+ */
+int admit__initialize(AdmissionFilter **filter, uint64_t max_bytes, uint32_t expected_size) {
+  uint64_t capacity = max_bytes / (expected_size > 0 ? expected_size : 1);
+  if(capacity == 0)
+    capacity = 1;
+  uint64_t width = ADMIT_MIN_WIDTH;
+  while(width < ADMIT_MAX_WIDTH && width < capacity)
+    width <<= 1;
+  uint64_t doorkeeper_bits = 64;
+  while(doorkeeper_bits < capacity * ADMIT_SAMPLE_FACTOR * ADMIT_DOORKEEPER_BITS && doorkeeper_bits < (uint64_t)ADMIT_MAX_WIDTH * 8)
+    doorkeeper_bits <<= 1;
+
+  *filter = (AdmissionFilter *)calloc(1, sizeof(AdmissionFilter));
+  if(*filter == NULL)
+    return E_NO_MEMORY;
+  (*filter)->sketch = (uint8_t *)calloc(ADMIT_ROWS * width, sizeof(uint8_t));
+  (*filter)->doorkeeper = (uint64_t *)calloc(doorkeeper_bits / 64, sizeof(uint64_t));
+  if((*filter)->sketch == NULL || (*filter)->doorkeeper == NULL) {
+    free((*filter)->sketch);
+    free((*filter)->doorkeeper);
+    free(*filter);
+    return E_NO_MEMORY;
+  }
+  (*filter)->width_mask = width - 1;
+  (*filter)->doorkeeper_mask = doorkeeper_bits - 1;
+  (*filter)->sample_size = capacity * ADMIT_SAMPLE_FACTOR;
+  (*filter)->memory = ADMIT_ROWS * width + doorkeeper_bits / 8;
+  return E_OK;
+}
+
+
+/* admit__destroy
+ * Frees a filter.
+ */
+void admit__destroy(AdmissionFilter *filter) {
+  if(filter == NULL)
+    return;
+  free(filter->sketch);
+  free(filter->doorkeeper);
+  free(filter);
+  return;
+}
+
+
+/* admit__record
+ * Counts one access to id.  The first access since a reset only goes in the doorkeeper; later ones bump the sketch.  Whoever
+ * records the sample_size'th access does the reset.
+ */
+void admit__record(AdmissionFilter *filter, bufferid_t id) {
+  const uint64_t HASH = admit__hash(id);
+  const uint32_t BIT_A = ADMIT_PROBE(HASH, ADMIT_ROWS) & filter->doorkeeper_mask;
+  const uint32_t BIT_B = ADMIT_PROBE(HASH, ADMIT_ROWS + 1) & filter->doorkeeper_mask;
+  const uint64_t SEEN_A = __atomic_fetch_or(&filter->doorkeeper[BIT_A >> 6], 1ull << (BIT_A & 63), __ATOMIC_RELAXED) & (1ull << (BIT_A & 63));
+  const uint64_t SEEN_B = __atomic_fetch_or(&filter->doorkeeper[BIT_B >> 6], 1ull << (BIT_B & 63), __ATOMIC_RELAXED) & (1ull << (BIT_B & 63));
+  uint8_t *counter = NULL;
+  if(SEEN_A != 0 && SEEN_B != 0) {
+    for(uint32_t row=0; row<ADMIT_ROWS; row++) {
+      counter = &filter->sketch[row * (filter->width_mask + 1ull) + (ADMIT_PROBE(HASH, row) & filter->width_mask)];
+      if(__atomic_load_n(counter, __ATOMIC_RELAXED) < ADMIT_COUNTER_MAX)
+        __atomic_fetch_add(counter, 1, __ATOMIC_RELAXED);
+    }
+  }
+  if(__atomic_add_fetch(&filter->additions, 1, __ATOMIC_RELAXED) == filter->sample_size)
+    admit__reset(filter);
+  return;
+}
+
+
+/* admit__estimate
+ * How often id has been asked for lately:  the smallest of its counters, plus one if the doorkeeper has seen it.
+ */
+uint8_t admit__estimate(AdmissionFilter *filter, bufferid_t id) {
+  const uint64_t HASH = admit__hash(id);
+  const uint32_t BIT_A = ADMIT_PROBE(HASH, ADMIT_ROWS) & filter->doorkeeper_mask;
+  const uint32_t BIT_B = ADMIT_PROBE(HASH, ADMIT_ROWS + 1) & filter->doorkeeper_mask;
+  uint8_t estimate = ADMIT_COUNTER_MAX, counter = 0;
+  for(uint32_t row=0; row<ADMIT_ROWS; row++) {
+    counter = __atomic_load_n(&filter->sketch[row * (filter->width_mask + 1ull) + (ADMIT_PROBE(HASH, row) & filter->width_mask)], __ATOMIC_RELAXED);
+    if(counter < estimate)
+      estimate = counter;
+  }
+  if((__atomic_load_n(&filter->doorkeeper[BIT_A >> 6], __ATOMIC_RELAXED) & (1ull << (BIT_A & 63))) != 0 &&
+     (__atomic_load_n(&filter->doorkeeper[BIT_B >> 6], __ATOMIC_RELAXED) & (1ull << (BIT_B & 63))) != 0)
+    estimate++;
+  return estimate;
+}
+
+
+/* admit__allow
+ * Decides whether candidate should take victim's place.  Ties go to the victim, which is what keeps one-hit wonders out.  A
+ * victim of BUFFER_ID_MAX means the policy had nobody to offer, so the candidate gets in.
+ */
+bool admit__allow(AdmissionFilter *filter, bufferid_t candidate, bufferid_t victim) {
+  if(victim == BUFFER_ID_MAX || admit__estimate(filter, candidate) > admit__estimate(filter, victim)) {
+    __atomic_add_fetch(&filter->admitted, 1, __ATOMIC_RELAXED);
+    return true;
+  }
+  __atomic_add_fetch(&filter->rejected, 1, __ATOMIC_RELAXED);
+  return false;
+}
+
+
+/* admit__reset
+ * Ages the filter:  halves every counter and forgets the doorkeeper.  Accesses recorded while this runs may be halved or not;
+ * either is fine for an estimate.
+ */
+void admit__reset(AdmissionFilter *filter) {
+  const uint64_t COUNTERS = ADMIT_ROWS * (filter->width_mask + 1ull);
+  for(uint64_t i=0; i<COUNTERS; i++)
+    __atomic_store_n(&filter->sketch[i], __atomic_load_n(&filter->sketch[i], __ATOMIC_RELAXED) >> 1, __ATOMIC_RELAXED);
+  for(uint64_t i=0; i<=filter->doorkeeper_mask / 64; i++)
+    __atomic_store_n(&filter->doorkeeper[i], 0, __ATOMIC_RELAXED);
+  __atomic_sub_fetch(&filter->additions, filter->sample_size / 2, __ATOMIC_RELAXED);
+  filter->resets++;
+  return;
+}
@@ -0,0 +1,56 @@
+/*
+ * admit.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: Kyle Harper
+ * Description: A W-TinyLFU style admission filter.  A count-min sketch estimates how often each buffer ID has been asked for
+ *              recently, with a small bloom filter (the doorkeeper) in front of it so IDs seen only once never touch the sketch.
+ *              When the raw tier is full, list__add() asks the filter whether the new buffer is asked for more often than the
+ *              replacement policy's next victim.  If it isn't, the buffer isn't worth the sweep and compression it would cost.
+ *              Every sample_size recorded accesses the counters are halved and the doorkeeper is cleared, so old popularity fades.
+ */
+
+#ifndef SRC_ADMIT_H_
+#define SRC_ADMIT_H_
+
+/* Includes */
+#include <stdbool.h>
+#include <stdint.h>
+#include "buffer.h"
+
+
+/* Limits and tuning. */
+#define ADMIT_ROWS            4           /* Hash rows in the count-min sketch. */
+#define ADMIT_COUNTER_MAX     15          /* Counters saturate here, same as TinyLFU's 4-bit counters. */
+#define ADMIT_MIN_WIDTH       1024        /* Smallest sketch row we bother building. */
+#define ADMIT_MAX_WIDTH       (1 << 24)   /* Largest sketch row, regardless of capacity.  Keeps the sketch under ~64 MB. */
+#define ADMIT_SAMPLE_FACTOR   10          /* Accesses between resets, as a multiple of the buffers the list can hold. */
+#define ADMIT_DOORKEEPER_BITS 4           /* Doorkeeper bits per access in a sample period. */
+
+
+typedef struct admissionfilter AdmissionFilter;
+struct admissionfilter {
+  uint8_t *sketch;                /* ADMIT_ROWS rows of counters, row after row.  Updated with relaxed atomics; estimates can be off by a few. */
+  uint64_t *doorkeeper;           /* Bloom filter of IDs seen once since the last reset. */
+  uint32_t width_mask;            /* Counters per row - 1.  Rows are a power of 2. */
+  uint32_t doorkeeper_mask;       /* Doorkeeper bits - 1.  Also a power of 2. */
+  uint64_t sample_size;           /* Recorded accesses between resets. */
+  uint64_t additions;             /* Recorded accesses since the last reset (halved by it). */
+  uint64_t resets;                /* Times the counters were halved. */
+  uint64_t admitted;              /* admit__allow() calls that let the candidate in. */
+  uint64_t rejected;              /* admit__allow() calls that turned it away. */
+  uint64_t memory;                /* Bytes used by the sketch and doorkeeper. */
+};
+
+
+/* Prototypes */
+int admit__initialize(AdmissionFilter **filter, uint64_t max_bytes, uint32_t expected_size);
+void admit__destroy(AdmissionFilter *filter);
+uint64_t admit__hash(bufferid_t id);
+void admit__record(AdmissionFilter *filter, bufferid_t id);
+uint8_t admit__estimate(AdmissionFilter *filter, bufferid_t id);
+bool admit__allow(AdmissionFilter *filter, bufferid_t candidate, bufferid_t victim);
+void admit__reset(AdmissionFilter *filter);
+
+
+#endif /* SRC_ADMIT_H_ */
@@ -0,0 +1,292 @@
+/*
+ * arena.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: Kyle Harper
+ * Description: See arena.h.  Segments are allocated aligned to their own size, so the segment an image lives in is just its address
+ *              with the low bits cleared.  That keeps arena__free() down to the image pointer, which is all buffer__destroy() has.
+ */
+
+/* Include Headers */
+#include <pthread.h>
+#include <jemalloc/jemalloc.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+
+/* Extern the error codes we'll use. */
+extern const int E_OK;
+extern const int E_NO_MEMORY;
+
+
+/* Room an image of length bytes takes in a segment, and where the first image in a segment starts. */
+#define ARENA_ROUND(bytes) (((bytes) + ARENA_ALIGNMENT - 1) & ~(uint32_t)(ARENA_ALIGNMENT - 1))
+#define ARENA_SLOT(length) ARENA_ROUND((uint32_t)sizeof(ArenaImage) + (length))
+#define ARENA_FIRST        ARENA_ROUND((uint32_t)sizeof(ArenaSegment))
+#define ARENA_SEGMENT_OF(image) ((ArenaSegment *)((uintptr_t)(image) & ~(uintptr_t)(ARENA_SEGMENT_SIZE - 1)))
+
+
+
+/* arena__initialize
+ * Builds an empty arena.  Segments are allocated as images arrive.  Dead bytes are charged to charge, if it isn't NULL.
+ */
+int arena__initialize(CompArena **arena, uint64_t *charge) {
+  *arena = (CompArena *)calloc(1, sizeof(CompArena));
+  if(*arena == NULL)
+    return E_NO_MEMORY;
+  (*arena)->charge = charge;
+  pthread_mutex_init(&(*arena)->lock, NULL);
+  return E_OK;
+}
+
+
+/* arena__destroy
+ * Frees every segment and the arena.  Any buffer still pointing into it is left dangling, so the list has to be gone first.
+ */
+void arena__destroy(CompArena *arena) {
+  if(arena == NULL)
+    return;
+  for(uint32_t i=0; i<arena->segment_count; i++)
+    free(arena->segments[i]);
+  free(arena->segments);
+  pthread_mutex_destroy(&arena->lock);
+  free(arena);
+  return;
+}
+
+
+/* arena__store
+ * Copies a compressed image of length bytes into the arena and returns where it went, or NULL if it can't be had (too big for a
+ * segment, or out of memory).  The image has no owner until arena__adopt(); compaction leaves it alone until then.
+ */
+void* arena__store(CompArena *arena, const void *image, uint32_t length) {
+  pthread_mutex_lock(&arena->lock);
+  void *destination = arena__place(arena, length);
+  if(destination != NULL) {
+    memcpy(destination, image, length);
+    arena->stored++;
+  }
+  pthread_mutex_unlock(&arena->lock);
+  return destination;
+}
+
+
+/* arena__adopt
+ * Names the buffer whose ->data image now is.  From here on compaction may move the image, under owner's lock.
+ */
+void arena__adopt(void *image, Buffer *owner) {
+  ArenaImage *header = (ArenaImage *)image - 1;
+  CompArena *arena = ARENA_SEGMENT_OF(header)->arena;
+  pthread_mutex_lock(&arena->lock);
+  header->owner = owner;
+  pthread_mutex_unlock(&arena->lock);
+  return;
+}
+
+
+/* arena__free
+ * Marks an image dead.  A segment with nothing left in it goes back to the allocator, unless we're still appending to it.
+ */
+void arena__free(void *image) {
+  ArenaImage *header = (ArenaImage *)image - 1;
+  ArenaSegment *segment = ARENA_SEGMENT_OF(header);
+  CompArena *arena = segment->arena;
+  pthread_mutex_lock(&arena->lock);
+  const uint32_t SLOT = ARENA_SLOT(header->length);
+  header->live = 0;
+  header->owner = NULL;
+  segment->live -= SLOT;
+  arena->live_bytes -= SLOT;
+  arena->image_bytes -= header->length;
+  arena__charge(arena, SLOT);
+  if(segment->live == 0 && segment != arena->open)
+    arena__release_segment(arena, segment);
+  pthread_mutex_unlock(&arena->lock);
+  return;
+}
+
+
+/* arena__place
+ * Appends room for an image of length bytes to the open segment, opening a new one if it doesn't fit.  Returns the image's address
+ * (just past its header) or NULL.  Caller MUST hold the arena's lock.
+ */
+void* arena__place(CompArena *arena, uint32_t length) {
+  const uint32_t SLOT = ARENA_SLOT(length);
+  if(SLOT > ARENA_SEGMENT_SIZE - ARENA_FIRST)
+    return NULL;
+  if(arena->open == NULL || arena->open->used + SLOT > ARENA_SEGMENT_SIZE) {
+    // Seal the open segment.  If everything in it already died it was only being kept because it was open.
+    ArenaSegment *sealed = arena->open;
+    arena->open = NULL;
+    if(sealed != NULL && sealed->live == 0)
+      arena__release_segment(arena, sealed);
+    if(arena__add_segment(arena) != E_OK)
+      return NULL;
+  }
+  ArenaImage *header = (ArenaImage *)((uint8_t *)arena->open + arena->open->used);
+  header->owner = NULL;
+  header->length = length;
+  header->live = 1;
+  arena->open->used += SLOT;
+  arena->open->live += SLOT;
+  arena->live_bytes += SLOT;
+  arena->image_bytes += length;
+  return header + 1;
+}
+
+
+/* arena__add_segment
+ * Allocates a new segment and makes it the open one.  Caller MUST hold the arena's lock.
+ */
+int arena__add_segment(CompArena *arena) {
+  if(arena->segment_count == arena->segment_capacity) {
+    const uint32_t CAPACITY = arena->segment_capacity == 0 ? 16 : 2 * arena->segment_capacity;
+    ArenaSegment **segments = (ArenaSegment **)realloc(arena->segments, CAPACITY * sizeof(ArenaSegment *));
+    if(segments == NULL)
+      return E_NO_MEMORY;
+    arena->segments = segments;
+    arena->segment_capacity = CAPACITY;
+  }
+  void *memory = NULL;
+  if(posix_memalign(&memory, ARENA_SEGMENT_SIZE, ARENA_SEGMENT_SIZE) != 0)
+    return E_NO_MEMORY;
+  ArenaSegment *segment = (ArenaSegment *)memory;
+  segment->arena = arena;
+  segment->index = arena->segment_count;
+  segment->used = ARENA_FIRST;
+  segment->live = 0;
+  arena->segments[arena->segment_count++] = segment;
+  if(arena->segment_count > arena->peak_segments)
+    arena->peak_segments = arena->segment_count;
+  arena->open = segment;
+  return E_OK;
+}
+
+
+/* arena__release_segment
+ * Frees an empty segment and takes its dead bytes off the charge.  The last segment in the array takes its place.  Caller MUST hold
+ * the arena's lock.
+ */
+void arena__release_segment(CompArena *arena, ArenaSegment *segment) {
+  arena__charge(arena, -(int64_t)(segment->used - ARENA_FIRST));
+  ArenaSegment *last = arena->segments[arena->segment_count - 1];
+  arena->segments[segment->index] = last;
+  last->index = segment->index;
+  arena->segment_count--;
+  arena->released++;
+  free(segment);
+  return;
+}
+
+
+/* arena__charge
+ * Adds bytes (negative to take them back) to the arena's dead bytes and whatever counter they're charged to.  Caller MUST hold the
+ * arena's lock.  The counter is shared with threads that don't, so it's changed atomically.
+ */
+void arena__charge(CompArena *arena, int64_t bytes) {
+  arena->dead_bytes += bytes;
+  if(arena->charge != NULL)
+    __sync_fetch_and_add(arena->charge, bytes);
+  return;
+}
+
+
+/* arena__compact
+ * Evacuates up to max_segments sealed segments with less than percent of their bytes live, sparsest first.  Stops early if one
+ * can't be emptied (an owner was busy), since it would just be picked again.  Returns the number evacuated.
+ */
+uint32_t arena__compact(CompArena *arena, uint32_t max_segments, uint32_t percent) {
+  uint32_t evacuated = 0;
+  ArenaSegment *sparsest = NULL, *segment = NULL;
+  pthread_mutex_lock(&arena->lock);
+  while(evacuated < max_segments) {
+    sparsest = NULL;
+    for(uint32_t i=0; i<arena->segment_count; i++) {
+      segment = arena->segments[i];
+      if(segment == arena->open || (uint64_t)segment->live * 100 >= (uint64_t)segment->used * percent)
+        continue;
+      if(sparsest == NULL || segment->live < sparsest->live)
+        sparsest = segment;
+    }
+    if(sparsest == NULL || !arena__evacuate(arena, sparsest))
+      break;
+    evacuated++;
+  }
+  pthread_mutex_unlock(&arena->lock);
+  return evacuated;
+}
+
+
+/* arena__evacuate
+ * Copies every live image in segment to the open segment and repoints its owner, then releases segment.  Owners are only ever
+ * try-locked:  a restore holds its buffer's lock while it waits on ours to free the image, so waiting on it here would deadlock.
+ * Returns whether the segment was emptied.  Caller MUST hold the arena's lock.
+ */
+bool arena__evacuate(CompArena *arena, ArenaSegment *segment) {
+  ArenaImage *header = NULL;
+  Buffer *owner = NULL;
+  void *destination = NULL;
+  uint32_t slot = 0;
+  for(uint32_t offset=ARENA_FIRST; offset<segment->used; offset+=slot) {
+    header = (ArenaImage *)((uint8_t *)segment + offset);
+    slot = ARENA_SLOT(header->length);
+    if(header->live == 0)
+      continue;
+    owner = header->owner;
+    if(owner == NULL || pthread_mutex_trylock(&owner->lock) != 0) {
+      arena->busy++;
+      continue;
+    }
+    if(owner->data != (void *)(header + 1)) {
+      pthread_mutex_unlock(&owner->lock);
+      arena->busy++;
+      continue;
+    }
+    destination = arena__place(arena, header->length);
+    if(destination == NULL) {
+      pthread_mutex_unlock(&owner->lock);
+      return false;
+    }
+    memcpy(destination, header + 1, header->length);
+    ((ArenaImage *)destination - 1)->owner = owner;
+    owner->data = destination;
+    pthread_mutex_unlock(&owner->lock);
+    header->live = 0;
+    header->owner = NULL;
+    segment->live -= slot;
+    arena->live_bytes -= slot;
+    arena->image_bytes -= header->length;
+    arena__charge(arena, slot);
+    arena->moved++;
+  }
+  if(segment->live != 0)
+    return false;
+  arena->compactions++;
+  arena__release_segment(arena, segment);
+  return true;
+}
+
+
+/* arena__resident
+ * Bytes of memory the arena holds, dead space included.
+ */
+uint64_t arena__resident(CompArena *arena) {
+  return (uint64_t)arena->segment_count * ARENA_SEGMENT_SIZE;
+}
+
+
+/* arena__show
+ * Prints arena statistics for list__show_structure().
+ */
+void arena__show(CompArena *arena) {
+  printf("Compressed arena                : %'"PRIu32" segments (%'"PRIu32" peak), %'"PRIu64" bytes resident for %'"PRIu64" bytes of images (%.1f%% used), %'"PRIu64" dead\n",
+         arena->segment_count, arena->peak_segments, arena__resident(arena), arena->image_bytes, arena->segment_count == 0 ? 0.0 : 100.0 * arena->image_bytes / arena__resident(arena), arena->dead_bytes);
+  printf("  Compaction                    : %'"PRIu64" images stored, %'"PRIu64" segments released empty, %'"PRIu64" compacted (%'"PRIu64" images moved, %'"PRIu64" busy)\n",
+         arena->stored, arena->released, arena->compactions, arena->moved, arena->busy);
+  return;
+}
@@ -0,0 +1,91 @@
+/*
+ * arena.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: Kyle Harper
+ * Description: Log-structured arena for the compressed tier.  buffer__compress() has to hand back room for the worst case (the
+ *              compressor's bound, a bit more than the page itself), so a compressed buffer kept in its own malloc takes about as much
+ *              memory as a raw one no matter how well it compressed.  Instead, compressors copy each image into large segments,
+ *              appending at exactly its size, and free the bound-sized scratch right away.
+ *
+ *              Every image is preceded by a small header naming the buffer that owns it.  Freeing an image just marks its header
+ *              dead and takes its bytes off the segment's live count; a segment nobody lives in anymore is released right away.
+ *              Segments that are mostly dead get compacted by the sweeper:  their live images are copied to the open segment and
+ *              their owners pointed at the new copy, under each owner's lock, which everyone reading compressed data holds anyway.
+ *
+ *              Dead bytes are still memory until their segment goes back to the allocator, so the arena charges them to a counter
+ *              its owner hands in (the list's current_comp_size) when an image dies, and takes them back off when the segment is
+ *              released or compacted.
+ */
+
+#ifndef SRC_ARENA_H_
+#define SRC_ARENA_H_
+
+/* Includes */
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "buffer.h"
+
+
+/* Limits and tuning. */
+#define ARENA_SEGMENT_SIZE     (1 << 20)  /* Bytes per segment.  Segments are aligned to this so an image can find its segment. */
+#define ARENA_ALIGNMENT        8          /* Images start on this boundary. */
+#define ARENA_COMPACT_PERCENT  50         /* Sealed segments with less than this percent of their bytes live get compacted. */
+#define ARENA_PRESSURE_PERCENT 90         /* ...or this percent, when the comp tier is over its watermark and would evict for them. */
+#define ARENA_COMPACT_BATCH    4          /* Most segments the sweeper compacts each time it comes around. */
+
+
+/* What precedes each image in a segment. */
+typedef struct arenaimage ArenaImage;
+struct arenaimage {
+  Buffer *owner;                  /* The buffer whose ->data this image is.  NULL until arena__adopt(), or once it's dead. */
+  uint32_t length;                /* Bytes in the image, not counting this header or padding. */
+  uint32_t live;                  /* 1 until the image is freed or moved. */
+};
+
+typedef struct comparena CompArena;
+typedef struct arenasegment ArenaSegment;
+struct arenasegment {
+  CompArena *arena;               /* The arena this segment belongs to, so arena__free() only needs the image. */
+  uint32_t index;                 /* Position in arena->segments. */
+  uint32_t used;                  /* Bytes handed out so far, this header included. */
+  uint32_t live;                  /* Bytes of live images, their headers and padding included. */
+};
+
+struct comparena {
+  pthread_mutex_t lock;           /* Compressors store, restores free, and the sweeper compacts; one short lock covers it all. */
+  ArenaSegment **segments;        /* Every segment we have. */
+  uint32_t segment_count;         /* Segments in ->segments. */
+  uint32_t segment_capacity;      /* Room in ->segments before it has to grow. */
+  ArenaSegment *open;             /* Segment new images are appended to, or NULL. */
+  uint64_t live_bytes;            /* Sum of ->live over every segment. */
+  uint64_t image_bytes;           /* Sum of ->length over live images.  live_bytes less headers and padding. */
+  uint64_t dead_bytes;            /* Bytes of dead images (headers and padding included) still sitting in segments we hold. */
+  uint64_t *charge;               /* Counter dead_bytes is charged to as it changes, or NULL. */
+  uint32_t peak_segments;         /* Most segments we've had at once. */
+  uint64_t stored;                /* Images arena__store() took. */
+  uint64_t released;              /* Segments freed because nothing in them was live. */
+  uint64_t compactions;           /* Segments arena__compact() evacuated. */
+  uint64_t moved;                 /* Images compaction copied forward. */
+  uint64_t busy;                  /* Images compaction had to leave where they were because their owner was locked. */
+};
+
+
+/* Prototypes */
+int arena__initialize(CompArena **arena, uint64_t *charge);
+void arena__destroy(CompArena *arena);
+void* arena__store(CompArena *arena, const void *image, uint32_t length);
+void arena__adopt(void *image, Buffer *owner);
+void arena__free(void *image);
+void* arena__place(CompArena *arena, uint32_t length);
+int arena__add_segment(CompArena *arena);
+void arena__release_segment(CompArena *arena, ArenaSegment *segment);
+void arena__charge(CompArena *arena, int64_t bytes);
+uint32_t arena__compact(CompArena *arena, uint32_t max_segments, uint32_t percent);
+bool arena__evacuate(CompArena *arena, ArenaSegment *segment);
+uint64_t arena__resident(CompArena *arena);
+void arena__show(CompArena *arena);
+
+
+#endif /* SRC_ARENA_H_ */
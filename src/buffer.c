@@ -14,6 +14,7 @@
 #include <stdlib.h>
 #include <time.h>     /* for clock_gettime() */
 #include <string.h>   /* for memcpy() */
+#include "arena.h"
 #include "buffer.h"
 #include "lz4/lz4.h"
 #include "zlib/zlib.h"
@@ -33,22 +34,36 @@ const Buffer BUFFER_INITIALIZER = {
   .id = 0,
   .ref_count = 0,
   .flags = 0,
+  .frequency = 0,
   .popularity = 0,
+  .policy_state = 0,
+  .window_stamp = 0,
   .lock = PTHREAD_MUTEX_INITIALIZER,
   /* Cost values for each buffer when pulled from disk or compressed/decompressed. */
   .comp_cost = 0,
   .comp_hits = 0,
+  .window_hits = 0,
   /* The actual payload we want to cache (i.e.: the page). */
   .data_length = 0,
   .comp_length = 0,
+  .dict_id = DICT_NONE,
+  .codec_id = 0,
+  .codec_level = 0,
+  .last_comp_length = 0,
+  .priority = 0,
   .data = NULL,
   /* Tracking for the list we're part of. */
-  .next = NULL
+  .next = NULL,
+  .ring_prev = NULL,
+  .ring_next = NULL
 };
 
 /* We need to know what one billion is for clock timing. */
 #define BILLION 1000000000L
 
+/* Random state for sampling popularity bumps in buffer__touch().  Per thread, so sampling never shares a cache line. */
+__thread uint32_t buffer_touch_state = 0;
+
 /* Extern the error codes we'll use. */
 extern const int E_OK;
 extern const int E_GENERIC;
@@ -115,7 +130,7 @@ int buffer__initialize(Buffer **buf, bufferid_t id, uint32_t size, void *data, c
 void buffer__destroy(Buffer *buf, const bool destroy_data) {
   if (destroy_data) {
     /* Free the members which are pointers to other data locations. */
-    free(buf->data);
+    buffer__free_data(buf);
   }
   /* All remaining members will die when free is invoked against the buffer itself. */
   free(buf);
@@ -149,17 +164,42 @@ void buffer__release_pin(Buffer *buf) {
 }
 
 
+/* buffer__free_data
+ * Frees ->data, wherever it lives, and NULLs it.  Compressed images in an arena go back to it; everything else was malloc'd.  An
+ * image's reference on its dictionary goes with it.
+ */
+void buffer__free_data(Buffer *buf) {
+  if(buf->flags & in_arena)
+    arena__free(buf->data);
+  else
+    free(buf->data);
+  buf->data = NULL;
+  __sync_fetch_and_and(&buf->flags, ~in_arena);
+  dict__release(buf->dict_id);
+  buf->dict_id = DICT_NONE;
+  buf->codec_id = NO_COMPRESSOR_ID;
+  buf->codec_level = 0;
+  return;
+}
+
+
 /* buffer__compress
  * Compresses the buffer's ->data element.
  * Whatever is in ->data will be obliterated without any checking (free()'d).
  * The data_length will remain intact because the compressor needs it for safety (and a future malloc), and we set comp_length to
  * allow us to modify the size(s) in the list accurately.  See buffer__decompress() for the counterpart to this.
+ * ctx is the calling thread's CodecContext; its compressor state is reused instead of being rebuilt for every page.
+ * dict, if not NULL, is a trained dictionary (see dict.h) for zlib or zstd.  The image takes its own reference on it and records
+ * its id in ->dict_id, so the caller's reference is still the caller's.  LZ4 ignores it.
+ * The image remembers compressor_id and compressor_level in ->codec_id and ->codec_level, so decompression never needs to ask the
+ * list what it was made with.  ctx->last_ns says how long it took.
  * Caller MUST drain readers.  (Only sweep should use this...)
  */
-int buffer__compress(Buffer *buf, void **compressed_data, int compressor_id, int compressor_level) {
+int buffer__compress(Buffer *buf, void **compressed_data, int compressor_id, int compressor_level, CodecContext *ctx, Dictionary *dict) {
   // Make sure we're supposed to be here.
   if(compressor_id == NO_COMPRESSOR_ID) {
     buf->comp_length = buf->data_length;
+    buf->codec_id = NO_COMPRESSOR_ID;
     return E_OK;
   }
 
@@ -171,17 +211,27 @@ int buffer__compress(Buffer *buf, void **compressed_data, int compressor_id, int
     return E_BUFFER_MISSING_DATA;
   if (buf->comp_length != 0)
     return E_BUFFER_ALREADY_COMPRESSED;
+  if (ctx == NULL)
+    return E_NO_MEMORY;
+  // Adaptive lists pick a real compressor before they get here (see list__choose_codec()).
+  if (compressor_id != LZ4_COMPRESSOR_ID && compressor_id != ZLIB_COMPRESSOR_ID && compressor_id != ZSTD_COMPRESSOR_ID)
+    return E_BAD_ARGS;
 
   /* Data looks good, time to compress. */
   struct timespec start, end;
   clock_gettime(CLOCK_MONOTONIC, &start);
+  // LZ4 has no use for a dictionary, so its images don't hold one.
+  if(compressor_id == LZ4_COMPRESSOR_ID)
+    dict = NULL;
   // -- Using LZ4
   if(compressor_id == LZ4_COMPRESSOR_ID) {
     int max_compressed_size = LZ4_compressBound(buf->data_length);
     *compressed_data = (void *)malloc(max_compressed_size);
-    if (*compressed_data == NULL)
+    if (*compressed_data == NULL || codec__lz4_state(ctx) != E_OK)
       return E_NO_MEMORY;
-    rv = LZ4_compress_default(buf->data, *compressed_data, buf->data_length, max_compressed_size);
+    // LZ4's only knob is its acceleration, and we always use 1; that's the level the image records.
+    compressor_level = 1;
+    rv = LZ4_compress_fast_extState(ctx->lz4_state, buf->data, *compressed_data, buf->data_length, max_compressed_size, compressor_level);
     if (rv < 1)
       return E_BUFFER_COMPRESSION_PROBLEM;
     // LZ4 returns the compressed size in the rv itself, assign it here.
@@ -193,19 +243,33 @@ int buffer__compress(Buffer *buf, void **compressed_data, int compressor_id, int
     *compressed_data = (void *)malloc(max_compressed_size);
     if (*compressed_data == NULL)
       return E_NO_MEMORY;
-    rv = compress2(*compressed_data, &max_compressed_size, buf->data, buf->data_length, compressor_level);
-    if (rv != Z_OK)
+    rv = codec__deflater(ctx, compressor_level);
+    if (rv != E_OK)
+      return rv;
+    // The dictionary goes in after the reset; its adler32 lands in the header so inflate knows to ask for it.
+    if (dict != NULL && deflateSetDictionary(&ctx->deflater, dict->content, dict->size) != Z_OK)
       return E_BUFFER_COMPRESSION_PROBLEM;
-    // Zlib returns the compressed length in max_compressed_size; so assign it here.
-    buf->comp_length = max_compressed_size;
+    // Same zlib-wrapped stream compress2() makes, so uncompress() can still read it.
+    ctx->deflater.next_in = buf->data;
+    ctx->deflater.avail_in = buf->data_length;
+    ctx->deflater.next_out = *compressed_data;
+    ctx->deflater.avail_out = max_compressed_size;
+    rv = deflate(&ctx->deflater, Z_FINISH);
+    if (rv != Z_STREAM_END)
+      return E_BUFFER_COMPRESSION_PROBLEM;
+    // The stream counts what it wrote since the last reset; that's our compressed length.
+    buf->comp_length = ctx->deflater.total_out;
   }
   // -- Using Zstd
   if(compressor_id == ZSTD_COMPRESSOR_ID) {
     int max_compressed_size = ZSTD_compressBound(buf->data_length);
     *compressed_data = (void *)malloc(max_compressed_size);
-    if (*compressed_data == NULL)
+    if (*compressed_data == NULL || codec__zstd_cctx(ctx) != E_OK)
       return E_NO_MEMORY;
-    rv = ZSTD_compress(*compressed_data, max_compressed_size, buf->data, buf->data_length, compressor_level);
+    if (dict != NULL)
+      rv = ZSTD_compress_usingCDict(ctx->zstd_cctx, *compressed_data, max_compressed_size, buf->data, buf->data_length, dict->cdict);
+    else
+      rv = ZSTD_compressCCtx(ctx->zstd_cctx, *compressed_data, max_compressed_size, buf->data, buf->data_length, compressor_level);
     if (ZSTD_isError(rv))
       return E_BUFFER_COMPRESSION_PROBLEM;
     // ZSTD returns the compressed size in the rv itself, assign it here.
@@ -214,7 +278,14 @@ int buffer__compress(Buffer *buf, void **compressed_data, int compressor_id, int
 
   /* At this point we've compressed the raw data and saved it in a tightly allocated section of heap. */
   clock_gettime(CLOCK_MONOTONIC, &end);
-  buf->comp_cost += BILLION *(end.tv_sec - start.tv_sec) + end.tv_nsec - start.tv_nsec;
+  ctx->last_ns = BILLION *(end.tv_sec - start.tv_sec) + end.tv_nsec - start.tv_nsec;
+  buf->comp_cost += ctx->last_ns;
+  buf->last_comp_length = buf->comp_length;
+  buf->dict_id = dict == NULL ? DICT_NONE : dict->id;
+  dict__retain(buf->dict_id);
+  buf->codec_id = compressor_id;
+  buf->codec_level = compressor_level;
+  ctx->compressions++;
   return E_OK;
 }
 
@@ -222,19 +293,19 @@ int buffer__compress(Buffer *buf, void **compressed_data, int compressor_id, int
 /* buffer__decompress
  * Decompresses the buffer's ->data element.
  * This sets comp_length back to 0 which signals that the buffer is no longer in a compressed state.
+ * ctx is the calling thread's CodecContext (see buffer__compress()).  The image's ->codec_id says which compressor to undo.
  * Caller MUST ensure no pins are in this (only search restores, which is safe for this).
  */
-int buffer__decompress(Buffer *buf, int compressor_id) {
-  // Make sure we're supposed to actually be doing work.
-  if(compressor_id == NO_COMPRESSOR_ID) {
-    buf->comp_length = 0;
-    return E_OK;
-  }
-
+int buffer__decompress(Buffer *buf, CodecContext *ctx) {
   /* Make sure we have a valid buffer with valid data element. */
   int rv = E_OK;
   if (buf == NULL)
     return E_BUFFER_NOT_FOUND;
+  // Make sure we're supposed to actually be doing work.
+  if(buf->codec_id == NO_COMPRESSOR_ID) {
+    buf->comp_length = 0;
+    return E_OK;
+  }
   if (buf->data == NULL || buf->data_length == 0)
     return E_BUFFER_MISSING_DATA;
   if (buf->comp_length == 0)
@@ -246,41 +317,112 @@ int buffer__decompress(Buffer *buf, int compressor_id) {
   void *decompressed_data = (void *)malloc(buf->data_length);
   if (decompressed_data == NULL)
     return E_NO_MEMORY;
+  rv = buffer__decompress_into(buf, decompressed_data, ctx);
+  if (rv != E_OK) {
+    free(decompressed_data);
+    return rv;
+  }
+
+  /* Now free buf->data of it's compressed information and modify the pointer to look at *decompressed_data now. We can avoid using
+   * memcpy because we kept a record of how long the original data_length was, so no guess work. */
+  buffer__free_data(buf);
+  buf->data = decompressed_data;
+
+  /* At this point we've decompressed the data and replaced buf->data with it.  Update tracking counters and move on. */
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  buf->comp_hits++;
+  buf->comp_length = 0;
+  buf->comp_cost += BILLION *(end.tv_sec - start.tv_sec) + end.tv_nsec - start.tv_nsec;
+
+  return E_OK;
+}
+
+
+/* buffer__decompress_into
+ * Decompresses buf->data into destination, which MUST hold at least buf->data_length bytes.  The buffer itself is left compressed
+ * and untouched; this is for readers who want a look at the page without restoring it.  Caller should hold the buffer's lock so
+ * the compressed data can't change underneath us.  Images compressed with a dictionary find it by ->dict_id.  An image with no
+ * codec (the list has no compressor) is the page itself and is just copied.  ctx->last_ns says how long it took.
+ */
+int buffer__decompress_into(Buffer *buf, void *destination, CodecContext *ctx) {
+  int rv = E_OK;
+  if (buf == NULL)
+    return E_BUFFER_NOT_FOUND;
+  if (buf->data == NULL || buf->data_length == 0)
+    return E_BUFFER_MISSING_DATA;
+  if (buf->comp_length == 0)
+    return E_BUFFER_ALREADY_DECOMPRESSED;
+  if (ctx == NULL)
+    return E_NO_MEMORY;
+  Dictionary *dict = dict__find(buf->dict_id);
+  const int compressor_id = buf->codec_id;
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  // -- Not compressed at all
+  if(compressor_id == NO_COMPRESSOR_ID)
+    memcpy(destination, buf->data, buf->data_length);
   // -- Use LZ4
   if(compressor_id == LZ4_COMPRESSOR_ID) {
-    rv = LZ4_decompress_safe(buf->data, decompressed_data, buf->comp_length, buf->data_length);
+    rv = LZ4_decompress_safe(buf->data, destination, buf->comp_length, buf->data_length);
     if (rv < 0)
       return E_BUFFER_COMPRESSION_PROBLEM;
   }
   // -- Use Zlib
   if(compressor_id == ZLIB_COMPRESSOR_ID) {
-    uLongf data_length = buf->data_length;
-    rv = uncompress(decompressed_data, &data_length, buf->data, buf->comp_length);
-    if (rv < 0 || data_length != buf->data_length)
+    rv = codec__inflater(ctx);
+    if (rv != E_OK)
+      return rv;
+    ctx->inflater.next_in = buf->data;
+    ctx->inflater.avail_in = buf->comp_length;
+    ctx->inflater.next_out = destination;
+    ctx->inflater.avail_out = buf->data_length;
+    rv = inflate(&ctx->inflater, Z_FINISH);
+    if (rv == Z_NEED_DICT && dict != NULL && inflateSetDictionary(&ctx->inflater, dict->content, dict->size) == Z_OK)
+      rv = inflate(&ctx->inflater, Z_FINISH);
+    if (rv != Z_STREAM_END || ctx->inflater.total_out != buf->data_length)
       return E_BUFFER_COMPRESSION_PROBLEM;
   }
   // -- Use Zstd
   if(compressor_id == ZSTD_COMPRESSOR_ID) {
-    rv = ZSTD_decompress(decompressed_data, buf->data_length, buf->data, buf->comp_length);
+    if (codec__zstd_dctx(ctx) != E_OK)
+      return E_NO_MEMORY;
+    if (dict != NULL)
+      rv = ZSTD_decompress_usingDDict(ctx->zstd_dctx, destination, buf->data_length, buf->data, buf->comp_length, dict->ddict);
+    else
+      rv = ZSTD_decompressDCtx(ctx->zstd_dctx, destination, buf->data_length, buf->data, buf->comp_length);
     if (ZSTD_isError(rv))
       return E_BUFFER_COMPRESSION_PROBLEM;
   }
-
-  /* Now free buf->data of it's compressed information and modify the pointer to look at *decompressed_data now. We can avoid using
-   * memcpy because we kept a record of how long the original data_length was, so no guess work. */
-  free(buf->data);
-  buf->data = decompressed_data;
-
-  /* At this point we've decompressed the data and replaced buf->data with it.  Update tracking counters and move on. */
   clock_gettime(CLOCK_MONOTONIC, &end);
-  buf->comp_hits++;
-  buf->comp_length = 0;
-  buf->comp_cost += BILLION *(end.tv_sec - start.tv_sec) + end.tv_nsec - start.tv_nsec;
-
+  ctx->last_ns = BILLION *(end.tv_sec - start.tv_sec) + end.tv_nsec - start.tv_nsec;
+  ctx->decompressions++;
   return E_OK;
 }
 
 
+/* buffer__touch
+ * Records a hit for the clock sweep.  Popularity saturates at MAX_POPULARITY and a hit only counts with probability
+ * 1/(popularity+1), so a hot buffer's line gets written less and less often instead of on every search.  Lost bumps from racing
+ * threads don't matter; it's a sample.
+ */
+void buffer__touch(Buffer *buf) {
+  const popularity_t POPULARITY = buf->popularity;
+  if(POPULARITY == MAX_POPULARITY)
+    return;
+  // Per-thread xorshift, seeded from its own address so threads don't walk in lockstep.
+  if(buffer_touch_state == 0)
+    buffer_touch_state = (uint32_t)(uintptr_t)&buffer_touch_state | 1;
+  buffer_touch_state ^= buffer_touch_state << 13;
+  buffer_touch_state ^= buffer_touch_state >> 17;
+  buffer_touch_state ^= buffer_touch_state << 5;
+  if((buffer_touch_state >> 8) % (POPULARITY + 1) != 0)
+    return;
+  buf->popularity = POPULARITY + 1;
+  return;
+}
+
+
 /* buffer__copy
  * Simple function to copy the contents of one buffer and all its elements to another.
  */
@@ -289,25 +431,38 @@ void buffer__copy(Buffer *src, Buffer *dst, bool copy_data) {
   dst->id           = src->id;
   dst->ref_count    = src->ref_count;
   dst->popularity   = src->popularity;
+  dst->policy_state = src->policy_state;
+  dst->frequency    = src->frequency;
+  dst->window_stamp = src->window_stamp;
   // The lock and conditions do not need to be linked.  Nor do pending writers.
   // Do NOT copy flags!
 
   /* Cost values for each buffer when pulled from disk or compressed/decompressed. */
   dst->comp_cost = src->comp_cost;
   dst->comp_hits = src->comp_hits;
+  dst->window_hits = src->window_hits;
 
   /* The actual payload we want to cache (i.e.: the page). */
   dst->data_length = src->data_length;
   dst->comp_length = src->comp_length;
+  dst->last_comp_length = src->last_comp_length;
+  dst->priority = src->priority;
   if(copy_data) {
-    free(dst->data);
+    buffer__free_data(dst);
     dst->data = malloc(src->comp_length > 0 ? src->comp_length : src->data_length);
     memcpy(dst->data, src->data, (src->comp_length > 0 ? src->comp_length : src->data_length));
+    // The copied image needs the same codec and dictionary, and its own reference on the dictionary.
+    dst->dict_id = src->dict_id;
+    dict__retain(dst->dict_id);
+    dst->codec_id = src->codec_id;
+    dst->codec_level = src->codec_level;
   }
 
   /* Tracking for the list we're part of. */
-  // We do NOT copy ->next data because that's handled by list__* functions.
+  // We do NOT copy ->next data because that's handled by list__* functions.  Ring links belong to the policy's replace().
   dst->next = NULL;
+  dst->ring_prev = NULL;
+  dst->ring_next = NULL;
 
   return;
 }
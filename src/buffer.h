@@ -13,6 +13,8 @@
 /* Include necessary headers here. */
 #include <stdint.h>  /* Used for the uint_ types */
 #include <stdbool.h> /* For bool types. */
+#include "codec.h"
+#include "dict.h"
 
 
 /* Globals to help track limits. */
@@ -30,6 +32,12 @@ typedef enum buffer_flags {
   // When sweeping we need to mark the buffer as 'compressing' so list__update() doesn't flake out (deadlock).
   compressing   = 1 <<  5,   // 32
   compressed    = 1 <<  6,   // 64
+  // Lock-free lists hold retired buffers for two grace periods; this marks that the first one has passed.
+  retired       = 1 <<  7,   // 128
+  // A compressor decided this sweep victim isn't worth compressing; the sweeper evicts it instead.
+  incompressible = 1 << 8,   // 256
+  // ->data is a compressed image in the list's arena (see arena.h), not a malloc of its own.
+  in_arena      = 1 <<  9,   // 512
 } buffer_flags;
 
 /* Build the typedef and structure for a Buffer */
@@ -39,21 +47,32 @@ typedef struct buffer Buffer;
 struct buffer {
   /* Tracking for the list we're part of. */
   Buffer *next;                /* Pointer to the next neighbor since lists are singularly linked. */
+  Buffer *ring_prev;           /* Neighbors in the replacement policy's ring for our tier, if it keeps one (see policy.h). */
+  Buffer *ring_next;           /* NULL when we aren't in a ring. */
 
   /* Attributes for typical buffer organization and management. */
   bufferid_t id;               /* Identifier of the page. Should come from the system providing the data itself (e.g.: inode). */
   uint16_t ref_count;          /* Number of references currently holding this buffer. */
-  buffer_flags flags;          /* Holds 32 bit flags.  See enum above for details. */
+  uint16_t frequency;          /* Hits per window, as a decaying average.  Times WINDOW_SCALE.  See window.h. */
+  uint16_t flags;              /* Holds the buffer_flags above.  Changed only with __sync_fetch_and_or/and; the sweeper doesn't take the lock. */
+  uint8_t codec_id;            /* Compressor that made the image (a *_COMPRESSOR_ID), or NO_COMPRESSOR_ID while the page is raw. */
+  int8_t codec_level;          /* Level it was made at.  LZ4's is its acceleration. */
   popularity_t popularity;     /* Rapidly decaying counter used for victim selection with clock sweep.  Ceiling of MAX_POPULARITY. */
+  uint8_t policy_state;        /* Bits owned by the list's replacement policy (see policy.h).  Reset whenever the buffer enters a tier. */
+  uint8_t window_stamp;        /* The popularity window window_hits were counted in. */
+  uint8_t dict_id;             /* Dictionary the image was compressed with, or DICT_NONE.  Holds a reference on it (see dict.h). */
   pthread_mutex_t lock;        /* The primary locking element for individual buffer protection. */
 
   /* Cost values for each buffer. */
   uint32_t comp_cost;          /* Time spent, in ns, to compress and decompress a page.  Using clock_gettime(3) */
   uint16_t comp_hits;          /* Number of times reclaimed from the compressed table during a polling period. */
+  uint16_t window_hits;        /* Number of hits during popularity window window_stamp.  Saturates. */
 
   /* The actual payload we want to cache (i.e.: the page). */
   uint32_t data_length;        /* Number of bytes originally in *data. */
   uint32_t comp_length;        /* Number of bytes in *data if it was compressed.  Set to 0 when not used. */
+  uint32_t last_comp_length;   /* Size the page compressed to the last time it was compressed.  Survives restoration; 0 if never. */
+  uint32_t priority;           /* GDSF:  L plus what keeping us is worth (see policy.h).  Unused by other policies. */
   void *data;                  /* Pointer to the memory holding the page data, whether raw or compressed. */
 };
 
@@ -61,11 +80,14 @@ struct buffer {
 /* Prototypes */
 int buffer__initialize(Buffer **buf, bufferid_t id, uint32_t size, void *data, char *page_filespec);
 void buffer__destroy(Buffer *buf, const bool destroy_data);
+void buffer__free_data(Buffer *buf);
 void buffer__lock(Buffer *buf);
 void buffer__unlock(Buffer *buf);
 void buffer__release_pin(Buffer *buf);
-int buffer__compress(Buffer *buf, void **compressed_data, int compressor_id, int compressor_level);
-int buffer__decompress(Buffer *buf, int compressor_id);
+void buffer__touch(Buffer *buf);
+int buffer__compress(Buffer *buf, void **compressed_data, int compressor_id, int compressor_level, CodecContext *ctx, Dictionary *dict);
+int buffer__decompress(Buffer *buf, CodecContext *ctx);
+int buffer__decompress_into(Buffer *buf, void *destination, CodecContext *ctx);
 void buffer__copy(Buffer *src, Buffer *dst, bool copy_data);
 
 
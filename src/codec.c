@@ -0,0 +1,247 @@
+/*
+ * codec.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: Kyle Harper
+ * Description: See codec.h.  The pieces are built lazily so a list using LZ4 never pays for zstd state and vice versa.
+ */
+
+/* Include Headers */
+#include <pthread.h>
+#include <jemalloc/jemalloc.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "codec.h"
+#include "lz4/lz4.h"
+#include "zlib/zlib.h"
+#include "zstd/zstd.h"
+
+
+/* Extern the error codes we'll use. */
+extern const int E_OK;
+extern const int E_NO_MEMORY;
+extern const int E_BUFFER_COMPRESSION_PROBLEM;
+
+/* Extern the compressor IDs for codec__name(). */
+extern const int NO_COMPRESSOR_ID;
+extern const int LZ4_COMPRESSOR_ID;
+extern const int ZLIB_COMPRESSOR_ID;
+extern const int ZSTD_COMPRESSOR_ID;
+extern const int ADAPTIVE_COMPRESSOR_ID;
+
+
+/* Each thread's context for codec__thread_context().  The key's destructor frees it when the thread exits. */
+__thread CodecContext *codec_thread_context = NULL;
+pthread_key_t codec_thread_key;
+pthread_once_t codec_thread_key_once = PTHREAD_ONCE_INIT;
+
+
+
+/* codec__initialize
+ * Builds an empty context.  Nothing is allocated for a compressor until it's first used.
+ */
+int codec__initialize(CodecContext **ctx) {
+  *ctx = (CodecContext *)calloc(1, sizeof(CodecContext));
+  if(*ctx == NULL)
+    return E_NO_MEMORY;
+  (*ctx)->deflate_level = CODEC_NO_LEVEL;
+  return E_OK;
+}
+
+
+/* codec__destroy
+ * Frees whatever state the context built, and the context.
+ */
+void codec__destroy(CodecContext *ctx) {
+  if(ctx == NULL)
+    return;
+  free(ctx->lz4_state);
+  ZSTD_freeCCtx(ctx->zstd_cctx);
+  ZSTD_freeDCtx(ctx->zstd_dctx);
+  if(ctx->deflate_level != CODEC_NO_LEVEL)
+    deflateEnd(&ctx->deflater);
+  if(ctx->inflater_ready)
+    inflateEnd(&ctx->inflater);
+  free(ctx);
+  return;
+}
+
+
+/* codec__make_thread_key
+ * pthread_once() helper for codec__thread_context().
+ */
+void codec__make_thread_key() {
+  pthread_key_create(&codec_thread_key, (void (*)(void *))codec__destroy);
+  return;
+}
+
+
+/* codec__thread_context
+ * Returns the calling thread's context, building it on first use.  NULL only if we're out of memory, which buffer__compress() and
+ * friends report as E_NO_MEMORY.
+ */
+CodecContext* codec__thread_context() {
+  if(codec_thread_context != NULL)
+    return codec_thread_context;
+  pthread_once(&codec_thread_key_once, codec__make_thread_key);
+  if(codec__initialize(&codec_thread_context) != E_OK)
+    return NULL;
+  pthread_setspecific(codec_thread_key, codec_thread_context);
+  return codec_thread_context;
+}
+
+
+/* codec__lz4_state
+ * Makes sure ctx has room for an LZ4 compression state.
+ */
+int codec__lz4_state(CodecContext *ctx) {
+  if(ctx->lz4_state != NULL)
+    return E_OK;
+  ctx->lz4_state = malloc(LZ4_sizeofState());
+  return ctx->lz4_state == NULL ? E_NO_MEMORY : E_OK;
+}
+
+
+/* codec__zstd_cctx
+ * Makes sure ctx has a zstd compression context.
+ */
+int codec__zstd_cctx(CodecContext *ctx) {
+  if(ctx->zstd_cctx == NULL)
+    ctx->zstd_cctx = ZSTD_createCCtx();
+  return ctx->zstd_cctx == NULL ? E_NO_MEMORY : E_OK;
+}
+
+
+/* codec__zstd_dctx
+ * Makes sure ctx has a zstd decompression context.
+ */
+int codec__zstd_dctx(CodecContext *ctx) {
+  if(ctx->zstd_dctx == NULL)
+    ctx->zstd_dctx = ZSTD_createDCtx();
+  return ctx->zstd_dctx == NULL ? E_NO_MEMORY : E_OK;
+}
+
+
+/* codec__deflater
+ * Gets ctx's deflate stream ready for a new page at level.  A stream at the same level is just reset; the level only changes if the
+ * caller switches lists, so rebuilding the stream then is fine.
+ */
+int codec__deflater(CodecContext *ctx, int level) {
+  if(ctx->deflate_level == level)
+    return deflateReset(&ctx->deflater) == Z_OK ? E_OK : E_BUFFER_COMPRESSION_PROBLEM;
+  if(ctx->deflate_level != CODEC_NO_LEVEL)
+    deflateEnd(&ctx->deflater);
+  ctx->deflate_level = CODEC_NO_LEVEL;
+  memset(&ctx->deflater, 0, sizeof(z_stream));
+  switch(deflateInit(&ctx->deflater, level)) {
+    case Z_OK:         break;
+    case Z_MEM_ERROR:  return E_NO_MEMORY;
+    default:           return E_BUFFER_COMPRESSION_PROBLEM;
+  }
+  ctx->deflate_level = level;
+  return E_OK;
+}
+
+
+/* codec__inflater
+ * Gets ctx's inflate stream ready for a new page.
+ */
+int codec__inflater(CodecContext *ctx) {
+  if(ctx->inflater_ready)
+    return inflateReset(&ctx->inflater) == Z_OK ? E_OK : E_BUFFER_COMPRESSION_PROBLEM;
+  memset(&ctx->inflater, 0, sizeof(z_stream));
+  switch(inflateInit(&ctx->inflater)) {
+    case Z_OK:         break;
+    case Z_MEM_ERROR:  return E_NO_MEMORY;
+    default:           return E_BUFFER_COMPRESSION_PROBLEM;
+  }
+  ctx->inflater_ready = true;
+  return E_OK;
+}
+
+
+/* codec__entropy
+ * Estimates how compressible a page is:  the order-0 entropy, in bits per byte, of CODEC_PROBE_SLICES slices spread across it.  0
+ * is a page of one byte repeated, 8 is noise.  It only sees single bytes, so it can't spot repeated strings; it's a cheap first guess
+ * for pages we've never compressed, not a substitute for having done it.
+ */
+double codec__entropy(const void *page, uint32_t length) {
+  const uint8_t *bytes = (const uint8_t *)page;
+  uint32_t histogram[256] = {0};
+  uint32_t seen = 0;
+  if(page == NULL || length == 0)
+    return 8.0;
+  // Small pages are read whole.  Otherwise each slice starts one stride after the last.
+  if(length <= CODEC_PROBE_SLICES * CODEC_PROBE_BYTES) {
+    for(uint32_t i = 0; i < length; i++)
+      histogram[bytes[i]]++;
+    seen = length;
+  } else {
+    const uint32_t STRIDE = length / CODEC_PROBE_SLICES;
+    for(uint32_t slice = 0; slice < CODEC_PROBE_SLICES; slice++)
+      for(uint32_t i = slice * STRIDE; i < slice * STRIDE + CODEC_PROBE_BYTES; i++)
+        histogram[bytes[i]]++;
+    seen = CODEC_PROBE_SLICES * CODEC_PROBE_BYTES;
+  }
+  double entropy = 0.0;
+  for(int i = 0; i < 256; i++) {
+    if(histogram[i] == 0)
+      continue;
+    const double P = (double)histogram[i] / seen;
+    entropy -= P * log2(P);
+  }
+  return entropy;
+}
+
+
+/* codec__name
+ * Short name of a compressor, as -c spells it.
+ */
+const char* codec__name(int compressor_id) {
+  if(compressor_id == LZ4_COMPRESSOR_ID)
+    return "lz4";
+  if(compressor_id == ZLIB_COMPRESSOR_ID)
+    return "zlib";
+  if(compressor_id == ZSTD_COMPRESSOR_ID)
+    return "zstd";
+  if(compressor_id == ADAPTIVE_COMPRESSOR_ID)
+    return "adaptive";
+  return "none";
+}
+
+
+/* codec__count_compression
+ * Tallies an image that made it into the compressed tier.  Compression time is counted separately, when it's spent.
+ */
+void codec__count_compression(CodecStats *stats, uint32_t data_length, uint32_t comp_length) {
+  __sync_fetch_and_add(&stats->compressions, 1);
+  __sync_fetch_and_add(&stats->data_bytes, data_length);
+  __sync_fetch_and_add(&stats->comp_bytes, comp_length);
+  return;
+}
+
+
+/* codec__count_decompression
+ * Tallies a decompression that took ns.
+ */
+void codec__count_decompression(CodecStats *stats, uint64_t ns) {
+  __sync_fetch_and_add(&stats->decompressions, 1);
+  __sync_fetch_and_add(&stats->decompress_ns, ns);
+  return;
+}
+
+
+/* codec__show
+ * Prints one codec's tally after label.
+ */
+void codec__show(const CodecStats *stats, const char *label) {
+  printf("%s: %'"PRIu64" pages, %'"PRIu64" bytes saved (%.2fx).  %'.1f ms compressing, %'"PRIu64" decompressions in %'.1f ms.\n",
+         label, stats->compressions, stats->data_bytes - stats->comp_bytes, stats->comp_bytes == 0 ? 0.0 : (double)stats->data_bytes / stats->comp_bytes,
+         stats->compress_ns / 1000000.0, stats->decompressions, stats->decompress_ns / 1000000.0);
+  return;
+}
@@ -0,0 +1,85 @@
+/*
+ * codec.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: Kyle Harper
+ * Description: Reusable compressor state.  The one-shot calls (ZSTD_compress, compress2, LZ4_compress_default) build and tear down
+ *              their state on every page, which for zstd is a big allocation and a table fill each time.  A CodecContext keeps
+ *              that state around instead:  a ZSTD_CCtx/DCtx, a deflate and an inflate stream that get reset between pages, and an
+ *              LZ4 state for LZ4_compress_fast_extState().  Each piece is built the first time it's needed.
+ *
+ *              A context is only ever used by one thread.  Compressor threads make their own; readers that restore buffers use
+ *              codec__thread_context(), which builds one per thread on first use and frees it when the thread exits.
+ *
+ *              Lists compressing with -c adaptive pick a codec for each page (see list__choose_codec()).  The cheap part of that
+ *              choice lives here:  codec__entropy() guesses how compressible a page is from a byte histogram of a few slices of it.
+ *              CodecStats keeps each codec's tally so the results can show what the choice bought.
+ */
+
+#ifndef SRC_CODEC_H_
+#define SRC_CODEC_H_
+
+/* Includes */
+#include <stdbool.h>
+#include <stdint.h>
+#include "zlib/zlib.h"
+#include "zstd/zstd.h"
+
+
+/* deflate_level before the deflate stream exists. */
+#define CODEC_NO_LEVEL  -2
+
+/* Per-page codec choice for -c adaptive. */
+#define CODEC_SLOTS          4      /* CodecStats slots:  one per codec an image can have, NO_COMPRESSOR_ID through ZSTD_COMPRESSOR_ID. */
+#define CODEC_PROBE_SLICES   16     /* Slices of the page codec__entropy() reads, spread evenly across it. */
+#define CODEC_PROBE_BYTES    128    /* Bytes in each slice.  2k all told, a quarter of an 8k page. */
+#define CODEC_HOT_RESTORES   2      /* Restores after which a page is hot enough that decompression speed matters more than size. */
+#define CODEC_COLD_ENTROPY   6.0    /* Bits per byte.  Pages the probe puts at or under this are compressible enough for zstd. */
+#define CODEC_COLD_RATIO     2      /* Pages that compressed at least this well last time are compressible enough for zstd. */
+#define CODEC_COLD_LEVEL     3      /* zstd level for cold pages.  zstd's own default; decompression speed doesn't depend on it. */
+
+
+typedef struct codeccontext CodecContext;
+struct codeccontext {
+  void *lz4_state;                /* LZ4_sizeofState() bytes for LZ4_compress_fast_extState(). */
+  ZSTD_CCtx *zstd_cctx;           /* Reused by ZSTD_compressCCtx(). */
+  ZSTD_DCtx *zstd_dctx;           /* Reused by ZSTD_decompressDCtx(). */
+  z_stream deflater;              /* Reset between pages with deflateReset(). */
+  z_stream inflater;              /* Reset between pages with inflateReset(). */
+  int deflate_level;              /* Level the deflater is set to, or CODEC_NO_LEVEL before it exists. */
+  bool inflater_ready;            /* Whether inflateInit() has been run on ->inflater. */
+  uint64_t compressions;          /* Pages compressed with this context. */
+  uint64_t decompressions;        /* Pages decompressed with this context. */
+  uint64_t last_ns;               /* How long the last compression or decompression took, in ns. */
+};
+
+/* What one codec did for a list.  Updated with atomics; compressors and readers share it. */
+typedef struct codecstats CodecStats;
+struct codecstats {
+  uint64_t compressions;          /* Images that made it into the compressed tier. */
+  uint64_t data_bytes;            /* Their raw bytes. */
+  uint64_t comp_bytes;            /* Their compressed bytes. */
+  uint64_t compress_ns;           /* Time spent compressing, including pages that weren't worth keeping. */
+  uint64_t decompressions;        /* Images decompressed:  restores, unspills, and no-promote scans. */
+  uint64_t decompress_ns;         /* Time spent on them. */
+};
+
+
+/* Prototypes */
+int codec__initialize(CodecContext **ctx);
+void codec__destroy(CodecContext *ctx);
+CodecContext* codec__thread_context();
+void codec__make_thread_key();
+int codec__lz4_state(CodecContext *ctx);
+int codec__zstd_cctx(CodecContext *ctx);
+int codec__zstd_dctx(CodecContext *ctx);
+int codec__deflater(CodecContext *ctx, int level);
+int codec__inflater(CodecContext *ctx);
+double codec__entropy(const void *page, uint32_t length);
+const char* codec__name(int compressor_id);
+void codec__count_compression(CodecStats *stats, uint32_t data_length, uint32_t comp_length);
+void codec__count_decompression(CodecStats *stats, uint64_t ns);
+void codec__show(const CodecStats *stats, const char *indent);
+
+
+#endif /* SRC_CODEC_H_ */
@@ -0,0 +1,425 @@
+/*
+ * dict.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: Kyle Harper
+ * Description: See dict.h.  Training runs in the sweeper on samples it detaches from the trainer, so compressors only ever wait on
+ *              the trainer's lock for a memcpy or a few counters.
+ */
+
+/* Include Headers */
+#include <pthread.h>
+#include <jemalloc/jemalloc.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dict.h"
+#include "zstd/zstd.h"
+
+
+/* Extern the error codes we'll use. */
+extern const int E_OK;
+extern const int E_TRY_AGAIN;
+extern const int E_NO_MEMORY;
+extern const int E_BAD_ARGS;
+
+/* Only zlib and zstd take dictionaries. */
+extern const int ZLIB_COMPRESSOR_ID;
+extern const int ZSTD_COMPRESSOR_ID;
+
+
+/* Every live dictionary in the process, by id % DICT_MAX_LIVE.  The lock covers adding and removing; readers hold a reference. */
+Dictionary *dict_registry[DICT_MAX_LIVE];
+pthread_mutex_t dict_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+uint8_t dict_next_id = 1;
+
+/* Bucket of an 8-byte substring.  memcpy() keeps unaligned loads legal; it compiles to one. */
+#define DICT_HASH(bytes) ((uint32_t)(dict__load64(bytes) * 0x9E3779B97F4A7C15ULL >> (64 - DICT_HASH_BITS)))
+
+
+
+/* dict__initialize
+ * Builds a trainer for a list.  It starts out sampling so the first dictionary comes as soon as enough pages go by.
+ */
+int dict__initialize(DictTrainer **trainer, uint32_t dict_size, int compressor_id, int compressor_level) {
+  if(dict_size < DICT_MIN_SIZE || dict_size > DICT_MAX_SIZE)
+    return E_BAD_ARGS;
+  *trainer = (DictTrainer *)calloc(1, sizeof(DictTrainer));
+  if(*trainer == NULL)
+    return E_NO_MEMORY;
+  pthread_mutex_init(&(*trainer)->lock, NULL);
+  (*trainer)->dict_size = dict_size;
+  (*trainer)->compressor_id = compressor_id;
+  (*trainer)->compressor_level = compressor_level;
+  (*trainer)->sampling = (compressor_id == ZLIB_COMPRESSOR_ID || compressor_id == ZSTD_COMPRESSOR_ID);
+  return E_OK;
+}
+
+
+/* dict__destroy
+ * Frees the trainer and lets go of its current dictionary.  Images that still use a dictionary keep it alive until they're freed.
+ */
+void dict__destroy(DictTrainer *trainer) {
+  if(trainer == NULL)
+    return;
+  if(trainer->current != NULL)
+    dict__release(trainer->current->id);
+  free(trainer->samples);
+  pthread_mutex_destroy(&trainer->lock);
+  free(trainer);
+  return;
+}
+
+
+/* dict__sample
+ * Keeps a copy of a raw page for the next training, if we're collecting.  Compressors call this for every page they're about to
+ * compress; the dirty read keeps it to one branch when we aren't.
+ */
+void dict__sample(DictTrainer *trainer, const void *page, uint32_t length) {
+  if(trainer->sampling == 0 || trainer->sample_count >= DICT_SAMPLE_PAGES || length == 0)
+    return;
+  pthread_mutex_lock(&trainer->lock);
+  if(trainer->sampling == 0 || trainer->sample_count >= DICT_SAMPLE_PAGES || trainer->sample_bytes + length > DICT_SAMPLE_MAX_BYTES) {
+    pthread_mutex_unlock(&trainer->lock);
+    return;
+  }
+  if(trainer->sample_bytes + length > trainer->sample_capacity) {
+    uint64_t capacity = trainer->sample_capacity == 0 ? (uint64_t)length * 16 : trainer->sample_capacity * 2;
+    if(capacity < trainer->sample_bytes + length)
+      capacity = trainer->sample_bytes + length;
+    if(capacity > DICT_SAMPLE_MAX_BYTES)
+      capacity = DICT_SAMPLE_MAX_BYTES;
+    uint8_t *samples = (uint8_t *)realloc(trainer->samples, capacity);
+    if(samples == NULL) {
+      pthread_mutex_unlock(&trainer->lock);
+      return;
+    }
+    trainer->samples = samples;
+    trainer->sample_capacity = capacity;
+  }
+  memcpy(trainer->samples + trainer->sample_bytes, page, length);
+  trainer->sample_lengths[trainer->sample_count++] = length;
+  trainer->sample_bytes += length;
+  pthread_mutex_unlock(&trainer->lock);
+  return;
+}
+
+
+/* dict__current
+ * Returns the dictionary new images should use, with a reference the caller MUST give back with dict__release(), or NULL if there
+ * isn't one yet.  The reference keeps a retraining from freeing it mid-compression.
+ */
+Dictionary* dict__current(DictTrainer *trainer) {
+  if(trainer->current == NULL)
+    return NULL;
+  pthread_mutex_lock(&trainer->lock);
+  Dictionary *dict = trainer->current;
+  if(dict != NULL)
+    __sync_fetch_and_add(&dict->refs, 1);
+  pthread_mutex_unlock(&trainer->lock);
+  return dict;
+}
+
+
+/* dict__record
+ * Counts a page compressed with dict.  Every DICT_DRIFT_PAGES pages with the current dictionary we compare the window's ratio with
+ * its first window's.  If pages have drifted far enough from what it was trained on, we start sampling for a new one.
+ */
+void dict__record(DictTrainer *trainer, Dictionary *dict, uint32_t data_length, uint32_t comp_length) {
+  pthread_mutex_lock(&trainer->lock);
+  trainer->pages++;
+  trainer->data_bytes += data_length;
+  trainer->comp_bytes += comp_length;
+  if(dict != trainer->current) {
+    pthread_mutex_unlock(&trainer->lock);
+    return;
+  }
+  trainer->window_data += data_length;
+  trainer->window_comp += comp_length;
+  trainer->window_pages++;
+  if(trainer->window_pages >= DICT_DRIFT_PAGES && trainer->window_comp > 0) {
+    const double RATIO = (double)trainer->window_data / trainer->window_comp;
+    if(dict->baseline_ratio == 0.0) {
+      dict->baseline_ratio = RATIO;
+    } else if(trainer->sampling == 0 && RATIO * 100 < dict->baseline_ratio * (100 - DICT_DRIFT_PERCENT)) {
+      trainer->sampling = 1;
+      trainer->drifts++;
+    }
+    trainer->window_data = 0;
+    trainer->window_comp = 0;
+    trainer->window_pages = 0;
+  }
+  pthread_mutex_unlock(&trainer->lock);
+  return;
+}
+
+
+/* dict__train
+ * Trains and installs a new dictionary once we've sampled enough pages.  The sweeper calls this each time it wakes up; it's a dirty
+ * read unless there's work to do.  Returns E_TRY_AGAIN if every registry slot is taken (the samples are kept for next time).
+ */
+int dict__train(DictTrainer *trainer) {
+  if(trainer->sampling == 0 || trainer->sample_count < DICT_SAMPLE_PAGES)
+    return E_OK;
+  // Detach the samples so compressors aren't held up while we build.
+  pthread_mutex_lock(&trainer->lock);
+  uint8_t *samples = trainer->samples;
+  uint32_t lengths[DICT_SAMPLE_PAGES];
+  const uint32_t COUNT = trainer->sample_count;
+  memcpy(lengths, trainer->sample_lengths, sizeof(lengths));
+  trainer->samples = NULL;
+  trainer->sample_capacity = 0;
+  trainer->sample_count = 0;
+  trainer->sample_bytes = 0;
+  trainer->sampling = 0;
+  pthread_mutex_unlock(&trainer->lock);
+
+  uint8_t *content = (uint8_t *)malloc(trainer->dict_size);
+  if(content == NULL) {
+    free(samples);
+    trainer->sampling = 1;
+    return E_NO_MEMORY;
+  }
+  const uint32_t SIZE = dict__build(samples, lengths, COUNT, content, trainer->dict_size);
+  Dictionary *dict = NULL;
+  int rv = SIZE < DICT_MIN_SIZE ? E_TRY_AGAIN : dict__register(content, SIZE, trainer->compressor_id, trainer->compressor_level, &dict);
+  free(content);
+  free(samples);
+  if(rv != E_OK) {
+    // Try again with fresh samples.  Pages that didn't have enough in common may have some by then.
+    if(rv == E_TRY_AGAIN && SIZE >= DICT_MIN_SIZE)
+      trainer->full++;
+    trainer->sampling = 1;
+    return rv;
+  }
+
+  pthread_mutex_lock(&trainer->lock);
+  Dictionary *old = trainer->current;
+  trainer->current = dict;
+  trainer->window_data = 0;
+  trainer->window_comp = 0;
+  trainer->window_pages = 0;
+  trainer->trainings++;
+  pthread_mutex_unlock(&trainer->lock);
+  if(old != NULL)
+    dict__release(old->id);
+  return E_OK;
+}
+
+
+/* dict__load64
+ * Reads 8 bytes from anywhere for DICT_HASH.
+ */
+uint64_t dict__load64(const uint8_t *bytes) {
+  uint64_t value = 0;
+  memcpy(&value, bytes, sizeof(value));
+  return value;
+}
+
+
+/* dict__build
+ * Builds a raw-content dictionary of up to capacity bytes from count samples laid end to end.  A cut-down COVER:
+ *   1. Count, for every 8-byte substring (d-mer), how many samples it appears in.  Ones in a single sample are noise.
+ *   2. Split the samples into one epoch per segment we have room for, and take the DICT_SEGMENT bytes in each epoch whose d-mers
+ *      add up to the most.  Those d-mers are now covered, so they stop counting toward later picks.
+ *   3. Lay the picks out worst to best.  zstd and zlib both reach the end of a dictionary with the shortest offsets, and zlib only
+ *      sees the last 32k of it.
+ * Returns the dictionary's size.
+ */
+uint32_t dict__build(const uint8_t *samples, const uint32_t *lengths, uint32_t count, uint8_t *dict, uint32_t capacity) {
+  uint64_t total = 0;
+  for(uint32_t s=0; s<count; s++)
+    total += lengths[s];
+  if(total < DICT_SEGMENT || capacity < DICT_SEGMENT)
+    return 0;
+  uint32_t *frequency = (uint32_t *)calloc(1 << DICT_HASH_BITS, sizeof(uint32_t));
+  uint32_t *last_sample = (uint32_t *)calloc(1 << DICT_HASH_BITS, sizeof(uint32_t));
+  uint64_t epochs = capacity / DICT_SEGMENT;
+  if(epochs > total / DICT_SEGMENT)
+    epochs = total / DICT_SEGMENT;
+  uint64_t *picks = (uint64_t *)malloc(epochs * sizeof(uint64_t));
+  uint64_t *scores = (uint64_t *)malloc(epochs * sizeof(uint64_t));
+  if(frequency == NULL || last_sample == NULL || picks == NULL || scores == NULL) {
+    free(frequency);
+    free(last_sample);
+    free(picks);
+    free(scores);
+    return 0;
+  }
+
+  // 1.  Sample counts per d-mer bucket.  last_sample holds sample number + 1 so a d-mer only counts once per sample.
+  uint64_t offset = 0;
+  uint32_t bucket = 0;
+  for(uint32_t s=0; s<count; s++) {
+    for(uint32_t i=0; i + DICT_DMER <= lengths[s]; i++) {
+      bucket = DICT_HASH(samples + offset + i);
+      if(last_sample[bucket] != s + 1) {
+        last_sample[bucket] = s + 1;
+        frequency[bucket]++;
+      }
+    }
+    offset += lengths[s];
+  }
+  for(uint32_t b=0; b < (1u << DICT_HASH_BITS); b++)
+    if(frequency[b] < 2)
+      frequency[b] = 0;
+
+  // 2.  The best segment in each epoch, by a sliding sum over its d-mers.
+  const uint64_t EPOCH_SIZE = total / epochs;
+  const uint32_t WINDOW = DICT_SEGMENT - DICT_DMER + 1;
+  uint64_t picked = 0, start = 0, end = 0, score = 0, best = 0, best_score = 0;
+  for(uint64_t e=0; e<epochs; e++) {
+    start = e * EPOCH_SIZE;
+    end = (e == epochs - 1 ? total : start + EPOCH_SIZE) - DICT_SEGMENT;
+    score = 0;
+    for(uint32_t i=0; i<WINDOW; i++)
+      score += frequency[DICT_HASH(samples + start + i)];
+    best = start;
+    best_score = score;
+    for(uint64_t p=start + 1; p<=end; p++) {
+      score += frequency[DICT_HASH(samples + p + WINDOW - 1)];
+      score -= frequency[DICT_HASH(samples + p - 1)];
+      if(score > best_score) {
+        best = p;
+        best_score = score;
+      }
+    }
+    if(best_score == 0)
+      continue;
+    for(uint32_t i=0; i<WINDOW; i++)
+      frequency[DICT_HASH(samples + best + i)] = 0;
+    picks[picked] = best;
+    scores[picked] = best_score;
+    picked++;
+  }
+
+  // 3.  Insertion sort by score, ascending; there are at most DICT_MAX_SIZE / DICT_SEGMENT picks.
+  uint64_t pick = 0;
+  for(uint64_t i=1; i<picked; i++) {
+    pick = picks[i];
+    score = scores[i];
+    uint64_t j = i;
+    for(; j>0 && scores[j-1] > score; j--) {
+      picks[j] = picks[j-1];
+      scores[j] = scores[j-1];
+    }
+    picks[j] = pick;
+    scores[j] = score;
+  }
+  for(uint64_t i=0; i<picked; i++)
+    memcpy(dict + i * DICT_SEGMENT, samples + picks[i], DICT_SEGMENT);
+
+  free(frequency);
+  free(last_sample);
+  free(picks);
+  free(scores);
+  return picked * DICT_SEGMENT;
+}
+
+
+/* dict__register
+ * Copies content into a new dictionary, prepares it for the compressor, and gives it an id whose registry slot is free.  The new
+ * dictionary has one reference, the caller's.  Returns E_TRY_AGAIN if every slot is taken.
+ */
+int dict__register(const void *content, uint32_t size, int compressor_id, int compressor_level, Dictionary **dict) {
+  *dict = (Dictionary *)calloc(1, sizeof(Dictionary));
+  if(*dict == NULL)
+    return E_NO_MEMORY;
+  (*dict)->content = malloc(size);
+  if((*dict)->content == NULL) {
+    free(*dict);
+    return E_NO_MEMORY;
+  }
+  memcpy((*dict)->content, content, size);
+  (*dict)->size = size;
+  (*dict)->refs = 1;
+  if(compressor_id == ZSTD_COMPRESSOR_ID) {
+    (*dict)->cdict = ZSTD_createCDict(content, size, compressor_level);
+    (*dict)->ddict = ZSTD_createDDict(content, size);
+    if((*dict)->cdict == NULL || (*dict)->ddict == NULL) {
+      ZSTD_freeCDict((*dict)->cdict);
+      ZSTD_freeDDict((*dict)->ddict);
+      free((*dict)->content);
+      free(*dict);
+      return E_NO_MEMORY;
+    }
+  }
+
+  pthread_mutex_lock(&dict_registry_lock);
+  for(uint32_t tries=0; tries<DICT_MAX_LIVE; tries++) {
+    if(dict_next_id == DICT_NONE)
+      dict_next_id++;
+    if(dict_registry[dict_next_id % DICT_MAX_LIVE] == NULL) {
+      (*dict)->id = dict_next_id++;
+      dict_registry[(*dict)->id % DICT_MAX_LIVE] = *dict;
+      pthread_mutex_unlock(&dict_registry_lock);
+      return E_OK;
+    }
+    dict_next_id++;
+  }
+  pthread_mutex_unlock(&dict_registry_lock);
+  ZSTD_freeCDict((*dict)->cdict);
+  ZSTD_freeDDict((*dict)->ddict);
+  free((*dict)->content);
+  free(*dict);
+  *dict = NULL;
+  return E_TRY_AGAIN;
+}
+
+
+/* dict__find
+ * Returns the dictionary with this id, or NULL for DICT_NONE.  Caller MUST hold a reference on it (an image compressed with it
+ * counts), which is what keeps the slot from being reused.
+ */
+Dictionary* dict__find(uint8_t id) {
+  if(id == DICT_NONE)
+    return NULL;
+  return dict_registry[id % DICT_MAX_LIVE];
+}
+
+
+/* dict__retain
+ * Takes another reference on a dictionary the caller already holds one on.
+ */
+void dict__retain(uint8_t id) {
+  if(id == DICT_NONE)
+    return;
+  __sync_fetch_and_add(&dict__find(id)->refs, 1);
+  return;
+}
+
+
+/* dict__release
+ * Gives back a reference.  The last one frees the dictionary and its registry slot.  Nobody can take a new reference on it at that
+ * point; the trainer let go of its own when it was replaced.
+ */
+void dict__release(uint8_t id) {
+  if(id == DICT_NONE)
+    return;
+  Dictionary *dict = dict__find(id);
+  if(__sync_sub_and_fetch(&dict->refs, 1) != 0)
+    return;
+  pthread_mutex_lock(&dict_registry_lock);
+  dict_registry[id % DICT_MAX_LIVE] = NULL;
+  pthread_mutex_unlock(&dict_registry_lock);
+  ZSTD_freeCDict(dict->cdict);
+  ZSTD_freeDDict(dict->ddict);
+  free(dict->content);
+  free(dict);
+  return;
+}
+
+
+/* dict__show
+ * Prints dictionary statistics for list__show_structure() and the manager.
+ */
+void dict__show(DictTrainer *trainer) {
+  printf("Dictionaries                    : %'"PRIu64" trained (%'"PRIu64" for drift, %'"PRIu64" put off), current id %"PRIu8" of %'"PRIu32" bytes\n",
+         trainer->trainings, trainer->drifts, trainer->full, trainer->current == NULL ? DICT_NONE : trainer->current->id, trainer->current == NULL ? 0 : trainer->current->size);
+  printf("  Compression                   : %'"PRIu64" pages with a dictionary, %'"PRIu64" bytes to %'"PRIu64" (%.2fx)\n",
+         trainer->pages, trainer->data_bytes, trainer->comp_bytes, trainer->comp_bytes == 0 ? 0.0 : (double)trainer->data_bytes / trainer->comp_bytes);
+  return;
+}
@@ -0,0 +1,100 @@
+/*
+ * dict.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: Kyle Harper
+ * Description: Trained compression dictionaries for zstd and zlib.  Our pages are only 8k to 32k, too small for either compressor
+ *              to learn much from the page itself.  A dictionary built from other pages gives them a head start.
+ *
+ *              The compressors sample raw pages on their way to the compressed tier.  Once enough are in, the sweeper trains a
+ *              dictionary from them.  The vendored zstd has no dictBuilder, so dict__build() is our own cut-down COVER:  it keeps
+ *              the segments whose 8-byte substrings turn up in the most samples, best ones last, where both compressors can reach
+ *              them cheapest.  The result is a raw-content dictionary.  zstd loads it into a prepared CDict/DDict and zlib passes
+ *              it to deflateSetDictionary()/inflateSetDictionary().
+ *
+ *              Each image records the id of the dictionary it was compressed with (Buffer->dict_id) and holds a reference on it.
+ *              When pages start compressing noticeably worse than they did when the dictionary was new, we sample again and
+ *              train a new one.  New pages use the new dictionary; old images keep theirs alive until they're freed.  Dictionaries
+ *              live in one table for the whole process, so an image can find its dictionary from the id alone.  buffer__destroy()
+ *              and spill entries don't know which list they came from.
+ */
+
+#ifndef SRC_DICT_H_
+#define SRC_DICT_H_
+
+/* Includes */
+#include <pthread.h>
+#include <stdint.h>
+#include "zstd/zstd.h"
+
+
+/* Limits and tuning. */
+#define DICT_NONE             0        /* dict_id of an image compressed without a dictionary. */
+#define DICT_MAX_LIVE         64       /* Dictionaries that can be alive at once, process-wide.  Retraining waits if they all are. */
+#define DICT_DEFAULT_SIZE     16384    /* A good dictionary size for 8k-32k pages.  zlib only ever sees the last 32k anyway. */
+#define DICT_MIN_SIZE         DICT_SEGMENT /* Smallest dictionary we'll train:  one segment. */
+#define DICT_MAX_SIZE         (1 << 20)/* Largest dictionary we'll train. */
+#define DICT_SAMPLE_PAGES     128      /* Pages sampled for each training. */
+#define DICT_SAMPLE_MAX_BYTES (8 << 20)/* Most sample bytes we'll hold, whatever the page size. */
+#define DICT_SEGMENT          1024     /* Bytes in each segment dict__build() picks.  About what zstd's own COVER trainer settles on. */
+#define DICT_DMER             8        /* Bytes in the substrings it scores segments by.  DICT_HASH reads exactly this many. */
+#define DICT_HASH_BITS        20       /* log2 of the buckets it counts those substrings in. */
+#define DICT_DRIFT_PAGES      1024     /* Pages compressed with a dictionary between checks for drift. */
+#define DICT_DRIFT_PERCENT    10       /* Retrain once those pages compress this much worse than the dictionary's first window did. */
+
+
+/* A trained dictionary, ready to use. */
+typedef struct dictionary Dictionary;
+struct dictionary {
+  uint8_t id;                     /* Never DICT_NONE.  Registry slot is id % DICT_MAX_LIVE, which divides 256, so ids can wrap. */
+  uint32_t refs;                  /* One for the trainer while it's current, plus one per image compressed with it. */
+  uint32_t size;                  /* Bytes in ->content. */
+  void *content;                  /* The raw dictionary.  zlib uses this directly. */
+  ZSTD_CDict *cdict;              /* zstd's prepared form for compressing.  Built at the list's level. */
+  ZSTD_DDict *ddict;              /* zstd's prepared form for decompressing. */
+  double baseline_ratio;          /* How well pages compressed with it in its first drift window.  0 until then.  The yardstick for drift. */
+};
+
+/* Each list's sampling, training, and drift tracking. */
+typedef struct dicttrainer DictTrainer;
+struct dicttrainer {
+  pthread_mutex_t lock;           /* Compressors sample and record, the sweeper trains. */
+  Dictionary *current;            /* What new images get compressed with.  NULL until the first training. */
+  uint32_t dict_size;             /* Bytes to train each dictionary to. */
+  int compressor_id;              /* The list's compressor.  Only zlib and zstd use dictionaries. */
+  int compressor_level;           /* Level the CDict is prepared at. */
+  uint8_t sampling;               /* 1 while we want samples:  at startup, and after drift. */
+  uint8_t *samples;               /* Sampled pages, back to back. */
+  uint64_t sample_capacity;       /* Bytes ->samples has room for.  Grows as pages come in. */
+  uint32_t sample_lengths[DICT_SAMPLE_PAGES];  /* Bytes in each sample. */
+  uint32_t sample_count;          /* Samples in ->samples. */
+  uint64_t sample_bytes;          /* Bytes in ->samples. */
+  uint64_t window_data;           /* Raw bytes compressed with ->current since the last drift check. */
+  uint64_t window_comp;           /* What they compressed to. */
+  uint32_t window_pages;          /* Pages in the window. */
+  uint64_t trainings;             /* Dictionaries trained. */
+  uint64_t drifts;                /* Retrainings drift asked for. */
+  uint64_t full;                  /* Trainings put off because every registry slot was taken. */
+  uint64_t pages;                 /* Pages compressed with a dictionary. */
+  uint64_t data_bytes;            /* Their raw bytes. */
+  uint64_t comp_bytes;            /* Their compressed bytes. */
+};
+
+
+/* Prototypes */
+int dict__initialize(DictTrainer **trainer, uint32_t dict_size, int compressor_id, int compressor_level);
+void dict__destroy(DictTrainer *trainer);
+void dict__sample(DictTrainer *trainer, const void *page, uint32_t length);
+Dictionary* dict__current(DictTrainer *trainer);
+void dict__record(DictTrainer *trainer, Dictionary *dict, uint32_t data_length, uint32_t comp_length);
+int dict__train(DictTrainer *trainer);
+uint64_t dict__load64(const uint8_t *bytes);
+uint32_t dict__build(const uint8_t *samples, const uint32_t *lengths, uint32_t count, uint8_t *dict, uint32_t capacity);
+int dict__register(const void *content, uint32_t size, int compressor_id, int compressor_level, Dictionary **dict);
+Dictionary* dict__find(uint8_t id);
+void dict__retain(uint8_t id);
+void dict__release(uint8_t id);
+void dict__show(DictTrainer *trainer);
+
+
+#endif /* SRC_DICT_H_ */
@@ -0,0 +1,172 @@
+/*
+ * epoch.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: Kyle Harper
+ * Description: See epoch.h.  The scheme is the classic 3-epoch EBR:  a reader registers in the parity of the epoch it saw, the
+ *              epoch can only move from e to e+1 once nobody is left in the parity of e-1, and anything retired during epoch e is
+ *              reclaimed when the epoch reaches e+2.  Readers never block and never take a lock.
+ */
+
+/* Include Headers */
+#include <pthread.h>
+#include <jemalloc/jemalloc.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "epoch.h"
+
+
+/* Extern the error codes we'll use. */
+extern const int E_OK;
+extern const int E_TRY_AGAIN;
+extern const int E_NO_MEMORY;
+
+/* Threads are handed slots round-robin the first time they enter any domain.  They keep it for life. */
+uint32_t epoch_next_slot = 0;
+__thread int epoch_my_slot = -1;
+
+
+
+/* epoch__initialize
+ * Builds an epoch domain with everything zeroed.
+ */
+int epoch__initialize(EpochDomain **domain) {
+  *domain = (EpochDomain *)calloc(1, sizeof(EpochDomain));
+  if(*domain == NULL)
+    return E_NO_MEMORY;
+  /* The epoch starts at 2 so the parity math never has to think about underflow. */
+  (*domain)->epoch = 2;
+  pthread_mutex_init(&(*domain)->limbo_lock, NULL);
+  return E_OK;
+}
+
+
+/* epoch__destroy
+ * Reclaims everything still in limbo and frees the domain.  Caller MUST ensure no readers remain.
+ */
+void epoch__destroy(EpochDomain *domain) {
+  Retiree *current = NULL, *next = NULL;
+  int drained = 0;
+  // Callbacks are allowed to retire things again, so keep going until every limbo list stays empty.
+  while(drained == 0) {
+    drained = 1;
+    for(int i=0; i<3; i++) {
+      if(domain->limbo[i] == NULL)
+        continue;
+      drained = 0;
+      current = domain->limbo[i];
+      domain->limbo[i] = NULL;
+      while(current != NULL) {
+        next = current->next;
+        if(current->reclaim == NULL)
+          free(current->ptr);
+        else
+          current->reclaim(current->ptr, current->arg);
+        free(current);
+        current = next;
+      }
+    }
+  }
+  pthread_mutex_destroy(&domain->limbo_lock);
+  free(domain);
+  return;
+}
+
+
+/* epoch__enter
+ * Enters a read-side critical section.  Returns a token which MUST be handed back to epoch__exit().  Critical sections nest.
+ */
+int epoch__enter(EpochDomain *domain) {
+  if(epoch_my_slot < 0)
+    epoch_my_slot = __sync_fetch_and_add(&epoch_next_slot, 1) % EPOCH_SLOTS;
+  EpochSlot *slot = &domain->slots[epoch_my_slot];
+  uint64_t epoch = 0;
+
+  /* Register under the parity we saw, then make sure the epoch didn't move before the registration was visible. */
+  for(;;) {
+    epoch = domain->epoch;
+    __sync_fetch_and_add(&slot->active[epoch & 1], 1);
+    if(__sync_fetch_and_add(&domain->epoch, 0) == epoch)
+      break;
+    __sync_fetch_and_sub(&slot->active[epoch & 1], 1);
+  }
+  return (int)(epoch & 1);
+}
+
+
+/* epoch__exit
+ * Leaves the critical section started by the matching epoch__enter().
+ */
+void epoch__exit(EpochDomain *domain, int token) {
+  __sync_fetch_and_sub(&domain->slots[epoch_my_slot].active[token], 1);
+  return;
+}
+
+
+/* epoch__retire
+ * Hands an unlinked item to the domain.  reclaim(ptr, arg) is called (or free(ptr) if reclaim is NULL) after a grace period.
+ */
+int epoch__retire(EpochDomain *domain, void *ptr, void (*reclaim)(void *ptr, void *arg), void *arg) {
+  Retiree *retiree = (Retiree *)malloc(sizeof(Retiree));
+  if(retiree == NULL)
+    return E_NO_MEMORY;
+  retiree->ptr = ptr;
+  retiree->reclaim = reclaim;
+  retiree->arg = arg;
+
+  pthread_mutex_lock(&domain->limbo_lock);
+  retiree->next = domain->limbo[domain->epoch % 3];
+  domain->limbo[domain->epoch % 3] = retiree;
+  domain->retired++;
+  domain->pending++;
+  if(domain->pending < EPOCH_RECLAIM_INTERVAL) {
+    pthread_mutex_unlock(&domain->limbo_lock);
+    return E_OK;
+  }
+  domain->pending = 0;
+  pthread_mutex_unlock(&domain->limbo_lock);
+  epoch__reclaim(domain);
+  return E_OK;
+}
+
+
+/* epoch__reclaim
+ * Tries to advance the epoch by one and, if it worked, reclaims the limbo list that just became safe.  Never blocks; returns
+ * E_TRY_AGAIN when readers from the previous epoch are still around or someone else is already reclaiming.
+ * Note:  Callers inside a critical section can advance at most once, since they hold back their own parity.
+ */
+int epoch__reclaim(EpochDomain *domain) {
+  if(pthread_mutex_trylock(&domain->limbo_lock) != 0)
+    return E_TRY_AGAIN;
+
+  /* Moving from e to e+1 requires that nobody registered in e-1 (same parity as e+1) is still reading. */
+  const uint64_t EPOCH = domain->epoch;
+  for(int i=0; i<EPOCH_SLOTS; i++) {
+    if(__sync_fetch_and_add(&domain->slots[i].active[(EPOCH + 1) & 1], 0) != 0) {
+      pthread_mutex_unlock(&domain->limbo_lock);
+      return E_TRY_AGAIN;
+    }
+  }
+  __sync_fetch_and_add(&domain->epoch, 1);
+  domain->advances++;
+
+  /* Items retired in e-1 are now two epochs old.  Detach them and run the callbacks without the lock; they may block. */
+  Retiree *current = domain->limbo[(EPOCH + 2) % 3];
+  domain->limbo[(EPOCH + 2) % 3] = NULL;
+  pthread_mutex_unlock(&domain->limbo_lock);
+
+  Retiree *next = NULL;
+  uint64_t reclaimed = 0;
+  while(current != NULL) {
+    next = current->next;
+    if(current->reclaim == NULL)
+      free(current->ptr);
+    else
+      current->reclaim(current->ptr, current->arg);
+    free(current);
+    current = next;
+    reclaimed++;
+  }
+  __sync_fetch_and_add(&domain->reclaimed, reclaimed);
+  return E_OK;
+}
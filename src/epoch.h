@@ -0,0 +1,65 @@
+/*
+ * epoch.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: Kyle Harper
+ * Description: Epoch-based reclamation (EBR).  Readers announce themselves in a critical section before touching shared nodes
+ *              and writers "retire" anything they unlink instead of free()-ing it.  Retired items are only reclaimed once every
+ *              reader that could still be looking at them has left.  There is no per-thread registration; threads are spread
+ *              over a fixed set of padded slots and counted by epoch parity.
+ */
+
+#ifndef SRC_EPOCH_H_
+#define SRC_EPOCH_H_
+
+/* Includes */
+#include <pthread.h>
+#include <stdint.h>
+
+
+/* Limits and tuning. */
+#define EPOCH_SLOTS              64    /* Reader slots.  Threads share slots round-robin, so this just limits contention. */
+#define EPOCH_RECLAIM_INTERVAL   64    /* Number of retirements between automatic attempts to advance the epoch. */
+#define EPOCH_CACHE_LINE         64
+
+
+/* A slot holds the count of readers in a critical section for each epoch parity.  Padded to avoid false sharing. */
+typedef struct epochslot EpochSlot;
+struct epochslot {
+  uint32_t active[2];                            /* Readers currently inside a critical section, by epoch parity. */
+  char padding[EPOCH_CACHE_LINE - 2 * sizeof(uint32_t)];
+};
+
+/* Something that was unlinked and is waiting for a grace period before reclaim() is called on it. */
+typedef struct retiree Retiree;
+struct retiree {
+  Retiree *next;                                 /* Next item in the same limbo list. */
+  void *ptr;                                     /* The item being retired. */
+  void (*reclaim)(void *ptr, void *arg);         /* Called once it's safe.  NULL means just free(ptr). */
+  void *arg;                                     /* Passed through to reclaim(). */
+};
+
+/* The domain ties readers and retirees together.  Each List owns one. */
+typedef struct epochdomain EpochDomain;
+struct epochdomain {
+  uint64_t epoch;                                /* The global epoch.  Only ever increments. */
+  EpochSlot slots[EPOCH_SLOTS];                  /* Reader slots. */
+  pthread_mutex_t limbo_lock;                    /* Protects limbo[] and epoch advancement. */
+  Retiree *limbo[3];                             /* Items retired in epoch e live in limbo[e % 3] until the epoch reaches e + 2. */
+  uint32_t pending;                              /* Retirements since the last attempt to advance. */
+  uint64_t retired;                              /* Items retired for the life of the domain. */
+  uint64_t reclaimed;                            /* Items reclaimed for the life of the domain. */
+  uint64_t advances;                             /* Number of times the epoch advanced. */
+};
+
+
+/* Prototypes */
+int epoch__initialize(EpochDomain **domain);
+void epoch__destroy(EpochDomain *domain);
+int epoch__enter(EpochDomain *domain);
+void epoch__exit(EpochDomain *domain, int token);
+int epoch__retire(EpochDomain *domain, void *ptr, void (*reclaim)(void *ptr, void *arg), void *arg);
+int epoch__reclaim(EpochDomain *domain);
+
+
+#endif /* SRC_EPOCH_H_ */
@@ -16,6 +16,10 @@
 
 // Compressor ID.  We use LZ4 in this example.
 extern const int LZ4_COMPRESSOR_ID;
+// Index mode.  We use the original locking skiplist; INDEX_LOCK_FREE and INDEX_FAT_NODE are the alternatives.
+extern const int INDEX_LOCKING;
+// Replacement policy.  We use the original clock; see policy.h for the others.
+extern const int POLICY_CLOCK;
 // Error codes.
 extern const int E_OK;
 extern const int E_BUFFER_NOT_FOUND;
@@ -44,7 +48,7 @@ int main() {
 
   // Step 1)
   // Use list__initialize() to allocate memory for your list pointer and set initial values and start sub-processes running.
-  rv = list__initialize(&list, 1, LZ4_COMPRESSOR_ID, 1, 1000000);
+  rv = list__initialize(&list, 1, LZ4_COMPRESSOR_ID, 1, 1000000, INDEX_LOCKING, POLICY_CLOCK);
   if (rv != E_OK) {
     printf("Failed to initialize the list.  Error code is %d.\n", rv);
     exit(rv);  // Or throw it to your caller...
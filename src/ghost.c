@@ -0,0 +1,173 @@
+/*
+ * ghost.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: Kyle Harper
+ * Description: See ghost.h.  The ring gives FIFO aging for free and the hash only ever holds ring positions, so a ghost costs 8
+ *              bytes in the ring plus 8 bytes of hash slots.  IDs are unique in a ghost list; inserting one that's already there
+ *              just moves it to the front.
+ */
+
+/* Include Headers */
+#include <pthread.h>
+#include <jemalloc/jemalloc.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "ghost.h"
+
+
+/* Extern the error codes we'll use. */
+extern const int E_OK;
+extern const int E_NO_MEMORY;
+
+
+/* Fibonacci hashing spreads sequential IDs across the table. */
+#define GHOST_HASH(ghosts, id) ((uint32_t)(((uint64_t)(id) * 0x9E3779B97F4A7C15ull) >> 32) & (ghosts)->slot_mask)
+
+
+
+/* ghost__initialize
+ * Builds an empty ghost list that holds up to max_bytes worth of buffers.  expected_size is a guess at the average buffer size,
+ * used to size the ring; if it's wrong the ring just ages ghosts out by count instead of by bytes.
+ */
+int ghost__initialize(GhostList **ghosts, uint64_t max_bytes, uint32_t expected_size) {
+  uint64_t entries = GHOST_MIN_ENTRIES;
+  while(entries < GHOST_MAX_ENTRIES && entries * (expected_size > 0 ? expected_size : 1) < max_bytes)
+    entries <<= 1;
+
+  *ghosts = (GhostList *)calloc(1, sizeof(GhostList));
+  if(*ghosts == NULL)
+    return E_NO_MEMORY;
+  (*ghosts)->ring = (GhostEntry *)malloc(entries * sizeof(GhostEntry));
+  (*ghosts)->slots = (uint32_t *)calloc(entries * 2, sizeof(uint32_t));
+  if((*ghosts)->ring == NULL || (*ghosts)->slots == NULL) {
+    free((*ghosts)->ring);
+    free((*ghosts)->slots);
+    free(*ghosts);
+    return E_NO_MEMORY;
+  }
+  (*ghosts)->ring_mask = entries - 1;
+  (*ghosts)->slot_mask = entries * 2 - 1;
+  (*ghosts)->max_bytes = max_bytes;
+  pthread_mutex_init(&(*ghosts)->lock, NULL);
+  return E_OK;
+}
+
+
+/* ghost__destroy
+ * Frees a ghost list.
+ */
+void ghost__destroy(GhostList *ghosts) {
+  if(ghosts == NULL)
+    return;
+  pthread_mutex_destroy(&ghosts->lock);
+  free(ghosts->ring);
+  free(ghosts->slots);
+  free(ghosts);
+  return;
+}
+
+
+/* ghost__insert
+ * Remembers that a buffer of size bytes just left the tier.  Ages out the oldest ghosts until it fits.
+ */
+void ghost__insert(GhostList *ghosts, bufferid_t id, uint32_t size) {
+  pthread_mutex_lock(&ghosts->lock);
+  // Already a ghost?  Drop the old one so this one goes to the front.
+  int64_t slot = ghost__find_slot(ghosts, id);
+  if(slot >= 0) {
+    GhostEntry *old = &ghosts->ring[ghosts->slots[slot] - 1];
+    ghosts->bytes -= old->size;
+    old->id = BUFFER_ID_MAX;
+    ghost__unlink(ghosts, slot);
+  }
+  if(size > ghosts->max_bytes) {
+    pthread_mutex_unlock(&ghosts->lock);
+    return;
+  }
+
+  // Age out from the tail until there's room in both the byte budget and the ring.  Holes just get skipped.
+  GhostEntry *oldest = NULL;
+  while(ghosts->bytes + size > ghosts->max_bytes || ghosts->head - ghosts->tail > ghosts->ring_mask) {
+    oldest = &ghosts->ring[ghosts->tail & ghosts->ring_mask];
+    ghosts->tail++;
+    if(oldest->id == BUFFER_ID_MAX)
+      continue;
+    ghosts->bytes -= oldest->size;
+    ghost__unlink(ghosts, ghost__find_slot(ghosts, oldest->id));
+    oldest->id = BUFFER_ID_MAX;
+  }
+
+  // Add it to the front of the ring and hash its position.
+  const uint32_t POSITION = ghosts->head & ghosts->ring_mask;
+  ghosts->ring[POSITION].id = id;
+  ghosts->ring[POSITION].size = size;
+  uint32_t i = GHOST_HASH(ghosts, id);
+  while(ghosts->slots[i] != GHOST_EMPTY)
+    i = (i + 1) & ghosts->slot_mask;
+  ghosts->slots[i] = POSITION + 1;
+  ghosts->head++;
+  ghosts->bytes += size;
+  ghosts->inserts++;
+  pthread_mutex_unlock(&ghosts->lock);
+  return;
+}
+
+
+/* ghost__take
+ * Removes the ghost for id, if there is one, and returns whether it was found.  Only counts a hit when count_hit is set; callers
+ * that just want a buffer's ghost gone (it moved to another ghost list, or came back some other way) pass false.
+ */
+bool ghost__take(GhostList *ghosts, bufferid_t id, bool count_hit) {
+  pthread_mutex_lock(&ghosts->lock);
+  int64_t slot = ghost__find_slot(ghosts, id);
+  if(slot < 0) {
+    pthread_mutex_unlock(&ghosts->lock);
+    return false;
+  }
+  GhostEntry *entry = &ghosts->ring[ghosts->slots[slot] - 1];
+  ghosts->bytes -= entry->size;
+  entry->id = BUFFER_ID_MAX;
+  ghost__unlink(ghosts, slot);
+  if(count_hit)
+    ghosts->hits++;
+  pthread_mutex_unlock(&ghosts->lock);
+  return true;
+}
+
+
+/* ghost__find_slot
+ * Returns the hash slot holding id, or -1.  Caller MUST hold the ghost list's lock.
+ */
+int64_t ghost__find_slot(GhostList *ghosts, bufferid_t id) {
+  uint32_t i = GHOST_HASH(ghosts, id);
+  while(ghosts->slots[i] != GHOST_EMPTY) {
+    if(ghosts->ring[ghosts->slots[i] - 1].id == id)
+      return i;
+    i = (i + 1) & ghosts->slot_mask;
+  }
+  return -1;
+}
+
+
+/* ghost__unlink
+ * Empties a hash slot and shifts later members of its probe run back so lookups never need tombstones.  Caller MUST hold the
+ * ghost list's lock, and the ring entry the slot pointed at must already be dealt with.
+ */
+void ghost__unlink(GhostList *ghosts, uint32_t slot) {
+  uint32_t hole = slot, next = slot, home = 0;
+  ghosts->slots[hole] = GHOST_EMPTY;
+  for(;;) {
+    next = (next + 1) & ghosts->slot_mask;
+    if(ghosts->slots[next] == GHOST_EMPTY)
+      return;
+    // An entry can fill the hole unless its home slot sits cyclically in (hole, next].
+    home = GHOST_HASH(ghosts, ghosts->ring[ghosts->slots[next] - 1].id);
+    if((next > hole && (home <= hole || home > next)) || (next < hole && home <= hole && home > next)) {
+      ghosts->slots[hole] = ghosts->slots[next];
+      ghosts->slots[next] = GHOST_EMPTY;
+      hole = next;
+    }
+  }
+}
@@ -0,0 +1,60 @@
+/*
+ * ghost.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: Kyle Harper
+ * Description: Ghost (shadow) lists, ARC style.  A ghost remembers the ID and size of a buffer that recently left a tier, but none
+ *              of its data.  If the buffer is asked for again while its ghost is still around, a tier that was bigger by the ghost
+ *              list's capacity would have avoided the work.  Ghosts are kept in FIFO order in a ring, with a small open-addressing
+ *              hash over the ring so lookups are O(1).  Oldest ghosts fall off when the capacity (in bytes) or the ring is full.
+ */
+
+#ifndef SRC_GHOST_H_
+#define SRC_GHOST_H_
+
+/* Includes */
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "buffer.h"
+
+
+/* Limits. */
+#define GHOST_MIN_ENTRIES  1024       /* Smallest ring we bother building. */
+#define GHOST_MAX_ENTRIES  (1 << 20)  /* Largest ring, regardless of capacity.  Keeps a ghost list under ~16 MB. */
+#define GHOST_EMPTY        0          /* Hash slot value for "nothing here".  Real slots hold ring position + 1. */
+
+
+/* A single ghost.  Holes left by ghost__take() keep their place in the ring with id BUFFER_ID_MAX until they age out. */
+typedef struct ghostentry GhostEntry;
+struct ghostentry {
+  bufferid_t id;                  /* The buffer ID, or BUFFER_ID_MAX for a hole. */
+  uint32_t size;                  /* Bytes the buffer took up in the tier it left. */
+};
+
+typedef struct ghostlist GhostList;
+struct ghostlist {
+  pthread_mutex_t lock;           /* Ghost lists are touched from the sweeper and from readers; one short lock covers it all. */
+  GhostEntry *ring;               /* FIFO of ghosts.  New ghosts go in at head, old ones leave at tail. */
+  uint32_t *slots;                /* Hash over the ring, keyed by ID.  Linear probing with backward-shift deletes. */
+  uint32_t ring_mask;             /* Ring entries - 1.  The ring is a power of 2. */
+  uint32_t slot_mask;             /* Hash slots - 1.  Twice the ring, so the load never passes 50%. */
+  uint64_t head;                  /* Ring position the next ghost goes into. */
+  uint64_t tail;                  /* Ring position of the oldest ghost (or hole). */
+  uint64_t bytes;                 /* Sum of ->size over live ghosts. */
+  uint64_t max_bytes;             /* Capacity.  Ghosts age out to keep bytes under this. */
+  uint64_t hits;                  /* ghost__take() calls that found their ID. */
+  uint64_t inserts;               /* Ghosts ever added. */
+};
+
+
+/* Prototypes */
+int ghost__initialize(GhostList **ghosts, uint64_t max_bytes, uint32_t expected_size);
+void ghost__destroy(GhostList *ghosts);
+void ghost__insert(GhostList *ghosts, bufferid_t id, uint32_t size);
+bool ghost__take(GhostList *ghosts, bufferid_t id, bool count_hit);
+int64_t ghost__find_slot(GhostList *ghosts, bufferid_t id);
+void ghost__unlink(GhostList *ghosts, uint32_t slot);
+
+
+#endif /* SRC_GHOST_H_ */
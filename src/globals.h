@@ -17,8 +17,23 @@ const int NO_COMPRESSOR_ID   = 0;
 const int LZ4_COMPRESSOR_ID  = 1;
 const int ZLIB_COMPRESSOR_ID = 2;
 const int ZSTD_COMPRESSOR_ID = 3;
+const int ADAPTIVE_COMPRESSOR_ID = 4;  // Not a compressor itself:  lists pick LZ4 or zstd for each page (see list__choose_codec()).
 
 
+/* Define the index modes a list can use.  These are bit flags so they can be combined where it makes sense. */
+const int INDEX_LOCKING   = 0;       // The original skiplist; writers lock the buffers along their path.
+const int INDEX_LOCK_FREE = 1 << 0;  // CAS-based skiplist with marked pointers; unlinked nodes are reclaimed through epochs.
+const int INDEX_FAT_NODE  = 1 << 1;  // B-skiplist of cache-line sized nodes searched with SIMD; readers use a sequence lock.
+const int INDEX_HASH      = 1 << 2;  // Adds an open-addressing hash table for O(1) point lookups.  Combine with any of the above.
+
+
+
+/* Define the replacement policies a list can use.  These index POLICIES[] in policy.c. */
+const int POLICY_CLOCK     = 0;  // The original clock:  one hand over both tiers with popularity halving.
+const int POLICY_CLOCK_PRO = 1;  // CLOCK-Pro:  hot/cold clocks with test periods.
+const int POLICY_ARC       = 2;  // ARC in its clock form (CAR), with B1/B2 ghost lists.
+const int POLICY_S3_FIFO   = 3;  // S3-FIFO:  small FIFO, main clock, and a ghost queue.
+const int POLICY_GDSF      = 4;  // GreedyDual-Size-Frequency over the clock's rings, using measured decompress and reload costs.
 
 /* Handy Variables for Lists and Buffers */
 const int NEED_PIN      = 0;
@@ -26,6 +41,10 @@ const int HAVE_PIN      = 1;
 const int KEEP_DATA     = 0;
 const int DESTROY_DATA  = 1;
 
+/* Flags for list__scan(). */
+const int SCAN_HAVE_PIN   = 1 << 0;  // Caller already holds a list pin (HAVE_PIN for list__search()).
+const int SCAN_NO_PROMOTE = 1 << 1;  // Decompress compressed buffers into the caller's scratch space and leave them compressed.
+
 
 /* Global Error Codes
  *         0  == Ok
@@ -44,7 +63,7 @@ const int E_BAD_CONF                        =   3;  // User provided a config fi
 /* Warnings and Recoverable Situations */
 const int E_TRY_AGAIN                       = 101;  // Conditions may exist (e.g. threading) requiring a caller the intended action again.
 const int E_BUFFER_NOT_FOUND                = 120;  // When searching for a buffer, throw this when not found.  Let caller handle.
-//121 is available
+const int E_BUFFER_NOT_ADMITTED             = 121;  // The admission filter turned a new buffer away.  Caller keeps its own copy.
 const int E_BUFFER_ALREADY_EXISTS           = 122;  // When trying to add a buffer to a list, we return this if it already exists.
 const int E_BUFFER_MISSING_DATA             = 123;  // Operations attempting to read data from a buffer might find it has none at the time.
 const int E_BUFFER_ALREADY_COMPRESSED       = 124;  // Not sure this condition ever really exists but we'll set a code.
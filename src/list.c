@@ -19,9 +19,17 @@
 #include <time.h>      /* for clock_gettime() */
 #include <math.h>
 #include <errno.h>
+#include <sched.h>     /* for sched_yield() */
+#ifdef __SSE2__
+#include <immintrin.h> /* For the SSE2/AVX2 compares in list__fat_rank(). */
+#endif
+#include "admit.h"
 #include "buffer.h"
 #include "error.h"
+#include "ghost.h"
 #include "list.h"
+#include "policy.h"
+#include "window.h"
 
 #include <unistd.h>  // Debugging, remove when sleep() is gone
 
@@ -43,6 +51,7 @@ extern const int E_OK;
 extern const int E_GENERIC;
 extern const int E_BUFFER_NOT_FOUND;
 extern const int E_BUFFER_ALREADY_EXISTS;
+extern const int E_BUFFER_NOT_ADMITTED;
 extern const int E_BUFFER_ALREADY_COMPRESSED;
 extern const int E_BUFFER_ALREADY_DECOMPRESSED;
 extern const int E_BUFFER_COMPRESSION_PROBLEM;
@@ -62,10 +71,27 @@ const int BUFFER_OVERHEAD = sizeof(Buffer) + sizeof(SkiplistNode);
 /* We use the have/don't have data flags. */
 extern const int HAVE_PIN;
 extern const int NEED_PIN;
+extern const int DESTROY_DATA;
 
-// Create a global tracker for compressor IDs.  This is because I can't have circular things:
-int next_compress_worker_id = 0;
+/* Index modes. */
+extern const int INDEX_LOCK_FREE;
+extern const int INDEX_FAT_NODE;
+extern const int INDEX_HASH;
+extern const int SCAN_HAVE_PIN;
+extern const int SCAN_NO_PROMOTE;
 
+/* Compressors skip the worth-it check when there's no compressor. */
+extern const int NO_COMPRESSOR_ID;
+extern const int LZ4_COMPRESSOR_ID;
+extern const int ZSTD_COMPRESSOR_ID;
+extern const int ADAPTIVE_COMPRESSOR_ID;
+
+/* More than one sweep hand only works with the clock. */
+extern const int POLICY_CLOCK;
+
+/* List pin slots are handed out round-robin the first time a thread pins any list, same as epoch slots. */
+uint32_t list_pin_next_slot = 0;
+__thread int list_pin_slot = -1;
 
 
 /*
@@ -77,13 +103,21 @@ int next_compress_worker_id = 0;
 /* list__initialize
  * Creates the actual list that we're being given a pointer to.  We will also create the head of it as a reference point.
  */
-int list__initialize(List **list, int compressor_count, int compressor_id, int compressor_level, uint64_t max_memory) {
+int list__initialize(List **list, int compressor_count, int compressor_id, int compressor_level, uint64_t max_memory, int index_mode, int policy_id) {
   /* Quick error checking, then initialize the list.  We don't need to lock it because it's synchronous. */
   int rv = E_OK;
+  if (policy_id < 0 || policy_id >= POLICY_COUNT)
+    return E_BAD_ARGS;
   *list = (List *)malloc(sizeof(List));
   if (*list == NULL)
     return E_NO_MEMORY;
 
+  /* Index Mode and Reclamation */
+  (*list)->index_mode = index_mode;
+  rv = epoch__initialize(&(*list)->epoch);
+  if (rv != E_OK)
+    return rv;
+
   /* Size and Counter Members */
   (*list)->raw_count = 0;
   (*list)->comp_count = 0;
@@ -91,7 +125,6 @@ int list__initialize(List **list, int compressor_count, int compressor_id, int c
   (*list)->max_raw_size = 0;
   (*list)->current_comp_size = 0;
   (*list)->max_comp_size = 0;
-  list__balance(*list, INITIAL_RAW_RATIO, max_memory);
 
   /* Locking, Reference Counters, and Similar Members */
   if (pthread_mutex_init(&(*list)->lock, NULL) != 0)
@@ -104,25 +137,58 @@ int list__initialize(List **list, int compressor_count, int compressor_id, int c
     return E_GENERIC;
   if (pthread_cond_init(&(*list)->sweeper_condition, NULL) != 0)
     return E_GENERIC;
-  (*list)->ref_count = 0;
+  for(int i=0; i<LIST_PIN_SLOTS; i++)
+    (*list)->pin_slots[i].pins = 0;
   (*list)->pending_writers = 0;
 
   /* Management and Administration Members */
   (*list)->active = 1;
-  pthread_create(&(*list)->sweeper_thread, NULL, (void *) &list__sweeper_start, (*list));
   (*list)->sweep_goal = 5;
+  (*list)->watermark_high = WATERMARK_HIGH;
+  (*list)->watermark_low = WATERMARK_LOW;
+  (*list)->overcommit = WATERMARK_OVERCOMMIT;
+  (*list)->sweep_requested = 0;
+  (*list)->stalls = 0;
+  (*list)->stall_time = 0;
   (*list)->sweeps = 0;
   (*list)->sweep_cost = 0;
+  (*list)->slice_budget_ns = 0;
+  (*list)->slice_victims = 0;
+  (*list)->sweep_unfinished = 0;
+  (*list)->slices = 0;
+  for(int i=0; i<SWEEP_PAUSE_BUCKETS; i++) {
+    (*list)->sweep_pauses[i] = 0;
+    (*list)->sweep_slices[i] = 0;
+  }
   (*list)->restorations = 0;
   (*list)->compressions = 0;
   (*list)->evictions = 0;
+  (*list)->compression_skips = 0;
+  memset(&(*list)->controller, 0, sizeof(RatioController));
+  (*list)->controller.step = -RATIO_STEP;
+  rv = ghost__initialize(&(*list)->raw_ghosts, max_memory * GHOST_RATIO / 100, BUFFER_OVERHEAD + GHOST_EXPECTED_SIZE);
+  if (rv != E_OK)
+    return rv;
+  rv = ghost__initialize(&(*list)->comp_ghosts, max_memory * GHOST_RATIO / 100, BUFFER_OVERHEAD + GHOST_EXPECTED_SIZE);
+  if (rv != E_OK)
+    return rv;
+  (*list)->admission = NULL;
+  (*list)->windows = NULL;
+  (*list)->spill = NULL;
+  (*list)->dictionaries = NULL;
+  rv = arena__initialize(&(*list)->arena, &(*list)->current_comp_size);
+  if (rv != E_OK)
+    return rv;
+  (*list)->policy = &POLICIES[policy_id];
+  rv = (*list)->policy->initialize(*list, max_memory);
+  if (rv != E_OK)
+    return rv;
 
   /* Head Nodes of the List and Skiplist (Index). Make the Buffer list head a dummy buffer. */
   rv = buffer__initialize(&(*list)->head, BUFFER_ID_MAX, 0, (void*)0, NULL);
   if (rv != E_OK)
     return rv;
   (*list)->head->next = (*list)->head;
-  (*list)->clock_hand = (*list)->head;
   (*list)->levels = 1;
   SkiplistNode *slnode = NULL;
   for(int i=0; i<SKIPLIST_MAX; i++) {
@@ -134,34 +200,65 @@ int list__initialize(List **list, int compressor_count, int compressor_id, int c
     // Assign it to the correct index.
     (*list)->indexes[i] = slnode;
   }
-
-  /* Compressor Pool Management */
+  (*list)->fat_root = NULL;
+  (*list)->fat_levels = 0;
+  if (pthread_mutex_init(&(*list)->fat_lock, NULL) != 0)
+    return E_GENERIC;
+  (*list)->fat_sequence = 0;
+  (*list)->fat_retries = 0;
+  (*list)->fat_misses = 0;
+  if(index_mode & INDEX_FAT_NODE) {
+    rv = list__fat_initialize(*list);
+    if (rv != E_OK)
+      return rv;
+  }
+  (*list)->hash_table = NULL;
+  if (pthread_mutex_init(&(*list)->hash_lock, NULL) != 0)
+    return E_GENERIC;
+  (*list)->hash_rebuilds = 0;
+  (*list)->search_interleave = 0;
+  if(index_mode & INDEX_HASH) {
+    rv = list__hash_initialize(*list);
+    if (rv != E_OK)
+      return rv;
+  }
+  // Balancing can sweep, so it (and the sweeper) have to wait until the locks, head, indexes, and victim arrays exist.
+  for(int i=0; i<MAX_COMP_VICTIMS; i++)
+    (*list)->comp_victims[i] = NULL;
+  (*list)->active_compressors = 0;
   pthread_mutex_init(&(*list)->jobs_lock, NULL);
   pthread_cond_init(&(*list)->jobs_cond, NULL);
   pthread_cond_init(&(*list)->jobs_parent_cond, NULL);
+  (*list)->hands = NULL;
+  (*list)->hand_count = 0;
+  pthread_mutex_init(&(*list)->sweep_lock, NULL);
+  pthread_mutex_init(&(*list)->hands_lock, NULL);
+  pthread_cond_init(&(*list)->hands_cond, NULL);
+  pthread_cond_init(&(*list)->hands_done_cond, NULL);
+  (*list)->hand_generation = 0;
+  (*list)->hands_running = 0;
+  (*list)->hands_stop = 0;
+  (*list)->highest_id = 0;
+  if(list__set_hands(*list, 1) != E_OK)
+    return E_NO_MEMORY;
+  list__balance(*list, INITIAL_RAW_RATIO, max_memory);
+  pthread_create(&(*list)->sweeper_thread, NULL, (void *) &list__sweeper_start, (*list));
+
+  /* Compressor Pool Management */
   (*list)->compressor_threads = calloc(compressor_count, sizeof(pthread_t));
   if((*list)->compressor_threads == NULL)
     return E_NO_MEMORY;
-  for(int i=0; i<VICTIM_BATCH_SIZE; i++)
-    (*list)->comp_victims[i] = NULL;
-  (*list)->comp_victims_index = 0;
-  for(int i=0; i<VICTIM_BATCH_SIZE; i++)
-    (*list)->victims[i] = NULL;
-  (*list)->victims_index = 0;
-  (*list)->victims_compressor_index = 0;
-  (*list)->active_compressors = 0;
+  (*list)->next_compressor_id = 0;
   (*list)->compressor_pool = calloc(compressor_count, sizeof(Compressor));
   if((*list)->compressor_pool == NULL)
     return E_NO_MEMORY;
+  memset((*list)->codec_stats, 0, sizeof((*list)->codec_stats));
   for(int i=0; i<compressor_count; i++) {
     (*list)->compressor_pool[i].jobs_cond = &(*list)->jobs_cond;
     (*list)->compressor_pool[i].jobs_lock = &(*list)->jobs_lock;
     (*list)->compressor_pool[i].jobs_parent_cond = &(*list)->jobs_parent_cond;
     (*list)->compressor_pool[i].active_compressors = &(*list)->active_compressors;
     (*list)->compressor_pool[i].runnable = 0;
-    (*list)->compressor_pool[i].victims = (*list)->victims;
-    (*list)->compressor_pool[i].victims_index = &(*list)->victims_index;
-    (*list)->compressor_pool[i].victims_compressor_index = &(*list)->victims_compressor_index;
     (*list)->compressor_pool[i].compressor_id = compressor_id;
     (*list)->compressor_pool[i].compressor_level = compressor_level;
     pthread_create(&(*list)->compressor_threads[i], NULL, (void*) &list__compressor_start, (*list));
@@ -200,6 +297,8 @@ int list__initialize_skiplistnode(SkiplistNode **slnode, Buffer *buf) {
 
 /* list__acquire_write_lock
  * Drains the list of references to allow the calling thread to have complete control of the list without the risk of corruption.
+ * Readers pin without the mutex (see list__update_ref()), so pending_writers stays raised until list__release_write_lock() to
+ * keep new pins out while we hold the list.
  */
 int list__acquire_write_lock(List *list) {
   /* Check to see if the current lock owner is us; this is free of race conditions because it's only a race when we own it... */
@@ -212,12 +311,12 @@ int list__acquire_write_lock(List *list) {
   pthread_mutex_lock(&list->lock);
   if (list->lock_depth != 0)
     return E_GENERIC;
-  list->pending_writers++;
-  /* Begin a predicate check while under the protection of the mutex.  Block if the predicate remains true. */
-  while(list->ref_count != 0)
+  /* Announce ourself before summing the pin slots.  Readers bump their slot before checking pending_writers, so between the two
+   * full barriers either they see us and back off, or we see their pin and wait for it. */
+  __atomic_add_fetch(&list->pending_writers, 1, __ATOMIC_SEQ_CST);
+  /* Begin a predicate check while under the protection of the mutex.  Readers dropping the last pin broadcast under the mutex. */
+  while(list__pin_count(list) != 0)
     pthread_cond_wait(&list->writer_condition, &list->lock);
-  /* We now have the lock again and our predicate is guaranteed protected (it respects the list lock). */
-  list->pending_writers--;
   /* Set ourself to the lock owner in case future paths function calls try to ensure this thread has the list locked. */
   list->lock_owner = pthread_self();
   list->lock_depth++;
@@ -235,8 +334,8 @@ int list__release_write_lock(List *list) {
   if (list->lock_depth != 0)
     return E_OK;
 
-  /* Determine if we need to notify the readers, avoids spurious wake ups. */
-  if(list->pending_writers == 0)
+  /* We're no longer a pending writer.  Determine if we need to notify the readers, avoids spurious wake ups. */
+  if(__atomic_sub_fetch(&list->pending_writers, 1, __ATOMIC_SEQ_CST) == 0)
     pthread_cond_broadcast(&list->reader_condition);
 
   /* Remove ourself as the lock owner so another can take our place.  Don't have to... just NULL-ing for safety. */
@@ -252,37 +351,90 @@ int list__release_write_lock(List *list) {
  * performance, but it's a minor improvement.  The real benefit is that readers can continue searching (list__search()) while this
  * function is running.
  * Note:  You MUST set a pin BEFORE adding if you want to guarantee it won't vanish!
+ * Lists with an admission filter can return E_BUFFER_NOT_ADMITTED, in which case the buffer is still entirely the caller's.
  */
 int list__add(List *list, Buffer *buf, uint8_t list_pin_status) {
   /* Initialize a few basic values. */
   int rv = E_OK;
   int slnode_rv = E_OK;
 
-  /* Grab the list lock so we can handle sweeping processes and signaling correctly.  Small race will allow exceeding max, but that's ok. */
-  if(list->current_raw_size > list->max_raw_size) {
-    // We're about to wake up the sweeper, which means we need to remove this threads list pin if the caller has one.
-    if(list_pin_status == HAVE_PIN)
-      list__update_ref(list, -1);
-    pthread_mutex_lock(&list->lock);
-    while(list->current_raw_size > list->max_raw_size) {
-      pthread_cond_broadcast(&list->sweeper_condition);
-      pthread_cond_wait(&list->reader_condition, &list->lock);
+  /* With an admission filter, a full raw tier means buf has to be asked for more often than whatever it would push out.  Turning
+   * it away here saves the sweep and compression it would cost; the caller just keeps using its own copy. */
+  if(list->admission != NULL) {
+    admit__record(list->admission, buf->id);
+    if(list->current_raw_size + BUFFER_OVERHEAD + buf->data_length > list__watermark(list->max_raw_size, list->watermark_high)) {
+      const int PEEK_TOKEN = epoch__enter(list->epoch);
+      const bufferid_t VICTIM_ID = list->policy->next_victim(list, TIER_RAW);
+      epoch__exit(list->epoch, PEEK_TOKEN);
+      if(!admit__allow(list->admission, buf->id, VICTIM_ID))
+        return E_BUFFER_NOT_ADMITTED;
     }
-    pthread_mutex_unlock(&list->lock);
-    // Now put this threads list pin back in place, making the caller never-aware it lost it's pin; if applicable.
-    if(list_pin_status == HAVE_PIN)
-      list__update_ref(list, 1);
   }
 
+  /* Nudge the sweeper if we're past the high watermark.  We only wait on it if the raw tier is past its overcommit. */
+  list__wait_for_sweeper(list, list_pin_status);
+
+  // Sweep hands split the ID space up to the highest ID we've seen.  Only IDs past it ever write the shared line.
+  bufferid_t highest = list->highest_id;
+  while(buf->id > highest && !__sync_bool_compare_and_swap(&list->highest_id, highest, buf->id))
+    highest = list->highest_id;
+
   // Add a list pin if the caller didn't provide one.
   if(list_pin_status == NEED_PIN)
     list__update_ref(list, 1);
 
+  // Make room in the hash index before linking.  Once buf is linked nothing past this point may fail, or the caller would free a
+  // buffer readers can already reach.
+  if(list->index_mode & INDEX_HASH) {
+    rv = list__hash_reserve(list, buf->id);
+    if(rv != E_OK) {
+      if(list_pin_status == NEED_PIN)
+        list__update_ref(list, -1);
+      return rv;
+    }
+  }
+
   // Decide how many levels we're willing to set the node upon.
   int levels = 0;
   while((levels < SKIPLIST_MAX) && (levels < list->levels) && (rand() % 2 == 0))
     levels++;
 
+  // Readers (and other writers) never free what they unlink while we're in here.
+  const int EPOCH_TOKEN = epoch__enter(list->epoch);
+
+  // Lock-free and fat node lists do their own linking, so skip straight to the accounting.
+  if(list->index_mode & (INDEX_LOCK_FREE | INDEX_FAT_NODE)) {
+    if(list->index_mode & INDEX_LOCK_FREE) {
+      rv = list__lock_free_add(list, buf, levels);
+    } else {
+      pthread_mutex_lock(&list->fat_lock);
+      rv = list__fat_add(list, buf);
+      pthread_mutex_unlock(&list->fat_lock);
+    }
+    epoch__exit(list->epoch, EPOCH_TOKEN);
+    if(list->index_mode & INDEX_HASH) {
+      if(rv == E_OK)
+        list__hash_insert(list, buf);
+      else
+        list__hash_release(list);
+    }
+    if (rv == E_OK) {
+      // If this buffer was evicted recently, a bigger compressed tier would have saved the caller a load.
+      ghost__take(list->comp_ghosts, buf->id, true);
+      // A spilled image of it would be stale from here on.
+      if(list->spill != NULL)
+        spill__drop(list->spill, buf->id);
+      list->policy->insert(list, buf, TIER_RAW);
+      pthread_mutex_lock(&list->lock);
+      list->raw_count++;
+      list->current_raw_size += BUFFER_OVERHEAD + buf->data_length;
+      pthread_mutex_unlock(&list->lock);
+    }
+    if(list_pin_status == NEED_PIN)
+      list__update_ref(list, -1);
+    return rv;
+  }
+
   // Build a local stack based on the main list->indexes[] to build breadcrumbs.  Lock each buffer as we descend the skiplist tree.
   // until we have the whole chain.  Since scanning always down-and-forward we're safe.
   SkiplistNode *slstack[SKIPLIST_MAX];
@@ -323,30 +475,35 @@ int list__add(List *list, Buffer *buf, uint8_t list_pin_status) {
       slstack[i-1] = slstack[i]->down;
   }
 
-  // Continue searching the list from slstack[0] to ensure it doesn't already exist.  Then add to the list.
+  // Continue searching the list from slstack[0] to ensure it doesn't already exist.
+  Buffer *nearest_neighbor = slstack[0]->target;
   if (rv == E_OK) {
-    Buffer *nearest_neighbor = slstack[0]->target;
     // Move right in the buffer list.  ->head is always max, so no need to check anything but ->id.
     while(nearest_neighbor->next->id <= buf->id)
       nearest_neighbor = nearest_neighbor->next;
-    if(nearest_neighbor->id == buf->id) {
+    if(nearest_neighbor->id == buf->id)
       rv = E_BUFFER_ALREADY_EXISTS;
-    } else {
-      buf->next = nearest_neighbor->next;
-      nearest_neighbor->next = buf;
+  }
+
+  // Create a new Skiplist Node for each level we'll be inserting at before linking anything, so running out of memory leaves the
+  // list as it was and falls through to the cleanup below like any other failure.
+  SkiplistNode *slnodes[SKIPLIST_MAX];
+  for(int i = 0; rv == E_OK && i < levels; i++) {
+    slnode_rv = list__initialize_skiplistnode(&slnodes[i], buf);
+    if (slnode_rv != E_OK) {
+      rv = slnode_rv;
+      for(int j = 0; j < i; j++)
+        free(slnodes[j]);
     }
   }
 
-  // Loop through the slstack and begin linking Skiplist Nodes together everything is still E_OK.
+  // Add to the list, then loop through the slstack and link the Skiplist Nodes in if everything is still E_OK.
   if (rv == E_OK) {
-    SkiplistNode *slnode = NULL;
+    buf->next = nearest_neighbor->next;
+    nearest_neighbor->next = buf;
     for(int i = 0; i < levels; i++) {
-      // Create a new Skiplist Node for each level we'll be inserting at and insert it into that index.
-      slnode_rv = list__initialize_skiplistnode(&slnode, buf);
-      if (slnode_rv != E_OK)
-        return slnode_rv;
-      slnode->right = slstack[i]->right;
-      slstack[i]->right = slnode;
+      slnodes[i]->right = slstack[i]->right;
+      slstack[i]->right = slnodes[i];
     }
     // Now that the Nodes all exist (if any) and our slstack's ->right members point to them, we can set their ->down members.
     for(int i = levels - 1; i > 0; i--)
@@ -356,6 +513,13 @@ int list__add(List *list, Buffer *buf, uint8_t list_pin_status) {
   // Unlock any buffers we locked along the way.
   for(int i = locked_ids_index; i >= 0; i--)
     buffer__unlock(locked_buffers[i]);
+  epoch__exit(list->epoch, EPOCH_TOKEN);
+  if(list->index_mode & INDEX_HASH) {
+    if(rv == E_OK)
+      list__hash_insert(list, buf);
+    else
+      list__hash_release(list);
+  }
 
   // Remove the list pin we set if the caller didn't provide one.
   if(list_pin_status == NEED_PIN)
@@ -363,6 +527,12 @@ int list__add(List *list, Buffer *buf, uint8_t list_pin_status) {
 
   // If everything worked, grab the list lock whenever it's available and increment counters.
   if (rv == E_OK) {
+    // If this buffer was evicted recently, a bigger compressed tier would have saved the caller a load.
+    ghost__take(list->comp_ghosts, buf->id, true);
+    // A spilled image of it would be stale from here on.
+    if(list->spill != NULL)
+      spill__drop(list->spill, buf->id);
+    list->policy->insert(list, buf, TIER_RAW);
     pthread_mutex_lock(&list->lock);
     if(levels == list->levels)
       list->levels++;
@@ -397,13 +567,49 @@ int list__remove(List *list, Buffer *buf) {
     return E_OK;
   }
   // Looks like no one else beat us to the update.  Flip some bits and have a party.  We'll mark it dirty after we're done.
-  buf->flags |= removing;
-  buf->flags |= dirty;
+  __sync_fetch_and_or(&buf->flags, removing);
+  __sync_fetch_and_or(&buf->flags, dirty);
   pthread_mutex_unlock(&buf->lock);
+  // A compressed buffer has a ghost in the raw tier; it's leaving for good, so it can't come back as a hit.
+  if(buf->flags & compressed)
+    ghost__take(list->raw_ghosts, buf->id, false);
+  list->policy->remove(list, buf, buf->flags & compressed ? TIER_COMP : TIER_RAW);
 
   /* Get a read lock to ensure the sweeper doesn't run (or that it's the sweeper who actually called us). */
   list__update_ref(list, 1);
   int rv = E_BUFFER_NOT_FOUND;
+  const int EPOCH_TOKEN = epoch__enter(list->epoch);
+
+  // Lock-free lists unlink with CAS; fat node lists under their writer lock.
+  if(list->index_mode & (INDEX_LOCK_FREE | INDEX_FAT_NODE)) {
+    if(list->index_mode & INDEX_LOCK_FREE) {
+      rv = list__lock_free_remove(list, buf);
+    } else {
+      pthread_mutex_lock(&list->fat_lock);
+      rv = list__fat_remove(list, buf);
+      pthread_mutex_unlock(&list->fat_lock);
+    }
+    epoch__exit(list->epoch, EPOCH_TOKEN);
+    if(list->index_mode & INDEX_HASH)
+      list__hash_remove(list, buf);
+    // Go by the flag:  a compressor may have filled in comp_length before it lost the race to swap buf out.
+    const uint32_t BUFFER_SIZE = BUFFER_OVERHEAD + (buf->flags & compressed ? buf->comp_length : buf->data_length);
+    if(buf->flags & compressed) {
+      __sync_fetch_and_sub(&list->current_comp_size, BUFFER_SIZE);
+      __sync_fetch_and_sub(&list->comp_count, 1);
+    } else {
+      __sync_fetch_and_sub(&list->current_raw_size, BUFFER_SIZE);
+      __sync_fetch_and_sub(&list->raw_count, 1);
+    }
+    pthread_mutex_lock(&buf->lock);
+    buf->flags = buf->flags | removed;
+    __sync_fetch_and_and(&buf->flags, ~removing);
+    pthread_mutex_unlock(&buf->lock);
+    __sync_fetch_and_add(&buf->ref_count, -1);
+    epoch__retire(list->epoch, buf, list__reclaim_buffer, list);
+    list__update_ref(list, -1);
+    return rv;
+  }
 
   // Build a local stack based on the main list->indexes[] to build breadcrumbs.  Lock each buffer as we descend the skiplist tree.
   // until we have the whole chain.  Since scanning is always down-and-forward we're safe.
@@ -455,10 +661,8 @@ int list__remove(List *list, Buffer *buf) {
 
   // We should be close-as-can-be.  If ->next matches, we're on the right track.  Otherwise we're still E_BUFFER_NOT_FOUND.
   rv = E_OK;
-  const uint32_t BUFFER_SIZE = BUFFER_OVERHEAD + (buf->comp_length == 0 ? buf->data_length : buf->comp_length);
-  // Update the list metrics and move the clock hand if it's pointing at the same address as buf.
-  if(list->clock_hand == buf)
-    list->clock_hand = buf->next;
+  const uint32_t BUFFER_SIZE = BUFFER_OVERHEAD + (buf->flags & compressed ? buf->comp_length : buf->data_length);
+  // Update the list metrics.
   if(buf->flags & compressed) {
     __sync_fetch_and_sub(&list->current_comp_size, BUFFER_SIZE);
     __sync_fetch_and_sub(&list->comp_count, 1);
@@ -475,7 +679,7 @@ int list__remove(List *list, Buffer *buf) {
       // Each of these levels was already found to have the node, so ->right->right has to exist or at least be NULL.
       slnode = slstack[i]->right;
       slstack[i]->right = slstack[i]->right->right;
-      free(slnode);
+      epoch__retire(list->epoch, slnode, NULL, NULL);
       // If the list's skip-index at this level is empty, drop the list levels height.
       if(list->indexes[i]->right == NULL)
         list->levels--;
@@ -485,15 +689,18 @@ int list__remove(List *list, Buffer *buf) {
   // Unlock any buffers we locked along the way.
   for(int i = locked_ids_index; i >= 0; i--)
     buffer__unlock(locked_buffers[i]);
+  epoch__exit(list->epoch, EPOCH_TOKEN);
+  if(list->index_mode & INDEX_HASH)
+    list__hash_remove(list, buf);
 
-  /* Flip bits and let go of the list pin we held.  Then send the buffer off. */
+  /* Flip bits and let go of the list pin we held.  Then send the buffer off once no reader can still be walking over it. */
   pthread_mutex_lock(&buf->lock);
   buf->flags = buf->flags | removed;
-  buf->flags &= (~removing);
+  __sync_fetch_and_and(&buf->flags, ~removing);
   pthread_mutex_unlock(&buf->lock);
   // Remove the pin the caller came in with.
   __sync_fetch_and_add(&buf->ref_count, -1);
-  list__add_cow(list, buf);
+  epoch__retire(list->epoch, buf, list__reclaim_buffer, list);
   list__update_ref(list, -1);
 
   return rv;
@@ -505,26 +712,531 @@ int list__remove(List *list, Buffer *buf) {
  * search it.  When successfully found, we increment ref_count.
  */
 int list__search(List *list, Buffer **buf, bufferid_t id, uint8_t list_pin_status) {
-  /* Since searching can cause restorations and ultimately exceed max size, check for it.  This is a dirty read but OK. */
-  if(list->current_raw_size > list->max_raw_size) {
-    // We're about to wake up the sweeper, which means we need to remove this threads list pin if the caller has one.
-    if(list_pin_status == HAVE_PIN)
-      list__update_ref(list, -1);
-    pthread_mutex_lock(&list->lock);
-    while(list->current_raw_size > list->max_raw_size) {
-      pthread_cond_broadcast(&list->sweeper_condition);
-      pthread_cond_wait(&list->reader_condition, &list->lock);
+  /* Since searching can cause restorations and ultimately exceed max size, check for it. */
+  list__wait_for_sweeper(list, list_pin_status);
+
+  /* If the caller doesn't provide a list pin, add one. */
+  if(list_pin_status == NEED_PIN)
+    list__update_ref(list, 1);
+
+  /* Find and pin the buffer with whichever index this list uses.  Once pinned, the buffer can't vanish on us. */
+  int rv = E_BUFFER_NOT_FOUND;
+  const int EPOCH_TOKEN = epoch__enter(list->epoch);
+  if(list->index_mode & INDEX_HASH)
+    rv = list__hash_search(list, buf, id);
+  else if(list->index_mode & INDEX_LOCK_FREE)
+    rv = list__lock_free_search(list, buf, id);
+  else if(list->index_mode & INDEX_FAT_NODE)
+    rv = list__fat_search(list, buf, id);
+  else
+    rv = list__search_index(list, buf, id);
+  epoch__exit(list->epoch, EPOCH_TOKEN);
+
+  /* Not in memory?  It might have spilled.  If so it comes back as a raw buffer, pinned and listed, and counts as a hit. */
+  if(rv == E_BUFFER_NOT_FOUND && list->spill != NULL)
+    rv = list__unspill(list, buf, id);
+
+  /* If the buffer was found and it's compressed, we need to decompress it.  Then count the hit for the replacement policy. */
+  if(rv == E_OK) {
+    rv = list__restore(list, *buf);
+    list->policy->hit(list, *buf);
+    if(list->windows != NULL)
+      window__hit(list->windows, *buf);
+    if(list->admission != NULL)
+      admit__record(list->admission, id);
+  }
+
+  /* If the caller didn't provide a pin, remove the one we set above. */
+  if(list_pin_status == NEED_PIN)
+    list__update_ref(list, -1);
+
+  return rv;
+}
+
+
+/* list__search_many
+ * Resolves a batch of IDs in one go.  bufs[i] and results[i] receive what list__search() would have for ids[i].  The whole batch
+ * runs under a single list pin and epoch critical section.  Locking skiplists with ->search_interleave set use interleaved
+ * lookups; everything else walks the IDs in sorted order.  Always returns E_OK; check results[] for each ID.
+ */
+int list__search_many(List *list, const bufferid_t *ids, int n, Buffer **bufs, int *results, uint8_t list_pin_status) {
+  if(n <= 0)
+    return E_OK;
+  list__wait_for_sweeper(list, list_pin_status);
+  if(list_pin_status == NEED_PIN)
+    list__update_ref(list, 1);
+
+  const int EPOCH_TOKEN = epoch__enter(list->epoch);
+  if(list->search_interleave > 1 && (list->index_mode & (INDEX_LOCK_FREE | INDEX_FAT_NODE | INDEX_HASH)) == 0)
+    list__search_interleaved(list, ids, n, bufs, results);
+  else
+    list__search_sorted(list, ids, n, bufs, results);
+  epoch__exit(list->epoch, EPOCH_TOKEN);
+
+  /* Count the hits and restore anything we found compressed, now that we're out of the critical section.  Misses try the spill tier. */
+  for(int i=0; i<n; i++) {
+    if(results[i] == E_BUFFER_NOT_FOUND && list->spill != NULL)
+      results[i] = list__unspill(list, &bufs[i], ids[i]);
+    if(results[i] == E_OK) {
+      results[i] = list__restore(list, bufs[i]);
+      list->policy->hit(list, bufs[i]);
+      if(list->windows != NULL)
+        window__hit(list->windows, bufs[i]);
+      if(list->admission != NULL)
+        admit__record(list->admission, ids[i]);
     }
-    pthread_mutex_unlock(&list->lock);
-    // Now put this threads list pin back in place, making the caller never-aware it lost it's pin; if applicable.
-    if(list_pin_status == HAVE_PIN)
-      list__update_ref(list, 1);
   }
 
-  /* If the caller doesn't provide a list pin, add one. */
   if(list_pin_status == NEED_PIN)
+    list__update_ref(list, -1);
+  return E_OK;
+}
+
+
+/* list__search_sorted
+ * The sorted half of list__search_many().  IDs are walked in order; repeated IDs just take another pin.  The locking skiplist keeps
+ * its descent path as a finger so each key only climbs as high as it needs to.  Caller MUST hold a list pin and be in an epoch
+ * critical section.
+ */
+void list__search_sorted(List *list, const bufferid_t *ids, int n, Buffer **bufs, int *results) {
+  /* Sort (id, position) pairs packed into one word so duplicates and positions ride along for free. */
+  uint64_t order[n];
+  for(int i=0; i<n; i++)
+    order[i] = ((uint64_t)ids[i] << 32) | (uint32_t)i;
+  qsort(order, n, sizeof(uint64_t), list__compare_keys);
+
+  SkiplistNode *path[SKIPLIST_MAX];
+  uint8_t path_levels = UINT8_MAX;
+  int level = 0, pos = 0, previous = -1;
+  bufferid_t id = 0;
+  for(int i=0; i<n; i++) {
+    id = (bufferid_t)(order[i] >> 32);
+    pos = (int)(order[i] & UINT32_MAX);
+    // Repeats of the same ID just take another pin on whatever the first one found.
+    if(previous >= 0 && ids[previous] == id) {
+      results[pos] = results[previous];
+      if(results[pos] == E_OK) {
+        bufs[pos] = bufs[previous];
+        __sync_fetch_and_add(&bufs[pos]->ref_count, 1);
+      }
+      continue;
+    }
+    previous = pos;
+    if(list->index_mode & INDEX_HASH) {
+      if(i + 1 < n)
+        __builtin_prefetch(&list->hash_table->slots[list__hash_home(list->hash_table, (bufferid_t)(order[i + 1] >> 32))], 0, 1);
+      results[pos] = list__hash_search(list, &bufs[pos], id);
+    } else if(list->index_mode & INDEX_LOCK_FREE) {
+      results[pos] = list__lock_free_search(list, &bufs[pos], id);
+    } else if(list->index_mode & INDEX_FAT_NODE) {
+      results[pos] = list__fat_search(list, &bufs[pos], id);
+    } else {
+      // The finger is only good while the skiplist height hasn't changed under us.
+      if(path_levels != list->levels) {
+        path_levels = list->levels;
+        path[path_levels] = list->indexes[path_levels];
+        level = path_levels;
+      } else {
+        level = list__finger_level(path, path_levels, id);
+      }
+      results[pos] = list__search_index_from(list, &bufs[pos], id, path, path_levels, level, i + 1 < n ? (bufferid_t)(order[i + 1] >> 32) : id);
+    }
+  }
+  return;
+}
+
+
+/* list__search_interleaved
+ * The interleaved half of list__search_many(), for the locking skiplist.  Up to ->search_interleave lookups are in flight at once,
+ * each a tiny state machine.  Every step makes one hop (right, down, or along the buffer chain), prefetches the node its next hop
+ * will read, and then yields to the next lookup.  By the time we come back around, that node should be in cache, so the dependent
+ * loads of one descent overlap with everyone else's instead of stalling one at a time.  Caller MUST hold a list pin and be in an
+ * epoch critical section.
+ */
+void list__search_interleaved(List *list, const bufferid_t *ids, int n, Buffer **bufs, int *results) {
+  const int WIDTH = list->search_interleave < n ? list->search_interleave : n;
+  LookupState lookups[WIDTH];
+  LookupState *lookup = NULL;
+  int next = 0, active = 0;
+  for(int i=0; i<WIDTH; i++) {
+    list__lookup_start(list, &lookups[i], ids[next], next);
+    next++;
+    active++;
+  }
+
+  while(active > 0) {
+    for(int i=0; i<WIDTH; i++) {
+      lookup = &lookups[i];
+      if(lookup->stage == LOOKUP_IDLE || list__lookup_step(lookup) == LOOKUP_RUNNING)
+        continue;
+      // This one finished.  Hand its result back and start the next ID in its place, if there is one.
+      results[lookup->pos] = lookup->target != NULL ? E_OK : E_BUFFER_NOT_FOUND;
+      if(lookup->target != NULL)
+        bufs[lookup->pos] = lookup->target;
+      if(next < n) {
+        list__lookup_start(list, lookup, ids[next], next);
+        next++;
+        continue;
+      }
+      lookup->stage = LOOKUP_IDLE;
+      active--;
+    }
+  }
+  return;
+}
+
+
+/* list__lookup_start
+ * Points an interleaved lookup at the top of the skiplist and prefetches its first node.
+ */
+void list__lookup_start(List *list, LookupState *lookup, bufferid_t id, int pos) {
+  lookup->id = id;
+  lookup->pos = pos;
+  lookup->target = NULL;
+  lookup->slnode = list->indexes[list->levels];
+  lookup->nearest_neighbor = NULL;
+  lookup->stage = LOOKUP_DESCEND;
+  __builtin_prefetch(lookup->slnode->right, 0, 1);
+  return;
+}
+
+
+/* list__lookup_step
+ * Advances an interleaved lookup by one hop.  Follows list__search_index() exactly, just one load at a time.  Returns
+ * LOOKUP_RUNNING until the lookup is over; ->target is the pinned buffer, or NULL if the ID isn't in the list.
+ */
+int list__lookup_step(LookupState *lookup) {
+  if(lookup->stage == LOOKUP_DESCEND) {
+    SkiplistNode *slnode = lookup->slnode;
+    if(slnode->right != NULL && slnode->right->buffer_id <= lookup->id) {
+      lookup->slnode = slnode->right;
+      __builtin_prefetch(lookup->slnode->right, 0, 1);
+      return LOOKUP_RUNNING;
+    }
+    if(slnode->buffer_id == lookup->id) {
+      lookup->target = slnode->target;
+      __sync_fetch_and_add(&lookup->target->ref_count, 1);
+      return LOOKUP_DONE;
+    }
+    if(slnode->down != NULL) {
+      lookup->slnode = slnode->down;
+      __builtin_prefetch(lookup->slnode->right, 0, 1);
+      return LOOKUP_RUNNING;
+    }
+    lookup->nearest_neighbor = slnode->target;
+    lookup->stage = LOOKUP_CHAIN;
+    __builtin_prefetch(lookup->nearest_neighbor->next, 0, 1);
+    return LOOKUP_RUNNING;
+  }
+
+  /* LOOKUP_CHAIN:  scan the nearest neighbor until we pass the ID. */
+  if(lookup->nearest_neighbor->next->id <= lookup->id) {
+    lookup->nearest_neighbor = lookup->nearest_neighbor->next;
+    __builtin_prefetch(lookup->nearest_neighbor->next, 0, 1);
+    return LOOKUP_RUNNING;
+  }
+  if(lookup->nearest_neighbor->id == lookup->id) {
+    lookup->target = lookup->nearest_neighbor;
+    __sync_fetch_and_add(&lookup->target->ref_count, 1);
+  }
+  return LOOKUP_DONE;
+}
+
+
+/* list__compare_keys
+ * qsort() comparator for the packed uint64_t keys list__search_many() sorts.
+ */
+int list__compare_keys(const void *a, const void *b) {
+  const uint64_t A = *(const uint64_t *)a, B = *(const uint64_t *)b;
+  return (A > B) - (A < B);
+}
+
+
+/* list__wait_for_sweeper
+ * Called before anything that can grow the raw tier.  Past the high watermark we wake the sweeper and carry on; it reclaims in the
+ * background.  Only past max_raw_size plus the overcommit is it an emergency:  then we wait for the sweep like we used to, and the
+ * wait is counted in ->stalls and ->stall_time.
+ */
+void list__wait_for_sweeper(List *list, uint8_t list_pin_status) {
+  if(list->current_raw_size <= list__watermark(list->max_raw_size, list->watermark_high))
+    return;
+  list__wake_sweeper(list);
+  if(list->current_raw_size <= list__watermark(list->max_raw_size, 100 + list->overcommit))
+    return;
+  // We're about to wait on the sweeper, which means we need to remove this threads list pin if the caller has one.
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  if(list_pin_status == HAVE_PIN)
+    list__update_ref(list, -1);
+  pthread_mutex_lock(&list->lock);
+  while(list->current_raw_size > list__watermark(list->max_raw_size, 100 + list->overcommit)) {
+    pthread_cond_broadcast(&list->sweeper_condition);
+    pthread_cond_wait(&list->reader_condition, &list->lock);
+  }
+  pthread_mutex_unlock(&list->lock);
+  // Now put this threads list pin back in place, making the caller never-aware it lost it's pin; if applicable.
+  if(list_pin_status == HAVE_PIN)
+    list__update_ref(list, 1);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  __sync_fetch_and_add(&list->stalls, 1);
+  __sync_fetch_and_add(&list->stall_time, BILLION * (end.tv_sec - start.tv_sec) + end.tv_nsec - start.tv_nsec);
+  return;
+}
+
+
+/* list__wake_sweeper
+ * Wakes the sweeper without waiting for it.  Only the first thread to ask since the sweeper last woke takes the list lock; the rest
+ * see ->sweep_requested already set and leave.
+ */
+void list__wake_sweeper(List *list) {
+  if(list->sweep_requested != 0 || !__sync_bool_compare_and_swap(&list->sweep_requested, 0, 1))
+    return;
+  pthread_mutex_lock(&list->lock);
+  pthread_cond_broadcast(&list->sweeper_condition);
+  pthread_mutex_unlock(&list->lock);
+  return;
+}
+
+
+/* list__watermark
+ * Converts a watermark percentage into bytes of a tier whose max size is max_size.
+ */
+uint64_t list__watermark(uint64_t max_size, uint16_t percent) {
+  return max_size * percent / 100;
+}
+
+
+/* list__restore
+ * Decompresses a buffer the caller found and pinned, if it's compressed, and moves it back to the raw side of the accounting.
+ */
+int list__restore(List *list, Buffer *buf) {
+  if((buf->flags & compressed) == 0)
+    return E_OK;
+  // The only protection we need is the buffer's lock.  We already have a pin, so it can't poof and there can't be any readers.
+  pthread_mutex_lock(&buf->lock);
+  // First check above was a dirty read, do it again
+  if(buf->comp_length != 0) {
+    // No one else decompressed it before us, so let's move forward.
+    int decompress_rv = E_OK;
+    uint16_t comp_length = buf->comp_length;
+    const uint32_t COMP_COST = buf->comp_cost;
+    const uint8_t CODEC_ID = buf->codec_id;
+    CodecContext *codec = codec__thread_context();
+    // The policy sizes what leaves the comp tier by comp_length, so it has to hear about it before we decompress.
+    list->policy->remove(list, buf, TIER_COMP);
+    decompress_rv = buffer__decompress(buf, codec);
+    if (decompress_rv == E_OK && CODEC_ID != NO_COMPRESSOR_ID)
+      codec__count_decompression(&list->codec_stats[CODEC_ID], codec->last_ns);
+    if (decompress_rv != E_OK && decompress_rv != E_BUFFER_ALREADY_DECOMPRESSED) {
+      list->policy->insert(list, buf, TIER_COMP);
+      pthread_mutex_unlock(&buf->lock);
+      return E_BUFFER_COMPRESSION_PROBLEM;
+    }
+    // Update counters for the list now by forcibly grabbing the mutex, while still holding our pin.
+    pthread_mutex_lock(&list->lock);
+    list->raw_count++;
+    list->comp_count--;
+    __sync_fetch_and_sub(&list->current_comp_size, BUFFER_OVERHEAD + comp_length);
+    list->current_raw_size += (BUFFER_OVERHEAD + buf->data_length);
+    list->restorations++;
+    list->controller.restore_cost += (uint32_t)(buf->comp_cost - COMP_COST);
+    pthread_mutex_unlock(&list->lock);
+    // Would a bigger raw tier have kept it?
+    ghost__take(list->raw_ghosts, buf->id, true);
+    list->policy->insert(list, buf, TIER_RAW);
+  }
+  // Clear the compressed flag.
+  __sync_fetch_and_and(&buf->flags, ~compressed);
+  pthread_mutex_unlock(&buf->lock);
+  return E_OK;
+}
+
+
+/* list__spill
+ * Hands the image of a compressed buffer the sweeper is evicting to the spill tier.  The caller MUST hold a pin; the buffer's lock
+ * keeps a restore from swapping the image out from under us while it's copied.
+ */
+void list__spill(List *list, Buffer *buf) {
+  pthread_mutex_lock(&buf->lock);
+  if(buf->data != NULL && (buf->flags & compressed))
+    spill__put(list->spill, buf->id, buf->data, buf->data_length, buf->comp_length, buf->codec_id, buf->dict_id);
+  pthread_mutex_unlock(&buf->lock);
+  return;
+}
+
+
+/* list__unspill
+ * Brings id back from the spill tier as a raw buffer and adds it to the list, pinned for the caller like list__search() would.
+ * Caller MUST hold a list pin.  Returns E_BUFFER_NOT_FOUND when the tier doesn't have it, or when the buffer can't go back in the
+ * list (someone loaded it first, or the admission filter turned it away).  Either way the caller does what it does for any miss.
+ */
+int list__unspill(List *list, Buffer **buf, bufferid_t id) {
+  Buffer *spilled = NULL;
+  int rv = spill__take(list->spill, id, &spilled);
+  if(rv != E_OK)
+    return E_BUFFER_NOT_FOUND;
+  if(spilled->comp_length != 0) {
+    const uint8_t CODEC_ID = spilled->codec_id;
+    CodecContext *codec = codec__thread_context();
+    if(buffer__decompress(spilled, codec) != E_OK) {
+      buffer__destroy(spilled, DESTROY_DATA);
+      return E_BUFFER_NOT_FOUND;
+    }
+    if(CODEC_ID != NO_COMPRESSOR_ID)
+      codec__count_decompression(&list->codec_stats[CODEC_ID], codec->last_ns);
+  }
+  spilled->comp_length = 0;
+  spilled->ref_count++;
+  rv = list__add(list, spilled, HAVE_PIN);
+  if(rv != E_OK) {
+    buffer__destroy(spilled, DESTROY_DATA);
+    return E_BUFFER_NOT_FOUND;
+  }
+  *buf = spilled;
+  return E_OK;
+}
+
+
+/* list__scan
+ * Visits every buffer with lo <= id <= hi in order.  We descend the index once to find where lo would be, then walk ->next, pinning
+ * each buffer while callback(buf, data, arg) looks at it.  data is the page itself:  buf->data after a restore, or the caller's
+ * scratch space (which MUST hold the largest page) when SCAN_NO_PROMOTE leaves compressed buffers in the compressed tier.  A
+ * callback returning anything but E_OK stops the scan and that value is returned.
+ * The callback runs outside the epoch critical section.  If the buffer we're parked on was removed or replaced in the meantime its
+ * ->next can't be trusted anymore, so we descend again from just past it.
+ */
+int list__scan(List *list, bufferid_t lo, bufferid_t hi, int (*callback)(Buffer *buf, void *data, void *arg), void *arg, void *scratch, int flags) {
+  if(lo > hi || lo == BUFFER_ID_MAX)
+    return E_OK;
+  if((flags & SCAN_NO_PROMOTE) && scratch == NULL)
+    return E_BAD_ARGS;
+  const uint8_t LIST_PIN_STATUS = (flags & SCAN_HAVE_PIN) ? HAVE_PIN : NEED_PIN;
+  if((flags & SCAN_NO_PROMOTE) == 0)
+    list__wait_for_sweeper(list, LIST_PIN_STATUS);
+  if(LIST_PIN_STATUS == NEED_PIN)
     list__update_ref(list, 1);
 
+  int rv = E_OK;
+  void *data = NULL;
+  bufferid_t from = lo;
+  Buffer *buf = NULL, *next = NULL;
+  int epoch_token = epoch__enter(list->epoch);
+  buf = list__scan_seek(list, lo);
+  for(;;) {
+    // Step to the next live buffer.  Lock-free lists mark the ->next of buffers that are on their way out.
+    next = LF_UNMARK(buf->next);
+    while(next != list->head && (LF_IS_MARKED(next->next) || (next->flags & removed)))
+      next = LF_UNMARK(next->next);
+    if(next == list->head || next->id > hi)
+      break;
+    buf = next;
+    if(buf->id < from)
+      continue;
+    __sync_fetch_and_add(&buf->ref_count, 1);
+    from = buf->id + 1;
+    epoch__exit(list->epoch, epoch_token);
+
+    // Get at the page, either by restoring it like list__search() would or by inflating it into scratch.  Only promoting scans
+    // count as hits; a no-promote scan shouldn't push everything it walks past up the clock.
+    data = buf->data;
+    if((flags & SCAN_NO_PROMOTE) == 0) {
+      rv = list__restore(list, buf);
+      list->policy->hit(list, buf);
+      if(list->windows != NULL)
+        window__hit(list->windows, buf);
+      if(list->admission != NULL)
+        admit__record(list->admission, buf->id);
+      data = buf->data;
+    } else if(buf->flags & compressed) {
+      pthread_mutex_lock(&buf->lock);
+      if(buf->comp_length != 0) {
+        CodecContext *codec = codec__thread_context();
+        rv = buffer__decompress_into(buf, scratch, codec);
+        if(rv == E_OK && buf->codec_id != NO_COMPRESSOR_ID)
+          codec__count_decompression(&list->codec_stats[buf->codec_id], codec->last_ns);
+        data = scratch;
+      }
+      pthread_mutex_unlock(&buf->lock);
+    }
+    if(rv == E_OK)
+      rv = callback(buf, data, arg);
+
+    epoch_token = epoch__enter(list->epoch);
+    // Dirty means removed or replaced (or about to be).  Either way its ->next is no longer ours to follow.
+    if(rv == E_OK && ((buf->flags & dirty) || LF_IS_MARKED(buf->next))) {
+      buffer__release_pin(buf);
+      if(from > hi)
+        break;
+      buf = list__scan_seek(list, from);
+      continue;
+    }
+    buffer__release_pin(buf);
+    if(rv != E_OK)
+      break;
+  }
+  epoch__exit(list->epoch, epoch_token);
+
+  if(LIST_PIN_STATUS == NEED_PIN)
+    list__update_ref(list, -1);
+  return rv;
+}
+
+
+/* list__scan_seek
+ * Finds a buffer to start walking from for a scan beginning at lo:  one with an ID below lo, or the head.  Caller MUST hold a list
+ * pin and be in an epoch critical section.  The hash index has no order, so hash lists seek with their ordered index.
+ */
+Buffer* list__scan_seek(List *list, bufferid_t lo) {
+  if(lo == 0)
+    return list->head;
+
+  /* Lock-free lists already have a find() that hands back the predecessor. */
+  if(list->index_mode & INDEX_LOCK_FREE) {
+    SkiplistNode *preds[SKIPLIST_MAX], *succs[SKIPLIST_MAX];
+    Buffer *bpred = NULL, *bcurr = NULL;
+    list__lock_free_find(list, lo, preds, succs, &bpred, &bcurr);
+    return bpred;
+  }
+
+  /* Fat nodes:  the same descent as list__fat_search(), keeping the last key below lo instead of looking for a match. */
+  if(list->index_mode & INDEX_FAT_NODE) {
+    FatNode *node = NULL;
+    Buffer *target = NULL;
+    uint32_t sequence = 0;
+    int rank = 0;
+    for(;;) {
+      while((sequence = list->fat_sequence) & 1)
+        __sync_synchronize();
+      __sync_synchronize();
+      node = list->fat_root;
+      while(node != NULL && node->level > 0) {
+        rank = list__fat_rank(node, lo) - 1;
+        node = node->slots[rank < 0 ? 0 : rank].down;
+      }
+      target = node != NULL ? list__fat_predecessor(list, node, list__fat_rank(node, lo)) : list->head;
+      __sync_synchronize();
+      if(list->fat_sequence == sequence)
+        return target;
+    }
+  }
+
+  /* Locking skiplist:  the same descent as list__search_index(), stopping short of lo. */
+  SkiplistNode *slnode = list->indexes[list->levels];
+  for(;;) {
+    while(slnode->right != NULL && slnode->right->buffer_id < lo)
+      slnode = slnode->right;
+    if(slnode->down == NULL)
+      break;
+    slnode = slnode->down;
+  }
+  return slnode->target;
+}
+
+
+/* list__search_index
+ * Walks the (locking) skiplist for a buffer and pins it if found.  Caller MUST hold a list pin and be in an epoch critical section.
+ */
+int list__search_index(List *list, Buffer **buf, bufferid_t id) {
   /* Begin searching the list at the highest level's index head. */
   int rv = E_BUFFER_NOT_FOUND;
   SkiplistNode *slnode = list->indexes[list->levels];
@@ -560,43 +1272,58 @@ int list__search(List *list, Buffer **buf, bufferid_t id, uint8_t list_pin_statu
     }
   }
 
-  /* If the buffer was found and is compressed, we need to decompress it. */
-  if(rv == E_OK && ((*buf)->flags & compressed)) {
-    // The only protection we need is the buffer's lock.  We already have a pin, so it can't poof and there can't be any readers.
-    pthread_mutex_lock(&(*buf)->lock);
-    // First check above was a dirty read, do it again
-    if((*buf)->comp_length != 0) {
-      // No one else decompressed it before us, so let's move forward.
-      int decompress_rv = E_OK;
-      uint16_t comp_length = (*buf)->comp_length;
-      decompress_rv = buffer__decompress(*buf, list->compressor_id);
-      if (decompress_rv != E_OK && decompress_rv != E_BUFFER_ALREADY_DECOMPRESSED) {
-        pthread_mutex_unlock(&(*buf)->lock);
-        return E_BUFFER_COMPRESSION_PROBLEM;
-      }
-      // Update counters for the list now by forcibly grabbing the mutex, while still holding our pin.
-      pthread_mutex_lock(&list->lock);
-      list->raw_count++;
-      list->comp_count--;
-      list->current_comp_size -= (BUFFER_OVERHEAD + comp_length);
-      list->current_raw_size += (BUFFER_OVERHEAD + (*buf)->data_length);
-      list->restorations++;
-      pthread_mutex_unlock(&list->lock);
-    }
-    // Clear the compressed flag.
-    (*buf)->flags &= (~compressed);
-    pthread_mutex_unlock(&(*buf)->lock);
-  }
-
-  /* If the caller didn't provide a pin, remove the one we set above. */
-  if(list_pin_status == NEED_PIN)
-    list__update_ref(list, -1);
-
   return rv;
 }
 
 
-/* list__update
+/* list__search_index_from
+ * Same walk as list__search_index(), but it starts from path[level] instead of the top and leaves its descent (levels high) in
+ * path[] for the next (larger) key.  Before finishing on the buffer chain it prefetches where next_id's walk will start.  Caller MUST hold a list
+ * pin and stay in one epoch critical section for the whole run of keys.
+ */
+int list__search_index_from(List *list, Buffer **buf, bufferid_t id, SkiplistNode **path, int levels, int level, bufferid_t next_id) {
+  int rv = E_BUFFER_NOT_FOUND;
+  SkiplistNode *slnode = path[level];
+  for(;;) {
+    while(slnode->right != NULL && slnode->right->buffer_id <= id) {
+      slnode = slnode->right;
+      __builtin_prefetch(slnode->right, 0, 1);
+    }
+    path[level] = slnode;
+    if(slnode->down == NULL)
+      break;
+    slnode = slnode->down;
+    level--;
+  }
+  if(list->levels == levels)
+    __builtin_prefetch(path[list__finger_level(path, levels, next_id)]->right, 0, 1);
+
+  /* The bottom node is the nearest neighbor at worst; finish on the buffer chain. */
+  Buffer *nearest_neighbor = slnode->target;
+  while(nearest_neighbor->next->id <= id)
+    nearest_neighbor = nearest_neighbor->next;
+  if(nearest_neighbor->id == id) {
+    *buf = nearest_neighbor;
+    __sync_fetch_and_add(&(*buf)->ref_count, 1);
+    rv = E_OK;
+  }
+  return rv;
+}
+
+
+/* list__finger_level
+ * Picks the level a finger search for id should start at:  the highest one whose next node is still at or below id.  Every level
+ * above it would just step straight down, so starting there gives the same walk as a full descent.
+ */
+int list__finger_level(SkiplistNode **path, int levels, bufferid_t id) {
+  for(int level=levels; level>0; level--)
+    if(path[level]->right != NULL && path[level]->right->buffer_id <= id)
+      return level;
+  return 0;
+}
+
+
+/* list__update
  * Updates a buffer with the data and size specified.  We require the caller to have a pin from list__search().
  * If the page is clean, the update marks the existing buffer dirty and swaps in a new one.
  * If the page is dirty, we refuse the update and send back a warning.  (Caller needs to refresh and re-process).
@@ -613,6 +1340,11 @@ int list__update(List *list, Buffer **callers_buf, void *data, uint32_t size, ui
   Buffer *buf = *callers_buf;
   if(buf->ref_count < 1)
     return E_BUFFER_MISSING_A_PIN;
+  /* Nudge (or in an emergency, wait on) the sweeper the same way list__add() does.  Compressors are the sweeper, so they never wait.
+   * Do this before claiming the buffer:  a compressor spinning on our updating flag would otherwise hold up the sweep we wait on. */
+  if((buf->flags & compressing) == 0)
+    list__wait_for_sweeper(list, list_pin_status);
+
   /* Use atomics/locks to compare and/or set the dirty flag to prevent multiple updates at once. */
   pthread_mutex_lock(&buf->lock);
   if(buf->flags & dirty) {
@@ -622,30 +1354,58 @@ int list__update(List *list, Buffer **callers_buf, void *data, uint32_t size, ui
     return E_BUFFER_IS_DIRTY;
   }
   // Looks like no one else beat us to the update.  Flip some bits and have a party.  We'll mark it dirty after we're done.
-  buf->flags |= updating;
-  buf->flags |= dirty;
+  __sync_fetch_and_or(&buf->flags, updating);
+  __sync_fetch_and_or(&buf->flags, dirty);
   pthread_mutex_unlock(&buf->lock);
 
-  /* Grab the list lock so we can handle sweeping processes and signaling correctly.  Small race will allow exceeding max, but that's ok. */
-  if((buf->flags & compressing) == 0 && (list->current_raw_size > list->max_raw_size)) {
-    // We're about to wake up the sweeper, which means we need to remove this threads list pin if the caller has one.
-    if(list_pin_status == HAVE_PIN)
-      list__update_ref(list, -1);
-    pthread_mutex_lock(&list->lock);
-    while(list->current_raw_size > list->max_raw_size) {
-      pthread_cond_broadcast(&list->sweeper_condition);
-      pthread_cond_wait(&list->reader_condition, &list->lock);
-    }
-    pthread_mutex_unlock(&list->lock);
-    // Now put this threads list pin back in place, making the caller never-aware it lost it's pin; if applicable.
-    if(list_pin_status == HAVE_PIN)
-      list__update_ref(list, 1);
-  }
-
   // Add a list pin if the caller didn't provide one.
   if(list_pin_status == NEED_PIN)
     list__update_ref(list, 1);
 
+  // Lock-free lists swap the new buffer in with CAS; fat node lists swap it under their writer lock.
+  const int EPOCH_TOKEN = epoch__enter(list->epoch);
+  if(list->index_mode & (INDEX_LOCK_FREE | INDEX_FAT_NODE)) {
+    Buffer *new_buffer;
+    buffer__initialize(&new_buffer, buf->id, size, data, NULL);
+    buffer__copy(buf, new_buffer, false);
+    new_buffer->ref_count = 1;
+    new_buffer->data_length = size;
+    new_buffer->comp_length = 0;
+    new_buffer->last_comp_length = 0;
+    if(buf->flags & compressing) {
+      new_buffer->data_length = buf->data_length;
+      new_buffer->comp_length = size;
+      new_buffer->last_comp_length = size;
+      new_buffer->dict_id = buf->dict_id;
+      buf->dict_id = DICT_NONE;
+      new_buffer->codec_id = buf->codec_id;
+      new_buffer->codec_level = buf->codec_level;
+      buf->codec_id = NO_COMPRESSOR_ID;
+    }
+    __sync_fetch_and_add(&buf->ref_count, -1);
+    if(list->index_mode & INDEX_LOCK_FREE) {
+      list__lock_free_update(list, buf, new_buffer);
+    } else {
+      pthread_mutex_lock(&list->fat_lock);
+      list__fat_update(list, buf, new_buffer);
+      pthread_mutex_unlock(&list->fat_lock);
+    }
+    list->policy->replace(list, buf, new_buffer);
+    epoch__exit(list->epoch, EPOCH_TOKEN);
+    if(list->index_mode & INDEX_HASH)
+      list__hash_update(list, buf, new_buffer);
+    if(list_pin_status == NEED_PIN)
+      list__update_ref(list, -1);
+    *callers_buf = new_buffer;
+    if((buf->flags & compressing) == 0)
+      __sync_fetch_and_add(&list->current_raw_size, (int)(size - buf->data_length));
+    pthread_mutex_lock(&buf->lock);
+    __sync_fetch_and_and(&buf->flags, ~updating);
+    pthread_mutex_unlock(&buf->lock);
+    epoch__retire(list->epoch, buf, list__reclaim_buffer, list);
+    return E_OK;
+  }
+
   // Since we're just updating a buffer in place, we don't need an slstack.  Just find the topmost slnode.
   SkiplistNode *topmost_slnode = NULL;
   // Build a local stack based on the main list->indexes[] to build breadcrumbs.  Lock each buffer as we descend the skiplist tree.
@@ -704,16 +1464,26 @@ int list__update(List *list, Buffer **callers_buf, void *data, uint32_t size, ui
   new_buffer->ref_count = 1;
   new_buffer->data_length = size;
   new_buffer->comp_length = 0;
+  // New data has to be compressed again before we know its size.
+  new_buffer->last_comp_length = 0;
   // If the update is working with a compressing buffer, update sizes properly or we'll have skewed accounting.
   if(buf->flags & compressing) {
     new_buffer->data_length = buf->data_length;
     new_buffer->comp_length = size;
+    new_buffer->last_comp_length = size;
+    // The image's codec and dictionary reference go with the image; buf only has the raw page.
+    new_buffer->dict_id = buf->dict_id;
+    buf->dict_id = DICT_NONE;
+    new_buffer->codec_id = buf->codec_id;
+    new_buffer->codec_level = buf->codec_level;
+    buf->codec_id = NO_COMPRESSOR_ID;
   }
   __sync_fetch_and_add(&buf->ref_count, -1);
 
-  // Update all the linking.  Update the new_buffer first!
+  // Update all the linking.  Update the new_buffer first!  The policy has to follow too or its hands end up walking buf.
   new_buffer->next = buf->next;
   nearest_neighbor->next = new_buffer;
+  list->policy->replace(list, buf, new_buffer);
   while(topmost_slnode != NULL && topmost_slnode->target == buf) {
     topmost_slnode->target = new_buffer;
     if(topmost_slnode->down == NULL)
@@ -724,6 +1494,9 @@ int list__update(List *list, Buffer **callers_buf, void *data, uint32_t size, ui
   // Unlock any buffers we locked along the way.
   for(int i = locked_ids_index; i >= 0; i--)
     buffer__unlock(locked_buffers[i]);
+  epoch__exit(list->epoch, EPOCH_TOKEN);
+  if(list->index_mode & INDEX_HASH)
+    list__hash_update(list, buf, new_buffer);
 
   // Remove the list pin we set if the caller didn't provide one.
   if(list_pin_status == NEED_PIN)
@@ -737,11 +1510,11 @@ int list__update(List *list, Buffer **callers_buf, void *data, uint32_t size, ui
     // Coerce to allow a negative value to the atomic; otherwise an underflow can be sent.
     __sync_fetch_and_add(&list->current_raw_size, (int)(size - buf->data_length));
 
-  // Mark the buffer dirty, remove the updating flag, and throw it in the dirty pool for future eviction.
+  // Mark the buffer dirty, remove the updating flag, and throw it in the dirty pool once readers are done walking over it.
   pthread_mutex_lock(&buf->lock);
-  buf->flags &= (~updating);
+  __sync_fetch_and_and(&buf->flags, ~updating);
   pthread_mutex_unlock(&buf->lock);
-  list__add_cow(list, buf);
+  epoch__retire(list->epoch, buf, list__reclaim_buffer, list);
 
   return E_OK;
 }
@@ -750,27 +1523,52 @@ int list__update(List *list, Buffer **callers_buf, void *data, uint32_t size, ui
 /* list__update_ref
  * Edits the reference count of threads currently pinning the list.  Pinning happens for searching the list.  Delta should only be
  * 1 or -1, ever.  Typically a worker should call this once and then respect pending_writers.
+ * Each thread counts its pins in its own padded slot so pinning is a single atomic on a private cache line.  The mutex is only
+ * touched when a writer is pending:  to wait it out when pinning, or to wake it when unpinning.
  */
 int list__update_ref(List *list, int delta) {
   /* Do we own the lock as a writer?  If so, we don't need to mess with reference counting.  Avoids deadlocking. */
   if (pthread_equal(list->lock_owner, pthread_self()))
     return E_OK;
+  if (list_pin_slot < 0)
+    list_pin_slot = __sync_fetch_and_add(&list_pin_next_slot, 1) % LIST_PIN_SLOTS;
+  ListPinSlot *slot = &list->pin_slots[list_pin_slot];
+
+  /* Unpinning never waits.  If a writer is draining the list it needs a broadcast, which has to go out under the mutex. */
+  if (delta < 0) {
+    __atomic_add_fetch(&slot->pins, delta, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&list->pending_writers, __ATOMIC_SEQ_CST) != 0) {
+      pthread_mutex_lock(&list->lock);
+      pthread_cond_broadcast(&list->writer_condition);
+      pthread_mutex_unlock(&list->lock);
+    }
+    return E_OK;
+  }
 
-  /* Lock the list and check pending writers.  If non-zero and we're incrementing, wait on the reader condition. */
-  pthread_mutex_lock(&list->lock);
-  if (delta > 0 && list->pending_writers > 0) {
+  /* Pin first, then look for writers.  If one is pending, back the pin out (waking the writer) and wait on the reader condition. */
+  for(;;) {
+    __atomic_add_fetch(&slot->pins, delta, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&list->pending_writers, __ATOMIC_SEQ_CST) == 0)
+      return E_OK;
+    __atomic_sub_fetch(&slot->pins, delta, __ATOMIC_SEQ_CST);
+    pthread_mutex_lock(&list->lock);
+    pthread_cond_broadcast(&list->writer_condition);
     while(list->pending_writers > 0)
       pthread_cond_wait(&list->reader_condition, &list->lock);
+    pthread_mutex_unlock(&list->lock);
   }
-  list->ref_count += delta;
+  return E_OK;
+}
 
-  /* When writers are waiting and we are decrementing, we need to broadcast to the writer condition that it's safe to proceed. */
-  if (delta < 0 && list->pending_writers != 0 && list->ref_count == 0)
-    pthread_cond_broadcast(&list->writer_condition);
 
-  /* Release the lock, which will also finally unblock any threads we woke up with broadcast above.  Then leave happy. */
-  pthread_mutex_unlock(&list->lock);
-  return E_OK;
+/* list__pin_count
+ * Sums the pin slots.  Only meaningful to a writer holding the list mutex with pending_writers raised, or for reporting.
+ */
+int64_t list__pin_count(List *list) {
+  int64_t pins = 0;
+  for(int i=0; i<LIST_PIN_SLOTS; i++)
+    pins += __atomic_load_n(&list->pin_slots[i].pins, __ATOMIC_SEQ_CST);
+  return pins;
 }
 
 
@@ -778,135 +1576,448 @@ int list__update_ref(List *list, int delta) {
  * Attempts to run the sweep algorithm on the list to find space to free up.
  * Note:  We attempt to free a percentage of ->current_size, NOT ->max_size!  There are pros/cons to both; in normal usage the
  * current size should always be high enough to avoid errors because sweeping shouldn't be called until we're low on memory.
+ * This is one unbounded slice; see list__sweep_slice() for the bounded kind the sweeper thread uses.
  */
 uint64_t list__sweep(List *list, uint8_t sweep_goal) {
-  // Variables and tracking data.  We only start the time when we drain readers with list__acquire_write_lock() below.
-  struct timespec start, end;
+  return list__sweep_slice(list, sweep_goal, 0, 0);
+}
+
+
+/* list__sweep_slice
+ * Does one slice of a sweep:  the same work as a whole sweep, but it stops once budget_ns have passed or max_victims victims (raw
+ * and compressed together) have been taken, whichever comes first.  Zero means no limit for either.  The policy keeps its hand
+ * where it stopped, so the next slice just carries on; ->sweep_unfinished tells the sweeper thread whether one is needed.
+ * Budgets are checked between batches, so a slice can run over by one batch.  Batches shrink to SWEEP_SLICE_BATCH when there's a
+ * time budget to keep that overrun small.  The one exception is a comp tier past its max, which gets one batch even out of budget.
+ */
+uint64_t list__sweep_slice(List *list, uint8_t sweep_goal, uint64_t budget_ns, uint32_t max_victims) {
+  // Variables and tracking data.  Readers are never drained; the epoch keeps everything the sweep touches alive instead.
+  struct timespec start, end, pause_start;
   Buffer *victim = NULL;
   uint64_t bytes_freed = 0;
   uint64_t comp_bytes_added = 0;
+  uint64_t bytes_dropped = 0;
+  uint64_t bytes_lost = 0;
   uint32_t total_victims = 0;
-  const uint64_t BYTES_NEEDED = (list->current_raw_size > list->max_raw_size ? list->current_raw_size - list->max_raw_size : 0) + (list->max_raw_size * sweep_goal / 100);
+  uint32_t comp_victims = 0;
+  uint32_t dropped = 0;
+  uint32_t lost = 0;
+  uint32_t room = 0;
+  bool out_of_budget = false;
+  const uint32_t COMP_BATCH = budget_ns != 0 ? SWEEP_SLICE_BATCH : MAX_COMP_VICTIMS;
+  const uint64_t RAW_LOW = list__watermark(list->max_raw_size, list->watermark_low);
+  const uint64_t COMP_LOW = list__watermark(list->max_comp_size, list->watermark_low);
+  const uint64_t MINIMUM_BYTES = list->max_raw_size * sweep_goal / 100;
+  const uint64_t BYTES_NEEDED = list->current_raw_size > RAW_LOW + MINIMUM_BYTES ? list->current_raw_size - RAW_LOW : MINIMUM_BYTES;
+  clock_gettime(CLOCK_MONOTONIC, &start);
 
-  // Loop forever to free up memory.  Memory checks happen near the end of the loop.
-  if(BYTES_NEEDED != 0 && list->current_raw_size > list->max_raw_size) {
-    while(1) {
-      // Scan until we find a buffer to remove.  Popularity is halved until a victim is found.  Skip head matches.
-      while(1) {
-        list->clock_hand = list->clock_hand->next;
-        if (list->clock_hand->popularity == 0 && list->clock_hand != list->head) {
-          // If the buffer is already pending for sweep operations, we can't reuse it.  Skip.
-          if(list->clock_hand->flags & pending_sweep)
-            continue;
-          // If it's compressed, just update the comp_victims array (if possible) and continue.
-          if (list->clock_hand->flags & compressed) {
-            if(list->comp_victims_index < MAX_COMP_VICTIMS) {
-              list->comp_victims[list->comp_victims_index] = list->clock_hand;
-              list->comp_victims_index++;
-              list->clock_hand->flags |= pending_sweep;
-            }
-            continue;
-          }
-          // We found a raw buffer victim.
-          victim = list->clock_hand;
-          victim->flags |= pending_sweep;
-          break;
-        }
-        list->clock_hand->popularity >>= 1;
-      }
-      // We only reach this when an unpopular raw victim id is found.  Update space we'll free and start tracking victim.
-      bytes_freed += BUFFER_OVERHEAD + victim->data_length;
-      list->victims[list->victims_index] = victim;
-      list->victims_index++;
-      total_victims++;
-
-      // If the victim pool is full or we've found enough memory to free, flush everything and reset counters.
-      if(list->victims_index == VICTIM_BATCH_SIZE || BYTES_NEEDED <= bytes_freed) {
-        // Grab the jobs lock and rely on our condition to tell us when compressor_jobs is empty.
-        pthread_mutex_lock(&list->jobs_lock);
-        while(list->active_compressors > 0 || list->victims_index > list->victims_compressor_index) {
-          pthread_cond_broadcast(&list->jobs_cond);
-          pthread_cond_wait(&list->jobs_parent_cond, &list->jobs_lock);
-        }
-        pthread_mutex_unlock(&list->jobs_lock);
-        for(int i=0; i<list->victims_index; i++) {
-          comp_bytes_added += BUFFER_OVERHEAD + list->victims[i]->comp_length;
-          list->victims[i]->flags &= (~pending_sweep);
-          list->victims[i] = NULL;
-        }
-        list->victims_index = 0;
-        list->victims_compressor_index = 0;
-        // Check to see if we're done scanning.  This prevents double checking via while() with every loop iteration.
-        if(BYTES_NEEDED <= bytes_freed)
-          break;
-      }
+  // Stay in the epoch so nothing the hands (or the victim arrays) point at is reclaimed mid-sweep.
+  const int EPOCH_TOKEN = epoch__enter(list->epoch);
+
+  // Send the hands after raw victims until they cover what we need, then add up what they found.
+  uint64_t bytes_selected = 0;
+  uint32_t selected = 0;
+  if(BYTES_NEEDED != 0 && list->current_raw_size > RAW_LOW) {
+    list__sweep_hands(list, BYTES_NEEDED, budget_ns, max_victims, &start);
+    for(int i=0; i<list->hand_count; i++) {
+      bytes_freed += list->hands[i].bytes_freed;
+      bytes_dropped += list->hands[i].bytes_dropped;
+      comp_bytes_added += list->hands[i].comp_bytes_added;
+      total_victims += list->hands[i].victims_taken;
+      dropped += list->hands[i].dropped;
+      bytes_lost += list->hands[i].bytes_lost;
+      lost += list->hands[i].lost;
+      if(list->hands[i].out_of_budget)
+        out_of_budget = true;
     }
   }
-  // Finally, remove all pending_sweep flags from the compressed victims now that we're done scanning.
-  for(int i=0; i<list->comp_victims_index; i++)
-    list->comp_victims[i]->flags &= (~pending_sweep);
 
 
-  // We freed up enough raw space.  If comp space is too large start freeing up space.  Update some counters under write protection.
-  clock_gettime(CLOCK_MONOTONIC, &start);
-  list__acquire_write_lock(list);
-  list->compressions += total_victims;
-  list->raw_count -= total_victims;
-  list->comp_count += total_victims;
-  list->current_raw_size -= bytes_freed;
-  list->current_comp_size += comp_bytes_added;
-  if(list->current_comp_size > list->max_comp_size) {
-    for(int i=0; i<list->comp_victims_index && list->current_comp_size > list->max_comp_size; i++) {
-      if((list->comp_victims[i]->flags & compressed) == 0)
+  // We freed up enough raw space.  Move the counters over atomically, the same way list__add() and list__remove() do, so readers
+  // keep searching.  Anything evicted below is unlinked by list__remove() and retired to the epoch, never freed under a reader.
+  __sync_fetch_and_add(&list->compressions, total_victims - dropped - lost);
+  __sync_fetch_and_add(&list->compression_skips, dropped);
+  __sync_fetch_and_add(&list->evictions, dropped);
+  __sync_fetch_and_sub(&list->raw_count, total_victims - dropped - lost);
+  __sync_fetch_and_add(&list->comp_count, total_victims - dropped - lost);
+  __sync_fetch_and_sub(&list->current_raw_size, bytes_freed - bytes_dropped - bytes_lost);
+  __sync_fetch_and_add(&list->current_comp_size, comp_bytes_added);
+  // Now ask the policy for compressed victims until the comp side is back down to its low watermark.
+  while(list->current_comp_size > COMP_LOW && (!out_of_budget || list->current_comp_size > list->max_comp_size)) {
+    // The arena's dead bytes count until compaction gives them back.  Copying a mostly live segment beats evicting pages for it.
+    arena__compact(list->arena, ARENA_COMPACT_BATCH, ARENA_PRESSURE_PERCENT);
+    if(list->current_comp_size <= COMP_LOW)
+      break;
+    bytes_selected = 0;
+    room = COMP_BATCH;
+    if(max_victims != 0 && !out_of_budget)
+      room = max_victims - total_victims - comp_victims < room ? max_victims - total_victims - comp_victims : room;
+    if(room == 0) {
+      out_of_budget = true;
+      break;
+    }
+    selected = list->policy->select_victims(list, TIER_COMP, list->current_comp_size - COMP_LOW, list->comp_victims, room, &bytes_selected);
+    if(selected == 0)
+      break;
+    comp_victims += selected;
+    for(uint32_t i=0; i<selected; i++) {
+      victim = list->comp_victims[i];
+      list->comp_victims[i] = NULL;
+      __sync_fetch_and_and(&victim->flags, ~pending_sweep);
+      // Workers may have restored, updated, or removed it since the policy picked it.
+      if((victim->flags & compressed) == 0 || (victim->flags & dirty) || list->current_comp_size <= COMP_LOW)
         continue;
       // We add a pin because list__remove requires it (buffers usually come list__search).
-      __sync_fetch_and_add(&list->comp_victims[i]->ref_count, 1);
-      list__remove(list, list->comp_victims[i]);
+      __sync_fetch_and_add(&victim->ref_count, 1);
+      ghost__insert(list->comp_ghosts, victim->id, BUFFER_OVERHEAD + victim->comp_length);
+      if(list->spill != NULL)
+        list__spill(list, victim);
+      list__remove(list, victim);
       list->evictions++;
-      list->comp_victims[i] = NULL;
     }
-    // If we still haven't freed enough comp space, start clockhand motion again and take more comp victims.
-    while(list->current_comp_size > list->max_comp_size) {
-      while(1) {
-        list->clock_hand = list->clock_hand->next;
-        if(list->clock_hand->popularity == 0 && list->clock_hand != list->head && (list->clock_hand->flags & compressed)) {
-          __sync_fetch_and_add(&list->clock_hand->ref_count, 1);
-          list__remove(list, list->clock_hand);
-          list->evictions++;
-          break;
-        }
-        list->clock_hand->popularity >>= 1;
-      }
+    if(out_of_budget || list__slice_spent(&start, budget_ns, total_victims + comp_victims, max_victims)) {
+      out_of_budget = true;
+      break;
     }
   }
-  // Wrap up and leave.
-  clock_gettime(CLOCK_MONOTONIC, &end);
-  list->comp_victims_index = 0;
+  // Wrap up and leave.  A slice that ran out of budget is only unfinished if there's still something above a low watermark.  So is
+  // one that made progress but was outrun by adds racing it; background reclaim goes all the way to the low watermark.
+  list->sweep_unfinished = (out_of_budget && (list->current_raw_size > RAW_LOW || list->current_comp_size > COMP_LOW)) ||
+                           (bytes_freed > 0 && list->current_raw_size > RAW_LOW);
   if(bytes_freed > 0 || comp_bytes_added > 0)
     list->sweeps++;
+  epoch__exit(list->epoch, EPOCH_TOKEN);
+
+  // The only exclusive part left is waking readers stuck in list__wait_for_sweeper(), which has to happen under the list lock.
+  // Record how long that held the lock up; it's the only time a sweep can stall anyone.  list__balance() already holds it.
+  clock_gettime(CLOCK_MONOTONIC, &pause_start);
+  if(pthread_equal(list->lock_owner, pthread_self())) {
+    pthread_cond_broadcast(&list->reader_condition);
+  } else {
+    pthread_mutex_lock(&list->lock);
+    pthread_cond_broadcast(&list->reader_condition);
+    pthread_mutex_unlock(&list->lock);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  list__record_latency(list->sweep_pauses, BILLION * (end.tv_sec - pause_start.tv_sec) + end.tv_nsec - pause_start.tv_nsec);
+  list__record_latency(list->sweep_slices, BILLION * (end.tv_sec - start.tv_sec) + end.tv_nsec - start.tv_nsec);
   list->sweep_cost += BILLION * (end.tv_sec - start.tv_sec) + end.tv_nsec - start.tv_nsec;
-  list__release_write_lock(list);
+  list->slices++;
 
   return bytes_freed;
 }
 
 
+/* list__sweep_hands
+ * The raw pass of a sweep.  Splits bytes_needed (and the slice's victim budget) between the hands, gives each a range of IDs when
+ * there's more than one, and runs them:  hand 0 here, the rest in their own threads.  A caller holding the list's write lock (see
+ * list__balance()) runs them all here, one after another, because the helper threads would just block on it.  Caller MUST be in an
+ * epoch critical section.
+ */
+void list__sweep_hands(List *list, uint64_t bytes_needed, uint64_t budget_ns, uint32_t max_victims, const struct timespec *start) {
+  pthread_mutex_lock(&list->sweep_lock);
+  const uint8_t HANDS = list->hand_count;
+  const uint64_t SPAN = (uint64_t)list->highest_id / HANDS + 1;
+  for(int i=0; i<HANDS; i++) {
+    SweepHand *hand = &list->hands[i];
+    hand->low = HANDS == 1 ? 0 : (bufferid_t)(SPAN * i);
+    hand->high = (HANDS == 1 || i == HANDS - 1) ? BUFFER_ID_MAX : (bufferid_t)(SPAN * (i + 1));
+    hand->bytes_needed = bytes_needed / HANDS + (i == HANDS - 1 ? bytes_needed % HANDS : 0);
+    hand->start = *start;
+    hand->budget_ns = budget_ns;
+    hand->max_victims = max_victims == 0 ? 0 : (max_victims + HANDS - 1) / HANDS;
+    hand->bytes_freed = 0;
+    hand->bytes_dropped = 0;
+    hand->comp_bytes_added = 0;
+    hand->victims_taken = 0;
+    hand->dropped = 0;
+    hand->bytes_lost = 0;
+    hand->lost = 0;
+    hand->out_of_budget = false;
+  }
+
+  if(HANDS == 1 || pthread_equal(list->lock_owner, pthread_self())) {
+    for(int i=0; i<HANDS; i++)
+      list__sweep_hand(list, &list->hands[i]);
+    pthread_mutex_unlock(&list->sweep_lock);
+    return;
+  }
+  pthread_mutex_lock(&list->hands_lock);
+  list->hands_running = HANDS - 1;
+  list->hand_generation++;
+  pthread_cond_broadcast(&list->hands_cond);
+  pthread_mutex_unlock(&list->hands_lock);
+  list__sweep_hand(list, &list->hands[0]);
+  pthread_mutex_lock(&list->hands_lock);
+  while(list->hands_running > 0)
+    pthread_cond_wait(&list->hands_done_cond, &list->hands_lock);
+  pthread_mutex_unlock(&list->hands_lock);
+  pthread_mutex_unlock(&list->sweep_lock);
+  return;
+}
+
+
+/* list__sweep_hand
+ * One hand's part of the raw pass:  picks raw victims until they cover hand->bytes_needed, handing each full batch to the
+ * compressors and waiting for that batch (not anyone else's) to come back before settling it.  A lone hand asks the policy; one of
+ * several runs the clock over its own range.  Stops early when the slice's budget runs out.  Caller MUST be in an epoch.
+ */
+void list__sweep_hand(List *list, SweepHand *hand) {
+  struct timespec end;
+  Buffer *victim = NULL;
+  uint64_t bytes_selected = 0;
+  uint32_t selected = 0, room = 0;
+  const uint32_t RAW_BATCH = hand->budget_ns != 0 ? SWEEP_SLICE_BATCH : VICTIM_BATCH_SIZE;
+  while(1) {
+    bytes_selected = 0;
+    room = RAW_BATCH - hand->victims_index;
+    if(hand->max_victims != 0 && hand->max_victims - hand->victims_taken < room)
+      room = hand->max_victims - hand->victims_taken;
+    if(list->hand_count == 1)
+      selected = list->policy->select_victims(list, TIER_RAW, hand->bytes_needed - hand->bytes_freed, &hand->victims[hand->victims_index], room, &bytes_selected);
+    else
+      selected = policy__clock_select_range(list, hand, hand->bytes_needed - hand->bytes_freed, &hand->victims[hand->victims_index], room, &bytes_selected);
+    pthread_mutex_lock(&list->jobs_lock);
+    hand->victims_index += selected;
+    pthread_mutex_unlock(&list->jobs_lock);
+    hand->victims_taken += selected;
+    hand->bytes_freed += bytes_selected;
+
+    // If the batch is full, we've found enough memory to free, the slice is out of victims, or the policy came up empty, flush.
+    if(hand->victims_index == RAW_BATCH || hand->bytes_needed <= hand->bytes_freed || selected == 0 || hand->victims_taken == hand->max_victims) {
+      // Grab the jobs lock and rely on our condition to tell us when our batch is done.
+      pthread_mutex_lock(&list->jobs_lock);
+      while(hand->in_flight > 0 || hand->victims_index > hand->victims_compressor_index) {
+        pthread_cond_broadcast(&list->jobs_cond);
+        pthread_cond_wait(&list->jobs_parent_cond, &list->jobs_lock);
+      }
+      pthread_mutex_unlock(&list->jobs_lock);
+      for(int i=0; i<hand->victims_index; i++) {
+        victim = hand->victims[i];
+        hand->victims[i] = NULL;
+        __sync_fetch_and_and(&victim->flags, ~pending_sweep);
+        // A worker updated or removed it before the compressors could swap it out, and already settled its raw bytes and count.
+        if((victim->flags & dirty) && (victim->flags & compressing) == 0) {
+          hand->bytes_lost += BUFFER_OVERHEAD + victim->data_length;
+          hand->lost++;
+          continue;
+        }
+        // Victims the compressors didn't think were worth it leave entirely.  list__remove() does its own raw accounting.  They get
+        // no raw ghost:  nothing restores them, so it would only crowd out ghosts of buffers that really are in the comp tier.
+        if((victim->flags & incompressible) && (victim->flags & dirty) == 0) {
+          hand->bytes_dropped += BUFFER_OVERHEAD + victim->data_length;
+          hand->dropped++;
+          __sync_fetch_and_add(&victim->ref_count, 1);
+          list__remove(list, victim);
+          continue;
+        }
+        ghost__insert(list->raw_ghosts, victim->id, BUFFER_OVERHEAD + victim->data_length);
+        hand->comp_bytes_added += BUFFER_OVERHEAD + victim->comp_length;
+      }
+      pthread_mutex_lock(&list->jobs_lock);
+      hand->victims_index = 0;
+      hand->victims_compressor_index = 0;
+      pthread_mutex_unlock(&list->jobs_lock);
+      // Check to see if we're done scanning.  This prevents double checking via while() with every loop iteration.
+      if(hand->bytes_needed <= hand->bytes_freed || selected == 0)
+        break;
+      if(list__slice_spent(&hand->start, hand->budget_ns, hand->victims_taken, hand->max_victims)) {
+        hand->out_of_budget = true;
+        break;
+      }
+    }
+  }
+  hand->total_freed += hand->bytes_freed;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  hand->sweep_time += BILLION * (end.tv_sec - hand->start.tv_sec) + end.tv_nsec - hand->start.tv_nsec;
+  return;
+}
+
+
+/* list__hand_start
+ * The thread a helper hand (1+) runs in.  Waits for the sweeper to bump hand_generation, runs its part of the raw pass in its own
+ * epoch, and reports back.
+ */
+void list__hand_start(SweepHand *hand) {
+  List *list = hand->list;
+  uint64_t generation = 0;
+  pthread_mutex_lock(&list->hands_lock);
+  generation = list->hand_generation;
+  while(1) {
+    while(list->hand_generation == generation && list->hands_stop == 0)
+      pthread_cond_wait(&list->hands_cond, &list->hands_lock);
+    if(list->hands_stop != 0)
+      break;
+    generation = list->hand_generation;
+    pthread_mutex_unlock(&list->hands_lock);
+    const int EPOCH_TOKEN = epoch__enter(list->epoch);
+    list__sweep_hand(list, hand);
+    epoch__exit(list->epoch, EPOCH_TOKEN);
+    pthread_mutex_lock(&list->hands_lock);
+    list->hands_running--;
+    if(list->hands_running == 0)
+      pthread_cond_broadcast(&list->hands_done_cond);
+  }
+  pthread_mutex_unlock(&list->hands_lock);
+  return;
+}
+
+
+/* list__set_hands
+ * Replaces the list's sweep hands with count new ones, stopping the old helper threads and starting new ones.  Waits for any raw
+ * pass in progress.  More than one hand needs the clock policy.
+ */
+int list__set_hands(List *list, uint8_t count) {
+  if(count == 0 || count > MAX_SWEEP_HANDS || (count > 1 && list->policy != &POLICIES[POLICY_CLOCK]))
+    return E_BAD_ARGS;
+  SweepHand *hands = (SweepHand *)calloc(count, sizeof(SweepHand));
+  if(hands == NULL)
+    return E_NO_MEMORY;
+  pthread_mutex_lock(&list->sweep_lock);
+  // Stop the old helpers.
+  pthread_mutex_lock(&list->hands_lock);
+  list->hands_stop = 1;
+  pthread_cond_broadcast(&list->hands_cond);
+  pthread_mutex_unlock(&list->hands_lock);
+  for(int i=1; i<list->hand_count; i++)
+    pthread_join(list->hands[i].thread, NULL);
+  list->hands_stop = 0;
+  // Compressors find hands under the jobs lock.  Nothing's queued:  the only raw pass that could have queued anything holds sweep_lock.
+  pthread_mutex_lock(&list->jobs_lock);
+  free(list->hands);
+  list->hands = hands;
+  list->hand_count = count;
+  pthread_mutex_unlock(&list->jobs_lock);
+  for(int i=0; i<count; i++) {
+    hands[i].list = list;
+    hands[i].index = i;
+    if(i > 0)
+      pthread_create(&hands[i].thread, NULL, (void *) &list__hand_start, &hands[i]);
+  }
+  pthread_mutex_unlock(&list->sweep_lock);
+  return E_OK;
+}
+
+
+/* list__hand_with_work
+ * The first hand with victims no compressor has taken yet, or NULL.  Caller MUST hold jobs_lock.
+ */
+SweepHand* list__hand_with_work(List *list) {
+  for(int i=0; i<list->hand_count; i++)
+    if(list->hands[i].victims_index > list->hands[i].victims_compressor_index)
+      return &list->hands[i];
+  return NULL;
+}
+
+
+/* list__slice_spent
+ * True when a slice that started at start has used up its time or victim budget.  Zero budgets never run out.
+ */
+bool list__slice_spent(const struct timespec *start, uint64_t budget_ns, uint32_t victims, uint32_t max_victims) {
+  struct timespec now;
+  if(max_victims != 0 && victims >= max_victims)
+    return true;
+  if(budget_ns == 0)
+    return false;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)(BILLION * (now.tv_sec - start->tv_sec) + now.tv_nsec - start->tv_nsec) >= budget_ns;
+}
+
+
+/* list__record_latency
+ * Adds one latency to a histogram.  Bucket i counts latencies of [2^i, 2^(i+1)) ns; the last bucket takes everything longer.
+ * Histograms are SWEEP_PAUSE_BUCKETS long.
+ */
+void list__record_latency(uint64_t *histogram, uint64_t latency_ns) {
+  int bucket = 0;
+  while(latency_ns > 1 && bucket < SWEEP_PAUSE_BUCKETS - 1) {
+    latency_ns >>= 1;
+    bucket++;
+  }
+  __sync_fetch_and_add(&histogram[bucket], 1);
+  return;
+}
+
+
+/* list__show_latencies
+ * Prints the non-empty buckets of a latency histogram, one per line, with each line prefixed by indent.
+ */
+void list__show_latencies(const uint64_t *histogram, const char *indent) {
+  uint64_t total = 0;
+  for(int i=0; i<SWEEP_PAUSE_BUCKETS; i++)
+    total += histogram[i];
+  if(total == 0) {
+    printf("%s(nothing recorded)\n", indent);
+    return;
+  }
+  for(int i=0; i<SWEEP_PAUSE_BUCKETS; i++) {
+    if(histogram[i] == 0)
+      continue;
+    printf("%s%'14"PRIu64" - %'14"PRIu64" ns : %'10"PRIu64" (%5.1f%%)\n", indent, (uint64_t)1 << i, ((uint64_t)1 << (i + 1)) - 1, histogram[i], 100.0 * histogram[i] / total);
+  }
+  return;
+}
+
+
 /* list__sweeper_start
  * This is the asynchronous thread that will call the sweeping logic when necessary.
  */
 void list__sweeper_start(List *list) {
+  struct timespec deadline;
+  uint64_t comp_size = 0;
+  bool fruitless = false;
   while(1) {
     pthread_mutex_lock(&list->lock);
-    while(list->current_raw_size < list->max_raw_size && list->current_comp_size < list->max_comp_size && list->active != 0) {
+    list->sweep_requested = 0;
+    // Above the high watermark with nothing we can take (everything pinned, say), sweeping again right away would just spin.
+    if(fruitless && list->active != 0) {
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_nsec += RATIO_INTERVAL_MS * MILLION;
+      deadline.tv_sec += deadline.tv_nsec / BILLION;
+      deadline.tv_nsec %= BILLION;
+      pthread_cond_broadcast(&list->reader_condition);
+      pthread_cond_timedwait(&list->sweeper_condition, &list->lock, &deadline);
+      list->sweep_requested = 0;
+    }
+    while(list->sweep_unfinished == 0 && list->current_raw_size <= list__watermark(list->max_raw_size, list->watermark_high) && list->current_comp_size <= list__watermark(list->max_comp_size, list->watermark_high) && list->active != 0) {
       pthread_cond_broadcast(&list->reader_condition);
-      pthread_cond_wait(&list->sweeper_condition, &list->lock);
+      // Every wake-up re-arms list__wake_sweeper(), even one whose recheck sends us back to sleep, or later wakes would be lost.
+      if(list->controller.adaptive == 0) {
+        pthread_cond_wait(&list->sweeper_condition, &list->lock);
+        list->sweep_requested = 0;
+        continue;
+      }
+      // The ratio controller needs a tick even when nobody needs a sweep.
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_nsec += RATIO_INTERVAL_MS * MILLION;
+      deadline.tv_sec += deadline.tv_nsec / BILLION;
+      deadline.tv_nsec %= BILLION;
+      const int WAIT_RV = pthread_cond_timedwait(&list->sweeper_condition, &list->lock, &deadline);
+      list->sweep_requested = 0;
+      if(WAIT_RV == ETIMEDOUT)
+        break;
     }
     pthread_mutex_unlock(&list->lock);
     if(list->active == 0) {
       pthread_cond_broadcast(&list->reader_condition);
       break;
     }
-    list__sweep(list, list->sweep_goal);
+    list__fold_misses(list);
+    if(list->controller.adaptive != 0)
+      list__tune_ratio(list);
+    fruitless = false;
+    if(list->sweep_unfinished || list->current_raw_size > list__watermark(list->max_raw_size, list->watermark_high) || list->current_comp_size > list__watermark(list->max_comp_size, list->watermark_high)) {
+      comp_size = list->current_comp_size;
+      fruitless = list__sweep_slice(list, list->sweep_goal, list->slice_budget_ns, list->slice_victims) == 0 && list->current_comp_size >= comp_size;
+      // Between slices, let everyone else have the CPU before picking the sweep back up.
+      if(list->sweep_unfinished)
+        sched_yield();
+    }
+    // Restores and evictions leave holes in the arena.  Squeeze a few of the sparsest segments while we're up.
+    arena__compact(list->arena, ARENA_COMPACT_BATCH, ARENA_COMPACT_PERCENT);
+    // Train a new dictionary if the compressors have sampled enough pages for one.
+    if(list->dictionaries != NULL)
+      dict__train(list->dictionaries);
   }
 
   // Perform a final sweep.  This is to solve the edge case where a reader (list__add or list__search) is stuck waiting because its
@@ -929,6 +2040,7 @@ int list__balance(List *list, uint32_t ratio, uint64_t max_memory) {
   // Set the memory values according to the ratio.
   list->max_raw_size = max_memory * ratio / 100;
   list->max_comp_size = max_memory - list->max_raw_size;
+  list->controller.raw_ratio = ratio;
 
   // Call list__sweep to clean up any needed raw space and remove any compressed buffers, if necessary.
   const uint8_t MINIMUM_SWEEP_GOAL = list->current_raw_size > list->max_raw_size ? 101 - (100 * list->max_raw_size / list->current_raw_size) : 1;
@@ -942,6 +2054,108 @@ int list__balance(List *list, uint32_t ratio, uint64_t max_memory) {
 }
 
 
+/* list__set_ratio
+ * Moves the raw/comp split of the list's memory without sweeping or locking.  The sweeper enforces the new limits on its next pass.
+ */
+void list__set_ratio(List *list, uint8_t ratio) {
+  const uint64_t MAX_MEMORY = list->max_raw_size + list->max_comp_size;
+  list->max_raw_size = MAX_MEMORY * ratio / 100;
+  list->max_comp_size = MAX_MEMORY - list->max_raw_size;
+  list->controller.raw_ratio = ratio;
+  return;
+}
+
+
+/* list__tune_ratio
+ * One step of the adaptive ratio controller; only the sweeper thread calls this.  Once per RATIO_INTERVAL_MS it prices the time
+ * readers lost:  ns spent decompressing restored buffers, plus the miss penalty for every eviction (each is a future reload).
+ * Then it hill-climbs.  If the cost got worse by more than RATIO_HYSTERESIS percent, it turns around.  If it got better by that
+ * much, it keeps going.  Anything in between is noise, so it holds.
+ */
+void list__tune_ratio(List *list) {
+  RatioController *controller = &list->controller;
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  const uint64_t NOW = BILLION * now.tv_sec + now.tv_nsec;
+  if(controller->checked_at == 0) {
+    controller->checked_at = NOW;
+    controller->last_restore_cost = controller->restore_cost;
+    controller->last_evictions = list->evictions;
+    return;
+  }
+  if(NOW - controller->checked_at < (uint64_t)RATIO_INTERVAL_MS * MILLION)
+    return;
+
+  // Price the interval in ns of reader stall per second.
+  const uint64_t RESTORE_COST = controller->restore_cost;
+  const uint64_t EVICTIONS = list->evictions;
+  const uint64_t PENALTY = controller->miss_penalty != 0 ? controller->miss_penalty : RATIO_MISS_PENALTY;
+  const uint64_t COST = (uint64_t)((RESTORE_COST - controller->last_restore_cost + (EVICTIONS - controller->last_evictions) * PENALTY) * (1.0 * BILLION / (NOW - controller->checked_at)));
+  controller->checked_at = NOW;
+  controller->last_restore_cost = RESTORE_COST;
+  controller->last_evictions = EVICTIONS;
+  controller->intervals++;
+
+  // Decide.  The very first interval has nothing to compare against, so just take a step to get a gradient.
+  const uint64_t LAST_COST = controller->last_cost;
+  controller->last_cost = COST;
+  if(controller->intervals > 1) {
+    if(COST * 100 > LAST_COST * (100 + RATIO_HYSTERESIS))
+      controller->step = -controller->step;
+    else if(COST * (100 + RATIO_HYSTERESIS) >= LAST_COST * 100)
+      return;
+  }
+  int ratio = controller->raw_ratio + controller->step;
+  if(ratio < RATIO_MIN || ratio > RATIO_MAX) {
+    // Pinned against a limit; point back inward so the next move can come off it.
+    controller->step = -controller->step;
+    return;
+  }
+
+  // Log it and move.
+  RatioDecision *decision = &controller->log[controller->adjustments % RATIO_LOG_SIZE];
+  decision->interval = controller->intervals;
+  decision->cost = COST;
+  decision->from = controller->raw_ratio;
+  decision->to = ratio;
+  controller->adjustments++;
+  list__set_ratio(list, ratio);
+  return;
+}
+
+
+/* list__record_miss
+ * Callers that had to load a page the list didn't have report how long it took and how big it was.  Any worker can call this, so it
+ * only adds to the controller's sums.  The sweeper folds them into the miss penalty with list__fold_misses().
+ */
+void list__record_miss(List *list, uint64_t load_ns, uint32_t bytes) {
+  __sync_fetch_and_add(&list->controller.miss_ns_sum, load_ns);
+  __sync_fetch_and_add(&list->controller.miss_bytes_sum, bytes);
+  __sync_fetch_and_add(&list->controller.misses, 1);
+  return;
+}
+
+
+/* list__fold_misses
+ * Takes the misses recorded since the last call and folds their average into the controller's miss penalty and the page size it
+ * goes with.  Only the sweeper thread calls this, so it's the only writer of miss_penalty and miss_bytes.  A miss recorded while we
+ * swap the sums out can land its ns in one fold and its count in the next; it's an average, so that's fine.
+ */
+void list__fold_misses(List *list) {
+  RatioController *controller = &list->controller;
+  const uint64_t MISSES = __sync_lock_test_and_set(&controller->misses, 0);
+  const uint64_t NS_SUM = __sync_lock_test_and_set(&controller->miss_ns_sum, 0);
+  const uint64_t BYTES_SUM = __sync_lock_test_and_set(&controller->miss_bytes_sum, 0);
+  if(MISSES == 0)
+    return;
+  const uint64_t PENALTY = controller->miss_penalty;
+  const uint64_t BYTES = controller->miss_bytes;
+  controller->miss_penalty = PENALTY == 0 ? NS_SUM / MISSES : (PENALTY * 7 + NS_SUM / MISSES) / 8;
+  controller->miss_bytes = BYTES == 0 ? BYTES_SUM / MISSES : (BYTES * 7 + BYTES_SUM / MISSES) / 8;
+  return;
+}
+
+
 /* list__destroy
  * Frees the data held by a list.
  */
@@ -953,6 +2167,12 @@ int list__destroy(List *list) {
   pthread_cond_broadcast(&list->sweeper_condition);
   pthread_mutex_unlock(&list->lock);
   pthread_join(list->sweeper_thread, NULL);
+  pthread_mutex_lock(&list->hands_lock);
+  list->hands_stop = 1;
+  pthread_cond_broadcast(&list->hands_cond);
+  pthread_mutex_unlock(&list->hands_lock);
+  for(int i=1; i<list->hand_count; i++)
+    pthread_join(list->hands[i].thread, NULL);
 
   // Destroy all the buffers, including head.
   while(list->head->next != list->head) {
@@ -961,12 +2181,30 @@ int list__destroy(List *list) {
     if(rv != E_OK)
       return E_LIST_REMOVAL;
   }
-  __sync_fetch_and_add(&list->head->next->ref_count, 1);
-  list__remove(list, list->head);
+  if(list->index_mode & (INDEX_LOCK_FREE | INDEX_FAT_NODE)) {
+    // The head is never part of a CAS or a fat node, so just kill it.
+    buffer__destroy(list->head, true);
+  } else {
+    __sync_fetch_and_add(&list->head->next->ref_count, 1);
+    list__remove(list, list->head);
+  }
 
   // Nuke all the skiplist items.
   for(int i=0; i<SKIPLIST_MAX; i++)
     free(list->indexes[i]);
+  list__fat_destroy(list);
+  pthread_mutex_destroy(&list->fat_lock);
+  list__hash_destroy(list);
+  pthread_mutex_destroy(&list->hash_lock);
+
+  // Reclaim anything still waiting on a grace period.  The cow killer is still running to catch buffers that have pins.
+  epoch__destroy(list->epoch);
+  ghost__destroy(list->raw_ghosts);
+  ghost__destroy(list->comp_ghosts);
+  admit__destroy(list->admission);
+  window__destroy(list->windows);
+  spill__destroy(list->spill);
+  list->policy->destroy(list);
 
   // Stop all the compressors.
   for(int i=0; i<list->compressor_count; i++)
@@ -980,6 +2218,9 @@ int list__destroy(List *list) {
     pthread_join(list->compressor_threads[i], NULL);
   free(list->compressor_pool);
   free(list->compressor_threads);
+  free(list->hands);
+  // Images still holding a dictionary keep it alive; this only drops the trainer's own reference.
+  dict__destroy(list->dictionaries);
 
   // Stop the cow killer.
   pthread_mutex_lock(&list->cow_lock);
@@ -987,6 +2228,9 @@ int list__destroy(List *list) {
   pthread_mutex_unlock(&list->cow_lock);
   pthread_join(list->slaughter_house_thread, NULL);
 
+  // Every buffer is gone, so nothing points into the arena anymore.
+  arena__destroy(list->arena);
+
   // Destroy the list object itself.
   free(list);
   return E_OK;
@@ -999,16 +2243,24 @@ int list__destroy(List *list) {
 void list__compressor_start(List *list) {
   // Figure out which index we are.
   pthread_mutex_lock(&list->lock);
-  int my_worker_id = next_compress_worker_id;
+  int my_worker_id = list->next_compressor_id;
   Compressor *comp = &list->compressor_pool[my_worker_id];
-  next_compress_worker_id++;
+  list->next_compressor_id++;
   pthread_mutex_unlock(&list->lock);
 
   // Try to do work forever.  We need to start off assuming we're an active worker.  It self-regulates within the loop.
   Buffer *work_me[COMPRESSOR_BATCH_SIZE];
+  SweepHand *hand = NULL;
   void *compressed_data = NULL;
+  void *arena_data = NULL;
+  Dictionary *dict = NULL;
+  int codec_id = NO_COMPRESSOR_ID;
+  int codec_level = 0;
   int work_me_count = 0;
   int rv = E_OK;
+  // Our own compressor state, kept for the life of the thread rather than rebuilt for every page.
+  CodecContext *codec = NULL;
+  codec__initialize(&codec);
   pthread_mutex_lock(comp->jobs_lock);
   (*comp->active_compressors)++;
   pthread_mutex_unlock(comp->jobs_lock);
@@ -1016,12 +2268,13 @@ void list__compressor_start(List *list) {
   while(1) {
     // Secure the lock to test the predicate.  If there's no work to do, do some signaling and wait.
     pthread_mutex_lock(comp->jobs_lock);
-    if((*comp->victims_index) == (*comp->victims_compressor_index)) {
+    hand = list__hand_with_work(list);
+    if(hand == NULL) {
       // There's no work to do.  Remove our active pin, notify the parent if pin count is 0, and then wait to be woken up again.
       (*comp->active_compressors)--;
       if(*comp->active_compressors == 0)
         pthread_cond_broadcast(comp->jobs_parent_cond);
-      while((*comp->victims_index) == (*comp->victims_compressor_index) && comp->runnable == 0)
+      while((hand = list__hand_with_work(list)) == NULL && comp->runnable == 0)
         pthread_cond_wait(comp->jobs_cond, comp->jobs_lock);
       // Someone woke us up and we have work to do.  Increment active counter.
       (*comp->active_compressors)++;
@@ -1035,12 +2288,14 @@ void list__compressor_start(List *list) {
       break;
     }
     // Yep, we have work to do!  Grab some items and release the lock so others can have it.
+    // Each hand waits on its own batch, so keep track of how much of it we have.
     work_me_count = 0;
-    while(work_me_count < COMPRESSOR_BATCH_SIZE && (*comp->victims_index) > (*comp->victims_compressor_index)) {
-      work_me[work_me_count] = comp->victims[(*comp->victims_compressor_index)];
+    while(work_me_count < COMPRESSOR_BATCH_SIZE && hand->victims_index > hand->victims_compressor_index) {
+      work_me[work_me_count] = hand->victims[hand->victims_compressor_index];
       work_me_count++;
-      (*comp->victims_compressor_index)++;
+      hand->victims_compressor_index++;
     }
+    hand->in_flight += work_me_count;
     pthread_cond_broadcast(comp->jobs_cond);
     pthread_mutex_unlock(comp->jobs_lock);
 
@@ -1048,20 +2303,148 @@ void list__compressor_start(List *list) {
       // Compress the buffer's data.  Lean on list__update() for the heavy lifting and CoW work.
       if(work_me[i]->flags & compressed)
         continue;
-      rv = buffer__compress(work_me[i], &compressed_data, comp->compressor_id, comp->compressor_level);
+      // Don't burn the CPU on a page we already know isn't worth it, and check the ones we didn't know about once we do.
+      if(!list__worth_compressing(list, work_me[i], work_me[i]->last_comp_length)) {
+        list__mark_incompressible(work_me[i]);
+        continue;
+      }
+      compressed_data = NULL;
+      codec_id = list__choose_codec(comp, work_me[i], &codec_level);
+      // Sample the page for the next dictionary if we're collecting, and hold the current one while we use it.  Adaptive lists
+      // only train for zstd, so LZ4 pages neither sample nor use it.
+      dict = NULL;
+      if(list->dictionaries != NULL && codec_id == list->dictionaries->compressor_id) {
+        dict__sample(list->dictionaries, work_me[i]->data, work_me[i]->data_length);
+        dict = dict__current(list->dictionaries);
+      }
+      rv = buffer__compress(work_me[i], &compressed_data, codec_id, codec_level, codec, dict);
+      if(rv == E_OK && codec_id != NO_COMPRESSOR_ID)
+        __sync_fetch_and_add(&list->codec_stats[codec_id].compress_ns, codec->last_ns);
+      if(dict != NULL) {
+        if(rv == E_OK)
+          dict__record(list->dictionaries, dict, work_me[i]->data_length, work_me[i]->comp_length);
+        dict__release(dict->id);
+      }
       if(rv == E_BUFFER_ALREADY_COMPRESSED)
         continue;
+      if(rv != E_OK || !list__worth_compressing(list, work_me[i], work_me[i]->comp_length)) {
+        // The buffer still holds its raw data; only last_comp_length remembers what we found.  Pages that won't compress at all
+        // (no data, out of memory) are just as well evicted.
+        free(compressed_data);
+        dict__release(work_me[i]->dict_id);
+        work_me[i]->dict_id = DICT_NONE;
+        work_me[i]->codec_id = NO_COMPRESSOR_ID;
+        work_me[i]->comp_length = 0;
+        list__mark_incompressible(work_me[i]);
+        continue;
+      }
+      // Keep the image at its exact size in the arena and give the bound-sized scratch back.
+      arena_data = compressed_data == NULL ? NULL : arena__store(list->arena, compressed_data, work_me[i]->comp_length);
+      if(arena_data != NULL) {
+        free(compressed_data);
+        compressed_data = arena_data;
+      }
+      const uint32_t COMP_LENGTH = work_me[i]->comp_length;
       // List update requires a pin.
       __sync_fetch_and_add(&work_me[i]->ref_count, 1);
-      // We are the only ones who ever set or release the compressing flag so it's ok.
-      work_me[i]->flags |= compressing;
+      // We are the only ones who ever set or release the compressing flag, but workers change the others under the buffer lock.
+      __sync_fetch_and_or(&work_me[i]->flags, compressing);
       rv = list__update(list, &work_me[i], compressed_data, work_me[i]->comp_length, HAVE_PIN);
-      // Removal of the compressing flag doesn't matter because of CoW.  But the new buffer pointed to by work_me[i] should get a flag.
-      work_me[i]->flags |= compressed;
+      // The new buffer carries the old one's policy state, so it can move from the raw tier to the comp tier.  It owns the image now;
+      // our pin keeps it from being reclaimed before it knows the image is in the arena.
+      if(rv == E_OK) {
+        if(arena_data != NULL) {
+          arena__adopt(arena_data, work_me[i]);
+          __sync_fetch_and_or(&work_me[i]->flags, in_arena);
+        }
+        list->policy->remove(list, work_me[i], TIER_RAW);
+        list->policy->insert(list, work_me[i], TIER_COMP);
+        if(codec_id != NO_COMPRESSOR_ID)
+          codec__count_compression(&list->codec_stats[codec_id], work_me[i]->data_length, COMP_LENGTH);
+        __sync_fetch_and_or(&work_me[i]->flags, compressed);
+      } else {
+        if(arena_data != NULL)
+          arena__free(arena_data);
+        else
+          free(compressed_data);
+        dict__release(work_me[i]->dict_id);
+        work_me[i]->dict_id = DICT_NONE;
+        work_me[i]->codec_id = NO_COMPRESSOR_ID;
+        // Removal of the compressing flag doesn't matter because of CoW, except when a worker updated or removed the buffer while
+        // we compressed it.  Then it tells the hand that the worker already settled the buffer.
+        pthread_mutex_lock(&work_me[i]->lock);
+        __sync_fetch_and_and(&work_me[i]->flags, ~compressing);
+        pthread_mutex_unlock(&work_me[i]->lock);
+      }
       __sync_fetch_and_add(&work_me[i]->ref_count, -1);
       work_me[i] = NULL;
     }
+    pthread_mutex_lock(comp->jobs_lock);
+    hand->in_flight -= work_me_count;
+    if(hand->in_flight == 0)
+      pthread_cond_broadcast(comp->jobs_parent_cond);
+    pthread_mutex_unlock(comp->jobs_lock);
   }
+  codec__destroy(codec);
+  return;
+}
+
+
+/* list__worth_compressing
+ * Decides whether a raw victim earns a place in the comp tier or should simply be evicted.  comp_length is what the page compresses
+ * to, either just now or the last time (buf->last_comp_length); 0 means we don't know yet and have to try.  Every restore saves a
+ * reload (the miss penalty) and costs a decompression.  Buffers that were restored before are expected to come back as often again,
+ * so they're allowed to save less space, but have to decompress faster than a reload.  Without a compressor the comp tier is just more raw space, so everything qualifies.
+ */
+bool list__worth_compressing(List *list, Buffer *buf, uint32_t comp_length) {
+  if(comp_length == 0 || list->compressor_id == NO_COMPRESSOR_ID)
+    return true;
+  const uint64_t RESTORES = buf->comp_hits + 1;
+  const uint64_t RAW_SIZE = BUFFER_OVERHEAD + buf->data_length;
+  const uint64_t COMP_SIZE = BUFFER_OVERHEAD + comp_length;
+  if(COMP_SIZE >= RAW_SIZE || (RAW_SIZE - COMP_SIZE) * 100 * RESTORES < RAW_SIZE * COMPRESS_MIN_SAVINGS)
+    return false;
+  // Time:  only a buffer that's been restored has told us what its decompressions cost.  comp_cost covers every compression and
+  // decompression so far (one more compression than restore).  A compression that already happened is spent, so don't charge it.
+  if(buf->comp_hits == 0)
+    return true;
+  const uint64_t OPERATION_COST = buf->comp_cost / (2 * buf->comp_hits + 1);
+  const uint64_t OPERATIONS = RESTORES + (buf->comp_length == 0 ? 1 : 0);
+  const uint64_t PENALTY = list->controller.miss_penalty != 0 ? list->controller.miss_penalty : RATIO_MISS_PENALTY;
+  return RESTORES * PENALTY > OPERATIONS * OPERATION_COST;
+}
+
+
+/* list__choose_codec
+ * Picks the compressor for a raw victim and sets *level to go with it.  Lists with one compressor always get it.  Adaptive lists
+ * weigh how often the page comes back against how well it compresses:  pages restored CODEC_HOT_RESTORES times or more, and pages
+ * that don't compress much, get LZ4, which decompresses several times faster.  Cold, compressible pages get zstd at
+ * CODEC_COLD_LEVEL, which saves more space.  A page compressed before is judged by what it compressed to then; a new one by
+ * codec__entropy().
+ */
+int list__choose_codec(Compressor *comp, Buffer *buf, int *level) {
+  *level = comp->compressor_level;
+  if(comp->compressor_id != ADAPTIVE_COMPRESSOR_ID)
+    return comp->compressor_id;
+  *level = 1;
+  if(buf->comp_hits >= CODEC_HOT_RESTORES)
+    return LZ4_COMPRESSOR_ID;
+  if(buf->last_comp_length != 0 && (uint64_t)buf->last_comp_length * CODEC_COLD_RATIO > buf->data_length)
+    return LZ4_COMPRESSOR_ID;
+  if(buf->last_comp_length == 0 && codec__entropy(buf->data, buf->data_length) > CODEC_COLD_ENTROPY)
+    return LZ4_COMPRESSOR_ID;
+  *level = CODEC_COLD_LEVEL;
+  return ZSTD_COMPRESSOR_ID;
+}
+
+
+/* list__mark_incompressible
+ * Flags a sweep victim for list__sweep() to evict rather than count as compressed.
+ */
+void list__mark_incompressible(Buffer *buf) {
+  pthread_mutex_lock(&buf->lock);
+  __sync_fetch_and_or(&buf->flags, incompressible);
+  pthread_mutex_unlock(&buf->lock);
   return;
 }
 
@@ -1078,73 +2461,103 @@ void list__show_structure(List *list) {
   printf("Buffer counts   : %'"PRIu32" raw, %'"PRIu32" compressed.\n", list->raw_count, list->comp_count);
   printf("Current sizes   : %'"PRIu64" bytes raw, %'"PRIu64" bytes compressed.\n", list->current_raw_size, list->current_comp_size);
   printf("Maximum sizes   : %'"PRIu64" bytes raw, %'"PRIu64" bytes compressed.\n", list->max_raw_size, list->max_comp_size);
+  printf("Codecs          : %s.\n", codec__name(list->compressor_id));
+  for(int i=0; i<CODEC_SLOTS; i++) {
+    if(list->codec_stats[i].compressions == 0 && list->codec_stats[i].decompressions == 0)
+      continue;
+    char label[32];
+    snprintf(label, sizeof(label), "                  %-5s", codec__name(i));
+    codec__show(&list->codec_stats[i], label);
+  }
   /* Locking, Reference Counters, and Similar Members */
-  printf("Reference pins  : %"PRIu32".  This should be 0 at program end.\n", list->ref_count);
+  printf("Reference pins  : %"PRId64".  This should be 0 at program end.\n", list__pin_count(list));
   printf("Pending writers : %"PRIu8".  This should be 0 at program end.\n", list->pending_writers);
   printf("CoW space used  : %"PRIu64".  This should be less than 5%% of max_memory at program end.\n", list->cow_current_size);
   /* Management and Administration Members */
   printf("Sweep goal      : %"PRIu8"%%.\n", list->sweep_goal);
+  printf("Watermarks      : sweeper starts at %"PRIu8"%% and stops at %"PRIu8"%% of each tier.  Workers wait past %"PRIu16"%% of raw.\n", list->watermark_high, list->watermark_low, 100 + list->overcommit);
+  printf("Stalls          : %'"PRIu64" waits on the sweeper, %'"PRIu64" ns total.\n", list->stalls, list->stall_time);
+  printf("Raw ratio       : %"PRIu8"%% (%s).  %'"PRIu64" adjustments over %'"PRIu64" intervals.\n", list->controller.raw_ratio, list->controller.adaptive ? "adaptive" : "fixed", list->controller.adjustments, list->controller.intervals);
+  for(uint64_t i = list->controller.adjustments > RATIO_LOG_SIZE ? list->controller.adjustments - RATIO_LOG_SIZE : 0; i < list->controller.adjustments; i++) {
+    RatioDecision *decision = &list->controller.log[i % RATIO_LOG_SIZE];
+    printf("                  interval %'6"PRIu64" : %3"PRIu8"%% -> %3"PRIu8"%%  (stall cost %'"PRIu64" ns/sec)\n", decision->interval, decision->from, decision->to, decision->cost);
+  }
   printf("Sweeps performed: %'"PRIu64".\n", list->sweeps);
-  printf("Time sweeping   : %'"PRIu64" ns.  (Cannot search during this time.  More == bad)\n", list->sweep_cost);
+  printf("Time sweeping   : %'"PRIu64" ns.  (Searches continue during this time.)\n", list->sweep_cost);
+  printf("Sweep pauses    : (time each sweep held the list lock; readers can't be woken or pin slowly during this)\n");
+  list__show_latencies(list->sweep_pauses, "                  ");
+  printf("Sweep hands     : %"PRIu8", splitting IDs 0 - %'"PRIu32".\n", list->hand_count, list->highest_id);
+  for(int i=0; i<list->hand_count; i++)
+    printf("                  hand %2d : IDs %'"PRIu32" - %'"PRIu32", resting at %'"PRIu32".  %'"PRIu64" bytes reclaimed in %'"PRIu64" ns.\n", i, list->hands[i].low, list->hands[i].high, list->hands[i].position, list->hands[i].total_freed, list->hands[i].sweep_time);
+  printf("Sweep slices    : %'"PRIu64" slices, budget %'"PRIu64" ns and %'"PRIu32" victims each (0 == unlimited).  Time each took:\n", list->slices, list->slice_budget_ns, list->slice_victims);
+  list__show_latencies(list->sweep_slices, "                  ");
   /* Management of Nodes for Skiplist and Buffers */
-  printf("Skiplist Levels : %"PRIu8"\n", list->levels);
+  if(list->index_mode & INDEX_FAT_NODE)
+    printf("Fat Node Levels : %"PRIu8"\n", list->fat_levels);
+  else
+    printf("Skiplist Levels : %"PRIu8"\n", list->levels);
 
-  // Skiplist Index information.
-  char *header_format    = "| %-5s | %-8s | %-11s | %-9s | %-44s |\n";
-  char *row_format       = "| %5d | %8s | %11s | %9s | %'9d  (%7.4f%% : %7.4f%% : %8.4f%%) |\n";
-  char *header_separator = "+-------------------------------------------------------------------------------------------+\n";
-  printf("\n");
-  printf("Skiplist Statistics\n");
-  printf("===================\n");
-  printf("%s", header_separator);
-  printf(header_format, "", "", "Down", "Target", "[Node Statistics]");
-  printf(header_format, "Index", "In Order", "Pointers OK", "IDs Match", "Count      (Coverage :  Optimal :     Delta)");
-  printf("%s", header_separator);
   int count = 0, out_of_order = 0, downs_wrong = 0, downs = 0, non_zero_refs = 0, target_ids_wrong = 0, pending_sweeps = 0, compressed = 0, raw = 0;
   int total_skiplistnodes = 0;
   SkiplistNode *slnode = NULL, *sldown = NULL;
-  // Step 1:  For each level...
-  for(int i=0; i<list->levels; i++) {
-    count = 0;
-    out_of_order = 0;
-    downs_wrong = 0;
-    target_ids_wrong = 0;
-    slnode = list->indexes[i];
-    // Step 2:  For each slnode moving rightward...
-    while(slnode->right != NULL) {
-      downs = 0;
-      sldown = slnode;
-      total_skiplistnodes++;
-      if(slnode->buffer_id != slnode->target->id) {
-        target_ids_wrong++;
-        printf("slnode in index %d has buffer_id of %u but target->id is %u\n", i, slnode->buffer_id, slnode->target->id);
-      }
-      // Step 3:  For each slnode looking downward...
-      while(sldown->down != NULL) {
-        if(sldown->buffer_id == sldown->down->buffer_id)
-          downs++;
-        sldown = sldown->down;
-      }
-      if(downs != i)
-        downs_wrong++;
-      slnode = slnode->right;
-      count++;
-      if((slnode->right != NULL) && (slnode->buffer_id >= slnode->right->buffer_id))
-        out_of_order++;
-    }
-    printf(row_format, i, out_of_order == 0 ? "yes" : "no", downs_wrong == 0 ? "yes" : "no", target_ids_wrong == 0 ? "yes" : "no", count, 100 * (double)count/(list->raw_count + list->comp_count), 100.0 / pow(2,i+1), (100 * (double)count/(list->raw_count + list->comp_count)) - (100.0 / pow(2,i+1)));
-    if(out_of_order != 0) {
-      printf("Index was out of order displaying: ");
+  // Fat node lists don't use the skiplist at all; show their own index instead.
+  if(list->index_mode & INDEX_FAT_NODE) {
+    list__fat_show_structure(list);
+  } else {
+    // Skiplist Index information.
+    char *header_format    = "| %-5s | %-8s | %-11s | %-9s | %-44s |\n";
+    char *row_format       = "| %5d | %8s | %11s | %9s | %'9d  (%7.4f%% : %7.4f%% : %8.4f%%) |\n";
+    char *header_separator = "+-------------------------------------------------------------------------------------------+\n";
+    printf("\n");
+    printf("Skiplist Statistics\n");
+    printf("===================\n");
+    printf("%s", header_separator);
+    printf(header_format, "", "", "Down", "Target", "[Node Statistics]");
+    printf(header_format, "Index", "In Order", "Pointers OK", "IDs Match", "Count      (Coverage :  Optimal :     Delta)");
+    printf("%s", header_separator);
+    // Step 1:  For each level...
+    for(int i=0; i<list->levels; i++) {
+      count = 0;
+      out_of_order = 0;
+      downs_wrong = 0;
+      target_ids_wrong = 0;
       slnode = list->indexes[i];
+      // Step 2:  For each slnode moving rightward...
       while(slnode->right != NULL) {
+        downs = 0;
+        sldown = slnode;
+        total_skiplistnodes++;
+        if(slnode->buffer_id != slnode->target->id) {
+          target_ids_wrong++;
+          printf("slnode in index %d has buffer_id of %u but target->id is %u\n", i, slnode->buffer_id, slnode->target->id);
+        }
+        // Step 3:  For each slnode looking downward...
+        while(sldown->down != NULL) {
+          if(sldown->buffer_id == sldown->down->buffer_id)
+            downs++;
+          sldown = sldown->down;
+        }
+        if(downs != i)
+          downs_wrong++;
         slnode = slnode->right;
-        printf(" %"PRIu32, slnode->buffer_id);
+        count++;
+        if((slnode->right != NULL) && (slnode->buffer_id >= slnode->right->buffer_id))
+          out_of_order++;
+      }
+      printf(row_format, i, out_of_order == 0 ? "yes" : "no", downs_wrong == 0 ? "yes" : "no", target_ids_wrong == 0 ? "yes" : "no", count, 100 * (double)count/(list->raw_count + list->comp_count), 100.0 / pow(2,i+1), (100 * (double)count/(list->raw_count + list->comp_count)) - (100.0 / pow(2,i+1)));
+      if(out_of_order != 0) {
+        printf("Index was out of order displaying: ");
+        slnode = list->indexes[i];
+        while(slnode->right != NULL) {
+          slnode = slnode->right;
+          printf(" %"PRIu32, slnode->buffer_id);
+        }
+        printf("\n");
       }
-      printf("\n");
     }
+    printf("%s", header_separator);
+    printf("Indexes %02d - %02d are all 0 / 0.0%%\n", list->levels, SKIPLIST_MAX);
   }
-  printf("%s", header_separator);
-  printf("Indexes %02d - %02d are all 0 / 0.0%%\n", list->levels, SKIPLIST_MAX);
   out_of_order = 0;
   Buffer *nearest_neighbor = list->head;
   while(nearest_neighbor->next != list->head) {
@@ -1160,7 +2573,8 @@ void list__show_structure(List *list) {
     if(nearest_neighbor->comp_length != 0)
       compressed++;
   }
-  printf("Total number of SkiplistNodes   : %d (%7.4f%% coverage, optimal %8.4f%%, delta %.4f%%)\n", total_skiplistnodes, 100.0 * total_skiplistnodes / (list->raw_count + list->comp_count), 100.0, 100.0 * total_skiplistnodes / (list->raw_count + list->comp_count) - 100.0);
+  if((list->index_mode & INDEX_FAT_NODE) == 0)
+    printf("Total number of SkiplistNodes   : %d (%7.4f%% coverage, optimal %8.4f%%, delta %.4f%%)\n", total_skiplistnodes, 100.0 * total_skiplistnodes / (list->raw_count + list->comp_count), 100.0, 100.0 * total_skiplistnodes / (list->raw_count + list->comp_count) - 100.0);
   printf("\n");
   printf("Buffer Statistics\n");
   printf("===================\n");
@@ -1169,7 +2583,21 @@ void list__show_structure(List *list) {
   printf("Buffers pending sweeps          : %d (should be 0)\n", pending_sweeps);
   printf("Buffers raw (uncompressed)      : %'d\n", raw);
   printf("Buffers compressed              : %'d\n", compressed);
-  printf("Buffers evicted                 : %'"PRIu64"\n", list->evictions);
+  printf("Buffers evicted                 : %'"PRIu64" (%'"PRIu64" raw victims not worth compressing)\n", list->evictions, list->compression_skips);
+  printf("Raw ghosts                      : %'"PRIu64" bytes (%'"PRIu64" max), %'"PRIu64" hits of %'"PRIu64" demotions\n", list->raw_ghosts->bytes, list->raw_ghosts->max_bytes, list->raw_ghosts->hits, list->raw_ghosts->inserts);
+  printf("Compressed ghosts               : %'"PRIu64" bytes (%'"PRIu64" max), %'"PRIu64" hits of %'"PRIu64" evictions\n", list->comp_ghosts->bytes, list->comp_ghosts->max_bytes, list->comp_ghosts->hits, list->comp_ghosts->inserts);
+  if(list->admission != NULL)
+    printf("Admission filter                : %'"PRIu64" admitted, %'"PRIu64" rejected.  %'"PRIu64" bytes of sketch and doorkeeper, aged %'"PRIu64" times\n", list->admission->admitted, list->admission->rejected, list->admission->memory, list->admission->resets);
+  if(list->windows != NULL)
+    window__show(list->windows);
+  arena__show(list->arena);
+  if(list->spill != NULL)
+    spill__show(list->spill);
+  if(list->dictionaries != NULL)
+    dict__show(list->dictionaries);
+  list->policy->show_structure(list);
+  if(list->index_mode & INDEX_HASH)
+    list__hash_show_structure(list);
   printf("\n");
 }
 
@@ -1233,21 +2661,39 @@ void list__add_cow(List *list, Buffer *buf) {
     return;
   }
 
-  /* Looks like it has pins.  Try to prepend it to the list.  If the cow space is full, we wait. */
+  /* Looks like it has pins.  Prepend it to the list.  We get here from epoch callbacks, often inside the sweeper, and the pins are
+   * usually held by workers waiting on that very sweep.  So never wait for cow space; running over just wakes the cow killer. */
   pthread_mutex_lock(&list->cow_lock);
-  while((list->cow_current_size + buf->data_length) > list->cow_max_size) {
-    pthread_cond_broadcast(&list->cow_killer_cond);
-    pthread_cond_wait(&list->cow_waiter_cond, &list->cow_lock);
-  }
-  // Space should be free, add our buffer.
   buf->next = list->cow_head->next;
   list->cow_head->next = buf;
   list->cow_current_size += BUFFER_OVERHEAD + (buf->comp_length == 0 ? buf->data_length : buf->comp_length);
+  if(list->cow_current_size > list->cow_max_size)
+    pthread_cond_broadcast(&list->cow_killer_cond);
   pthread_mutex_unlock(&list->cow_lock);
   return;
 }
 
 
+/* list__reclaim_buffer
+ * Epoch callback for buffers that were removed or replaced.  In lock-free lists a tower node can be linked to a buffer just after
+ * its remover's find() went by, so a reader could reach the buffer after it was retired.  Making buffers wait out a second grace
+ * period closes that window.  After that, the slaughter house takes over so pinned buffers are respected like always.
+ */
+void list__reclaim_buffer(void *ptr, void *arg) {
+  Buffer *buf = (Buffer *)ptr;
+  List *list = (List *)arg;
+  if((buf->flags & retired) == 0) {
+    pthread_mutex_lock(&buf->lock);
+    __sync_fetch_and_or(&buf->flags, retired);
+    pthread_mutex_unlock(&buf->lock);
+    epoch__retire(list->epoch, buf, list__reclaim_buffer, list);
+    return;
+  }
+  list__add_cow(list, buf);
+  return;
+}
+
+
 /* list__slaughter_house
  * Kills cows... yep.
  * Ok, it purges the Copy-On-Write buffers that are no longer pinned.
@@ -1299,3 +2745,931 @@ void list__slaughter_house(List *list) {
 }
 
 
+/*
+ * +----------------------+
+ * | Lock-Free Index Mode |
+ * +----------------------+
+ * Everything below is used when a list is built with INDEX_LOCK_FREE.  Deletion is two-phase:  a Buffer is logically removed by
+ * marking its ->next pointer, then physically unlinked by whichever thread next walks past it (list__lock_free_find).  Index nodes
+ * work the same way with ->right.  Nothing unlinked is freed until the list's epoch domain says no reader can still see it.
+ * Caller MUST be inside an epoch critical section for all of these; list__add/remove/update/search take care of that.
+ */
+
+/* list__lock_free_is_dead
+ * A node is dead once its ->right is marked or the buffer it targets has been unlinked.
+ */
+bool list__lock_free_is_dead(SkiplistNode *slnode) {
+  if(LF_IS_MARKED(slnode->right))
+    return true;
+  Buffer *target = slnode->target;
+  if(!LF_IS_MARKED(target->next))
+    return false;
+  // Updates retarget every node before marking the old buffer; if the target moved under us the node is still alive.
+  __sync_synchronize();
+  return slnode->target == target;
+}
+
+
+/* list__lock_free_find
+ * Fills preds[] and succs[] with the nodes on either side of id at each index level, and pred_buf/curr_buf with the same for the
+ * buffer list, unlinking any dead nodes or buffers found along the way.  Returns E_OK when curr_buf is a live buffer matching id.
+ * Only the thread whose CAS unlinks an index node may retire it.  A predecessor is re-checked after reading ->down (or ->target) so
+ * we never descend into a tower that's already been taken apart.
+ */
+int list__lock_free_find(List *list, bufferid_t id, SkiplistNode **preds, SkiplistNode **succs, Buffer **pred_buf, Buffer **curr_buf) {
+  SkiplistNode *pred = NULL, *curr = NULL, *succ = NULL, *down = NULL;
+  Buffer *bpred = NULL, *bcurr = NULL, *bsucc = NULL;
+  const int TOP = list->levels < SKIPLIST_MAX ? list->levels : SKIPLIST_MAX - 1;
+
+  retry:
+  pred = list->indexes[TOP];
+  for(int i = TOP; i >= 0; i--) {
+    curr = LF_UNMARK(pred->right);
+    while(curr != NULL) {
+      if(list__lock_free_is_dead(curr)) {
+        // Mark it (if nobody has yet) so no one can link behind it, then try to unlink it.
+        succ = curr->right;
+        while(!LF_IS_MARKED(succ) && !__sync_bool_compare_and_swap(&curr->right, succ, LF_MARK(succ)))
+          succ = curr->right;
+        succ = LF_UNMARK(succ);
+        if(!__sync_bool_compare_and_swap(&pred->right, curr, succ))
+          goto retry;
+        epoch__retire(list->epoch, curr, NULL, NULL);
+        curr = succ;
+        continue;
+      }
+      if(curr->buffer_id >= id)
+        break;
+      pred = curr;
+      curr = LF_UNMARK(curr->right);
+    }
+    preds[i] = pred;
+    succs[i] = curr;
+    if(i > 0) {
+      down = pred->down;
+      if(list__lock_free_is_dead(pred))
+        goto retry;
+      pred = down;
+    }
+  }
+
+  // Now walk the buffers from the level 0 predecessor.  ->head is always max, so no need to check anything but ->id.
+  bpred = pred->target;
+  if(list__lock_free_is_dead(pred))
+    goto retry;
+  bcurr = LF_UNMARK(bpred->next);
+  while(1) {
+    bsucc = bcurr->next;
+    if(LF_IS_MARKED(bsucc)) {
+      if(!__sync_bool_compare_and_swap(&bpred->next, bcurr, LF_UNMARK(bsucc)))
+        goto retry;
+      bcurr = LF_UNMARK(bsucc);
+      continue;
+    }
+    if(bcurr->id >= id)
+      break;
+    bpred = bcurr;
+    bcurr = bsucc;
+  }
+  *pred_buf = bpred;
+  *curr_buf = bcurr;
+  return (bcurr->id == id && bcurr != list->head) ? E_OK : E_BUFFER_NOT_FOUND;
+}
+
+
+/* list__lock_free_add
+ * Links buf into the buffer list with a single CAS, then builds its tower of index nodes bottom-up.  If buf gets removed while
+ * we're still building we stop and let find() clean up anything we already linked.
+ */
+int list__lock_free_add(List *list, Buffer *buf, int levels) {
+  SkiplistNode *preds[SKIPLIST_MAX], *succs[SKIPLIST_MAX];
+  SkiplistNode *slnode = NULL, *below = NULL;
+  Buffer *bpred = NULL, *bcurr = NULL;
+  int rv = E_OK;
+
+  // Link the buffer itself.  This is the linearization point; once it works the buffer is in the list.
+  while(1) {
+    if(list__lock_free_find(list, buf->id, preds, succs, &bpred, &bcurr) == E_OK)
+      return E_BUFFER_ALREADY_EXISTS;
+    buf->next = bcurr;
+    if(__sync_bool_compare_and_swap(&bpred->next, bcurr, buf))
+      break;
+  }
+
+  // Build the tower.  Each node points down at the one we linked before it.
+  for(int i = 0; i < levels && rv == E_OK; i++) {
+    rv = list__initialize_skiplistnode(&slnode, buf);
+    if(rv != E_OK)
+      break;
+    slnode->down = below;
+    while(1) {
+      if(LF_IS_MARKED(buf->next)) {
+        free(slnode);
+        rv = E_BUFFER_NOT_FOUND;
+        break;
+      }
+      slnode->right = succs[i];
+      if(__sync_bool_compare_and_swap(&preds[i]->right, succs[i], slnode))
+        break;
+      // Someone changed this level.  Refresh the breadcrumbs; if buf is no longer there, it was removed out from under us.
+      if(list__lock_free_find(list, buf->id, preds, succs, &bpred, &bcurr) != E_OK || bcurr != buf) {
+        free(slnode);
+        rv = E_BUFFER_NOT_FOUND;
+        break;
+      }
+    }
+    below = slnode;
+  }
+  if(rv == E_OK && levels == list->levels)
+    __sync_bool_compare_and_swap(&list->levels, levels, levels + 1);
+
+  // If we lost a race with a remover, sweep up any index nodes we linked after it went through.
+  if(LF_IS_MARKED(buf->next))
+    list__lock_free_find(list, buf->id, preds, succs, &bpred, &bcurr);
+
+  // Failing to build the whole tower only costs search speed; the buffer was still added.
+  return E_OK;
+}
+
+
+/* list__lock_free_remove
+ * Marks buf as deleted and then unlinks it (and its index nodes) via find().  Caller is responsible for retiring buf afterward.
+ */
+int list__lock_free_remove(List *list, Buffer *buf) {
+  SkiplistNode *preds[SKIPLIST_MAX], *succs[SKIPLIST_MAX];
+  Buffer *bpred = NULL, *bcurr = NULL, *succ = NULL;
+
+  // The dirty flag guarantees we're the only remover/updater, but a racing add can still move ->next.
+  do {
+    succ = buf->next;
+    if(LF_IS_MARKED(succ))
+      break;
+  } while(!__sync_bool_compare_and_swap(&buf->next, succ, LF_MARK(succ)));
+  list__lock_free_find(list, buf->id, preds, succs, &bpred, &bcurr);
+  return E_OK;
+}
+
+
+/* list__lock_free_update
+ * Replaces buf with new_buffer.  Index nodes are retargeted first, then buf->next is swapped to a marked pointer to new_buffer in
+ * one CAS, so any reader who lands on buf just walks onto its replacement.  Caller is responsible for retiring buf afterward.
+ */
+int list__lock_free_update(List *list, Buffer *buf, Buffer *new_buffer) {
+  SkiplistNode *preds[SKIPLIST_MAX], *succs[SKIPLIST_MAX];
+  Buffer *bpred = NULL, *bcurr = NULL, *succ = NULL;
+
+  // Point the tower at the new buffer.  See list__lock_free_is_dead() for why this has to happen before the mark.
+  for(int i = 0; i < SKIPLIST_MAX; i++)
+    succs[i] = NULL;
+  list__lock_free_find(list, buf->id, preds, succs, &bpred, &bcurr);
+  for(int i = 0; i < SKIPLIST_MAX; i++)
+    if(succs[i] != NULL && succs[i]->target == buf)
+      __sync_bool_compare_and_swap(&succs[i]->target, buf, new_buffer);
+
+  // Splice new_buffer in behind buf and mark buf in the same CAS.
+  do {
+    succ = buf->next;
+    new_buffer->next = succ;
+  } while(!__sync_bool_compare_and_swap(&buf->next, succ, LF_MARK(new_buffer)));
+  list__lock_free_find(list, buf->id, preds, succs, &bpred, &bcurr);
+  return E_OK;
+}
+
+
+/* list__lock_free_search
+ * Read-only version of find().  Dead nodes are walked over rather than unlinked (their ->right is still good while we're in the
+ * epoch), so the hot loop looks just like the locking search.  Only the node we descend from has to be alive; if it isn't, let
+ * find() clean up and start over.  Pins the buffer when found.
+ */
+int list__lock_free_search(List *list, Buffer **buf, bufferid_t id) {
+  SkiplistNode *preds[SKIPLIST_MAX], *succs[SKIPLIST_MAX];
+  SkiplistNode *slnode = NULL, *curr = NULL, *down = NULL;
+  Buffer *nearest_neighbor = NULL, *bpred = NULL, *bcurr = NULL;
+  int rv = E_BUFFER_NOT_FOUND;
+  const int TOP = list->levels < SKIPLIST_MAX ? list->levels : SKIPLIST_MAX - 1;
+
+  restart:
+  slnode = list->indexes[TOP];
+  while(1) {
+    // Move right until we can't go farther.  Try to let the system know to prefetch this, as this is the hottest spot in the code.
+    curr = LF_UNMARK(slnode->right);
+    while(curr != NULL && curr->buffer_id <= id) {
+      slnode = curr;
+      curr = LF_UNMARK(curr->right);
+      __builtin_prefetch(curr, 0, 1);
+    }
+    // If the node matches and its buffer is live we're done.
+    if(slnode->buffer_id == id) {
+      nearest_neighbor = slnode->target;
+      if(!LF_IS_MARKED(nearest_neighbor->next)) {
+        *buf = nearest_neighbor;
+        __sync_fetch_and_add(&(*buf)->ref_count, 1);
+        rv = E_OK;
+        break;
+      }
+    }
+    down = slnode->down;
+    nearest_neighbor = slnode->target;
+    if(list__lock_free_is_dead(slnode)) {
+      list__lock_free_find(list, id, preds, succs, &bpred, &bcurr);
+      goto restart;
+    }
+    if(down == NULL)
+      break;
+    slnode = down;
+  }
+
+  // Scan the buffers.  Marked buffers with our ID are being replaced or removed; their ->next leads to the replacement if there is one.
+  if(rv == E_BUFFER_NOT_FOUND) {
+    nearest_neighbor = LF_UNMARK(nearest_neighbor->next);
+    while(nearest_neighbor->id < id || (nearest_neighbor->id == id && LF_IS_MARKED(nearest_neighbor->next)))
+      nearest_neighbor = LF_UNMARK(nearest_neighbor->next);
+    if(nearest_neighbor->id == id) {
+      *buf = nearest_neighbor;
+      __sync_fetch_and_add(&(*buf)->ref_count, 1);
+      rv = E_OK;
+    }
+  }
+
+  return rv;
+}
+
+
+/* list__lock_free_locate
+ * Returns the first live buffer with an ID of id or greater (->head if there isn't one).
+ */
+Buffer* list__lock_free_locate(List *list, bufferid_t id) {
+  SkiplistNode *preds[SKIPLIST_MAX], *succs[SKIPLIST_MAX];
+  Buffer *bpred = NULL, *bcurr = NULL;
+  list__lock_free_find(list, id, preds, succs, &bpred, &bcurr);
+  return bcurr;
+}
+
+
+/*
+ * +---------------------+
+ * | Fat Node Index Mode |
+ * +---------------------+
+ * Everything below is used when a list is built with INDEX_FAT_NODE.  The index is a B-skiplist:  each level is a linked list of
+ * FatNodes holding up to FAT_NODE_KEYS sorted keys, and every node except the leftmost starts with a key that also sits one level
+ * up.  Level 0 holds every buffer, so a search touches one node per level and never walks the buffer chain.  The leftmost node of
+ * every upper level starts with a 0 key pointing at the leftmost node below; it's a sentinel and is never removed or re-keyed.
+ * Writers are serialized by ->fat_lock.  Readers take no locks at all:  they note ->fat_sequence, search, and start over if a writer
+ * moved keys in the meantime.  Nodes a writer drops go through the list's epoch so a reader can't land on freed memory.  Full nodes
+ * split; nodes never merge and are only dropped once they're empty.
+ */
+
+/* list__fat_initialize
+ * Builds an empty fat node index:  a single, empty leaf.
+ */
+int list__fat_initialize(List *list) {
+  int rv = list__fat_initialize_node(&list->fat_root, 0);
+  if(rv != E_OK)
+    return rv;
+  list->fat_levels = 1;
+  return E_OK;
+}
+
+
+/* list__fat_initialize_node
+ * Builds an empty, cache-line aligned fat node for the given level.
+ */
+int list__fat_initialize_node(FatNode **node, uint8_t level) {
+  if(posix_memalign((void **)node, FAT_CACHE_LINE, sizeof(FatNode)) != 0)
+    return E_NO_MEMORY;
+  for(int i=0; i<FAT_NODE_KEYS; i++) {
+    (*node)->keys[i] = BUFFER_ID_MAX;
+    (*node)->slots[i].down = NULL;
+  }
+  (*node)->left = NULL;
+  (*node)->right = NULL;
+  (*node)->count = 0;
+  (*node)->level = level;
+  return E_OK;
+}
+
+
+/* list__fat_destroy
+ * Frees every node in the fat node index.  Caller MUST ensure no readers remain.
+ */
+void list__fat_destroy(List *list) {
+  FatNode *leftmost = list->fat_root, *below = NULL, *node = NULL, *next = NULL;
+  while(leftmost != NULL) {
+    below = leftmost->level > 0 ? leftmost->slots[0].down : NULL;
+    for(node = leftmost; node != NULL; node = next) {
+      next = node->right;
+      free(node);
+    }
+    leftmost = below;
+  }
+  list->fat_root = NULL;
+  list->fat_levels = 0;
+  return;
+}
+
+
+/* list__fat_rank
+ * Returns how many keys in the node are less than id.  The keys are a single cache line, so compare all of them at once with AVX2
+ * or SSE2 when the compiler allows it (-march=native will pick up AVX2).  SSE2/AVX2 only compare signed integers, so both sides are
+ * biased by INT32_MIN to get an unsigned compare.  Unused slots hold BUFFER_ID_MAX and never count.
+ */
+int list__fat_rank(const FatNode *node, bufferid_t id) {
+#if defined(__AVX2__)
+  const __m256i BIAS = _mm256_set1_epi32(INT32_MIN);
+  const __m256i ID = _mm256_xor_si256(_mm256_set1_epi32((int32_t)id), BIAS);
+  const __m256i LOW = _mm256_xor_si256(_mm256_load_si256((const __m256i *)&node->keys[0]), BIAS);
+  const __m256i HIGH = _mm256_xor_si256(_mm256_load_si256((const __m256i *)&node->keys[8]), BIAS);
+  return __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(ID, LOW)))) +
+         __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(ID, HIGH))));
+#elif defined(__SSE2__)
+  const __m128i BIAS = _mm_set1_epi32(INT32_MIN);
+  const __m128i ID = _mm_xor_si128(_mm_set1_epi32((int32_t)id), BIAS);
+  int rank = 0;
+  for(int i=0; i<FAT_NODE_KEYS; i+=4)
+    rank += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(ID, _mm_xor_si128(_mm_load_si128((const __m128i *)&node->keys[i]), BIAS)))));
+  return rank;
+#else
+  int rank = 0;
+  for(int i=0; i<FAT_NODE_KEYS; i++)
+    rank += node->keys[i] < id;
+  return rank;
+#endif
+}
+
+
+/* list__fat_descend
+ * Walks down to the leaf where id belongs, filling path[] with the node used at each level and ranks[] with the slot followed (for
+ * the leaf, the slot id is or would be in).  Caller MUST hold ->fat_lock and id MUST NOT be BUFFER_ID_MAX.
+ */
+FatNode* list__fat_descend(List *list, bufferid_t id, FatNode **path, int *ranks) {
+  FatNode *node = list->fat_root;
+  for(int level = list->fat_levels - 1; level > 0; level--) {
+    // Follow the last key <= id.  Every node we land on starts with a key <= id (or is leftmost and has the sentinel), so it exists.
+    path[level] = node;
+    ranks[level] = list__fat_rank(node, id + 1) - 1;
+    node = node->slots[ranks[level]].down;
+  }
+  path[0] = node;
+  ranks[0] = list__fat_rank(node, id);
+  return node;
+}
+
+
+/* list__fat_predecessor
+ * Finds the buffer just before slot rank of a leaf, which is where the buffer chain has to be spliced.  Only the leftmost leaf can
+ * be empty, so at most one hop left is needed before falling back to the list head.  Caller MUST hold ->fat_lock, or validate the
+ * result against ->fat_sequence like list__scan_seek() does.
+ */
+Buffer* list__fat_predecessor(List *list, FatNode *leaf, int rank) {
+  if(rank > 0)
+    return leaf->slots[rank - 1].target;
+  for(leaf = leaf->left; leaf != NULL; leaf = leaf->left)
+    if(leaf->count > 0)
+      return leaf->slots[leaf->count - 1].target;
+  return list->head;
+}
+
+
+/* list__fat_insert_entry
+ * Inserts key (pointing at a node below or, at level 0, a buffer) into path[level].  A full node is split first and its new right
+ * half is inserted one level up, growing a new root if needed.  Caller MUST hold ->fat_lock and have bumped ->fat_sequence.
+ */
+int list__fat_insert_entry(List *list, FatNode **path, int level, bufferid_t key, void *pointer) {
+  int rv = E_OK;
+  FatNode *node = path[level], *sibling = NULL, *root = NULL;
+  int position = list__fat_rank(node, key);
+
+  if(node->count == FAT_NODE_KEYS) {
+    // Split in half, unless we're appending to the end (sequential IDs); then only move the last key so nodes stay nearly full.
+    const int SPLIT = position == FAT_NODE_KEYS ? FAT_NODE_KEYS - 1 : FAT_NODE_KEYS / 2;
+    if(level + 1 >= FAT_NODE_MAX_LEVELS)
+      return E_NO_MEMORY;
+    rv = list__fat_initialize_node(&sibling, node->level);
+    if(rv != E_OK)
+      return rv;
+    for(int i=SPLIT; i<FAT_NODE_KEYS; i++) {
+      sibling->keys[i - SPLIT] = node->keys[i];
+      sibling->slots[i - SPLIT] = node->slots[i];
+      node->keys[i] = BUFFER_ID_MAX;
+      node->slots[i].down = NULL;
+    }
+    sibling->count = FAT_NODE_KEYS - SPLIT;
+    node->count = SPLIT;
+    sibling->left = node;
+    sibling->right = node->right;
+    if(node->right != NULL)
+      node->right->left = sibling;
+    node->right = sibling;
+    // If we just split the root, start a new one above it with the sentinel pointing back down at the old root.
+    if(level == list->fat_levels - 1) {
+      rv = list__fat_initialize_node(&root, level + 1);
+      if(rv != E_OK)
+        return rv;
+      root->keys[0] = 0;
+      root->slots[0].down = node;
+      root->count = 1;
+      path[level + 1] = root;
+      list->fat_root = root;
+      list->fat_levels++;
+    }
+    rv = list__fat_insert_entry(list, path, level + 1, sibling->keys[0], sibling);
+    if(rv != E_OK)
+      return rv;
+    // The new key never lands in the first slot of the sibling, so the key we just pushed up stays correct.
+    if(position > SPLIT) {
+      node = sibling;
+      position -= SPLIT;
+    }
+  }
+
+  // Shift everything from position over by one and drop the new entry in.
+  for(int i=node->count; i>position; i--) {
+    node->keys[i] = node->keys[i - 1];
+    node->slots[i] = node->slots[i - 1];
+  }
+  node->keys[position] = key;
+  node->slots[position].down = pointer;
+  node->count++;
+  return E_OK;
+}
+
+
+/* list__fat_remove_entry
+ * Removes slot ranks[level] from path[level].  An emptied node is unlinked and its own entry removed from the level above; a node
+ * that lost its first key has its key above (and further up, for as long as it was a first key there too) replaced.  Caller MUST
+ * hold ->fat_lock and have bumped ->fat_sequence.
+ */
+void list__fat_remove_entry(List *list, FatNode **path, int *ranks, int level) {
+  FatNode *node = path[level];
+  const int POSITION = ranks[level];
+  for(int i=POSITION; i<node->count - 1; i++) {
+    node->keys[i] = node->keys[i + 1];
+    node->slots[i] = node->slots[i + 1];
+  }
+  node->count--;
+  node->keys[node->count] = BUFFER_ID_MAX;
+  node->slots[node->count].down = NULL;
+
+  // The leftmost node is what the sentinel above points at, so it's never dropped and has no key above to fix.
+  if(node->left == NULL)
+    return;
+  if(node->count == 0) {
+    node->left->right = node->right;
+    if(node->right != NULL)
+      node->right->left = node->left;
+    epoch__retire(list->epoch, node, NULL, NULL);
+    list__fat_remove_entry(list, path, ranks, level + 1);
+    return;
+  }
+  if(POSITION == 0) {
+    for(int i=level + 1; i<list->fat_levels; i++) {
+      path[i]->keys[ranks[i]] = node->keys[0];
+      if(ranks[i] != 0)
+        break;
+    }
+  }
+  return;
+}
+
+
+/* list__fat_add
+ * Links buf into the buffer chain and the fat node index.  Caller MUST hold ->fat_lock.
+ */
+int list__fat_add(List *list, Buffer *buf) {
+  FatNode *path[FAT_NODE_MAX_LEVELS];
+  int ranks[FAT_NODE_MAX_LEVELS];
+  int rv = E_OK;
+  FatNode *leaf = list__fat_descend(list, buf->id, path, ranks);
+  if(ranks[0] < leaf->count && leaf->keys[ranks[0]] == buf->id)
+    return E_BUFFER_ALREADY_EXISTS;
+
+  // Splice the chain first; it doesn't care about the sequence lock.  Then reshape the index while readers know to retry.
+  Buffer *nearest_neighbor = list__fat_predecessor(list, leaf, ranks[0]);
+  buf->next = nearest_neighbor->next;
+  __sync_synchronize();
+  nearest_neighbor->next = buf;
+  __sync_fetch_and_add(&list->fat_sequence, 1);
+  rv = list__fat_insert_entry(list, path, 0, buf->id, buf);
+  __sync_fetch_and_add(&list->fat_sequence, 1);
+  return rv;
+}
+
+
+/* list__fat_remove
+ * Unlinks buf from the buffer chain and the fat node index, then drops any levels that are down to just their sentinel.  Caller MUST
+ * hold ->fat_lock.
+ */
+int list__fat_remove(List *list, Buffer *buf) {
+  FatNode *path[FAT_NODE_MAX_LEVELS];
+  int ranks[FAT_NODE_MAX_LEVELS];
+  FatNode *leaf = list__fat_descend(list, buf->id, path, ranks), *old_root = NULL;
+  if(ranks[0] >= leaf->count || leaf->slots[ranks[0]].target != buf)
+    return E_BUFFER_NOT_FOUND;
+
+  Buffer *nearest_neighbor = list__fat_predecessor(list, leaf, ranks[0]);
+  nearest_neighbor->next = buf->next;
+  __sync_fetch_and_add(&list->fat_sequence, 1);
+  list__fat_remove_entry(list, path, ranks, 0);
+  while(list->fat_levels > 1 && list->fat_root->count == 1) {
+    old_root = list->fat_root;
+    list->fat_root = old_root->slots[0].down;
+    list->fat_levels--;
+    epoch__retire(list->epoch, old_root, NULL, NULL);
+  }
+  __sync_fetch_and_add(&list->fat_sequence, 1);
+  return E_OK;
+}
+
+
+/* list__fat_update
+ * Swaps new_buffer in for buf in the buffer chain and the leaf.  Only a pointer changes, so readers don't need to retry; they get
+ * either buffer, just like the locking index.  Caller MUST hold ->fat_lock.
+ */
+int list__fat_update(List *list, Buffer *buf, Buffer *new_buffer) {
+  FatNode *path[FAT_NODE_MAX_LEVELS];
+  int ranks[FAT_NODE_MAX_LEVELS];
+  FatNode *leaf = list__fat_descend(list, buf->id, path, ranks);
+  if(ranks[0] >= leaf->count || leaf->slots[ranks[0]].target != buf)
+    return E_BUFFER_NOT_FOUND;
+
+  Buffer *nearest_neighbor = list__fat_predecessor(list, leaf, ranks[0]);
+  new_buffer->next = buf->next;
+  __sync_synchronize();
+  nearest_neighbor->next = new_buffer;
+  leaf->slots[ranks[0]].target = new_buffer;
+  return E_OK;
+}
+
+
+/* list__fat_search
+ * Lock-free read of the fat node index.  Pins the buffer when found.  If a writer reshaped nodes while we were looking, whatever we
+ * found can't be trusted:  drop the pin and start over.  Caller MUST be inside an epoch critical section.
+ */
+int list__fat_search(List *list, Buffer **buf, bufferid_t id) {
+  FatNode *node = NULL;
+  Buffer *target = NULL;
+  uint32_t sequence = 0;
+  int rank = 0;
+  if(id == BUFFER_ID_MAX)
+    return E_BUFFER_NOT_FOUND;
+
+  for(;;) {
+    // Wait for any writer in the middle of moving keys to finish.
+    while((sequence = list->fat_sequence) & 1)
+      __sync_synchronize();
+    __sync_synchronize();
+    node = list->fat_root;
+    while(node->level > 0) {
+      rank = list__fat_rank(node, id + 1) - 1;
+      node = node->slots[rank < 0 ? 0 : rank].down;
+      // A torn read can only happen if a writer is active, which the sequence check below will catch.
+      if(node == NULL)
+        break;
+    }
+    target = NULL;
+    if(node != NULL) {
+      rank = list__fat_rank(node, id);
+      if(rank < FAT_NODE_KEYS && node->keys[rank] == id)
+        target = node->slots[rank].target;
+    }
+    // Pin before validating so the buffer can't be reused out from under us after the check passes.
+    if(target != NULL)
+      __sync_fetch_and_add(&target->ref_count, 1);
+    __sync_synchronize();
+    if(list->fat_sequence == sequence)
+      break;
+    if(target != NULL)
+      __sync_fetch_and_add(&target->ref_count, -1);
+    __sync_fetch_and_add(&list->fat_retries, 1);
+  }
+
+  if(target == NULL) {
+    __sync_fetch_and_add(&list->fat_misses, 1);
+    return E_BUFFER_NOT_FOUND;
+  }
+  *buf = target;
+  return E_OK;
+}
+
+
+/* list__fat_show_structure
+ * The fat node counterpart to the skiplist statistics in list__show_structure():  node counts and fill per level, a sanity check
+ * of ordering and linking, and what lookups cost.
+ */
+void list__fat_show_structure(List *list) {
+  char *header_format    = "| %-5s | %-9s | %-11s | %-8s | %-8s | %-10s |\n";
+  char *row_format       = "| %5d | %'9d | %'11d | %7.2f%% | %-8s | %-10s |\n";
+  char *header_separator = "+-------------------------------------------------------------------+\n";
+  const uint32_t BUFFER_COUNT = list->raw_count + list->comp_count;
+  FatNode *leftmost = list->fat_root, *node = NULL;
+  int nodes = 0, keys = 0, total_nodes = 0, out_of_order = 0, links_wrong = 0;
+  bufferid_t last_key = 0;
+
+  printf("\n");
+  printf("Fat Node Index Statistics\n");
+  printf("=========================\n");
+  printf("%s", header_separator);
+  printf(header_format, "Level", "Nodes", "Keys", "Fill", "In Order", "Links OK");
+  printf("%s", header_separator);
+  while(leftmost != NULL) {
+    nodes = 0;
+    keys = 0;
+    out_of_order = 0;
+    links_wrong = 0;
+    last_key = 0;
+    for(node = leftmost; node != NULL; node = node->right) {
+      nodes++;
+      keys += node->count;
+      for(int i=0; i<node->count; i++) {
+        if((nodes > 1 || i > 0) && node->keys[i] <= last_key)
+          out_of_order++;
+        last_key = node->keys[i];
+        // Every key has to point at something with the same ID:  the buffer itself or the node below that starts with it.
+        if(node->level == 0 && node->slots[i].target->id != node->keys[i])
+          links_wrong++;
+        if(node->level > 0 && (nodes > 1 || i > 0) && node->slots[i].down->keys[0] != node->keys[i])
+          links_wrong++;
+      }
+      if(node->right != NULL && node->right->left != node)
+        links_wrong++;
+    }
+    printf(row_format, leftmost->level, nodes, keys, 100.0 * keys / (nodes * FAT_NODE_KEYS), out_of_order == 0 ? "yes" : "no", links_wrong == 0 ? "yes" : "no");
+    total_nodes += nodes;
+    leftmost = leftmost->level > 0 ? leftmost->slots[0].down : NULL;
+  }
+  printf("%s", header_separator);
+  printf("Total number of FatNodes        : %'d (%'zu bytes each, %'zu bytes total)\n", total_nodes, sizeof(FatNode), total_nodes * sizeof(FatNode));
+  // A lookup reads the key line and one line of slots per level.  A skiplist lookup misses on roughly every node it visits.
+  printf("Cache lines per lookup          : %d (a skiplist of %'"PRIu32" buffers visits ~%.1f nodes)\n", 2 * list->fat_levels, BUFFER_COUNT, BUFFER_COUNT > 1 ? 2 * log2(BUFFER_COUNT) : 1.0);
+  printf("Lookup misses (ID not found)    : %'"PRIu64"\n", list->fat_misses);
+  printf("Lookup retries (writer raced)   : %'"PRIu64"\n", list->fat_retries);
+  return;
+}
+
+
+/*
+ * +-----------------+
+ * | Hash Index Mode |
+ * +-----------------+
+ * Everything below is used when a list is built with INDEX_HASH.  The ordered index (and the buffer chain it maintains) is still
+ * there for adds, removes, the clock hand, and ordered walks; the hash table just turns list__search() into an O(1) probe.  Writers
+ * are serialized by ->hash_lock.  Readers take no locks:  a slot's target is always written before its ID (and read after it), and
+ * a table that gets rebuilt is retired through the list's epoch so readers still probing it are safe.
+ */
+
+/* list__hash_initialize
+ * Builds an empty hash index for the list.
+ */
+int list__hash_initialize(List *list) {
+  return list__hash_initialize_table(&list->hash_table, HASH_INITIAL_BITS);
+}
+
+
+/* list__hash_initialize_table
+ * Builds a table of 2^bits empty slots.
+ */
+int list__hash_initialize_table(HashTable **table, uint8_t bits) {
+  *table = (HashTable *)malloc(sizeof(HashTable));
+  if(*table == NULL)
+    return E_NO_MEMORY;
+  (*table)->bits = bits;
+  (*table)->mask = ((uint64_t)1 << bits) - 1;
+  (*table)->live = 0;
+  (*table)->used = 0;
+  (*table)->reserved = 0;
+  (*table)->slots = (HashSlot *)malloc(sizeof(HashSlot) << bits);
+  if((*table)->slots == NULL) {
+    free(*table);
+    return E_NO_MEMORY;
+  }
+  for(uint64_t i=0; i<=(*table)->mask; i++) {
+    (*table)->slots[i].id = BUFFER_ID_MAX;
+    (*table)->slots[i].target = NULL;
+  }
+  return E_OK;
+}
+
+
+/* list__hash_destroy
+ * Frees the hash index.  Caller MUST ensure no readers remain.
+ */
+void list__hash_destroy(List *list) {
+  if(list->hash_table != NULL)
+    list__hash_reclaim_table(list->hash_table, NULL);
+  list->hash_table = NULL;
+  return;
+}
+
+
+/* list__hash_reclaim_table
+ * Epoch callback (and destroy helper) to free a table and its slots.
+ */
+void list__hash_reclaim_table(void *ptr, void *arg) {
+  (void)arg;
+  HashTable *table = (HashTable *)ptr;
+  free(table->slots);
+  free(table);
+  return;
+}
+
+
+/* list__hash_home
+ * Returns the slot an ID would like to live in.  Fibonacci hashing spreads sequential IDs across the whole table.
+ */
+uint64_t list__hash_home(HashTable *table, bufferid_t id) {
+  return (uint32_t)(id * 2654435761u) >> (32 - table->bits);
+}
+
+
+/* list__hash_rebuild
+ * Copies every live entry into a new table of 2^bits slots, which also drops all tombstones, then swaps it in and retires the old
+ * one.  Caller MUST hold ->hash_lock.
+ */
+int list__hash_rebuild(List *list, uint8_t bits) {
+  HashTable *old_table = list->hash_table, *new_table = NULL;
+  int rv = list__hash_initialize_table(&new_table, bits);
+  if(rv != E_OK)
+    return rv;
+  uint64_t slot = 0;
+  for(uint64_t i=0; i<=old_table->mask; i++) {
+    if(old_table->slots[i].id == BUFFER_ID_MAX)
+      continue;
+    for(slot = list__hash_home(new_table, old_table->slots[i].id); new_table->slots[slot].id != BUFFER_ID_MAX; slot = (slot + 1) & new_table->mask);
+    new_table->slots[slot] = old_table->slots[i];
+    new_table->live++;
+  }
+  new_table->used = new_table->live;
+  new_table->reserved = old_table->reserved;
+  __atomic_store_n(&list->hash_table, new_table, __ATOMIC_RELEASE);
+  list->hash_rebuilds++;
+  epoch__retire(list->epoch, old_table, list__hash_reclaim_table, NULL);
+  return E_OK;
+}
+
+
+/* list__hash_reserve
+ * Makes sure the table will have room for id once list__add() has linked it, growing it first if it's getting crowded (or just
+ * rebuilding it if tombstones are the problem).  Done before linking so a full or failing table never strands a linked buffer.
+ * Returns E_BUFFER_ALREADY_EXISTS if id is already indexed.  Every E_OK MUST be followed by list__hash_insert() or _release().
+ */
+int list__hash_reserve(List *list, bufferid_t id) {
+  int rv = E_OK;
+  pthread_mutex_lock(&list->hash_lock);
+  HashTable *table = list->hash_table;
+  if((table->used + table->reserved + 1) * 100 > (table->mask + 1) * HASH_MAX_LOAD) {
+    const uint64_t WANTED = table->live + table->reserved + 1;
+    rv = list__hash_rebuild(list, WANTED * 100 > (table->mask + 1) * HASH_MAX_LOAD / 2 ? table->bits + 1 : table->bits);
+    if(rv != E_OK) {
+      pthread_mutex_unlock(&list->hash_lock);
+      return rv;
+    }
+    table = list->hash_table;
+  }
+  for(uint64_t slot = list__hash_home(table, id); table->slots[slot].target != NULL; slot = (slot + 1) & table->mask) {
+    if(table->slots[slot].id == id) {
+      pthread_mutex_unlock(&list->hash_lock);
+      return E_BUFFER_ALREADY_EXISTS;
+    }
+  }
+  table->reserved++;
+  pthread_mutex_unlock(&list->hash_lock);
+  return E_OK;
+}
+
+
+/* list__hash_release
+ * Gives back a reservation from list__hash_reserve() when the ordered index turned the buffer away.
+ */
+void list__hash_release(List *list) {
+  pthread_mutex_lock(&list->hash_lock);
+  list->hash_table->reserved--;
+  pthread_mutex_unlock(&list->hash_lock);
+}
+
+
+/* list__hash_insert
+ * Adds buf to the hash index using the room list__hash_reserve() set aside, so it can't fail once buf is linked.  If the ID is
+ * still here it belongs to a buffer another thread has unlinked but not yet dropped from the hash; buf takes the slot over rather
+ * than failing, and at worst that thread's list__hash_remove() turns later lookups of buf into misses.
+ */
+int list__hash_insert(List *list, Buffer *buf) {
+  pthread_mutex_lock(&list->hash_lock);
+  HashTable *table = list->hash_table;
+  table->reserved--;
+
+  // Take the first tombstone or empty slot, but keep probing to the first empty one to be sure the ID isn't already here.
+  uint64_t slot = list__hash_home(table, buf->id), free_slot = BUFFER_ID_MAX;
+  bool found_free = false;
+  for(;; slot = (slot + 1) & table->mask) {
+    if(table->slots[slot].id == buf->id) {
+      __atomic_store_n(&table->slots[slot].target, buf, __ATOMIC_RELEASE);
+      pthread_mutex_unlock(&list->hash_lock);
+      return E_OK;
+    }
+    if(table->slots[slot].id != BUFFER_ID_MAX)
+      continue;
+    if(!found_free) {
+      free_slot = slot;
+      found_free = true;
+    }
+    if(table->slots[slot].target == NULL)
+      break;
+  }
+  if(table->slots[free_slot].target == NULL)
+    table->used++;
+  table->live++;
+  // Target first, then ID.  A reader who sees the ID is guaranteed to see the target.
+  __atomic_store_n(&table->slots[free_slot].target, buf, __ATOMIC_RELEASE);
+  __atomic_store_n(&table->slots[free_slot].id, buf->id, __ATOMIC_RELEASE);
+  pthread_mutex_unlock(&list->hash_lock);
+  return E_OK;
+}
+
+
+/* list__hash_remove
+ * Turns buf's slot into a tombstone.  The stale target pointer stays behind so the slot doesn't look empty to probes.
+ */
+int list__hash_remove(List *list, Buffer *buf) {
+  int rv = E_BUFFER_NOT_FOUND;
+  pthread_mutex_lock(&list->hash_lock);
+  HashTable *table = list->hash_table;
+  for(uint64_t slot = list__hash_home(table, buf->id); table->slots[slot].target != NULL; slot = (slot + 1) & table->mask) {
+    if(table->slots[slot].id != buf->id)
+      continue;
+    __atomic_store_n(&table->slots[slot].id, BUFFER_ID_MAX, __ATOMIC_RELEASE);
+    table->live--;
+    rv = E_OK;
+    break;
+  }
+  pthread_mutex_unlock(&list->hash_lock);
+  return rv;
+}
+
+
+/* list__hash_update
+ * Points buf's slot at new_buffer.
+ */
+int list__hash_update(List *list, Buffer *buf, Buffer *new_buffer) {
+  int rv = E_BUFFER_NOT_FOUND;
+  pthread_mutex_lock(&list->hash_lock);
+  HashTable *table = list->hash_table;
+  for(uint64_t slot = list__hash_home(table, buf->id); table->slots[slot].target != NULL; slot = (slot + 1) & table->mask) {
+    if(table->slots[slot].id != buf->id)
+      continue;
+    __atomic_store_n(&table->slots[slot].target, new_buffer, __ATOMIC_RELEASE);
+    rv = E_OK;
+    break;
+  }
+  pthread_mutex_unlock(&list->hash_lock);
+  return rv;
+}
+
+
+/* list__hash_search
+ * Probes the hash index for id and pins the buffer when found.  Caller MUST be inside an epoch critical section.
+ */
+int list__hash_search(List *list, Buffer **buf, bufferid_t id) {
+  if(id == BUFFER_ID_MAX)
+    return E_BUFFER_NOT_FOUND;
+  HashTable *table = __atomic_load_n(&list->hash_table, __ATOMIC_ACQUIRE);
+  Buffer *target = NULL;
+  for(uint64_t slot = list__hash_home(table, id); ; slot = (slot + 1) & table->mask) {
+    if(__atomic_load_n(&table->slots[slot].id, __ATOMIC_ACQUIRE) == id) {
+      target = __atomic_load_n(&table->slots[slot].target, __ATOMIC_ACQUIRE);
+      __sync_fetch_and_add(&target->ref_count, 1);
+      *buf = target;
+      return E_OK;
+    }
+    if(__atomic_load_n(&table->slots[slot].target, __ATOMIC_ACQUIRE) == NULL)
+      return E_BUFFER_NOT_FOUND;
+  }
+}
+
+
+/* list__hash_show_structure
+ * Reports how full the hash index is and how long probes are.
+ */
+void list__hash_show_structure(List *list) {
+  HashTable *table = list->hash_table;
+  uint64_t distance = 0, total_distance = 0, max_distance = 0, tombstones = 0;
+  for(uint64_t i=0; i<=table->mask; i++) {
+    if(table->slots[i].id == BUFFER_ID_MAX) {
+      if(table->slots[i].target != NULL)
+        tombstones++;
+      continue;
+    }
+    distance = (i - list__hash_home(table, table->slots[i].id)) & table->mask;
+    total_distance += distance;
+    if(distance > max_distance)
+      max_distance = distance;
+  }
+  printf("\n");
+  printf("Hash Index Statistics\n");
+  printf("=====================\n");
+  printf("Slots                           : %'"PRIu64" (%'zu bytes each)\n", table->mask + 1, sizeof(HashSlot));
+  printf("Live entries                    : %'"PRIu64" (%5.2f%% load)\n", table->live, 100.0 * table->live / (table->mask + 1));
+  printf("Tombstones                      : %'"PRIu64"\n", tombstones);
+  printf("Average probe distance          : %.3f slots (max %'"PRIu64")\n", table->live > 0 ? 1.0 * total_distance / table->live : 0.0, max_distance);
+  printf("Rebuilds                        : %'"PRIu64"\n", list->hash_rebuilds);
+  return;
+}
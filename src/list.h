@@ -14,6 +14,20 @@
 #include <stdbool.h> /* For bool types. */
 #include <inttypes.h>
 #include "buffer.h"
+#include "admit.h"
+#include "arena.h"
+#include "dict.h"
+#include "epoch.h"
+#include "ghost.h"
+#include "spill.h"
+#include "window.h"
+
+
+/* Lock-free lists mark a Buffer (->next) or SkiplistNode (->right) as logically deleted by setting the low bit of its forward
+ * pointer.  Both structures are malloc()'d so the bit is always free. */
+#define LF_MARK(ptr)       ((__typeof__(ptr))((uintptr_t)(ptr) | 1))
+#define LF_UNMARK(ptr)     ((__typeof__(ptr))((uintptr_t)(ptr) & ~(uintptr_t)1))
+#define LF_IS_MARKED(ptr)  (((uintptr_t)(ptr) & 1) != 0)
 
 /* A list is simply the collection of buffers, metadata to describe the list for management, and control attributes to protect it.
  * Most people will call this a "pool"... shrugs.
@@ -33,6 +47,156 @@ struct skiplistnode {
 };
 
 
+/* Build the Fat Node (B-skiplist) Structures.  Each node packs a cache line of sorted keys so one miss compares 16 IDs at once.
+ * Every node except the leftmost one on a level starts with a key that also sits in the level above, pointing down to it. */
+#define FAT_NODE_KEYS 16       /* 16 x 4-byte bufferid_t == one 64 byte cache line.  The SIMD rank function assumes this. */
+#define FAT_NODE_MAX_LEVELS 32 /* Nodes can be as little as half full (less after removals), so leave plenty of headroom. */
+#define FAT_CACHE_LINE 64
+typedef struct fatnode FatNode;
+struct fatnode {
+  /* Keys first so they get their own cache line.  Unused slots hold BUFFER_ID_MAX so searches can compare the whole line. */
+  bufferid_t keys[FAT_NODE_KEYS] __attribute__((aligned(FAT_CACHE_LINE)));
+  union {
+    FatNode *down;       /* Level 1+:  The node one level down that starts with this key. */
+    Buffer *target;      /* Level 0:  The buffer itself. */
+  } slots[FAT_NODE_KEYS];
+
+  /* Directions for Traversal.  Only writers and statistics use these; searches only ever move down. */
+  FatNode *left;         /* NULL for the leftmost node of a level. */
+  FatNode *right;        /* NULL for the rightmost node of a level. */
+  uint8_t count;         /* Number of keys in use. */
+  uint8_t level;         /* 0 for leaves. */
+};
+
+
+/* Build the Hash Index Structures.  Open addressing with linear probing, keyed by buffer ID.  An empty slot is {BUFFER_ID_MAX, NULL}
+ * and a tombstone is {BUFFER_ID_MAX, non-NULL}, so no real ID (other than the head's) has to be reserved. */
+#define HASH_INITIAL_BITS 10   /* 1024 slots to start. */
+#define HASH_MAX_LOAD 70       /* Percent of slots (live + tombstones) in use before the table is rebuilt. */
+typedef struct hashslot HashSlot;
+struct hashslot {
+  bufferid_t id;         /* The buffer ID, or BUFFER_ID_MAX when the slot is empty or a tombstone. */
+  Buffer *target;        /* The buffer itself.  NULL only when the slot has never been used. */
+};
+typedef struct hashtable HashTable;
+struct hashtable {
+  uint8_t bits;          /* The table holds 2^bits slots. */
+  uint64_t mask;         /* (2^bits) - 1, for wrapping probes. */
+  uint64_t live;         /* Slots holding a buffer. */
+  uint64_t used;         /* Slots holding a buffer or a tombstone.  Probes only stop at empty slots, so this drives rebuilds. */
+  uint64_t reserved;     /* Slots promised to list__add() callers who are still linking their buffer into the ordered index. */
+  HashSlot *slots;       /* The slots themselves. */
+};
+
+
+/* State for one interleaved lookup in list__search_interleaved().  Each one walks the locking skiplist a single hop at a time. */
+#define LOOKUP_IDLE 0          /* Slot has nothing left to do. */
+#define LOOKUP_DESCEND 1       /* Moving right/down through the skiplist nodes. */
+#define LOOKUP_CHAIN 2         /* Scanning the buffer chain from the nearest neighbor. */
+#define LOOKUP_RUNNING 0       /* list__lookup_step() return: hop made, come back later. */
+#define LOOKUP_DONE 1          /* list__lookup_step() return: the lookup is over. */
+typedef struct lookupstate LookupState;
+struct lookupstate {
+  SkiplistNode *slnode;      /* Where the descent is now. */
+  Buffer *nearest_neighbor;  /* Where the chain scan is now. */
+  Buffer *target;            /* The pinned match, once found. */
+  bufferid_t id;             /* The ID being looked up. */
+  int pos;                   /* Position of the ID in the caller's arrays. */
+  uint8_t stage;             /* LOOKUP_IDLE, LOOKUP_DESCEND, or LOOKUP_CHAIN. */
+};
+
+
+/* Replacement policies.  The sweeper asks the list's policy for raw buffers to compress (TIER_RAW) and compressed buffers to evict
+ * (TIER_COMP) instead of walking a clock itself.  See policy.h for the policies and how tiers map onto them. */
+#define TIER_RAW   0
+#define TIER_COMP  1
+#define TIER_COUNT 2
+typedef struct replacementpolicy ReplacementPolicy;
+
+
+/* Ghost lists.  Each one remembers up to GHOST_RATIO percent of max memory worth of buffers that left a tier. */
+#define GHOST_RATIO          10      /* Capacity of each ghost list, as a percentage of the list's max memory. */
+#define GHOST_EXPECTED_SIZE  4096    /* Guess at an average buffer's data size, to size the ghost rings. */
+
+/* The raw/comp ratio controller.  The sweeper thread runs list__tune_ratio() every RATIO_INTERVAL_MS and hill-climbs the raw
+ * ratio toward whatever costs readers the least time:  decompressing restored buffers plus reloading evicted ones. */
+#define RATIO_INTERVAL_MS 250      /* How often the controller measures and decides. */
+#define RATIO_STEP 5               /* Percentage points the raw ratio moves per decision. */
+#define RATIO_MIN 10               /* The raw ratio never drops below this... */
+#define RATIO_MAX 95               /* ...or climbs above this. */
+#define RATIO_HYSTERESIS 10        /* Cost has to move by more than this percent to count as better or worse.  Otherwise hold. */
+#define RATIO_MISS_PENALTY 100000  /* ns charged per eviction until list__record_miss() has measured real page loads. */
+#define RATIO_LOG_SIZE 32          /* Most recent decisions kept for list__show_structure(). */
+
+/* Compress or drop.  Compressors run each raw victim through list__worth_compressing() before and after compressing it; the ones
+ * that aren't worth a place in the comp tier are evicted by the sweeper instead.  See TODO item 1c. */
+#define COMPRESS_MIN_SAVINGS 12    /* A compressed copy has to save this percent of the raw footprint (divided by expected restores). */
+typedef struct ratiodecision RatioDecision;
+struct ratiodecision {
+  uint64_t interval;     /* Which controller interval made the decision. */
+  uint64_t cost;         /* Stall cost measured over that interval, in ns per second. */
+  uint8_t from;          /* Raw ratio before. */
+  uint8_t to;            /* Raw ratio after. */
+};
+typedef struct ratiocontroller RatioController;
+struct ratiocontroller {
+  uint8_t adaptive;                     /* Non-zero when the sweeper should tune the ratio.  Off for fixed ratios (-f) and tests. */
+  uint8_t raw_ratio;                    /* Percent of memory currently given to raw buffers. */
+  int8_t step;                          /* Signed step for the next move.  Flips when a move makes things worse. */
+  uint64_t restore_cost;                /* ns spent decompressing in list__restore() (growth of Buffer->comp_cost). */
+  uint64_t miss_penalty;                /* Moving average of ns to load a page the list didn't have.  0 until measured. */
+  uint64_t miss_bytes;                  /* Moving average of the size of those pages, so a penalty can be scaled to a buffer's. */
+  uint64_t miss_ns_sum;                 /* ns of page loads reported since the sweeper last folded them into miss_penalty. */
+  uint64_t miss_bytes_sum;              /* Bytes of those pages. */
+  uint64_t misses;                      /* How many there were. */
+  uint64_t checked_at;                  /* CLOCK_MONOTONIC ns when the current interval started. */
+  uint64_t last_restore_cost;           /* restore_cost at the start of the current interval. */
+  uint64_t last_evictions;              /* List->evictions at the start of the current interval. */
+  uint64_t last_cost;                   /* Stall cost of the previous interval, in ns per second. */
+  uint64_t intervals;                   /* Intervals measured. */
+  uint64_t adjustments;                 /* Intervals that moved the ratio. */
+  RatioDecision log[RATIO_LOG_SIZE];    /* Ring of the most recent moves.  log[adjustments % RATIO_LOG_SIZE] is next. */
+};
+
+
+#define MAX_COMP_VICTIMS 10000
+#define VICTIM_BATCH_SIZE 1000
+#define COMPRESSOR_BATCH_SIZE 250
+/* Sweep hands.  The raw pass of a sweep can be split across up to MAX_SWEEP_HANDS clock hands that run in parallel, each over its
+ * own range of buffer IDs with its own victim batch for the compressor pool.  Hand 0 is always the sweeper thread itself; the others
+ * get a thread each from list__set_hands().  A single hand (the default) asks the replacement policy for victims like it always has;
+ * several hands run the clock over their ranges (see policy__clock_select_range()), so they need -P clock.  Ranges are cut from 0 to
+ * the highest ID ever added, which assumes IDs are reasonably dense (they're page numbers here). */
+#define MAX_SWEEP_HANDS 64
+typedef struct sweephand SweepHand;
+struct sweephand {
+  struct list *list;                   /* The list this hand sweeps. */
+  uint8_t index;                       /* Which hand this is.  Hand 0 runs in the sweeper thread. */
+  pthread_t thread;                    /* The thread helper hands (1+) run in. */
+  bufferid_t low;                      /* First ID this hand owns for the current sweep. */
+  bufferid_t high;                     /* First ID past this hand's range.  The last hand's is BUFFER_ID_MAX. */
+  bufferid_t position;                 /* ID the hand rests on between sweeps. */
+  Buffer *victims[VICTIM_BATCH_SIZE];  /* Raw victims waiting on, or being handled by, the compressors. */
+  uint16_t victims_index;              /* The next-available victims[] insertion point. */
+  uint16_t victims_compressor_index;   /* The next victim a compressor should take. */
+  uint16_t in_flight;                  /* Victims compressors have taken from this hand but not finished.  Under jobs_lock. */
+  struct timespec start;               /* This sweep:  when the slice started.  Budgets count from here. */
+  uint64_t bytes_needed;               /* This sweep:  raw bytes the hand should find. */
+  uint64_t budget_ns;                  /* This sweep:  the slice's time budget, or 0. */
+  uint32_t max_victims;                /* This sweep:  the hand's share of the slice's victim budget, or 0. */
+  uint64_t bytes_freed;                /* This sweep:  raw bytes taken, compressed or dropped. */
+  uint64_t bytes_dropped;              /* This sweep:  raw bytes evicted outright because they weren't worth compressing. */
+  uint64_t comp_bytes_added;           /* This sweep:  bytes the compressed victims now take in the comp tier. */
+  uint32_t victims_taken;              /* This sweep:  victims selected. */
+  uint32_t dropped;                    /* This sweep:  victims evicted outright. */
+  uint64_t bytes_lost;                 /* This sweep:  raw bytes of victims a worker updated or removed first.  They settled those. */
+  uint32_t lost;                       /* This sweep:  victims a worker updated or removed before the compressors could swap them. */
+  bool out_of_budget;                  /* This sweep:  the hand stopped on the slice budget rather than finishing. */
+  uint64_t total_freed;                /* Raw bytes this hand has reclaimed over the life of the list. */
+  uint64_t sweep_time;                 /* ns this hand has spent sweeping over the life of the list. */
+};
+
+
 /* Build the Compressor Structures */
 typedef struct compressor Compressor;
 struct compressor {
@@ -42,19 +206,33 @@ struct compressor {
   pthread_cond_t *jobs_parent_cond;    /* Pointer to the parent condition to trigger when job queue is empty and active is 0. */
   uint16_t *active_compressors;        /* Pointer to shared counter of active compressors. */
   uint8_t runnable;                    /* Flag determining if we are still allowed to be running.  If not, pthread_exit(). */
-  Buffer **victims;                    /* Link to the array of victims. */
-  uint16_t *victims_index;             /* Link to the victims index to track the next-available position. */
-  uint16_t *victims_compressor_index;  /* Link to the next-available Buffer to check for compressing in *victims[]. */
   int compressor_id;                   /* The ID of the compressor we're supposed to use. */
   int compressor_level;                /* The level to send the compressor, only supported by zlib and zstd right now. */
 };
 
 
 /* Build the typedef and structure for a List */
+/* List pins are counted in per-thread slots (big-reader style) so readers only ever touch their own cache line.  Writers sum them. */
+#define LIST_PIN_SLOTS 64
+#define LIST_PIN_CACHE_LINE 64
+typedef struct listpinslot ListPinSlot;
+struct listpinslot {
+  int32_t pins;                                  /* Pins taken minus pins released through this slot.  Only the sum over all slots means anything. */
+  char padding[LIST_PIN_CACHE_LINE - sizeof(int32_t)];
+};
+
+
 #define SKIPLIST_MAX 32
-#define MAX_COMP_VICTIMS 10000
-#define VICTIM_BATCH_SIZE 1000
-#define COMPRESSOR_BATCH_SIZE 250
+#define SWEEP_PAUSE_BUCKETS 32
+/* Watermarks, as percentages of a tier's max size.  The sweeper starts reclaiming in the background once a tier passes the high
+ * mark and brings it back down to the low mark.  Foreground threads only wait on it past max size plus the overcommit. */
+#define WATERMARK_HIGH 95
+#define WATERMARK_LOW 90
+#define WATERMARK_OVERCOMMIT 5
+/* Incremental sweeping.  With a slice budget (ns and/or victims) the sweeper works in slices that stop once either is spent and
+ * resume from wherever the policy's hand was left on the next one, so no single slice runs longer than roughly one batch past the
+ * budget.  Zero means no limit, which is one slice per sweep like before. */
+#define SWEEP_SLICE_BATCH 64
 typedef struct list List;
 struct list {
   /* Size and Counter Members */
@@ -62,7 +240,7 @@ struct list {
   uint32_t comp_count;                           /* Number of compressed buffers in the list. */
   uint64_t current_raw_size;                     /* Number of bytes currently allocated to the raw buffers in this list. */
   uint64_t max_raw_size;                         /* Maximum number of bytes the raw list is allowed to hold, ever. */
-  uint64_t current_comp_size;                    /* Number of bytes currently allocated to the comp buffers in this list. */
+  uint64_t current_comp_size;                    /* Number of bytes currently allocated to the comp buffers in this list, and dead bytes the arena still holds. */
   uint64_t max_comp_size;                        /* Maximum number of bytes the comp list is allowed to hold, ever. */
 
   /* Locking, Reference Counters, and Similar Members */
@@ -72,40 +250,82 @@ struct list {
   pthread_cond_t writer_condition;               /* The condition variable for writers to wait for when attempting to drain a list of refs. */
   pthread_cond_t reader_condition;               /* The condition variable for readers to wait for when attempting to increment ref count. */
   pthread_cond_t sweeper_condition;              /* The condition variable for sweeping signals. */
-  uint32_t ref_count;                            /* Number of threads pinning this list (searching it) */
-  uint8_t pending_writers;                       /* Value to indicate how many writers are waiting to edit the list. */
+  ListPinSlot pin_slots[LIST_PIN_SLOTS];         /* Threads pinning this list (searching it), spread over padded slots.  See list__pin_count(). */
+  uint8_t pending_writers;                       /* Writers waiting for, or holding, the write lock.  Readers must not pin while non-zero. */
 
   /* Management and Administration Members */
   pthread_t sweeper_thread;                      /* The threads that the sweeper runs in. */
   uint8_t active;                                /* Boolean for active/inactive status for async processes like sweeping. */
   uint8_t sweep_goal;                            /* Minimum percentage of memory we want to free up whenever we sweep, relative to current_size. */
+  uint8_t watermark_high;                        /* Percent of a tier's max at which the sweeper starts reclaiming on its own. */
+  uint8_t watermark_low;                         /* Percent of a tier's max the sweeper reclaims down to. */
+  uint8_t overcommit;                            /* Percent past max_raw_size the raw tier may reach before foreground threads wait. */
+  uint8_t sweep_requested;                       /* Set by whoever woke the sweeper; cleared every time it wakes.  Saves everyone else the lock. */
+  uint64_t stalls;                               /* Times a foreground thread had to wait for the sweeper. */
+  uint64_t stall_time;                           /* Total ns foreground threads spent waiting for the sweeper. */
   uint64_t sweeps;                               /* Number of times the list has been swept. */
-  uint64_t sweep_cost;                           /* Time in ns spent sweeping lists. */
+  uint64_t sweep_cost;                           /* Time in ns spent sweeping lists.  Readers keep searching throughout. */
+  uint64_t sweep_pauses[SWEEP_PAUSE_BUCKETS];    /* Histogram of the time each sweep held the list lock.  See list__record_latency(). */
+  uint64_t slice_budget_ns;                      /* Most ns the sweeper spends in one slice before yielding.  0 == no limit. */
+  uint32_t slice_victims;                        /* Most victims (both tiers) the sweeper takes in one slice.  0 == no limit. */
+  uint8_t sweep_unfinished;                      /* Set when the last slice ran out of budget before reaching the low watermarks. */
+  uint64_t slices;                               /* Number of sweep slices run, including ones that freed nothing. */
+  uint64_t sweep_slices[SWEEP_PAUSE_BUCKETS];    /* Histogram of how long each slice took, start to finish.  Bounds sweep latency. */
   uint64_t restorations;                         /* Number of buffers restored. */
   uint64_t compressions;                         /* Buffers compressed during the life of the list. */
   uint64_t evictions;                            /* Buffers that were evicted from the list entirely. */
+  uint64_t compression_skips;                    /* Raw victims evicted instead of compressed; counted in evictions too. */
+  RatioController controller;                    /* Adaptive raw/comp ratio state.  See list__tune_ratio(). */
+  GhostList *raw_ghosts;                         /* Buffers recently demoted from raw to compressed.  A restore that finds one is a raw ghost hit. */
+  GhostList *comp_ghosts;                        /* Buffers recently evicted from the compressed tier.  A re-add that finds one is a comp ghost hit. */
+  AdmissionFilter *admission;                    /* TinyLFU gate list__add() uses while the raw tier is full.  NULL to admit everything. */
+  FrequencyWindows *windows;                     /* Rotating popularity windows that spare the hot set from the clock.  NULL when off. */
+  SpillTier *spill;                              /* Log-structured file that compressed evictions spill to.  NULL to just drop them. */
+  CompArena *arena;                              /* Segments holding compressed images at their exact size.  See arena.h. */
+  DictTrainer *dictionaries;                     /* Trains the dictionaries zlib and zstd compress with.  NULL when off.  See dict.h. */
+  const ReplacementPolicy *policy;               /* Picks the sweeper's victims in both tiers.  See policy.h. */
+  void *policy_data;                             /* Whatever the policy keeps for this list. */
 
   /* Management of Nodes for Skiplist and Buffers */
   Buffer *head;                                  /* The head of the list of buffers. */
-  Buffer *clock_hand;                            /* The current Buffer to be checked when sweeping is invoked. */
   SkiplistNode *indexes[SKIPLIST_MAX];           /* List of the heads of the bottom-most (least-granular) Skiplists. */
   uint8_t levels;                                /* The current height of the skip list thus far. */
+  int index_mode;                                /* Bit flags (INDEX_*) controlling how the index is built and searched. */
+  EpochDomain *epoch;                            /* Epoch domain for safe reclamation of nodes unlinked by lock-free operations. */
+  FatNode *fat_root;                             /* Top node of the fat node index (INDEX_FAT_NODE).  Always leftmost on its level. */
+  uint8_t fat_levels;                            /* Number of levels in the fat node index. */
+  pthread_mutex_t fat_lock;                      /* Serializes writers of the fat node index. */
+  uint32_t fat_sequence;                         /* Sequence lock for fat node readers; odd while a writer is reshaping nodes. */
+  uint64_t fat_retries;                          /* Fat node searches that had to start over because a writer moved nodes. */
+  uint64_t fat_misses;                           /* Fat node searches that didn't find the ID. */
+  HashTable *hash_table;                         /* Open-addressing hash index (INDEX_HASH) used by list__search() for point lookups. */
+  pthread_mutex_t hash_lock;                     /* Serializes writers of the hash index. */
+  uint64_t hash_rebuilds;                        /* Times the hash table was grown or rebuilt to clear tombstones. */
+  uint8_t search_interleave;                     /* Lookups list__search_many() keeps in flight at once.  0 or 1 means sorted walks. */
 
   /* Compressor Pool Management */
   pthread_mutex_t jobs_lock;                     /* The mutex that all jobs need to respect. */
   pthread_cond_t jobs_cond;                      /* The shared condition variable for compressors to respect. */
   pthread_cond_t jobs_parent_cond;               /* The parent condition to signal when the job queue is empty and active compressors is 0. */
-  Buffer *comp_victims[MAX_COMP_VICTIMS];        /* An array of available compressed buffers to remove if comp_size is too high after a sweep. */
-  uint16_t comp_victims_index;                   /* The index for the next-available comp buffer to be stored in comp_victims[]. */
-  Buffer *victims[VICTIM_BATCH_SIZE];            /* Items which are ready for compression. */
-  uint16_t victims_index;                        /* The tracking index for the next-available victims[] insertion point. */
-  uint16_t victims_compressor_index;             /* The index for the next-available buffer to be compressed by a compressor. */
+  Buffer *comp_victims[MAX_COMP_VICTIMS];        /* Compressed buffers the policy picked for eviction in the current batch. */
+  SweepHand *hands;                              /* The sweep hands.  Each has its own batch of victims for the compressors. */
+  uint8_t hand_count;                            /* Number of hands.  Only list__set_hands() changes it, under sweep_lock and jobs_lock. */
+  pthread_mutex_t sweep_lock;                    /* Held while hands are running or being replaced, so only one raw pass runs at a time. */
+  pthread_mutex_t hands_lock;                    /* Protects the hand hand-off below. */
+  pthread_cond_t hands_cond;                     /* Helper hands wait on this for the next sweep. */
+  pthread_cond_t hands_done_cond;                /* The sweeper waits on this for helper hands to finish. */
+  uint64_t hand_generation;                      /* Bumped for each sweep the helper hands should run. */
+  uint8_t hands_running;                         /* Helper hands still working on the current sweep. */
+  uint8_t hands_stop;                            /* Tells helper hands to exit. */
+  bufferid_t highest_id;                         /* Largest ID ever added.  Hands split [0, highest_id] between them. */
   uint16_t active_compressors;                   /* The number of compressors currently doing work. */
   pthread_t *compressor_threads;                 /* A pool of threads for each compressor to run within. */
   Compressor *compressor_pool;                   /* A pool of workers for buffer compression when sweeping. */
-  int compressor_id;                             /* The ID of the compressor we're supposed to use. */
+  int compressor_id;                             /* The ID of the compressor we're supposed to use.  ADAPTIVE_COMPRESSOR_ID picks per page. */
   int compressor_level;                          /* The level to send the compressor, only supported by zlib and zstd right now. */
+  CodecStats codec_stats[CODEC_SLOTS];           /* What each codec did, indexed by compressor ID (see codec.h). */
   int compressor_count;                          /* The number of compressors to run from the list. */
+  int next_compressor_id;                        /* Slot in compressor_pool the next compressor thread to start will take. */
 
   /* Copy-On-Write Space (of Buffers) */
   uint64_t cow_max_size;                         /* Size, in bytes, for cow space. */
@@ -118,24 +338,114 @@ struct list {
 };
 
 
+/* A replacement policy.  Hooks are called with the buffer's tier; hit() is called from every search, so it has to stay cheap. */
+struct replacementpolicy {
+  const char *name;                                          /* What -P calls it. */
+  int (*initialize)(List *list, uint64_t max_memory);        /* Sets up ->policy_data. */
+  void (*destroy)(List *list);                               /* Frees ->policy_data. */
+  void (*hit)(List *list, Buffer *buf);                      /* A reader found buf. */
+  void (*insert)(List *list, Buffer *buf, int tier);         /* buf just entered tier:  added, compressed, or restored. */
+  void (*remove)(List *list, Buffer *buf, int tier);         /* buf is leaving tier:  compressed, restored, evicted, or removed. */
+  void (*replace)(List *list, Buffer *buf, Buffer *new_buffer);  /* list__update() swapped new_buffer in for buf.  Same ID, same tier. */
+  uint32_t (*select_victims)(List *list, int tier, uint64_t bytes_needed, Buffer **victims, uint32_t max_victims, uint64_t *bytes_selected);
+                                                             /* Sweeper only, inside an epoch.  Fills victims[] from tier, marks them pending_sweep,
+                                                              * adds their size in the tier to *bytes_selected, and returns how many.  Stops once
+                                                              * bytes_needed is covered; 0 means it found nothing. */
+  bufferid_t (*next_victim)(List *list, int tier);           /* Inside an epoch.  Peeks at the buffer select_victims() would most likely take next
+                                                              * from tier, without moving anything.  BUFFER_ID_MAX if there isn't one. */
+  void (*show_structure)(List *list);                        /* Prints policy state for list__show_structure(). */
+};
+
+
 /* Function prototypes.  Not required, but whatever. */
-int list__initialize(List **list, int compressor_count, int compressor_id, int compressor_level, uint64_t max_memory);
+int list__initialize(List **list, int compressor_count, int compressor_id, int compressor_level, uint64_t max_memory, int index_mode, int policy_id);
 int list__initialize_skiplistnode(SkiplistNode **slnode, Buffer *buf);
 int list__add(List *list, Buffer *buf, uint8_t list_pin_status);
 int list__remove(List *list, Buffer *buf);
 int list__update(List *list, Buffer **callers_buf, void *data, uint32_t size, uint8_t list_pin_status);
 int list__update_ref(List *list, int delta);
+int64_t list__pin_count(List *list);
 int list__search(List *list, Buffer **buf, bufferid_t id, uint8_t list_pin_status);
+int list__search_index(List *list, Buffer **buf, bufferid_t id);
+int list__search_many(List *list, const bufferid_t *ids, int n, Buffer **bufs, int *results, uint8_t list_pin_status);
+void list__search_sorted(List *list, const bufferid_t *ids, int n, Buffer **bufs, int *results);
+void list__search_interleaved(List *list, const bufferid_t *ids, int n, Buffer **bufs, int *results);
+void list__lookup_start(List *list, LookupState *lookup, bufferid_t id, int pos);
+int list__lookup_step(LookupState *lookup);
+int list__compare_keys(const void *a, const void *b);
+void list__wait_for_sweeper(List *list, uint8_t list_pin_status);
+void list__wake_sweeper(List *list);
+uint64_t list__watermark(uint64_t max_size, uint16_t percent);
+int list__restore(List *list, Buffer *buf);
+void list__spill(List *list, Buffer *buf);
+int list__unspill(List *list, Buffer **buf, bufferid_t id);
+int list__scan(List *list, bufferid_t lo, bufferid_t hi, int (*callback)(Buffer *buf, void *data, void *arg), void *arg, void *scratch, int flags);
+Buffer* list__scan_seek(List *list, bufferid_t lo);
+int list__search_index_from(List *list, Buffer **buf, bufferid_t id, SkiplistNode **path, int levels, int level, bufferid_t next_id);
+int list__finger_level(SkiplistNode **path, int levels, bufferid_t id);
 int list__acquire_write_lock(List *list);
 int list__release_write_lock(List *list);
 uint64_t list__sweep(List *list, uint8_t sweep_goal);
+uint64_t list__sweep_slice(List *list, uint8_t sweep_goal, uint64_t budget_ns, uint32_t max_victims);
+void list__sweep_hands(List *list, uint64_t bytes_needed, uint64_t budget_ns, uint32_t max_victims, const struct timespec *start);
+void list__sweep_hand(List *list, SweepHand *hand);
+void list__hand_start(SweepHand *hand);
+int list__set_hands(List *list, uint8_t count);
+SweepHand* list__hand_with_work(List *list);
+bool list__slice_spent(const struct timespec *start, uint64_t budget_ns, uint32_t victims, uint32_t max_victims);
+void list__record_latency(uint64_t *histogram, uint64_t latency_ns);
+void list__show_latencies(const uint64_t *histogram, const char *indent);
 void list__sweeper_start(List *list);
 int list__balance(List *list, uint32_t ratio, uint64_t max_memory);
+void list__set_ratio(List *list, uint8_t ratio);
+void list__tune_ratio(List *list);
+void list__record_miss(List *list, uint64_t load_ns, uint32_t bytes);
+void list__fold_misses(List *list);
 int list__destroy(List *list);
 void list__compressor_start(List *list);
+bool list__worth_compressing(List *list, Buffer *buf, uint32_t comp_length);
+void list__mark_incompressible(Buffer *buf);
+int list__choose_codec(Compressor *comp, Buffer *buf, int *level);
 void list__show_structure(List *list);
 void list__dump_structure(List *list);
 void list__add_cow(List *list, Buffer *buf);
 void list__slaughter_house(List *list);
+void list__reclaim_buffer(void *ptr, void *arg);
+/* Lock-free index variants.  These are dispatched to by the functions above when INDEX_LOCK_FREE is set. */
+bool list__lock_free_is_dead(SkiplistNode *slnode);
+int list__lock_free_find(List *list, bufferid_t id, SkiplistNode **preds, SkiplistNode **succs, Buffer **pred_buf, Buffer **curr_buf);
+int list__lock_free_add(List *list, Buffer *buf, int levels);
+int list__lock_free_remove(List *list, Buffer *buf);
+int list__lock_free_update(List *list, Buffer *buf, Buffer *new_buffer);
+int list__lock_free_search(List *list, Buffer **buf, bufferid_t id);
+Buffer* list__lock_free_locate(List *list, bufferid_t id);
+/* Fat node (B-skiplist) index variants.  Dispatched to when INDEX_FAT_NODE is set.  Writers MUST hold ->fat_lock. */
+int list__fat_initialize(List *list);
+int list__fat_initialize_node(FatNode **node, uint8_t level);
+void list__fat_destroy(List *list);
+int list__fat_rank(const FatNode *node, bufferid_t id);
+FatNode* list__fat_descend(List *list, bufferid_t id, FatNode **path, int *ranks);
+Buffer* list__fat_predecessor(List *list, FatNode *leaf, int rank);
+int list__fat_insert_entry(List *list, FatNode **path, int level, bufferid_t key, void *pointer);
+void list__fat_remove_entry(List *list, FatNode **path, int *ranks, int level);
+int list__fat_add(List *list, Buffer *buf);
+int list__fat_remove(List *list, Buffer *buf);
+int list__fat_update(List *list, Buffer *buf, Buffer *new_buffer);
+int list__fat_search(List *list, Buffer **buf, bufferid_t id);
+void list__fat_show_structure(List *list);
+/* Hash index.  Kept alongside whichever ordered index the list uses when INDEX_HASH is set.  Writers take ->hash_lock themselves. */
+int list__hash_initialize(List *list);
+int list__hash_initialize_table(HashTable **table, uint8_t bits);
+void list__hash_destroy(List *list);
+void list__hash_reclaim_table(void *ptr, void *arg);
+uint64_t list__hash_home(HashTable *table, bufferid_t id);
+int list__hash_rebuild(List *list, uint8_t bits);
+int list__hash_reserve(List *list, bufferid_t id);
+void list__hash_release(List *list);
+int list__hash_insert(List *list, Buffer *buf);
+int list__hash_remove(List *list, Buffer *buf);
+int list__hash_update(List *list, Buffer *buf, Buffer *new_buffer);
+int list__hash_search(List *list, Buffer **buf, bufferid_t id);
+void list__hash_show_structure(List *list);
 
 #endif /* SRC_LIST_H_ */
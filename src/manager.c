@@ -42,9 +42,16 @@ extern const int E_OK;
 extern const int E_GENERIC;
 extern const int E_BUFFER_NOT_FOUND;
 extern const int E_BUFFER_ALREADY_EXISTS;
+extern const int E_BUFFER_NOT_ADMITTED;
 extern const int E_BUFFER_IS_DIRTY;
 
 extern const int DESTROY_DATA;
+extern const int BUFFER_OVERHEAD;
+extern const int INDEX_LOCK_FREE;
+extern const int INDEX_FAT_NODE;
+extern const int INDEX_HASH;
+extern const int ZSTD_COMPRESSOR_ID;
+extern const int ADAPTIVE_COMPRESSOR_ID;
 
 /* Globals to protect worker IDs. */
 #define MAX_WORKER_ID UINT32_MAX
@@ -82,13 +89,51 @@ Manager* manager__initialize(managerid_t id, char **pages) {
   /* Create the listset for this manager to use. */
   List *list = NULL;
   int list_rv = E_OK;
-  list_rv = list__initialize(&list, opts.cpu_count, opts.compressor_id, opts.compressor_level, opts.max_memory);
+  list_rv = list__initialize(&list, opts.cpu_count, opts.compressor_id, opts.compressor_level, opts.max_memory, opts.index_mode, opts.policy_id);
   if (list_rv != E_OK)
     show_error(E_GENERIC, "Couldn't create the list for manager "PRIu8".  This is fatal.", id);
   mgr->list = list;
+  list->search_interleave = opts.search_interleave;
+  list->watermark_high = opts.watermark_high;
+  list->watermark_low = opts.watermark_low;
+  list->overcommit = opts.overcommit;
+  list->slice_budget_ns = opts.slice_budget_ns;
+  list->slice_victims = opts.slice_victims;
+  if(list__set_hands(list, opts.sweep_hands) != E_OK)
+    show_error(E_GENERIC, "Couldn't start %"PRIu8" sweep hands for manager "PRIu8".  This is fatal.", opts.sweep_hands, id);
+  /* The admission filter (-A) is sized for every buffer the list could hold, raw or compressed. */
+  if(opts.admission) {
+    list_rv = admit__initialize(&list->admission, opts.max_memory, BUFFER_OVERHEAD + GHOST_EXPECTED_SIZE);
+    if (list_rv != E_OK)
+      show_error(E_GENERIC, "Couldn't create the admission filter for manager "PRIu8".  This is fatal.", id);
+  }
+  /* Popularity windows (-Z) rotate on the clock or on hits, whichever was asked for. */
+  if(opts.window_ns != 0 || opts.window_hits != 0) {
+    list_rv = window__initialize(&list->windows, opts.window_ns, opts.window_hits, opts.window_decay);
+    if (list_rv != E_OK)
+      show_error(E_GENERIC, "Couldn't create the popularity windows for manager "PRIu8".  This is fatal.", id);
+  }
+  /* The spill tier (-S) catches what the compressed tier evicts. */
+  if(opts.spill_path != NULL) {
+    list_rv = spill__initialize(&list->spill, opts.spill_path, opts.spill_bytes);
+    if (list_rv != E_OK)
+      show_error(E_GENERIC, "Couldn't create the spill file %s for manager "PRIu8".  This is fatal.", opts.spill_path, id);
+  }
+  /* Trained dictionaries (-T) for zlib and zstd.  The compressors sample pages for the first one as soon as they start.  Adaptive
+   * lists train for the pages they give zstd. */
+  if(opts.dict_size != 0) {
+    if(opts.compressor_id == ADAPTIVE_COMPRESSOR_ID)
+      list_rv = dict__initialize(&list->dictionaries, opts.dict_size, ZSTD_COMPRESSOR_ID, CODEC_COLD_LEVEL);
+    else
+      list_rv = dict__initialize(&list->dictionaries, opts.dict_size, opts.compressor_id, opts.compressor_level);
+    if (list_rv != E_OK)
+      show_error(E_GENERIC, "Couldn't create the dictionary trainer for manager "PRIu8".  This is fatal.", id);
+  }
 
   /* Set the memory sizes for both lists. */
   list__balance(list, opts.fixed_ratio > 0 ? opts.fixed_ratio : INITIAL_RAW_RATIO, opts.max_memory);
+  /* Without a fixed ratio (-f) the sweeper tunes the split itself as it goes. */
+  list->controller.adaptive = opts.fixed_ratio > 0 ? 0 : 1;
 
   /* Return our manager. */
   return mgr;
@@ -132,13 +177,59 @@ int manager__start(Manager *mgr) {
   printf("=============\n");
   printf("Buffer Acquisitions : %'"PRIu64" (%'.f per sec).  %'"PRIu64" hits.  %'"PRIu64" misses.\n", total_acquisitions, total_acquisitions / (1.0 * mgr->run_duration / 1000), mgr->hits, mgr->misses);
   printf("Pages in Data Set   : %'"PRIu32" (%'"PRIu64" bytes)\n",opts.page_count, opts.dataset_size);
-  printf("Compressions        : %'"PRIu64" compressions (%'.f per sec)\n", mgr->list->compressions, mgr->list->compressions / (1.0 * mgr->run_duration / 1000));
+  printf("Compressions        : %'"PRIu64" compressions (%'.f per sec).  %'"PRIu64" victims evicted instead (not worth compressing).\n", mgr->list->compressions, mgr->list->compressions / (1.0 * mgr->run_duration / 1000), mgr->list->compression_skips);
   printf("Restorations        : %'"PRIu64" restorations (%'.f per sec)\n", mgr->list->restorations, mgr->list->restorations / (1.0 * mgr->run_duration / 1000));
+  printf("Codecs              : %s\n", codec__name(opts.compressor_id));
+  for(int i=0; i<CODEC_SLOTS; i++) {
+    if(mgr->list->codec_stats[i].compressions == 0 && mgr->list->codec_stats[i].decompressions == 0)
+      continue;
+    char label[32];
+    snprintf(label, sizeof(label), "  %-18s", codec__name(i));
+    codec__show(&mgr->list->codec_stats[i], label);
+  }
   printf("Hit Ratio           : %5.2f%%\n", 100.0 * mgr->hits / total_acquisitions);
-  printf("Fixed Memory Ratio  : %"PRIi8"%% (%'"PRIu64" bytes raw, %'"PRIu64" bytes compressed)\n", opts.fixed_ratio, mgr->list->max_raw_size, mgr->list->max_comp_size);
+  printf("Ghost Hits          : %'"PRIu64" raw (restores a bigger raw tier would have avoided).  %'"PRIu64" compressed (loads a bigger compressed tier would have avoided).\n", mgr->list->raw_ghosts->hits, mgr->list->comp_ghosts->hits);
+  if(mgr->list->controller.adaptive)
+    printf("Memory Ratio        : adaptive, converged at %"PRIu8"%% after %'"PRIu64" adjustments (%'"PRIu64" bytes raw, %'"PRIu64" bytes compressed)\n", mgr->list->controller.raw_ratio, mgr->list->controller.adjustments, mgr->list->max_raw_size, mgr->list->max_comp_size);
+  else
+    printf("Memory Ratio        : fixed at %"PRIi8"%% (%'"PRIu64" bytes raw, %'"PRIu64" bytes compressed)\n", opts.fixed_ratio, mgr->list->max_raw_size, mgr->list->max_comp_size);
   printf("Manager run time    : %.1f sec\n", 1.0 * mgr->run_duration / 1000);
-  printf("Time sweeping       : %'"PRIu64" sweeps (%'"PRIu64" ns)\n", mgr->list->sweeps, mgr->list->sweep_cost);
+  printf("Time sweeping       : %'"PRIu64" sweeps (%'"PRIu64" ns, concurrent with readers)\n", mgr->list->sweeps, mgr->list->sweep_cost);
+  printf("Foreground Stalls   : %'"PRIu64" waits on the sweeper (%'"PRIu64" ns total).  Watermarks %"PRIu8"%%/%"PRIu8"%%, overcommit %"PRIu8"%%.\n", mgr->list->stalls, mgr->list->stall_time, mgr->list->watermark_high, mgr->list->watermark_low, mgr->list->overcommit);
+  printf("Sweep Pauses        :\n");
+  list__show_latencies(mgr->list->sweep_pauses, "  ");
+  printf("Sweep Hands         : %"PRIu8" (raw pass split by ID range).  Reclaimed per hand:\n", mgr->list->hand_count);
+  for(int i=0; i<mgr->list->hand_count; i++)
+    printf("  hand %2d : %'16"PRIu64" bytes in %'16"PRIu64" ns (%'.f bytes/sec)\n", i, mgr->list->hands[i].total_freed, mgr->list->hands[i].sweep_time, mgr->list->hands[i].sweep_time == 0 ? 0.0 : 1.0 * BILLION * mgr->list->hands[i].total_freed / mgr->list->hands[i].sweep_time);
+  printf("Sweep Slices        : %'"PRIu64" slices (budget %'"PRIu64" ns, %'"PRIu32" victims; 0 == unlimited)\n", mgr->list->slices, mgr->list->slice_budget_ns, mgr->list->slice_victims);
+  list__show_latencies(mgr->list->sweep_slices, "  ");
   printf("Threads & Workers   : %"PRIu16" CPUs.  %"PRIu16" Workers.\n", opts.cpu_count, opts.workers);
+  printf("Index Mode          : %s%s\n", (opts.index_mode & INDEX_LOCK_FREE) ? "lock-free (epoch reclamation)" : (opts.index_mode & INDEX_FAT_NODE) ? "fat node (B-skiplist)" : "locking",
+                                         (opts.index_mode & INDEX_HASH) ? " + hash" : "");
+  printf("Replacement Policy  : %s\n", mgr->list->policy->name);
+  if(mgr->list->admission != NULL)
+    printf("Admission Filter    : TinyLFU (%'"PRIu64" bytes).  %'"PRIu64" admitted, %'"PRIu64" rejected (kept privately by workers).\n", mgr->list->admission->memory, mgr->list->admission->admitted, mgr->list->admission->rejected);
+  else
+    printf("Admission Filter    : off\n");
+  if(mgr->list->windows != NULL)
+    printf("Popularity Windows  : %'"PRIu64" rotations.  Zipf s = %.2f, hot set of %'"PRIu64" buffers.  Mean hot set error %.1f points, %'"PRIu64" spared.\n", mgr->list->windows->rotations, mgr->list->windows->zipf_exponent,
+           mgr->list->windows->hot_buffers, mgr->list->windows->scored == 0 ? 0.0 : 100 * mgr->list->windows->share_error / mgr->list->windows->scored, mgr->list->windows->spared);
+  else
+    printf("Popularity Windows  : off\n");
+  if(mgr->list->spill != NULL)
+    printf("Spill Tier          : %'"PRIu64" spilled, %'"PRIu64" restored (%'"PRIu64" preads).  %'"PRIu64" segment writes, %'"PRIu64" cleanings, %'"PRIu64" records expired.\n", mgr->list->spill->spills,
+           mgr->list->spill->hits, mgr->list->spill->reads, mgr->list->spill->writes, mgr->list->spill->cleanings, mgr->list->spill->expired);
+  else
+    printf("Spill Tier          : off\n");
+  if(mgr->list->dictionaries != NULL)
+    printf("Dictionaries        : %'"PRIu64" trained (%'"PRIu64" for drift) of %'"PRIu32" bytes.  %'"PRIu64" pages compressed with one, %.2fx.\n", mgr->list->dictionaries->trainings, mgr->list->dictionaries->drifts,
+           mgr->list->dictionaries->dict_size, mgr->list->dictionaries->pages, mgr->list->dictionaries->comp_bytes == 0 ? 0.0 : 1.0 * mgr->list->dictionaries->data_bytes / mgr->list->dictionaries->comp_bytes);
+  else
+    printf("Dictionaries        : off\n");
+  printf("Read Path           : %s", opts.batched_reads ? "batched (list__search_many)" : "one at a time (list__search)");
+  if(opts.search_interleave > 1)
+    printf(", %"PRIu8" interleaved", opts.search_interleave);
+  printf("\n");
   printf("CRUD Operations     : %'"PRIu64" rounds/transactions (%'.f per sec)\n", mgr->rounds, mgr->rounds / (1.0 * mgr->run_duration / 1000));
   printf("  Create/Read       : %'"PRIu64" pages read (%'.f per sec).\n", mgr->hits + mgr->misses, (mgr->hits + mgr->misses) / (1.0 * mgr->run_duration / 1000));
   printf("  Updates           : %'"PRIu64" pages updated (%'.f per sec).\n", mgr->updates, mgr->updates / (1.0 * mgr->run_duration / 1000));
@@ -278,15 +369,18 @@ void manager__spawn_worker(Manager *mgr) {
   const int BUF_MAX = 10000;  // At 8 bytes per pointer, this uses 80KB on the stack.
   const int modulo = (opts.max_pages_retrieved - opts.min_pages_retrieved) > 1 ? (opts.max_pages_retrieved - opts.min_pages_retrieved) : 2;
   Buffer *bufs[BUF_MAX];
+  bufferid_t ids[BUF_MAX];
+  int results[BUF_MAX];
+  uint8_t private_copy[BUF_MAX];  // 1 when the admission filter turned bufs[i] away, so this worker owns it outright.
   int fetch_this_round = 0;
   int rv = 0;
   int buf_rv = 0;
   bufferid_t id_to_get = 0;
   int delete_ceiling = 0;
   const int hot_floor = 0;
-  const int hot_ceiling = opts.page_count * opts.bias_percent;
+  const int hot_ceiling = opts.page_count * opts.bias_percent > 1 ? opts.page_count * opts.bias_percent : 1;
   const int cold_floor = hot_ceiling;
-  const int cold_ceiling = opts.page_count + 1;
+  const int cold_ceiling = opts.page_count;
   int temp_ceiling = 0;
   int temp_floor = 0;
   uint64_t hot_selections = 0;
@@ -296,6 +390,7 @@ void manager__spawn_worker(Manager *mgr) {
   float my_update_frequency = 0.0;
   uint64_t deletions = 0;
   float my_delete_frequency = 0.0;
+  struct timespec load_start, load_end;
   while(mgr->runnable != 0) {
     /* Callers can provide their own list pins before calling read operations.  Do so here to reduce lock contention. */
     if(has_list_pin == 0) {
@@ -308,6 +403,7 @@ void manager__spawn_worker(Manager *mgr) {
     if(fetch_this_round == 0)
       fetch_this_round++;
     for(int i = 0; i<fetch_this_round; i++) {
+      private_copy[i] = 0;
       my_aggregate = 1.0 * hot_selections / (hot_selections + cold_selections);
       // Find the ID to get.  Make it hot if necessary.
       temp_ceiling = opts.page_count;
@@ -325,27 +421,73 @@ void manager__spawn_worker(Manager *mgr) {
         }
       }
 
-      /* Go find our buffer!  If the one we need doesn't exist, get it and add it. */
-      id_to_get = (rand_r(&seed) % temp_ceiling) - temp_floor;
+      /* Go find our buffer!  If the one we need doesn't exist, get it and add it.  Batched workers just collect IDs for now. */
+      // IDs index mgr->pages[], so they're drawn from [temp_floor, temp_ceiling).  An empty cold range falls back to everything.
+      if(temp_ceiling <= temp_floor) {
+        temp_floor = 0;
+        temp_ceiling = opts.page_count;
+      }
+      id_to_get = (rand_r(&seed) % (temp_ceiling - temp_floor)) + temp_floor;
+      if(opts.batched_reads) {
+        ids[i] = id_to_get;
+        continue;
+      }
       rv = list__search(mgr->list, &bufs[i], id_to_get, has_list_pin);
 
       if(rv == E_OK)
         mgr->workers[id].hits++;
       while(rv == E_BUFFER_NOT_FOUND) {
         mgr->workers[id].misses++;
+        clock_gettime(CLOCK_MONOTONIC, &load_start);
         buf_rv = buffer__initialize(&bufs[i], id_to_get, 0, NULL, mgr->pages[id_to_get]);
         if (buf_rv != E_OK)
           show_error(buf_rv, "Unable to get a buffer.  RV is %d.", buf_rv);
+        clock_gettime(CLOCK_MONOTONIC, &load_end);
+        list__record_miss(mgr->list, BILLION * (load_end.tv_sec - load_start.tv_sec) + load_end.tv_nsec - load_start.tv_nsec, bufs[i]->data_length);
         bufs[i]->ref_count++;
         rv = list__add(mgr->list, bufs[i], has_list_pin);
         if (rv == E_OK)
           break;
+        // Not worth caching.  Use our copy for this round and throw it away after.
+        if (rv == E_BUFFER_NOT_ADMITTED) {
+          private_copy[i] = 1;
+          break;
+        }
         // If it already exists, destroy our copy and search again.
         if (rv == E_BUFFER_ALREADY_EXISTS)
           buffer__destroy(bufs[i], DESTROY_DATA);
         rv = list__search(mgr->list, &bufs[i], id_to_get, has_list_pin);
       }
     }
+    /* Batched workers resolve the whole round at once, then go load whatever was missing one at a time like above. */
+    if(opts.batched_reads) {
+      list__search_many(mgr->list, ids, fetch_this_round, bufs, results, has_list_pin);
+      for(int i = 0; i<fetch_this_round; i++) {
+        rv = results[i];
+        if(rv == E_OK)
+          mgr->workers[id].hits++;
+        while(rv == E_BUFFER_NOT_FOUND) {
+          mgr->workers[id].misses++;
+          clock_gettime(CLOCK_MONOTONIC, &load_start);
+          buf_rv = buffer__initialize(&bufs[i], ids[i], 0, NULL, mgr->pages[ids[i]]);
+          if (buf_rv != E_OK)
+            show_error(buf_rv, "Unable to get a buffer.  RV is %d.", buf_rv);
+          clock_gettime(CLOCK_MONOTONIC, &load_end);
+          list__record_miss(mgr->list, BILLION * (load_end.tv_sec - load_start.tv_sec) + load_end.tv_nsec - load_start.tv_nsec, bufs[i]->data_length);
+          bufs[i]->ref_count++;
+          rv = list__add(mgr->list, bufs[i], has_list_pin);
+          if (rv == E_OK)
+            break;
+          if (rv == E_BUFFER_NOT_ADMITTED) {
+            private_copy[i] = 1;
+            break;
+          }
+          if (rv == E_BUFFER_ALREADY_EXISTS)
+            buffer__destroy(bufs[i], DESTROY_DATA);
+          rv = list__search(mgr->list, &bufs[i], ids[i], has_list_pin);
+        }
+      }
+    }
     // Hooray, we finished a round!
     mgr->workers[id].rounds++;
 
@@ -356,6 +498,12 @@ void manager__spawn_worker(Manager *mgr) {
       for(int i=0; i<fetch_this_round; i++) {
         void *new_data = malloc(bufs[i]->data_length);
         memcpy(new_data, bufs[i]->data, bufs[i]->data_length);
+        // Nobody else can see a private copy, so there's nothing to copy-on-write.
+        if(private_copy[i]) {
+          free(bufs[i]->data);
+          bufs[i]->data = new_data;
+          continue;
+        }
         rv = list__update(mgr->list, &bufs[i], new_data, bufs[i]->data_length, has_list_pin);
         while(rv == E_BUFFER_IS_DIRTY) {
           // Someone else updated this buffer before us and it's in the slaughter house now.  Find the updated one.
@@ -368,11 +516,20 @@ void manager__spawn_worker(Manager *mgr) {
             rv = list__add(mgr->list, bufs[i], has_list_pin);
             if (rv == E_OK)
               break;
+            if (rv == E_BUFFER_NOT_ADMITTED) {
+              private_copy[i] = 1;
+              break;
+            }
             if (rv == E_BUFFER_ALREADY_EXISTS)
               buffer__destroy(bufs[i], DESTROY_DATA);
             rv = list__search(mgr->list, &bufs[i], id_to_get, has_list_pin);
           }
-          // Now try the update again.
+          // Now try the update again.  A fresh copy that wasn't admitted just takes the new data.
+          if(private_copy[i]) {
+            free(bufs[i]->data);
+            bufs[i]->data = new_data;
+            break;
+          }
           rv = list__update(mgr->list, &bufs[i], new_data, bufs[i]->data_length, has_list_pin);
         }
       }
@@ -388,6 +545,10 @@ void manager__spawn_worker(Manager *mgr) {
       // Try to delete a portion of the buffers.  See DELETE_RATIO.
       delete_ceiling = (fetch_this_round * DELETE_RATIO / 100) + 1;
       for(int i=0; i<delete_ceiling; i++) {
+        if(private_copy[i]) {
+          buffer__destroy(bufs[i], DESTROY_DATA);
+          continue;
+        }
         rv = list__remove(mgr->list, bufs[i]);
       }
       deletions++;
@@ -396,8 +557,12 @@ void manager__spawn_worker(Manager *mgr) {
     my_delete_frequency = 1.0 * deletions / mgr->workers[id].rounds;
 
     // Now release any remaining pins we have.  Deleted ones already lost their pin, so we start from delete_ceiling, if applicable.
-    for(int i = delete_ceiling; i<fetch_this_round; i++)
-      buffer__release_pin(bufs[i]);
+    for(int i = delete_ceiling; i<fetch_this_round; i++) {
+      if(private_copy[i])
+        buffer__destroy(bufs[i], DESTROY_DATA);
+      else
+        buffer__release_pin(bufs[i]);
+    }
 
     /* Release the list pin if there are pending writers.  This is a dirty read/race but that's ok for an extra loop */
     if(mgr->list->pending_writers != 0) {
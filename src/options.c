@@ -15,8 +15,11 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include "dict.h"
 #include "error.h"
 #include "options.h"
+#include "policy.h"
+#include "spill.h"
 
 
 /* Definitions to match most of the options. */
@@ -42,6 +45,16 @@ extern const int NO_COMPRESSOR_ID;
 extern const int LZ4_COMPRESSOR_ID;
 extern const int ZLIB_COMPRESSOR_ID;
 extern const int ZSTD_COMPRESSOR_ID;
+extern const int ADAPTIVE_COMPRESSOR_ID;
+
+/* Extern the index modes. */
+extern const int INDEX_LOCKING;
+extern const int INDEX_LOCK_FREE;
+extern const int INDEX_FAT_NODE;
+extern const int INDEX_HASH;
+
+/* Extern the replacement policies. */
+extern const int POLICY_CLOCK;
 
 
 /* options__process
@@ -62,12 +75,29 @@ void options__process(int argc, char **argv) {
   opts.fixed_ratio = -1;
   opts.workers = sysconf(_SC_NPROCESSORS_ONLN) > 0 ? (uint16_t)sysconf(_SC_NPROCESSORS_ONLN) : 1;
   opts.cpu_count = sysconf(_SC_NPROCESSORS_ONLN) > 0 ? (uint16_t)sysconf(_SC_NPROCESSORS_ONLN) : 1;
+  opts.watermark_high = WATERMARK_HIGH;
+  opts.watermark_low = WATERMARK_LOW;
+  opts.overcommit = WATERMARK_OVERCOMMIT;
+  opts.slice_budget_ns = 0;
+  opts.slice_victims = 0;
+  opts.sweep_hands = 1;
   /* Tyche Management */
   opts.duration = 5;
   opts.compressor_id = LZ4_COMPRESSOR_ID;
   opts.compressor_level = 1;
+  opts.index_mode = INDEX_LOCKING;
+  opts.policy_id = POLICY_CLOCK;
+  opts.admission = 0;
+  opts.window_ns = 0;
+  opts.window_hits = 0;
+  opts.window_decay = 50;
+  opts.spill_path = NULL;
+  opts.spill_bytes = SPILL_DEFAULT_BYTES;
+  opts.dict_size = 0;
   opts.min_pages_retrieved = 5;
   opts.max_pages_retrieved = 5;
+  opts.batched_reads = 0;
+  opts.search_interleave = 0;
   opts.bias_percent = 1.0;
   opts.bias_aggregate = 1.0;
   opts.update_frequency = 0.0;
@@ -82,10 +112,14 @@ void options__process(int argc, char **argv) {
   /* Process everything passed from CLI now. */
   char *save_ptr = NULL;
   char *token = NULL;
+  char *suffix = NULL;
   int c = 0;
   opterr = 0;
-  while ((c = getopt(argc, argv, "b:B:c:Cd:D:f:hm:M:n:p:qt:U:w:X:v")) != -1) {
+  while ((c = getopt(argc, argv, "Ab:B:c:Cd:D:f:gG:hH:I:m:M:n:p:P:qs:S:t:T:U:w:W:X:vZ:")) != -1) {
     switch (c) {
+      case 'A':
+        opts.admission = 1;
+        break;
       case 'b':
         opts.dataset_max = (uint64_t)atoll(optarg);
         break;
@@ -98,14 +132,16 @@ void options__process(int argc, char **argv) {
           opts.bias_aggregate = 1.0 * atof(token) / 100;
         break;
       case 'c':
-        if(strcmp(optarg, "lz4") != 0 && strcmp(optarg, "zlib") != 0 && strcmp(optarg, "zstd"))
-          show_error(E_BAD_CLI, "You must specify either 'lz4' or 'zlib' for compression (-c), not: %s", optarg);
+        if(strcmp(optarg, "lz4") != 0 && strcmp(optarg, "zlib") != 0 && strcmp(optarg, "zstd") != 0 && strcmp(optarg, "adaptive") != 0)
+          show_error(E_BAD_CLI, "You must specify 'lz4', 'zlib', 'zstd', or 'adaptive' for compression (-c), not: %s", optarg);
         if(strcmp(optarg, "lz4") == 0)
           opts.compressor_id = LZ4_COMPRESSOR_ID;
         if(strcmp(optarg, "zlib") == 0)
           opts.compressor_id = ZLIB_COMPRESSOR_ID;
         if(strcmp(optarg, "zstd") == 0)
           opts.compressor_id = ZSTD_COMPRESSOR_ID;
+        if(strcmp(optarg, "adaptive") == 0)
+          opts.compressor_id = ADAPTIVE_COMPRESSOR_ID;
         break;
       case 'C':
         opts.compressor_id = NO_COMPRESSOR_ID;
@@ -121,10 +157,41 @@ void options__process(int argc, char **argv) {
       case 'f':
         opts.fixed_ratio = (int8_t)atoi(optarg);
         break;
+      case 'g':
+        opts.batched_reads = 1;
+        break;
+      case 'G':
+        if(atoi(optarg) < 1 || atoi(optarg) > UINT8_MAX)
+          show_error(E_BAD_CLI, "The interleave width (-G) must be between 1 and %d, not: %s", UINT8_MAX, optarg);
+        opts.search_interleave = (uint8_t)atoi(optarg);
+        opts.batched_reads = 1;
+        break;
       case 'h':
         options__show_help();
         exit(E_OK);
         break;
+      case 'H':
+        if(atoi(optarg) < 1 || atoi(optarg) > MAX_SWEEP_HANDS)
+          show_error(E_BAD_CLI, "The sweep hands (-H) must be between 1 and %d, not: %s", MAX_SWEEP_HANDS, optarg);
+        opts.sweep_hands = (uint8_t)atoi(optarg);
+        break;
+      case 'I':
+        opts.index_mode = INDEX_LOCKING;
+        token = strtok_r(optarg, "+", &save_ptr);
+        while(token != NULL) {
+          if(strcmp(token, "locking") != 0 && strcmp(token, "lockfree") != 0 && strcmp(token, "fatnode") != 0 && strcmp(token, "hash") != 0)
+            show_error(E_BAD_CLI, "You must specify 'locking', 'lockfree', 'fatnode', and/or 'hash' for the index mode (-I), not: %s", token);
+          if(strcmp(token, "lockfree") == 0)
+            opts.index_mode |= INDEX_LOCK_FREE;
+          if(strcmp(token, "fatnode") == 0)
+            opts.index_mode |= INDEX_FAT_NODE;
+          if(strcmp(token, "hash") == 0)
+            opts.index_mode |= INDEX_HASH;
+          token = strtok_r(NULL, "+", &save_ptr);
+        }
+        if((opts.index_mode & INDEX_LOCK_FREE) && (opts.index_mode & INDEX_FAT_NODE))
+          show_error(E_BAD_CLI, "The index mode (-I) can only use one of 'locking', 'lockfree', or 'fatnode'.");
+        break;
       case 'm':
         opts.max_memory = (uint64_t)atoll(optarg);
         break;
@@ -142,14 +209,30 @@ void options__process(int argc, char **argv) {
       case 'p':
         opts.page_directory = optarg;
         break;
+      case 'P':
+        opts.policy_id = policy__find(optarg);
+        if(opts.policy_id < 0)
+          show_error(E_BAD_CLI, "You must specify 'clock', 'clockpro', 'arc', 's3fifo', or 'gdsf' for the replacement policy (-P), not: %s", optarg);
+        break;
       case 'q':
         opts.quiet = 1;
         break;
+      case 's':
+        token = strtok_r(optarg, ",", &save_ptr);
+        if(token != NULL)
+          opts.slice_budget_ns = strtoull(token, NULL, 10);
+        token = strtok_r(NULL, ",", &save_ptr);
+        if (token != NULL)
+          opts.slice_victims = (uint32_t)strtoul(token, NULL, 10);
+        break;
       case 't':
         if (opts.test != NULL)
           show_error(E_BAD_CLI, "You cannot specify the -t option more than once.");
         opts.test = optarg;
         break;
+      case 'T':
+        opts.dict_size = (uint32_t)strtoul(optarg, NULL, 10);
+        break;
       case 'U':
         opts.update_frequency = 1.0 * atof(optarg) / 100;
         break;
@@ -158,6 +241,27 @@ void options__process(int argc, char **argv) {
         if (atoi(optarg) > MAX_WORKERS)
           opts.workers = MAX_WORKERS;
         break;
+      case 'W':
+        // Range check before narrowing, or something like 300 would quietly wrap into a valid looking percentage.
+        token = strtok_r(optarg, ",", &save_ptr);
+        if(token != NULL) {
+          if(atoi(token) < 1 || atoi(token) > 100)
+            show_error(E_BAD_CLI, "The high watermark (-W X,Y,Z) must be between 1 and 100, not: %s", token);
+          opts.watermark_high = (uint8_t)atoi(token);
+        }
+        token = strtok_r(NULL, ",", &save_ptr);
+        if (token != NULL) {
+          if(atoi(token) < 1 || atoi(token) > 100)
+            show_error(E_BAD_CLI, "The low watermark (-W X,Y,Z) must be between 1 and 100, not: %s", token);
+          opts.watermark_low = (uint8_t)atoi(token);
+        }
+        token = strtok_r(NULL, ",", &save_ptr);
+        if (token != NULL) {
+          if(atoi(token) < 0 || atoi(token) > 100)
+            show_error(E_BAD_CLI, "The overcommit (-W X,Y,Z) must be between 0 and 100, not: %s", token);
+          opts.overcommit = (uint8_t)atoi(token);
+        }
+        break;
       case 'X':
         free(opts.extended_test_options);
         opts.extended_test_options = optarg;
@@ -171,9 +275,30 @@ void options__process(int argc, char **argv) {
           show_error(E_BAD_CLI, "Verbosity is already at maximum value: %d", opts.verbosity);
         opts.verbosity++;
         break;
+      case 'S':
+        token = strtok_r(optarg, ",", &save_ptr);
+        if (token != NULL)
+          opts.spill_path = token;
+        token = strtok_r(NULL, ",", &save_ptr);
+        if (token != NULL)
+          opts.spill_bytes = strtoull(token, NULL, 10);
+        break;
+      case 'Z':
+        token = strtok_r(optarg, ",", &save_ptr);
+        if(token != NULL) {
+          opts.window_hits = strtoull(token, &suffix, 10);
+          if(strcmp(suffix, "ms") == 0) {
+            opts.window_ns = opts.window_hits * 1000000;
+            opts.window_hits = 0;
+          }
+        }
+        token = strtok_r(NULL, ",", &save_ptr);
+        if (token != NULL)
+          opts.window_decay = (uint8_t)atoi(token);
+        break;
       case '?':
         options__show_help();
-        if (optopt == 'b' || optopt == 'B' || optopt == 'c' || optopt == 'd' || optopt == 'D' || optopt == 'f' || optopt == 'm' || optopt == 'M' || optopt == 'n' || optopt == 'p' || optopt == 't' || optopt == 'U' || optopt == 'w' || optopt == 'X')
+        if (optopt == 'b' || optopt == 'B' || optopt == 'c' || optopt == 'd' || optopt == 'D' || optopt == 'f' || optopt == 'H' || optopt == 'I' || optopt == 'm' || optopt == 'M' || optopt == 'n' || optopt == 'p' || optopt == 'P' || optopt == 's' || optopt == 'S' || optopt == 't' || optopt == 'T' || optopt == 'U' || optopt == 'w' || optopt == 'W' || optopt == 'X' || optopt == 'Z')
           show_error(E_BAD_CLI, "Option -%c requires an argument.", optopt);
         if (isprint (optopt))
           show_error(E_BAD_CLI, "Unknown option `-%c'.", optopt);
@@ -236,6 +361,25 @@ void options__process(int argc, char **argv) {
   // -- The min pages retrieved in a round can't greater than max...
   if (opts.min_pages_retrieved > opts.max_pages_retrieved)
     show_error(E_BAD_CLI, "You can't set the minimum pages per round (X) higher than the maximum per round (Y) for -M.\n");
+  // -- Watermarks have to be real percentages, and the sweeper can't stop above where it starts.
+  if (opts.watermark_high == 0 || opts.watermark_high > 100 || opts.watermark_low == 0 || opts.watermark_low > opts.watermark_high)
+    show_error(E_BAD_CLI, "The watermarks (-W X,Y,Z) need 0 < low (Y) <= high (X) <= 100.  You sent %"PRIu8" and %"PRIu8".\n", opts.watermark_high, opts.watermark_low);
+  if (opts.overcommit > 100)
+    show_error(E_BAD_CLI, "The overcommit (-W X,Y,Z) can't be more than 100%%, not %"PRIu8".\n", opts.overcommit);
+  // -- Only the clock can split its hand by ID range.
+  if (opts.sweep_hands > 1 && opts.policy_id != POLICY_CLOCK)
+    show_error(E_BAD_CLI, "More than one sweep hand (-H) needs the clock policy (-P clock).  The other policies keep one hand per tier.\n");
+  // -- Popularity windows have to keep some, but not all, of a buffer's popularity each rotation.
+  if ((opts.window_ns != 0 || opts.window_hits != 0) && (opts.window_decay == 0 || opts.window_decay > 99))
+    show_error(E_BAD_CLI, "The window decay (-Z X,Y) needs to be 1 to 99, not %"PRIu8".\n", opts.window_decay);
+  // -- A spill file has to be big enough to cut into a few segments.
+  if (opts.spill_path != NULL && opts.spill_bytes < (uint64_t)SPILL_MIN_SEGMENTS * SPILL_SEGMENT_SIZE)
+    show_error(E_BAD_CLI, "The spill file (-S X,Y) needs to be at least %d bytes, not %"PRIu64".\n", SPILL_MIN_SEGMENTS * SPILL_SEGMENT_SIZE, opts.spill_bytes);
+  // -- Only zlib and zstd can use a dictionary, and it has to be a size we can train.  Adaptive lists use it for their zstd pages.
+  if (opts.dict_size != 0 && opts.compressor_id != ZLIB_COMPRESSOR_ID && opts.compressor_id != ZSTD_COMPRESSOR_ID && opts.compressor_id != ADAPTIVE_COMPRESSOR_ID)
+    show_error(E_BAD_CLI, "Dictionaries (-T) need the zlib, zstd, or adaptive compressor (-c).\n");
+  if (opts.dict_size != 0 && (opts.dict_size < DICT_MIN_SIZE || opts.dict_size > DICT_MAX_SIZE))
+    show_error(E_BAD_CLI, "The dictionary size (-T) needs to be %d to %d bytes, not %"PRIu32".\n", DICT_MIN_SIZE, DICT_MAX_SIZE, opts.dict_size);
 
   return;
 }
@@ -249,35 +393,62 @@ void options__show_help() {
   fprintf(stderr, "tyche - Example Program for the Adaptive Compressed Cache Replacement Strategy (ACCRS)\n");
   fprintf(stderr, "        This is an implementation of ACCRS and is NOT intended as a tool or API!\n");
   fprintf(stderr, "\n");
-  fprintf(stderr, "  Usage: tyche <-p pages_directory> <-m memory_size> [-bBcCdDfhmnpqrtUwXv]\n");
+  fprintf(stderr, "  Usage: tyche <-p pages_directory> <-m memory_size> [-AbBcCdDfhHImnpPqrstTUwWXvZ]\n");
   fprintf(stderr, "     ex: tyche -d /data/pages/8k -m 10000000\n");
   fprintf(stderr, "\n");
   fprintf(stderr, "  Options:\n");
+  fprintf(stderr, "    %2s   %-13s   %s", "-A", "",               "Admission filter.  When the raw list is full, only admit new buffers used more than the next victim (TinyLFU).\n");
   fprintf(stderr, "    %2s   %-13s   %s", "-b", "<number>",       "Maximum number of bytes to use from the data pages.  Default: unlimited.\n");
   fprintf(stderr, "    %2s   %-13s   %s", "-B", "X,Y",            "Bias to simulate page popularity.  For example: -B 20,80 would mean:\n");
   fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "  X) Percentage of data set that is popular; aka the Bias Percentage.\n");
   fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "  Y) Percentage of hits that the popular buffers should make up; aka the Bias Aggregate.\n");
   fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "     The above would mimic the Pareto Principle (80/20 Rule) in our usage pattern.\n");
-  fprintf(stderr, "    %2s   %-13s   %s", "-c", "lz4,zlib,zstd",  "Which compressor to use: defaults to lz4.\n");
+  fprintf(stderr, "    %2s   %-13s   %s", "-c", "<name>",         "Which compressor to use: lz4, zlib, zstd, or adaptive (lz4 or zstd per page).  Defaults to lz4.\n");
   fprintf(stderr, "    %2s   %-13s   %s", "-C", "",               "Disable compression steps (for testing list management speeds).\n");
   fprintf(stderr, "    %2s   %-13s   %s", "-d", "<number>",       "Duration to run tyche, in seconds (+/- 1 sec).  Default: 5 sec\n");
   fprintf(stderr, "    %2s   %-13s   %s", "-D", "0 - 100",        "Percentage of times a worker should delete the buffers it finds.\n");
-  fprintf(stderr, "    %2s   %-13s   %s", "-f", "1 - 100",        "Fixed ratio.  Percentage RAM guaranteed for the raw buffer list.  Default: disabled (-1)\n");
+  fprintf(stderr, "    %2s   %-13s   %s", "-f", "1 - 100",        "Fixed ratio.  Percentage RAM guaranteed for the raw buffer list.  Default: disabled (-1), the sweeper adapts it.\n");
+  fprintf(stderr, "    %2s   %-13s   %s", "-g", "",               "Workers get each round's buffers with one batched, sorted search.  Default: one at a time.\n");
+  fprintf(stderr, "    %2s   %-13s   %s", "-G", "1 - 255",        "Like -g, but interleave this many lookups at once to overlap cache misses (locking index).\n");
   fprintf(stderr, "    %2s   %-13s   %s", "-h", "",               "Show this help.\n");
+  fprintf(stderr, "    %2s   %-13s   %s", "-H", "1 - 64",         "Clock hands to split the sweeper's raw pass across, each over its own ID range.  Default: 1\n");
+  fprintf(stderr, "    %2s   %-13s   %s", "-I", "<mode>",         "Index mode.  Default: locking.\n");
+  fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "  locking)  The original skiplist; writers lock buffers along their path.\n");
+  fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "  lockfree) CAS-based skiplist with epoch-based reclamation.\n");
+  fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "  fatnode)  B-skiplist of cache-line sized nodes searched with SIMD compares.\n");
+  fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "  hash)     Adds a hash table for point lookups.  Combine with the above, e.g.: fatnode+hash\n");
   fprintf(stderr, "    %2s   %-13s   %s", "-m", "<number>",       "Maximum number of bytes (RAM) to use for all buffers.  Default: 10 MB.\n");
   fprintf(stderr, "    %2s   %-13s   %s", "-M", "X,Y",            "Minimum (X) and maximum (Y) pages to use per round by workers.  Default: 5,5\n");
   fprintf(stderr, "    %2s   %-13s   %s", "-n", "<number>",       "Maximum number of pages to use from the sample data pages.  Default: unlimited.\n");
   fprintf(stderr, "    %2s   %-13s   %s", "-p", "/some/dir",      "The directory to scan for pages of sample data.  Default: ./sample_data.\n");
+  fprintf(stderr, "    %2s   %-13s   %s", "-P", "<policy>",       "Replacement policy the sweeper uses for each tier.  Default: clock.\n");
+  fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "  clock)    The original clock; popularity is halved until a buffer reaches 0.\n");
+  fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "  clockpro) CLOCK-Pro; hot and cold buffers, with a test period for new ones.\n");
+  fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "  arc)      ARC, run as CAR (its clock form) with B1/B2 ghost lists.\n");
+  fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "  s3fifo)   S3-FIFO; a small FIFO filters one-hit wonders from the main queue.\n");
+  fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "  gdsf)     GreedyDual-Size-Frequency; weighs hits against size and measured decompress/reload cost.\n");
   fprintf(stderr, "    %2s   %-13s   %s", "-q", "",               "Suppress most output, namely tracking/status.  Default: false.\n");
   fprintf(stderr, "    %2s   %-13s   %s", "-r", "1 - 100",        "Hit Ratio to ensure as a minimum (by searching raw list when too low).  Default: disabled (-1)\n");
+  fprintf(stderr, "    %2s   %-13s   %s", "-s", "X,Y",            "Sweep in slices of at most X ns and Y victims, resuming where the last left off.  Default: 0,0 (unlimited)\n");
+  fprintf(stderr, "    %2s   %-13s   %s", "-S", "X,Y",            "Spill compressed evictions to a log-structured file instead of dropping them.  Default: off\n");
+  fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "  X) Path of the spill file, e.g.: /tmp/tyche.spill.  Removed when tyche exits.\n");
+  fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "  Y) Most bytes the file may use.  Default: 256 MB.\n");
   fprintf(stderr, "    %2s   %-13s   %s", "-t", "test_name",      "Run an internal test.  Specify 'help' to see available tests.  (For debugging).\n");
+  fprintf(stderr, "    %2s   %-13s   %s", "-T", "<number>",       "Train zlib/zstd dictionaries of this many bytes from sampled pages, e.g.: 16384.  Default: off\n");
   fprintf(stderr, "    %2s   %-13s   %s", "-U", "0 - 100",        "Percentage of times a worker should update the buffers' data it finds.\n");
   fprintf(stderr, "    %2s   %-13s   %s", "-w", "<number>",       "Number of workers (threads) to use while testing.  Defaults to CPU count.\n");
+  fprintf(stderr, "    %2s   %-13s   %s", "-W", "X,Y,Z",          "Watermarks, as percentages of each tier's max size.  Default: 95,90,5\n");
+  fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "  X) High.  The sweeper starts reclaiming in the background once a tier passes this.\n");
+  fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "  Y) Low.  The sweeper reclaims until the tier is back down to this.\n");
+  fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "  Z) Overcommit.  Workers only wait on the sweeper once the raw tier is this far past its max.\n");
   fprintf(stderr, "    %2s   %-13s   %s", "-X", "opt1,opt2",      "Extended options for tests that require it.  Specify -X 'help' for information.\n");
   fprintf(stderr, "    %2s   %-13s   %s", "-v", "",               "Increase verbosity.  Repeat to increment level.  Current levels:\n");
   fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "  0) Show normal output (default).  Update frequency is 0.25s. \n");
   fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "  1) Increase update frequency to 0.1s.  Show a list summary at the end.\n");
   fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "  2) Increase update frequency to 0.01s.  Show list summary.  Display ENTIRE list structure!\n");
+  fprintf(stderr, "    %2s   %-13s   %s", "-Z", "X,Y",            "Popularity windows.  Buffers' popularity decays once per window, not per pass of the clock.  Default: off\n");
+  fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "  X) Window length:  a number of hits, or of milliseconds with an 'ms' suffix (e.g.: 100ms).\n");
+  fprintf(stderr, "    %2s   %-13s   %s",   "", "",               "  Y) Percent of its popularity a buffer keeps each window.  Default: 50\n");
   fprintf(stderr, "(Note, capital options are usually for advanced use only.)\n");
   fprintf(stderr, "\n");
 
@@ -298,8 +469,30 @@ void options__show_extended_test_options() {
   fprintf(stderr, "  d) Number of read operations to perform for each worker.\n");
   fprintf(stderr, "  e) Time to spent, in milliseconds, 'using' the buffer for each read.  Helps simulate usage for pinning.\n");
   fprintf(stderr, "  f) Number of workers to spawn for reading.  Each one will do read_operations (d above) reads each.\n");
+  fprintf(stderr, "compression_benchmark: a,b\n");
+  fprintf(stderr, "  a) Number of sample pages to compress.  Default: 2,000 (or every page, if there are fewer).\n");
+  fprintf(stderr, "  b) Number of rounds over the pages for each codec and method.  Default: 500.\n");
   fprintf(stderr, "elements: a\n");
   fprintf(stderr, "  a) Number of Buffer elements to add/remove from the list.\n");
+  fprintf(stderr, "index_benchmark: a,b,c\n");
+  fprintf(stderr, "  a) Number of Buffer elements to add/remove in each index mode.  Rounded down to a multiple of b.\n");
+  fprintf(stderr, "  b) Number of workers (threads) to run each phase with.\n");
+  fprintf(stderr, "  c) Number of searches each worker performs in the search phase.\n");
+  fprintf(stderr, "interleaved_lookups: a,b,c\n");
+  fprintf(stderr, "  a) Number of Buffer elements in the list.  Default: 4,000,000.\n");
+  fprintf(stderr, "  b) Number of random lookups to time for each method.  Rounded down to a multiple of c.  Default: 2,000,000.\n");
+  fprintf(stderr, "  c) Number of IDs per list__search_many() batch.  Default: 64.\n");
+  fprintf(stderr, "lookup_latency: a,b,c\n");
+  fprintf(stderr, "  a) Number of Buffer elements in the small list.  Default: 1,000,000.\n");
+  fprintf(stderr, "  b) Number of Buffer elements in the large list.  Default: 10,000,000.\n");
+  fprintf(stderr, "  c) Number of random lookups to time against each index.  Default: 2,000,000.\n");
+  fprintf(stderr, "pin_scaling: a,b,c\n");
+  fprintf(stderr, "  a) Most reader threads to run.  Readers double from 1 up to this.  Default: 64.\n");
+  fprintf(stderr, "  b) Number of pin/search/unpin rounds each reader performs.  Default: 1,000,000.\n");
+  fprintf(stderr, "  c) Microseconds the writer sleeps between taking the write lock.  Default: 1,000.\n");
+  fprintf(stderr, "sweep_hands: a,b\n");
+  fprintf(stderr, "  a) Most sweep hands to run.  Hands double from 1 up to this.  Also the size of the compressor pool.  Default: 4.\n");
+  fprintf(stderr, "  b) Number of pages to fill the raw tier with before each sweep.  Default: 4,000.\n");
   fprintf(stderr, "\n");
 
   return;
@@ -29,13 +29,30 @@ struct options {
   int8_t fixed_ratio;           // If non-negative, enforce raw list to this ratio when balancing.
   uint16_t workers;             // Number of worker threads to use simultaneously.
   uint16_t cpu_count;           // Number of CPUs/cores available.
+  uint8_t watermark_high;       // Percent of a tier's max size at which the sweeper starts reclaiming in the background.
+  uint8_t watermark_low;        // Percent of a tier's max size the sweeper reclaims down to.
+  uint8_t overcommit;           // Percent the raw tier may run past its max before workers have to wait on the sweeper.
+  uint64_t slice_budget_ns;     // Most ns the sweeper spends in one slice of a sweep.  0 == no limit.
+  uint32_t slice_victims;       // Most victims the sweeper takes in one slice of a sweep.  0 == no limit.
+  uint8_t sweep_hands;          // Clock hands the raw pass of a sweep is split across, each over its own range of IDs.
 
   /* Tyche Management */
   uint16_t duration;            // Amount of time for each worker to run, in seconds (s).
   int compressor_id;            // The ID of the compressor to use for buffer__compress/decompress.
   int compressor_level;         // The level of zlib/zstd to use (1-9).  Future option.  For now, always 1.
+  int index_mode;               // The INDEX_* mode the list should use for its skiplist.
+  int policy_id;                // The POLICY_* replacement policy the sweeper should use.
+  uint8_t admission;            // Should list__add() run new buffers past a TinyLFU admission filter.  0 == No, 1 == Yes.
+  uint64_t window_ns;           // Popularity windows rotate every this many ns.  0 == not timed.
+  uint64_t window_hits;         // Popularity windows rotate every this many hits.  0 (with window_ns 0) == no windows.
+  uint8_t window_decay;         // Percent of a buffer's popularity it keeps each window rotation.
+  char *spill_path;             // File compressed evictions spill to.  NULL == no spill tier.
+  uint64_t spill_bytes;         // Most bytes the spill file may grow to.
+  uint32_t dict_size;           // Bytes of each trained compression dictionary (zlib/zstd).  0 == no dictionaries.
   int min_pages_retrieved;      // The minimum number of pages to find and pin for a "round" in a worker.
   int max_pages_retrieved;      // The maximum number of pages to find and pin for a "round" in a worker.
+  uint8_t batched_reads;        // Should workers resolve each round with one list__search_many() call.  0 == No, 1 == Yes.
+  uint8_t search_interleave;    // Lookups a batched read keeps in flight at once (locking index only).  0 == sorted walks.
   float bias_percent;           // Percentage of data set that is most popular (e.g.: 20%)
   float bias_aggregate;         // Percentage of all hits that the biased buffers represent (e.g.: 80%)
   float update_frequency;       // Percentage of hits that should result in a list__update() too.
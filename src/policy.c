@@ -0,0 +1,1052 @@
+/*
+ * policy.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: Kyle Harper
+ * Description: See policy.h.  Every select_victims() here runs in the sweeper, inside an epoch critical section, without a list
+ *              pin.  That's the same footing the original clock hand always had:  buffers it walks over may be unlinked or replaced
+ *              under it, but never freed, so hands just skip anything that isn't a live member of the tier they're working on.
+ */
+
+/* Include Headers */
+#include <pthread.h>
+#include <jemalloc/jemalloc.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "buffer.h"
+#include "ghost.h"
+#include "list.h"
+#include "policy.h"
+#include "window.h"
+
+
+/* Extern the error codes we'll use. */
+extern const int E_OK;
+extern const int E_NO_MEMORY;
+
+/* Buffers are charged their overhead in every tier, same as list.c does. */
+extern const int BUFFER_OVERHEAD;
+
+/* The policy table.  Order MUST match the POLICY_* globals. */
+const ReplacementPolicy POLICIES[POLICY_COUNT] = {
+  {"clock",    policy__clock_initialize,     policy__clock_destroy, policy__clock_hit,      policy__clock_insert,     policy__clock_remove,     policy__clock_replace, policy__clock_select_victims,     policy__clock_next_victim,    policy__clock_show_structure},
+  {"clockpro", policy__clock_pro_initialize, policy__destroy_data,  policy__referenced_hit, policy__clock_pro_insert, policy__clock_pro_remove, policy__no_replace,    policy__clock_pro_select_victims, policy__cold_next_victim,     policy__show_data},
+  {"arc",      policy__arc_initialize,       policy__destroy_data,  policy__referenced_hit, policy__arc_insert,       policy__arc_remove,       policy__no_replace,    policy__arc_select_victims,       policy__cold_next_victim,     policy__show_data},
+  {"s3fifo",   policy__s3_fifo_initialize,   policy__destroy_data,  policy__s3_fifo_hit,    policy__s3_fifo_insert,   policy__s3_fifo_remove,   policy__no_replace,    policy__s3_fifo_select_victims,   policy__s3_fifo_next_victim,  policy__show_data},
+  {"gdsf",     policy__clock_initialize,     policy__clock_destroy, policy__gdsf_hit,       policy__gdsf_insert,      policy__clock_remove,     policy__clock_replace, policy__gdsf_select_victims,      policy__gdsf_next_victim,     policy__gdsf_show_structure},
+};
+
+/* Shorthand for a list's per-tier policy state. */
+#define POLICY_TIER(list, tier) (&((PolicyData *)(list)->policy_data)->tiers[(tier)])
+#define CLOCK_RING(list, tier)  (&((ClockData *)(list)->policy_data)->rings[(tier)])
+
+
+
+/*
+ * +---------+
+ * | Helpers |
+ * +---------+
+ */
+
+/* policy__find
+ * Returns the index in POLICIES[] of the policy called name, or -1.
+ */
+int policy__find(const char *name) {
+  for(int i=0; i<POLICY_COUNT; i++)
+    if(strcmp(POLICIES[i].name, name) == 0)
+      return i;
+  return -1;
+}
+
+
+/* policy__locate
+ * Returns the first buffer with an ID of id or greater, or ->head if there isn't one.  Caller MUST be in an epoch critical section.
+ */
+Buffer* policy__locate(List *list, bufferid_t id) {
+  Buffer *buf = list__scan_seek(list, id);
+  do {
+    buf = LF_UNMARK(buf->next);
+  } while(buf != list->head && buf->id < id);
+  return buf;
+}
+
+
+/* policy__advance
+ * Moves a hand to the next buffer, stepping over ->head and counting a lap each time it does.
+ */
+Buffer* policy__advance(List *list, Buffer *hand, uint32_t *laps) {
+  hand = LF_UNMARK(hand->next);
+  if(hand == list->head) {
+    (*laps)++;
+    hand = LF_UNMARK(hand->next);
+  }
+  return hand;
+}
+
+
+/* policy__in_tier
+ * Whether a hand should consider buf for tier:  it's a live buffer in that tier and nobody (including an earlier pick) has it.
+ */
+bool policy__in_tier(List *list, Buffer *buf, int tier) {
+  if(buf == list->head || (buf->flags & (pending_sweep | dirty)) || LF_IS_MARKED(buf->next))
+    return false;
+  return ((buf->flags & compressed) != 0) == (tier == TIER_COMP);
+}
+
+
+/* policy__spare
+ * Whether a clock hand should pass over buf even though its popularity is gone, because the popularity windows have it in the hot
+ * set.  Only for the first half of POLICY_MAX_LAPS, so a hot set bigger than the tier can't stall a sweep.
+ */
+bool policy__spare(List *list, Buffer *buf, uint32_t laps) {
+  if(list->windows == NULL || laps >= POLICY_MAX_LAPS / 2 || !window__is_hot(list->windows, buf))
+    return false;
+  __atomic_add_fetch(&list->windows->spared, 1, __ATOMIC_RELAXED);
+  return true;
+}
+
+
+/* policy__size
+ * Bytes buf takes up in tier.
+ */
+uint32_t policy__size(Buffer *buf, int tier) {
+  return BUFFER_OVERHEAD + (tier == TIER_COMP ? buf->comp_length : buf->data_length);
+}
+
+
+/* policy__set_state
+ * Sets and clears bits in buf->policy_state without losing a concurrent hit's bits.
+ */
+void policy__set_state(Buffer *buf, uint8_t set, uint8_t clear) {
+  uint8_t state = buf->policy_state;
+  while(!__sync_bool_compare_and_swap(&buf->policy_state, state, (uint8_t)((state & ~clear) | set)))
+    state = buf->policy_state;
+  return;
+}
+
+
+/* policy__initialize_data
+ * Builds a PolicyData for the list with whichever ghost lists and queues the policy wants.  Ghost lists can remember up to
+ * max_memory worth of buffers, which is the most either tier can ever hold.
+ */
+int policy__initialize_data(List *list, uint64_t max_memory, bool ghosts, bool hot_ghosts, bool queue) {
+  PolicyData *pd = (PolicyData *)calloc(1, sizeof(PolicyData));
+  if(pd == NULL)
+    return E_NO_MEMORY;
+  list->policy_data = pd;
+  for(int tier=0; tier<TIER_COUNT; tier++) {
+    PolicyTier *pt = &pd->tiers[tier];
+    pthread_mutex_init(&pt->queue_lock, NULL);
+    if(ghosts && ghost__initialize(&pt->ghosts, max_memory, BUFFER_OVERHEAD + GHOST_EXPECTED_SIZE) != E_OK)
+      return E_NO_MEMORY;
+    if(hot_ghosts && ghost__initialize(&pt->hot_ghosts, max_memory, BUFFER_OVERHEAD + GHOST_EXPECTED_SIZE) != E_OK)
+      return E_NO_MEMORY;
+    if(queue) {
+      pt->queue = (bufferid_t *)malloc(POLICY_QUEUE_MIN * sizeof(bufferid_t));
+      if(pt->queue == NULL)
+        return E_NO_MEMORY;
+      pt->queue_mask = POLICY_QUEUE_MIN - 1;
+    }
+  }
+  return E_OK;
+}
+
+
+/* policy__destroy_data
+ * Frees whatever policy__initialize_data() built.
+ */
+void policy__destroy_data(List *list) {
+  PolicyData *pd = (PolicyData *)list->policy_data;
+  if(pd == NULL)
+    return;
+  for(int tier=0; tier<TIER_COUNT; tier++) {
+    ghost__destroy(pd->tiers[tier].ghosts);
+    ghost__destroy(pd->tiers[tier].hot_ghosts);
+    free(pd->tiers[tier].queue);
+    pthread_mutex_destroy(&pd->tiers[tier].queue_lock);
+  }
+  free(pd);
+  list->policy_data = NULL;
+  return;
+}
+
+
+/* policy__show_data
+ * Prints the state of a PolicyData-based policy for list__show_structure().
+ */
+void policy__show_data(List *list) {
+  const char *TIER_NAMES[TIER_COUNT] = {"raw", "comp"};
+  printf("Replacement policy              : %s\n", list->policy->name);
+  for(int tier=0; tier<TIER_COUNT; tier++) {
+    PolicyTier *pt = POLICY_TIER(list, tier);
+    printf("  %-4s tier                     : %'"PRId64" hot, %'"PRId64" cold (target %'"PRId64").  %'"PRIu64" promotions, %'"PRIu64" demotions, %'"PRIu64" ghost hits\n",
+           TIER_NAMES[tier], pt->hot_count, pt->cold_count, pt->target, pt->promotions, pt->demotions,
+           (pt->ghosts != NULL ? pt->ghosts->hits : 0) + (pt->hot_ghosts != NULL ? pt->hot_ghosts->hits : 0));
+  }
+  return;
+}
+
+
+/* policy__no_replace
+ * For policies that keep hands by ID.  new_buffer already carries buf's policy_state, so there's nothing to move.
+ */
+void policy__no_replace(List *list, Buffer *buf, Buffer *new_buffer) {
+  (void)list;
+  (void)buf;
+  (void)new_buffer;
+  return;
+}
+
+
+
+/*
+ * +-------+
+ * | Clock |
+ * +-------+
+ * The original sweeper:  hits bump popularity; a hand halves it, and anything it finds at 0 is a victim.  Each tier has a ring and a
+ * hand of its own (ClockData), so a raw pass never walks compressed buffers or the other way around.  With popularity windows on,
+ * buffers in their hot set are spared for the first few laps.
+ */
+
+/* policy__clock_initialize
+ * Builds an empty ring for each tier.  Each ring is just its sentinel, with the hand resting on it.
+ */
+int policy__clock_initialize(List *list, uint64_t max_memory) {
+  (void)max_memory;
+  ClockData *cd = (ClockData *)calloc(1, sizeof(ClockData));
+  if(cd == NULL)
+    return E_NO_MEMORY;
+  for(int tier=0; tier<TIER_COUNT; tier++) {
+    ClockRing *ring = &cd->rings[tier];
+    ring->sentinel.id = BUFFER_ID_MAX;
+    ring->sentinel.ring_prev = &ring->sentinel;
+    ring->sentinel.ring_next = &ring->sentinel;
+    ring->hand = &ring->sentinel;
+    pthread_mutex_init(&ring->lock, NULL);
+  }
+  list->policy_data = cd;
+  return E_OK;
+}
+
+
+/* policy__clock_destroy
+ * Frees the rings.  The buffers in them belong to the list.
+ */
+void policy__clock_destroy(List *list) {
+  ClockData *cd = (ClockData *)list->policy_data;
+  if(cd == NULL)
+    return;
+  for(int tier=0; tier<TIER_COUNT; tier++)
+    pthread_mutex_destroy(&cd->rings[tier].lock);
+  free(cd);
+  list->policy_data = NULL;
+  return;
+}
+
+
+/* policy__clock_hit
+ * Bumps popularity.
+ */
+void policy__clock_hit(List *list, Buffer *buf) {
+  (void)list;
+  buffer__touch(buf);
+  return;
+}
+
+
+/* policy__clock_link
+ * Puts buf just behind the hand, so it gets a full lap before the hand looks at it.  Caller MUST hold the ring's lock.
+ */
+void policy__clock_link(ClockRing *ring, Buffer *buf) {
+  buf->ring_next = ring->hand;
+  buf->ring_prev = ring->hand->ring_prev;
+  buf->ring_prev->ring_next = buf;
+  ring->hand->ring_prev = buf;
+  ring->count++;
+  return;
+}
+
+
+/* policy__clock_unlink
+ * Takes buf out of the ring, backing the hand up first if it's resting on buf.  Caller MUST hold the ring's lock.
+ */
+void policy__clock_unlink(ClockRing *ring, Buffer *buf) {
+  if(ring->hand == buf)
+    ring->hand = buf->ring_prev;
+  buf->ring_prev->ring_next = buf->ring_next;
+  buf->ring_next->ring_prev = buf->ring_prev;
+  buf->ring_prev = NULL;
+  buf->ring_next = NULL;
+  ring->count--;
+  return;
+}
+
+
+/* policy__clock_insert
+ * Links buf into tier's ring.  A buffer someone is already removing or updating stays out; remove() may have come and gone, and
+ * replace() takes care of the copy.
+ */
+void policy__clock_insert(List *list, Buffer *buf, int tier) {
+  ClockRing *ring = CLOCK_RING(list, tier);
+  pthread_mutex_lock(&ring->lock);
+  if((buf->flags & dirty) == 0 && buf->ring_next == NULL) {
+    policy__clock_link(ring, buf);
+    policy__set_state(buf, tier == TIER_COMP ? POLICY_COMP_RING : 0, tier == TIER_COMP ? 0 : POLICY_COMP_RING);
+  }
+  pthread_mutex_unlock(&ring->lock);
+  return;
+}
+
+
+/* policy__clock_remove
+ * Unlinks buf from whichever ring it's in.  Callers pass the tier from buf->flags, which can be a step behind a compressor moving
+ * the buffer, so both rings are locked and the buffer's own POLICY_COMP_RING bit decides.
+ */
+void policy__clock_remove(List *list, Buffer *buf, int tier) {
+  (void)tier;
+  ClockData *cd = (ClockData *)list->policy_data;
+  pthread_mutex_lock(&cd->rings[TIER_RAW].lock);
+  pthread_mutex_lock(&cd->rings[TIER_COMP].lock);
+  if(buf->ring_next != NULL)
+    policy__clock_unlink(&cd->rings[buf->policy_state & POLICY_COMP_RING ? TIER_COMP : TIER_RAW], buf);
+  pthread_mutex_unlock(&cd->rings[TIER_COMP].lock);
+  pthread_mutex_unlock(&cd->rings[TIER_RAW].lock);
+  return;
+}
+
+
+/* policy__clock_replace
+ * Splices new_buffer into buf's place, hand and all.  If buf wasn't linked (a compressor was between rings with it), new_buffer goes
+ * into the ring for buf's tier instead, since the compressor's insert() will see buf is dirty and skip it.
+ */
+void policy__clock_replace(List *list, Buffer *buf, Buffer *new_buffer) {
+  ClockData *cd = (ClockData *)list->policy_data;
+  pthread_mutex_lock(&cd->rings[TIER_RAW].lock);
+  pthread_mutex_lock(&cd->rings[TIER_COMP].lock);
+  const int TIER = buf->ring_next != NULL ? (buf->policy_state & POLICY_COMP_RING ? TIER_COMP : TIER_RAW) : (buf->flags & compressed ? TIER_COMP : TIER_RAW);
+  ClockRing *ring = &cd->rings[TIER];
+  policy__set_state(new_buffer, TIER == TIER_COMP ? POLICY_COMP_RING : 0, TIER == TIER_COMP ? 0 : POLICY_COMP_RING);
+  if(buf->ring_next == NULL) {
+    policy__clock_link(ring, new_buffer);
+  } else {
+    new_buffer->ring_prev = buf->ring_prev;
+    new_buffer->ring_next = buf->ring_next;
+    new_buffer->ring_prev->ring_next = new_buffer;
+    new_buffer->ring_next->ring_prev = new_buffer;
+    if(ring->hand == buf)
+      ring->hand = new_buffer;
+    buf->ring_prev = NULL;
+    buf->ring_next = NULL;
+  }
+  pthread_mutex_unlock(&cd->rings[TIER_COMP].lock);
+  pthread_mutex_unlock(&cd->rings[TIER_RAW].lock);
+  return;
+}
+
+
+/* policy__clock_select_victims
+ * Runs tier's hand around its ring until it has enough victims.  Popularity is halved until a victim is found.  The ring's lock is
+ * let go every POLICY_RING_STEPS buffers so inserts and removes aren't stuck behind a long sweep.
+ */
+uint32_t policy__clock_select_victims(List *list, int tier, uint64_t bytes_needed, Buffer **victims, uint32_t max_victims, uint64_t *bytes_selected) {
+  ClockRing *ring = CLOCK_RING(list, tier);
+  uint32_t count = 0, laps = 0, steps = 0;
+  Buffer *hand = NULL;
+
+  pthread_mutex_lock(&ring->lock);
+  while(count < max_victims && *bytes_selected < bytes_needed && laps < POLICY_MAX_LAPS && ring->count > 0) {
+    if(++steps % POLICY_RING_STEPS == 0) {
+      pthread_mutex_unlock(&ring->lock);
+      pthread_mutex_lock(&ring->lock);
+    }
+    ring->hand = ring->hand->ring_next;
+    hand = ring->hand;
+    if(hand == &ring->sentinel) {
+      laps++;
+      continue;
+    }
+    if(hand->popularity != 0) {
+      hand->popularity >>= 1;
+      continue;
+    }
+    // Buffers already pending for sweep, being removed or updated, or still on their way from the other tier are skipped.
+    if(!policy__in_tier(list, hand, tier) || policy__spare(list, hand, laps))
+      continue;
+    __sync_fetch_and_or(&hand->flags, pending_sweep);
+    victims[count] = hand;
+    count++;
+    *bytes_selected += policy__size(hand, tier);
+  }
+  pthread_mutex_unlock(&ring->lock);
+  return count;
+}
+
+
+/* policy__clock_select_range
+ * The clock for one of several sweep hands:  the same popularity halving, but only over raw buffers with IDs in [hand->low,
+ * hand->high), wrapping back to hand->low at the end of the range.  Compressed buffers are left for the comp tier's pass, so hands
+ * never share anything but the compressor pool.  Called from hand threads, each inside its own epoch.
+ */
+uint32_t policy__clock_select_range(List *list, SweepHand *hand, uint64_t bytes_needed, Buffer **victims, uint32_t max_victims, uint64_t *bytes_selected) {
+  uint32_t count = 0, laps = 0;
+  Buffer *buf = policy__locate(list, hand->position < hand->low || hand->position >= hand->high ? hand->low : hand->position);
+
+  while(count < max_victims && *bytes_selected < bytes_needed && laps < POLICY_MAX_LAPS) {
+    if(buf == list->head || buf->id >= hand->high) {
+      laps++;
+      buf = policy__locate(list, hand->low);
+      // Nothing at all in the range.
+      if(buf == list->head || buf->id >= hand->high)
+        break;
+      continue;
+    }
+    if((buf->flags & compressed) == 0) {
+      if(buf->popularity == 0) {
+        if(policy__in_tier(list, buf, TIER_RAW) && !policy__spare(list, buf, laps)) {
+          __sync_fetch_and_or(&buf->flags, pending_sweep);
+          victims[count] = buf;
+          count++;
+          *bytes_selected += policy__size(buf, TIER_RAW);
+        }
+      } else {
+        buf->popularity >>= 1;
+      }
+    }
+    buf = LF_UNMARK(buf->next);
+  }
+  hand->position = (buf == list->head || buf->id >= hand->high) ? hand->low : buf->id;
+  return count;
+}
+
+
+/* policy__clock_next_victim
+ * The first buffer in tier past the hand with no popularity left, or the least popular one it passes on the way.
+ */
+bufferid_t policy__clock_next_victim(List *list, int tier) {
+  ClockRing *ring = CLOCK_RING(list, tier);
+  bufferid_t best = BUFFER_ID_MAX;
+  popularity_t best_popularity = MAX_POPULARITY;
+  pthread_mutex_lock(&ring->lock);
+  Buffer *hand = ring->hand;
+  for(int64_t i=0; i<POLICY_PEEK_LIMIT && i<=ring->count; i++) {
+    hand = hand->ring_next;
+    if(hand == &ring->sentinel || !policy__in_tier(list, hand, tier))
+      continue;
+    if(hand->popularity == 0) {
+      best = hand->id;
+      break;
+    }
+    if(best == BUFFER_ID_MAX || hand->popularity < best_popularity) {
+      best = hand->id;
+      best_popularity = hand->popularity;
+    }
+  }
+  pthread_mutex_unlock(&ring->lock);
+  return best;
+}
+
+
+/* policy__clock_show_structure
+ * Prints how many buffers each ring holds.
+ */
+void policy__clock_show_structure(List *list) {
+  const char *TIER_NAMES[TIER_COUNT] = {"raw", "comp"};
+  printf("Replacement policy              : %s\n", list->policy->name);
+  for(int tier=0; tier<TIER_COUNT; tier++)
+    printf("  %-4s ring                     : %'"PRId64" buffers\n", TIER_NAMES[tier], CLOCK_RING(list, tier)->count);
+  return;
+}
+
+
+
+/*
+ * +-----------+
+ * | CLOCK-Pro |
+ * +-----------+
+ * Pages are hot or cold.  New pages start cold and in their test period.  A cold page hit during its test period has a shorter
+ * reuse distance than the hot pages, so the cold hand promotes it; one hit outside its test period just starts a new one; no hit
+ * makes it a victim.  The hot hand keeps hot pages within (resident - cold target) by demoting unreferenced ones, and ends the test
+ * period of cold pages it passes.  A page that leaves while in its test period becomes a non-resident test page (a ghost); if it
+ * comes back before it ages out, it comes back hot and the cold target grows.  Test periods that run out shrink it again.
+ */
+
+/* policy__clock_pro_initialize
+ * One ghost list per tier for non-resident test pages.
+ */
+int policy__clock_pro_initialize(List *list, uint64_t max_memory) {
+  return policy__initialize_data(list, max_memory, true, false, false);
+}
+
+
+/* policy__referenced_hit
+ * Sets the reference bit.  Shared by CLOCK-Pro and ARC.  Skips the write when it's already set so hot buffers stay read-only.
+ */
+void policy__referenced_hit(List *list, Buffer *buf) {
+  (void)list;
+  if((buf->policy_state & POLICY_REFERENCED) == 0)
+    __sync_fetch_and_or(&buf->policy_state, POLICY_REFERENCED);
+  return;
+}
+
+
+/* policy__clock_pro_insert
+ * New pages start cold and in their test period.  Pages whose test period was still running come back hot.
+ */
+void policy__clock_pro_insert(List *list, Buffer *buf, int tier) {
+  PolicyTier *pt = POLICY_TIER(list, tier);
+  if(ghost__take(pt->ghosts, buf->id, true)) {
+    buf->policy_state = POLICY_HOT;
+    __sync_fetch_and_add(&pt->hot_count, 1);
+    __sync_fetch_and_add(&pt->target, 1);
+    return;
+  }
+  buf->policy_state = POLICY_TEST;
+  __sync_fetch_and_add(&pt->cold_count, 1);
+  return;
+}
+
+
+/* policy__clock_pro_remove
+ * Cold pages still in their test period stay in the test as ghosts.
+ */
+void policy__clock_pro_remove(List *list, Buffer *buf, int tier) {
+  PolicyTier *pt = POLICY_TIER(list, tier);
+  if(buf->policy_state & POLICY_HOT) {
+    __sync_fetch_and_sub(&pt->hot_count, 1);
+    return;
+  }
+  __sync_fetch_and_sub(&pt->cold_count, 1);
+  if(buf->policy_state & POLICY_TEST)
+    ghost__insert(pt->ghosts, buf->id, policy__size(buf, tier));
+  return;
+}
+
+
+/* policy__clock_pro_select_victims
+ * Runs the cold hand for victims, running the hot hand first whenever hot pages are over their share.
+ */
+uint32_t policy__clock_pro_select_victims(List *list, int tier, uint64_t bytes_needed, Buffer **victims, uint32_t max_victims, uint64_t *bytes_selected) {
+  PolicyTier *pt = POLICY_TIER(list, tier);
+  uint32_t count = 0, cold_laps = 0, hot_laps = 0;
+  int64_t resident = 0, cold_target = 0;
+  Buffer *cold = policy__locate(list, pt->cold_hand);
+  Buffer *hot = policy__locate(list, pt->hot_hand);
+
+  while(count < max_victims && *bytes_selected < bytes_needed && cold_laps < POLICY_MAX_LAPS) {
+    // Hot pages get whatever the cold target leaves them.
+    resident = pt->hot_count + pt->cold_count;
+    cold_target = pt->target > resident - 1 ? resident - 1 : pt->target;
+    if(cold_target < 1)
+      cold_target = 1;
+    while(pt->hot_count > resident - cold_target && hot_laps < POLICY_MAX_LAPS) {
+      hot = policy__advance(list, hot, &hot_laps);
+      if(!policy__in_tier(list, hot, tier))
+        continue;
+      if(hot->policy_state & POLICY_HOT) {
+        if(hot->policy_state & POLICY_REFERENCED) {
+          policy__set_state(hot, 0, POLICY_REFERENCED);
+          continue;
+        }
+        policy__set_state(hot, 0, POLICY_HOT);
+        __sync_fetch_and_sub(&pt->hot_count, 1);
+        __sync_fetch_and_add(&pt->cold_count, 1);
+        pt->demotions++;
+      } else if(hot->policy_state & POLICY_TEST) {
+        // Its test period ran out without a reuse; cold pages need less room than we thought.
+        policy__set_state(hot, 0, POLICY_TEST);
+        if(pt->target > 0)
+          __sync_fetch_and_sub(&pt->target, 1);
+      }
+    }
+
+    // The cold hand.  Hot pages are the hot hand's business.
+    cold = policy__advance(list, cold, &cold_laps);
+    if(!policy__in_tier(list, cold, tier) || (cold->policy_state & POLICY_HOT))
+      continue;
+    if(cold->policy_state & POLICY_REFERENCED) {
+      if(cold->policy_state & POLICY_TEST) {
+        policy__set_state(cold, POLICY_HOT, POLICY_REFERENCED | POLICY_TEST);
+        __sync_fetch_and_add(&pt->hot_count, 1);
+        __sync_fetch_and_sub(&pt->cold_count, 1);
+        pt->promotions++;
+      } else {
+        policy__set_state(cold, POLICY_TEST, POLICY_REFERENCED);
+      }
+      continue;
+    }
+    __sync_fetch_and_or(&cold->flags, pending_sweep);
+    victims[count] = cold;
+    count++;
+    *bytes_selected += policy__size(cold, tier);
+  }
+  pt->cold_hand = cold->id;
+  pt->hot_hand = hot->id;
+  return count;
+}
+
+
+
+/* policy__cold_next_victim
+ * The first unreferenced cold buffer past the cold hand.  Shared by CLOCK-Pro and ARC (whose cold hand is T1's).  Falls back to the
+ * first cold buffer at all, since the hand clears reference bits as it goes.
+ */
+bufferid_t policy__cold_next_victim(List *list, int tier) {
+  PolicyTier *pt = POLICY_TIER(list, tier);
+  uint32_t laps = 0;
+  bufferid_t first = BUFFER_ID_MAX;
+  Buffer *cold = policy__locate(list, pt->cold_hand);
+  for(int i=0; i<POLICY_PEEK_LIMIT && laps < 2; i++) {
+    cold = policy__advance(list, cold, &laps);
+    if(!policy__in_tier(list, cold, tier) || (cold->policy_state & POLICY_HOT))
+      continue;
+    if((cold->policy_state & POLICY_REFERENCED) == 0)
+      return cold->id;
+    if(first == BUFFER_ID_MAX)
+      first = cold->id;
+  }
+  return first;
+}
+
+
+
+/*
+ * +-----+
+ * | ARC |
+ * +-----+
+ * ARC run as CAR (Clock with Adaptive Replacement) so a hit only sets a reference bit.  T1 holds buffers seen once, T2 buffers
+ * seen again; each has its own hand.  While T1 holds at least its target p, the T1 hand runs:  referenced buffers move to T2 and
+ * unreferenced ones are victims.  Otherwise the T2 hand runs as a plain clock.  Victims leave ghosts in B1 or B2, and a buffer that
+ * comes back through a ghost goes straight to T2 and moves p toward the list that would have kept it, by the ratio of the ghost
+ * lists' sizes, just like ARC.
+ */
+
+/* policy__arc_initialize
+ * B1 and B2 for each tier.
+ */
+int policy__arc_initialize(List *list, uint64_t max_memory) {
+  return policy__initialize_data(list, max_memory, true, true, false);
+}
+
+
+/* policy__arc_insert
+ * New buffers go in T1.  Ghost hits adapt p and go in T2.
+ */
+void policy__arc_insert(List *list, Buffer *buf, int tier) {
+  PolicyTier *pt = POLICY_TIER(list, tier);
+  const int64_t RESIDENT = pt->hot_count + pt->cold_count;
+  const uint64_t B1 = pt->ghosts->bytes, B2 = pt->hot_ghosts->bytes;
+  if(ghost__take(pt->ghosts, buf->id, true)) {
+    __sync_fetch_and_add(&pt->target, B1 > 0 && B2 > B1 ? (int64_t)(B2 / B1) : 1);
+    if(pt->target > RESIDENT)
+      pt->target = RESIDENT;
+  } else if(ghost__take(pt->hot_ghosts, buf->id, true)) {
+    __sync_fetch_and_sub(&pt->target, B2 > 0 && B1 > B2 ? (int64_t)(B1 / B2) : 1);
+    if(pt->target < 0)
+      pt->target = 0;
+  } else {
+    buf->policy_state = 0;
+    __sync_fetch_and_add(&pt->cold_count, 1);
+    return;
+  }
+  buf->policy_state = POLICY_HOT;
+  __sync_fetch_and_add(&pt->hot_count, 1);
+  return;
+}
+
+
+/* policy__arc_remove
+ * Leaves a ghost in B1 or B2, depending on which list it left.
+ */
+void policy__arc_remove(List *list, Buffer *buf, int tier) {
+  PolicyTier *pt = POLICY_TIER(list, tier);
+  if(buf->policy_state & POLICY_HOT) {
+    __sync_fetch_and_sub(&pt->hot_count, 1);
+    ghost__insert(pt->hot_ghosts, buf->id, policy__size(buf, tier));
+    return;
+  }
+  __sync_fetch_and_sub(&pt->cold_count, 1);
+  ghost__insert(pt->ghosts, buf->id, policy__size(buf, tier));
+  return;
+}
+
+
+/* policy__arc_select_victims
+ * Runs the T1 hand while T1 is at or over p, and the T2 hand otherwise.  Either one takes over if the other runs dry.
+ */
+uint32_t policy__arc_select_victims(List *list, int tier, uint64_t bytes_needed, Buffer **victims, uint32_t max_victims, uint64_t *bytes_selected) {
+  PolicyTier *pt = POLICY_TIER(list, tier);
+  uint32_t count = 0, t1_laps = 0, t2_laps = 0;
+  int64_t t1_selected = 0;
+  Buffer *t1 = policy__locate(list, pt->cold_hand);
+  Buffer *t2 = policy__locate(list, pt->hot_hand);
+  Buffer *victim = NULL;
+
+  while(count < max_victims && *bytes_selected < bytes_needed && (t1_laps < POLICY_MAX_LAPS || t2_laps < POLICY_MAX_LAPS)) {
+    if(t1_laps < POLICY_MAX_LAPS && (t2_laps >= POLICY_MAX_LAPS || pt->cold_count - t1_selected >= (pt->target > 1 ? pt->target : 1))) {
+      t1 = policy__advance(list, t1, &t1_laps);
+      if(!policy__in_tier(list, t1, tier) || (t1->policy_state & POLICY_HOT))
+        continue;
+      // Seen again since it got here:  it belongs in T2.
+      if(t1->policy_state & POLICY_REFERENCED) {
+        policy__set_state(t1, POLICY_HOT, POLICY_REFERENCED);
+        __sync_fetch_and_add(&pt->hot_count, 1);
+        __sync_fetch_and_sub(&pt->cold_count, 1);
+        pt->promotions++;
+        continue;
+      }
+      victim = t1;
+      t1_selected++;
+    } else {
+      t2 = policy__advance(list, t2, &t2_laps);
+      if(!policy__in_tier(list, t2, tier) || (t2->policy_state & POLICY_HOT) == 0)
+        continue;
+      if(t2->policy_state & POLICY_REFERENCED) {
+        policy__set_state(t2, 0, POLICY_REFERENCED);
+        continue;
+      }
+      victim = t2;
+    }
+    __sync_fetch_and_or(&victim->flags, pending_sweep);
+    victims[count] = victim;
+    count++;
+    *bytes_selected += policy__size(victim, tier);
+  }
+  pt->cold_hand = t1->id;
+  pt->hot_hand = t2->id;
+  return count;
+}
+
+
+
+/*
+ * +---------+
+ * | S3-FIFO |
+ * +---------+
+ * New buffers go in a small FIFO (a ring of IDs) that aims for POLICY_SMALL_PERCENT of the tier.  When it's over that, the front
+ * buffer moves to the main queue if it was hit more than once, or is a victim (and a ghost) if not.  Otherwise the main queue gives
+ * up a victim:  it's a clock where each hit, up to 3, buys one more trip around.  Buffers that come back while their ghost is still
+ * around skip the small queue.  IDs in the ring go stale when buffers are removed or change tiers; those are skipped at the front.
+ * POLICY_QUEUED marks buffers that have an ID in the ring, so the main hand can re-queue any small-queue buffer that lost its own
+ * (e.g. one a worker updated while it was being compressed).
+ */
+
+/* policy__s3_fifo_initialize
+ * One ghost queue and one small queue per tier.
+ */
+int policy__s3_fifo_initialize(List *list, uint64_t max_memory) {
+  return policy__initialize_data(list, max_memory, true, false, true);
+}
+
+
+/* policy__s3_fifo_hit
+ * Bumps the 2-bit frequency.  Once it's at 3 the buffer is never written again.
+ */
+void policy__s3_fifo_hit(List *list, Buffer *buf) {
+  (void)list;
+  uint8_t state = buf->policy_state;
+  while(POLICY_FREQ(state) < 3) {
+    if(__sync_bool_compare_and_swap(&buf->policy_state, state, (uint8_t)(state + (1 << POLICY_FREQ_SHIFT))))
+      return;
+    state = buf->policy_state;
+  }
+  return;
+}
+
+
+/* policy__s3_fifo_insert
+ * Ghosts go straight to the main queue; everything else starts in the small queue.
+ */
+void policy__s3_fifo_insert(List *list, Buffer *buf, int tier) {
+  PolicyTier *pt = POLICY_TIER(list, tier);
+  if(ghost__take(pt->ghosts, buf->id, true)) {
+    buf->policy_state = POLICY_HOT;
+    __sync_fetch_and_add(&pt->hot_count, 1);
+    return;
+  }
+  buf->policy_state = POLICY_QUEUED;
+  __sync_fetch_and_add(&pt->cold_count, 1);
+  if(policy__s3_fifo_push(pt, buf->id) != E_OK)
+    buf->policy_state = 0;
+  return;
+}
+
+
+/* policy__s3_fifo_remove
+ * Buffers leaving from the small queue leave a ghost.
+ */
+void policy__s3_fifo_remove(List *list, Buffer *buf, int tier) {
+  PolicyTier *pt = POLICY_TIER(list, tier);
+  if(buf->policy_state & POLICY_HOT) {
+    __sync_fetch_and_sub(&pt->hot_count, 1);
+    return;
+  }
+  __sync_fetch_and_sub(&pt->cold_count, 1);
+  ghost__insert(pt->ghosts, buf->id, policy__size(buf, tier));
+  return;
+}
+
+
+/* policy__s3_fifo_select_victims
+ * Drains the small queue while it's over its share (or main is empty), then runs the main hand.
+ */
+uint32_t policy__s3_fifo_select_victims(List *list, int tier, uint64_t bytes_needed, Buffer **victims, uint32_t max_victims, uint64_t *bytes_selected) {
+  PolicyTier *pt = POLICY_TIER(list, tier);
+  uint32_t count = 0, laps = 0;
+  int64_t small_selected = 0, small_target = 0;
+  uint64_t popped = 0;
+  const uint64_t QUEUED = pt->queue_head - pt->queue_tail;
+  bufferid_t id = 0;
+  Buffer *main_hand = policy__locate(list, pt->hot_hand);
+  Buffer *buf = NULL;
+
+  while(count < max_victims && *bytes_selected < bytes_needed && laps < POLICY_MAX_LAPS) {
+    small_target = (pt->hot_count + pt->cold_count) * POLICY_SMALL_PERCENT / 100;
+    if(popped < QUEUED && (pt->cold_count - small_selected > small_target || pt->hot_count <= 0)) {
+      // Only the sweeper pops, so QUEUED bounds this pass even though workers keep pushing.
+      id = policy__s3_fifo_pop(pt);
+      popped++;
+      buf = policy__locate(list, id);
+      // Removed, moved to the other tier, or already promoted:  the ID is stale.
+      if(buf == list->head || buf->id != id || ((buf->flags & compressed) != 0) != (tier == TIER_COMP) || (buf->policy_state & POLICY_HOT))
+        continue;
+      // Busy right now; keep its place in line.
+      if(!policy__in_tier(list, buf, tier)) {
+        policy__s3_fifo_push(pt, id);
+        continue;
+      }
+      if(POLICY_FREQ(buf->policy_state) > 1) {
+        policy__set_state(buf, POLICY_HOT, POLICY_FREQ_MASK | POLICY_QUEUED);
+        __sync_fetch_and_add(&pt->hot_count, 1);
+        __sync_fetch_and_sub(&pt->cold_count, 1);
+        pt->promotions++;
+        continue;
+      }
+      policy__set_state(buf, 0, POLICY_QUEUED);
+      small_selected++;
+    } else {
+      main_hand = policy__advance(list, main_hand, &laps);
+      if(!policy__in_tier(list, main_hand, tier))
+        continue;
+      buf = main_hand;
+      if((buf->policy_state & POLICY_HOT) == 0) {
+        // A small-queue buffer with no place in line.  Give it one.
+        if((buf->policy_state & POLICY_QUEUED) == 0 && policy__s3_fifo_push(pt, buf->id) == E_OK)
+          policy__set_state(buf, POLICY_QUEUED, 0);
+        continue;
+      }
+      if(POLICY_FREQ(buf->policy_state) > 0) {
+        policy__set_state(buf, (uint8_t)((POLICY_FREQ(buf->policy_state) - 1) << POLICY_FREQ_SHIFT), POLICY_FREQ_MASK);
+        continue;
+      }
+    }
+    __sync_fetch_and_or(&buf->flags, pending_sweep);
+    victims[count] = buf;
+    count++;
+    *bytes_selected += policy__size(buf, tier);
+  }
+  pt->hot_hand = main_hand->id;
+  return count;
+}
+
+
+/* policy__s3_fifo_next_victim
+ * The front of the small queue.  It may be stale, or get promoted instead, but it's the next buffer the sweeper will judge.
+ */
+bufferid_t policy__s3_fifo_next_victim(List *list, int tier) {
+  PolicyTier *pt = POLICY_TIER(list, tier);
+  bufferid_t id = BUFFER_ID_MAX;
+  pthread_mutex_lock(&pt->queue_lock);
+  if(pt->queue_tail < pt->queue_head)
+    id = pt->queue[pt->queue_tail & pt->queue_mask];
+  pthread_mutex_unlock(&pt->queue_lock);
+  return id;
+}
+
+
+/* policy__s3_fifo_push
+ * Adds an ID to the back of a tier's small queue, doubling the ring if it's full.
+ */
+int policy__s3_fifo_push(PolicyTier *pt, bufferid_t id) {
+  pthread_mutex_lock(&pt->queue_lock);
+  if(pt->queue_head - pt->queue_tail > pt->queue_mask) {
+    // Unroll the old ring so the front lands at 0.
+    const uint64_t SIZE = (uint64_t)pt->queue_mask + 1;
+    bufferid_t *queue = (bufferid_t *)malloc(SIZE * 2 * sizeof(bufferid_t));
+    if(queue == NULL) {
+      pthread_mutex_unlock(&pt->queue_lock);
+      return E_NO_MEMORY;
+    }
+    for(uint64_t i=0; i<SIZE; i++)
+      queue[i] = pt->queue[(pt->queue_tail + i) & pt->queue_mask];
+    free(pt->queue);
+    pt->queue = queue;
+    pt->queue_tail = 0;
+    pt->queue_head = SIZE;
+    pt->queue_mask = SIZE * 2 - 1;
+  }
+  pt->queue[pt->queue_head & pt->queue_mask] = id;
+  pt->queue_head++;
+  pthread_mutex_unlock(&pt->queue_lock);
+  return E_OK;
+}
+
+
+/* policy__s3_fifo_pop
+ * Takes the ID at the front of a tier's small queue, or BUFFER_ID_MAX if it's empty.
+ */
+bufferid_t policy__s3_fifo_pop(PolicyTier *pt) {
+  bufferid_t id = BUFFER_ID_MAX;
+  pthread_mutex_lock(&pt->queue_lock);
+  if(pt->queue_tail < pt->queue_head) {
+    id = pt->queue[pt->queue_tail & pt->queue_mask];
+    pt->queue_tail++;
+  }
+  pthread_mutex_unlock(&pt->queue_lock);
+  return id;
+}
+
+
+
+/*
+ * +------+
+ * | GDSF |
+ * +------+
+ * GreedyDual-Size-Frequency, on the clock's rings.  A buffer's priority is L + F * C / S:  F is how often it's been hit, C what it
+ * costs to bring back if it leaves the tier, and S the space it takes there.  L is the tier's inflation value.  Buffers at or under
+ * L are victims; a lap that doesn't find enough raises L to the lowest priority it passed, so everything else ages without the hand
+ * touching it.  C is real, measured time:  for raw buffers, a decompression (their own if they've been restored, otherwise the
+ * list's average); for compressed ones, a reload, which is the controller's miss penalty scaled to the buffer's page size.  A hit
+ * only writes a new priority when its sampled popularity moved or it had already sunk to L, so hot buffers stay read-mostly.
+ */
+
+/* policy__gdsf_credit
+ * F * C / S for buf in tier, in ns per POLICY_GDSF_SCALE bytes, capped at POLICY_GDSF_MAX.  Popularity is a sampled counter that
+ * takes about p(p+1)/2 hits to reach p, so that's F.
+ */
+uint32_t policy__gdsf_credit(List *list, Buffer *buf, int tier) {
+  const uint64_t POPULARITY = buf->popularity;
+  const uint64_t FREQUENCY = POPULARITY * (POPULARITY + 1) / 2 + 1;
+  uint64_t cost = 0;
+  if(tier == TIER_COMP) {
+    const uint64_t PENALTY = list->controller.miss_penalty != 0 ? list->controller.miss_penalty : RATIO_MISS_PENALTY;
+    const uint64_t BYTES = list->controller.miss_bytes;
+    cost = BYTES == 0 ? PENALTY : PENALTY * buf->data_length / BYTES;
+  } else if(buf->comp_hits != 0) {
+    cost = buf->comp_cost / (2 * buf->comp_hits + 1);
+  } else if(list->restorations != 0) {
+    cost = list->controller.restore_cost / list->restorations;
+  }
+  const uint64_t CREDIT = FREQUENCY * (cost + 1) * POLICY_GDSF_SCALE / policy__size(buf, tier);
+  return CREDIT > POLICY_GDSF_MAX ? POLICY_GDSF_MAX : (uint32_t)CREDIT;
+}
+
+
+/* policy__gdsf_hit
+ * Bumps popularity like the clock, and brings buf's priority up to date if that changed anything.
+ */
+void policy__gdsf_hit(List *list, Buffer *buf) {
+  const popularity_t POPULARITY = buf->popularity;
+  const int TIER = buf->flags & compressed ? TIER_COMP : TIER_RAW;
+  const uint32_t INFLATION = CLOCK_RING(list, TIER)->inflation;
+  buffer__touch(buf);
+  if(buf->popularity != POPULARITY || (int32_t)(buf->priority - INFLATION) <= 0)
+    buf->priority = INFLATION + policy__gdsf_credit(list, buf, TIER);
+  return;
+}
+
+
+/* policy__gdsf_insert
+ * Links buf into tier's ring like the clock does, priced for that tier.
+ */
+void policy__gdsf_insert(List *list, Buffer *buf, int tier) {
+  buf->priority = CLOCK_RING(list, tier)->inflation + policy__gdsf_credit(list, buf, tier);
+  policy__clock_insert(list, buf, tier);
+  return;
+}
+
+
+/* policy__gdsf_select_victims
+ * Runs tier's hand around its ring taking everything at or under L.  Each time the hand passes the sentinel still short, L rises to
+ * the lowest priority seen since the last time, which is at least one more victim next lap.
+ */
+uint32_t policy__gdsf_select_victims(List *list, int tier, uint64_t bytes_needed, Buffer **victims, uint32_t max_victims, uint64_t *bytes_selected) {
+  ClockRing *ring = CLOCK_RING(list, tier);
+  uint32_t count = 0, laps = 0, steps = 0, lowest = UINT32_MAX;
+  int32_t above = 0;
+  Buffer *hand = NULL;
+
+  pthread_mutex_lock(&ring->lock);
+  while(count < max_victims && *bytes_selected < bytes_needed && laps < POLICY_MAX_LAPS && ring->count > 0) {
+    if(++steps % POLICY_RING_STEPS == 0) {
+      pthread_mutex_unlock(&ring->lock);
+      pthread_mutex_lock(&ring->lock);
+    }
+    ring->hand = ring->hand->ring_next;
+    hand = ring->hand;
+    if(hand == &ring->sentinel) {
+      laps++;
+      if(lowest != UINT32_MAX)
+        ring->inflation += lowest;
+      lowest = UINT32_MAX;
+      continue;
+    }
+    if(!policy__in_tier(list, hand, tier))
+      continue;
+    above = (int32_t)(hand->priority - ring->inflation);
+    if(above > 0 || policy__spare(list, hand, laps)) {
+      if(above > 0 && (uint32_t)above < lowest)
+        lowest = (uint32_t)above;
+      continue;
+    }
+    __sync_fetch_and_or(&hand->flags, pending_sweep);
+    victims[count] = hand;
+    count++;
+    *bytes_selected += policy__size(hand, tier);
+  }
+  pthread_mutex_unlock(&ring->lock);
+  return count;
+}
+
+
+/* policy__gdsf_next_victim
+ * The first buffer in tier past the hand at or under L, or the lowest priority one it passes on the way.
+ */
+bufferid_t policy__gdsf_next_victim(List *list, int tier) {
+  ClockRing *ring = CLOCK_RING(list, tier);
+  bufferid_t best = BUFFER_ID_MAX;
+  int32_t best_above = INT32_MAX, above = 0;
+  pthread_mutex_lock(&ring->lock);
+  Buffer *hand = ring->hand;
+  for(int64_t i=0; i<POLICY_PEEK_LIMIT && i<=ring->count; i++) {
+    hand = hand->ring_next;
+    if(hand == &ring->sentinel || !policy__in_tier(list, hand, tier))
+      continue;
+    above = (int32_t)(hand->priority - ring->inflation);
+    if(above <= 0) {
+      best = hand->id;
+      break;
+    }
+    if(above < best_above) {
+      best = hand->id;
+      best_above = above;
+    }
+  }
+  pthread_mutex_unlock(&ring->lock);
+  return best;
+}
+
+
+/* policy__gdsf_show_structure
+ * The clock's ring counts, plus where each tier's L has got to.
+ */
+void policy__gdsf_show_structure(List *list) {
+  const char *TIER_NAMES[TIER_COUNT] = {"raw", "comp"};
+  policy__clock_show_structure(list);
+  for(int tier=0; tier<TIER_COUNT; tier++)
+    printf("  %-4s inflation (L)          : %'"PRIu32"\n", TIER_NAMES[tier], CLOCK_RING(list, tier)->inflation);
+  return;
+}
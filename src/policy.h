@@ -0,0 +1,161 @@
+/*
+ * policy.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: Kyle Harper
+ * Description: Replacement policies for the sweeper.  A list picks one at list__initialize() and the sweeper asks it which raw
+ *              buffers to compress and which compressed buffers to evict.  Each tier is its own cache as far as a policy cares:
+ *              compressing a buffer removes it from the raw tier and inserts it into the comp tier, restoring does the opposite.
+ *              Policies keep their per-buffer bits in Buffer->policy_state and everything else in List->policy_data.  Most hands
+ *              are kept as buffer IDs and re-found with the index each sweep, so CoW updates and lock-free unlinks never strand them.
+ *              The clock instead links each tier into a ring of its own, so its hands only ever pass buffers of their tier.
+ *
+ *              clock    :  The original.  A hand per tier, each on its own ring, popularity halving.  Several hands split the raw
+ *                          tier by ID.
+ *              clockpro :  CLOCK-Pro.  Hot and cold pages with a test period; non-resident test pages live in a ghost list.
+ *              arc      :  ARC, as its clock form (CAR) so a hit is one atomic OR instead of a list move.  B1/B2 are ghost lists.
+ *              s3fifo   :  S3-FIFO.  A small FIFO of IDs filters one-hit wonders; survivors go to a clock-like main queue.
+ *              gdsf     :  GreedyDual-Size-Frequency on the clock's rings.  Buffers that are hit more, are smaller, or cost more to
+ *                          bring back (decompression for raw, a reload for comp) stay longer.
+ */
+
+#ifndef SRC_POLICY_H_
+#define SRC_POLICY_H_
+
+/* Includes */
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "buffer.h"
+#include "ghost.h"
+#include "list.h"
+
+
+/* Policies live in POLICIES[], indexed by the POLICY_* globals. */
+#define POLICY_COUNT 5
+
+/* Bits in Buffer->policy_state.  What they mean depends on the policy. */
+#define POLICY_REFERENCED      (1 << 0)   /* CLOCK-Pro, ARC:  hit since a hand last went by. */
+#define POLICY_HOT             (1 << 1)   /* CLOCK-Pro:  hot page.  ARC:  in T2.  S3-FIFO:  in the main queue. */
+#define POLICY_TEST            (1 << 2)   /* CLOCK-Pro:  cold page in its test period. */
+#define POLICY_FREQ_SHIFT      3          /* S3-FIFO:  2-bit access frequency. */
+#define POLICY_FREQ_MASK       (3 << POLICY_FREQ_SHIFT)
+#define POLICY_FREQ(state)     (((state) & POLICY_FREQ_MASK) >> POLICY_FREQ_SHIFT)
+#define POLICY_QUEUED          (1 << 5)   /* S3-FIFO:  has an ID in the small queue. */
+#define POLICY_COMP_RING       (1 << 6)   /* Clock:  linked into the comp tier's ring rather than the raw one. */
+
+/* Tuning. */
+#define POLICY_MAX_LAPS        10         /* A hand gives up after this many trips around the list.  Halving 255 takes 8. */
+#define POLICY_SMALL_PERCENT   10         /* S3-FIFO:  share of a tier's buffers the small queue aims for. */
+#define POLICY_QUEUE_MIN       1024       /* S3-FIFO:  starting size of the small queue ring.  Doubles as needed. */
+#define POLICY_PEEK_LIMIT      32         /* next_victim() gives up after looking at this many buffers. */
+#define POLICY_RING_STEPS      64         /* Clock:  buffers a hand passes before letting go of its ring's lock for a moment. */
+#define POLICY_GDSF_SCALE      1024       /* GDSF:  priorities are ns of reload per POLICY_GDSF_SCALE bytes. */
+#define POLICY_GDSF_MAX        (1 << 30)  /* GDSF:  most a priority can sit above L, so wrapping comparisons always work. */
+
+
+/* What a policy keeps for each tier.  Counters are touched by every thread that inserts or removes, so they're all atomics.  The
+ * hands and targets belong to the sweeper. */
+typedef struct policytier PolicyTier;
+struct policytier {
+  int64_t hot_count;             /* Buffers in the tier with POLICY_HOT set (CLOCK-Pro hot, ARC T2, S3-FIFO main). */
+  int64_t cold_count;            /* Buffers in the tier without it (CLOCK-Pro cold, ARC T1, S3-FIFO small). */
+  int64_t target;                /* CLOCK-Pro:  cold target.  ARC:  T1 target (p).  Both in buffers.  Unused by S3-FIFO. */
+  bufferid_t hot_hand;           /* ID the hot hand (ARC's T2 hand, S3-FIFO's main hand) rests on between sweeps. */
+  bufferid_t cold_hand;          /* ID the cold hand (ARC's T1 hand) rests on between sweeps. */
+  GhostList *ghosts;             /* CLOCK-Pro:  non-resident test pages.  ARC:  B1.  S3-FIFO:  the ghost queue. */
+  GhostList *hot_ghosts;         /* ARC:  B2. */
+  pthread_mutex_t queue_lock;    /* S3-FIFO:  protects the small queue, which inserts from any thread. */
+  bufferid_t *queue;             /* S3-FIFO:  the small queue, a ring of IDs.  Stale IDs are skipped when they reach the front. */
+  uint64_t queue_head;           /* S3-FIFO:  next ring position to push. */
+  uint64_t queue_tail;           /* S3-FIFO:  next ring position to pop. */
+  uint32_t queue_mask;           /* S3-FIFO:  ring size - 1. */
+  uint64_t promotions;           /* Buffers moved to the hot side (CLOCK-Pro hot, ARC T2, S3-FIFO main). */
+  uint64_t demotions;            /* Buffers moved back to the cold side. */
+};
+
+typedef struct policydata PolicyData;
+struct policydata {
+  PolicyTier tiers[TIER_COUNT];  /* Indexed by TIER_RAW and TIER_COMP. */
+};
+
+
+/* The clock's rings.  Each tier's buffers are linked through Buffer->ring_prev/ring_next, apart from the ID-ordered chain, so
+ * moving a buffer between tiers is an unlink and a link.  Everything in a ring, its hand included, is protected by its lock, and
+ * anything that touches both rings takes raw's first.  A buffer is unlinked before it's retired, so a ring never holds one that
+ * could be reclaimed. */
+typedef struct clockring ClockRing;
+struct clockring {
+  Buffer sentinel;               /* Never a victim.  The hand counts a lap every time it passes. */
+  Buffer *hand;                  /* Where the hand rests.  Unlinking the buffer under it moves it back one. */
+  int64_t count;                 /* Buffers in the ring. */
+  uint32_t inflation;            /* GDSF:  L, which only rises.  Buffers at or below it are victims.  Compared with wrapping. */
+  pthread_mutex_t lock;          /* Protects the links, the hand, count, and inflation. */
+};
+
+typedef struct clockdata ClockData;
+struct clockdata {
+  ClockRing rings[TIER_COUNT];   /* Indexed by TIER_RAW and TIER_COMP. */
+};
+
+
+/* The policy table. */
+extern const ReplacementPolicy POLICIES[POLICY_COUNT];
+
+
+/* Prototypes */
+int policy__find(const char *name);
+Buffer* policy__locate(List *list, bufferid_t id);
+Buffer* policy__advance(List *list, Buffer *hand, uint32_t *laps);
+bool policy__in_tier(List *list, Buffer *buf, int tier);
+bool policy__spare(List *list, Buffer *buf, uint32_t laps);
+uint32_t policy__size(Buffer *buf, int tier);
+void policy__set_state(Buffer *buf, uint8_t set, uint8_t clear);
+int policy__initialize_data(List *list, uint64_t max_memory, bool ghosts, bool hot_ghosts, bool queue);
+void policy__destroy_data(List *list);
+void policy__show_data(List *list);
+void policy__no_replace(List *list, Buffer *buf, Buffer *new_buffer);
+// Clock
+int policy__clock_initialize(List *list, uint64_t max_memory);
+void policy__clock_destroy(List *list);
+void policy__clock_hit(List *list, Buffer *buf);
+void policy__clock_insert(List *list, Buffer *buf, int tier);
+void policy__clock_remove(List *list, Buffer *buf, int tier);
+void policy__clock_replace(List *list, Buffer *buf, Buffer *new_buffer);
+void policy__clock_link(ClockRing *ring, Buffer *buf);
+void policy__clock_unlink(ClockRing *ring, Buffer *buf);
+uint32_t policy__clock_select_victims(List *list, int tier, uint64_t bytes_needed, Buffer **victims, uint32_t max_victims, uint64_t *bytes_selected);
+uint32_t policy__clock_select_range(List *list, SweepHand *hand, uint64_t bytes_needed, Buffer **victims, uint32_t max_victims, uint64_t *bytes_selected);
+bufferid_t policy__clock_next_victim(List *list, int tier);
+void policy__clock_show_structure(List *list);
+// CLOCK-Pro
+int policy__clock_pro_initialize(List *list, uint64_t max_memory);
+void policy__referenced_hit(List *list, Buffer *buf);
+void policy__clock_pro_insert(List *list, Buffer *buf, int tier);
+void policy__clock_pro_remove(List *list, Buffer *buf, int tier);
+uint32_t policy__clock_pro_select_victims(List *list, int tier, uint64_t bytes_needed, Buffer **victims, uint32_t max_victims, uint64_t *bytes_selected);
+bufferid_t policy__cold_next_victim(List *list, int tier);
+// ARC
+int policy__arc_initialize(List *list, uint64_t max_memory);
+void policy__arc_insert(List *list, Buffer *buf, int tier);
+void policy__arc_remove(List *list, Buffer *buf, int tier);
+uint32_t policy__arc_select_victims(List *list, int tier, uint64_t bytes_needed, Buffer **victims, uint32_t max_victims, uint64_t *bytes_selected);
+// S3-FIFO
+int policy__s3_fifo_initialize(List *list, uint64_t max_memory);
+void policy__s3_fifo_hit(List *list, Buffer *buf);
+void policy__s3_fifo_insert(List *list, Buffer *buf, int tier);
+void policy__s3_fifo_remove(List *list, Buffer *buf, int tier);
+uint32_t policy__s3_fifo_select_victims(List *list, int tier, uint64_t bytes_needed, Buffer **victims, uint32_t max_victims, uint64_t *bytes_selected);
+bufferid_t policy__s3_fifo_next_victim(List *list, int tier);
+int policy__s3_fifo_push(PolicyTier *pt, bufferid_t id);
+bufferid_t policy__s3_fifo_pop(PolicyTier *pt);
+// GDSF
+uint32_t policy__gdsf_credit(List *list, Buffer *buf, int tier);
+void policy__gdsf_hit(List *list, Buffer *buf);
+void policy__gdsf_insert(List *list, Buffer *buf, int tier);
+uint32_t policy__gdsf_select_victims(List *list, int tier, uint64_t bytes_needed, Buffer **victims, uint32_t max_victims, uint64_t *bytes_selected);
+bufferid_t policy__gdsf_next_victim(List *list, int tier);
+void policy__gdsf_show_structure(List *list);
+
+
+#endif /* SRC_POLICY_H_ */
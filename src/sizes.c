@@ -10,6 +10,7 @@
 #include "buffer.h"
 #include "list.h"
 #include "manager.h"
+#include "policy.h"
 
 
 int main() {
@@ -58,28 +59,68 @@ int main() {
   printf("Size of List->writer_condition                : %5zu Bytes\n", sizeof((List *)0)->writer_condition);
   printf("Size of List->reader_condition                : %5zu Bytes\n", sizeof((List *)0)->reader_condition);
   printf("Size of List->sweeper_condition               : %5zu Bytes\n", sizeof((List *)0)->sweeper_condition);
-  printf("Size of List->ref_count                       : %5zu Bytes\n", sizeof((List *)0)->ref_count);
+  printf("Size of List->pin_slots                       : %5zu Bytes\n", sizeof((List *)0)->pin_slots);
   printf("Size of List->pending_writers                 : %5zu Bytes\n", sizeof((List *)0)->pending_writers);
   /* Management and Administration Members */
   printf("Size of List->sweep_goal                      : %5zu Bytes\n", sizeof((List *)0)->sweep_goal);
+  printf("Size of List->watermark_high                  : %5zu Bytes\n", sizeof((List *)0)->watermark_high);
+  printf("Size of List->watermark_low                   : %5zu Bytes\n", sizeof((List *)0)->watermark_low);
+  printf("Size of List->overcommit                      : %5zu Bytes\n", sizeof((List *)0)->overcommit);
+  printf("Size of List->sweep_requested                 : %5zu Bytes\n", sizeof((List *)0)->sweep_requested);
+  printf("Size of List->stalls                          : %5zu Bytes\n", sizeof((List *)0)->stalls);
+  printf("Size of List->stall_time                      : %5zu Bytes\n", sizeof((List *)0)->stall_time);
   printf("Size of List->sweeps                          : %5zu Bytes\n", sizeof((List *)0)->sweeps);
   printf("Size of List->sweep_cost                      : %5zu Bytes\n", sizeof((List *)0)->sweep_cost);
+  printf("Size of List->sweep_pauses                    : %5zu Bytes\n", sizeof((List *)0)->sweep_pauses);
+  printf("Size of List->slice_budget_ns                 : %5zu Bytes\n", sizeof((List *)0)->slice_budget_ns);
+  printf("Size of List->slice_victims                   : %5zu Bytes\n", sizeof((List *)0)->slice_victims);
+  printf("Size of List->sweep_unfinished                : %5zu Bytes\n", sizeof((List *)0)->sweep_unfinished);
+  printf("Size of List->slices                          : %5zu Bytes\n", sizeof((List *)0)->slices);
+  printf("Size of List->sweep_slices                    : %5zu Bytes\n", sizeof((List *)0)->sweep_slices);
   printf("Size of List->restorations                    : %5zu Bytes\n", sizeof((List *)0)->restorations);
   printf("Size of List->compressions                    : %5zu Bytes\n", sizeof((List *)0)->compressions);
+  printf("Size of List->evictions                       : %5zu Bytes\n", sizeof((List *)0)->evictions);
+  printf("Size of List->compression_skips               : %5zu Bytes\n", sizeof((List *)0)->compression_skips);
+  printf("Size of List->controller                      : %5zu Bytes\n", sizeof((List *)0)->controller);
+  printf("Size of List->raw_ghosts                      : %5zu Bytes\n", sizeof((List *)0)->raw_ghosts);
+  printf("Size of List->comp_ghosts                     : %5zu Bytes\n", sizeof((List *)0)->comp_ghosts);
+  printf("Size of List->admission                       : %5zu Bytes\n", sizeof((List *)0)->admission);
+  printf("Size of List->windows                         : %5zu Bytes\n", sizeof((List *)0)->windows);
+  printf("Size of List->spill                           : %5zu Bytes\n", sizeof((List *)0)->spill);
+  printf("Size of List->dictionaries                    : %5zu Bytes\n", sizeof((List *)0)->dictionaries);
+  printf("Size of List->policy                          : %5zu Bytes\n", sizeof((List *)0)->policy);
+  printf("Size of List->policy_data                     : %5zu Bytes\n", sizeof((List *)0)->policy_data);
   /* Management of Nodes for Skiplist and Buffers */
   printf("Size of List->head                            : %5zu Bytes\n", sizeof((List *)0)->head);
-  printf("Size of List->clock_hand                      : %5zu Bytes\n", sizeof((List *)0)->clock_hand);
   printf("Size of List->indexes                         : %5zu Bytes\n", sizeof((List *)0)->indexes);
   printf("Size of List->levels                          : %5zu Bytes\n", sizeof((List *)0)->levels);
+  printf("Size of List->index_mode                      : %5zu Bytes\n", sizeof((List *)0)->index_mode);
+  printf("Size of List->epoch                           : %5zu Bytes\n", sizeof((List *)0)->epoch);
+  printf("Size of List->fat_root                        : %5zu Bytes\n", sizeof((List *)0)->fat_root);
+  printf("Size of List->fat_levels                      : %5zu Bytes\n", sizeof((List *)0)->fat_levels);
+  printf("Size of List->fat_lock                        : %5zu Bytes\n", sizeof((List *)0)->fat_lock);
+  printf("Size of List->fat_sequence                    : %5zu Bytes\n", sizeof((List *)0)->fat_sequence);
+  printf("Size of List->fat_retries                     : %5zu Bytes\n", sizeof((List *)0)->fat_retries);
+  printf("Size of List->fat_misses                      : %5zu Bytes\n", sizeof((List *)0)->fat_misses);
+  printf("Size of List->hash_table                      : %5zu Bytes\n", sizeof((List *)0)->hash_table);
+  printf("Size of List->hash_lock                       : %5zu Bytes\n", sizeof((List *)0)->hash_lock);
+  printf("Size of List->hash_rebuilds                   : %5zu Bytes\n", sizeof((List *)0)->hash_rebuilds);
+  printf("Size of List->search_interleave               : %5zu Bytes\n", sizeof((List *)0)->search_interleave);
   /* Compressor Pool Management */
   printf("Size of List->jobs_lock                       : %5zu Bytes\n", sizeof((List *)0)->jobs_lock);
   printf("Size of List->jobs_cond                       : %5zu Bytes\n", sizeof((List *)0)->jobs_cond);
   printf("Size of List->jobs_parent_cond                : %5zu Bytes\n", sizeof((List *)0)->jobs_parent_cond);
   printf("Size of List->comp_victims                    : %5zu Bytes\n", sizeof((List *)0)->comp_victims);
-  printf("Size of List->comp_victims_index              : %5zu Bytes\n", sizeof((List *)0)->comp_victims_index);
-  printf("Size of List->victims                         : %5zu Bytes\n", sizeof((List *)0)->victims);
-  printf("Size of List->victims_index                   : %5zu Bytes\n", sizeof((List *)0)->victims_index);
-  printf("Size of List->victims_compressor_index        : %5zu Bytes\n", sizeof((List *)0)->victims_compressor_index);
+  printf("Size of List->hands                           : %5zu Bytes\n", sizeof((List *)0)->hands);
+  printf("Size of List->hand_count                      : %5zu Bytes\n", sizeof((List *)0)->hand_count);
+  printf("Size of List->sweep_lock                      : %5zu Bytes\n", sizeof((List *)0)->sweep_lock);
+  printf("Size of List->hands_lock                      : %5zu Bytes\n", sizeof((List *)0)->hands_lock);
+  printf("Size of List->hands_cond                      : %5zu Bytes\n", sizeof((List *)0)->hands_cond);
+  printf("Size of List->hands_done_cond                 : %5zu Bytes\n", sizeof((List *)0)->hands_done_cond);
+  printf("Size of List->hand_generation                 : %5zu Bytes\n", sizeof((List *)0)->hand_generation);
+  printf("Size of List->hands_running                   : %5zu Bytes\n", sizeof((List *)0)->hands_running);
+  printf("Size of List->hands_stop                      : %5zu Bytes\n", sizeof((List *)0)->hands_stop);
+  printf("Size of List->highest_id                      : %5zu Bytes\n", sizeof((List *)0)->highest_id);
   printf("Size of List->active_compressors              : %5zu Bytes\n", sizeof((List *)0)->active_compressors);
   printf("Size of List->compressor_threads              : %5zu Bytes\n", sizeof((List *)0)->compressor_threads);
   printf("Size of List->compressor_pool                 : %5zu Bytes\n", sizeof((List *)0)->compressor_pool);
@@ -98,15 +139,40 @@ int main() {
   printf("Size of Compressor->jobs_parent_cond          : %5zu Bytes\n", sizeof((Compressor *)0)->jobs_parent_cond);
   printf("Size of Compressor->acive_compressors         : %5zu Bytes\n", sizeof((Compressor *)0)->active_compressors);
   printf("Size of Compressor->runnable                  : %5zu Bytes\n", sizeof((Compressor *)0)->runnable);
-  printf("Size of Compressor->victims                   : %5zu Bytes\n", sizeof((Compressor *)0)->victims);
-  printf("Size of Compressor->victims_index             : %5zu Bytes\n", sizeof((Compressor *)0)->victims_index);
-  printf("Size of Compressor->victims_compressor_index  : %5zu Bytes\n", sizeof((Compressor *)0)->victims_compressor_index);
   printf("Size of Compressor->compressor_id             : %5zu Bytes\n", sizeof((Compressor *)0)->compressor_id);
   printf("Size of Compressor->compressor_level          : %5zu Bytes\n", sizeof((Compressor *)0)->compressor_level);
   printf("-----------------------------------------------------------\n");
   printf("Size of Compressor                              %5zu Bytes\n", sizeof(Compressor));
 
 
+  // -- SweepHand Information
+  printf("\n");
+  printf("Size of SweepHand->list                       : %5zu Bytes\n", sizeof((SweepHand *)0)->list);
+  printf("Size of SweepHand->index                      : %5zu Bytes\n", sizeof((SweepHand *)0)->index);
+  printf("Size of SweepHand->thread                     : %5zu Bytes\n", sizeof((SweepHand *)0)->thread);
+  printf("Size of SweepHand->low                        : %5zu Bytes\n", sizeof((SweepHand *)0)->low);
+  printf("Size of SweepHand->high                       : %5zu Bytes\n", sizeof((SweepHand *)0)->high);
+  printf("Size of SweepHand->position                   : %5zu Bytes\n", sizeof((SweepHand *)0)->position);
+  printf("Size of SweepHand->victims                    : %5zu Bytes\n", sizeof((SweepHand *)0)->victims);
+  printf("Size of SweepHand->victims_index              : %5zu Bytes\n", sizeof((SweepHand *)0)->victims_index);
+  printf("Size of SweepHand->victims_compressor_index   : %5zu Bytes\n", sizeof((SweepHand *)0)->victims_compressor_index);
+  printf("Size of SweepHand->in_flight                  : %5zu Bytes\n", sizeof((SweepHand *)0)->in_flight);
+  printf("Size of SweepHand->start                      : %5zu Bytes\n", sizeof((SweepHand *)0)->start);
+  printf("Size of SweepHand->bytes_needed               : %5zu Bytes\n", sizeof((SweepHand *)0)->bytes_needed);
+  printf("Size of SweepHand->budget_ns                  : %5zu Bytes\n", sizeof((SweepHand *)0)->budget_ns);
+  printf("Size of SweepHand->max_victims                : %5zu Bytes\n", sizeof((SweepHand *)0)->max_victims);
+  printf("Size of SweepHand->bytes_freed                : %5zu Bytes\n", sizeof((SweepHand *)0)->bytes_freed);
+  printf("Size of SweepHand->bytes_dropped              : %5zu Bytes\n", sizeof((SweepHand *)0)->bytes_dropped);
+  printf("Size of SweepHand->comp_bytes_added           : %5zu Bytes\n", sizeof((SweepHand *)0)->comp_bytes_added);
+  printf("Size of SweepHand->victims_taken              : %5zu Bytes\n", sizeof((SweepHand *)0)->victims_taken);
+  printf("Size of SweepHand->dropped                    : %5zu Bytes\n", sizeof((SweepHand *)0)->dropped);
+  printf("Size of SweepHand->out_of_budget              : %5zu Bytes\n", sizeof((SweepHand *)0)->out_of_budget);
+  printf("Size of SweepHand->total_freed                : %5zu Bytes\n", sizeof((SweepHand *)0)->total_freed);
+  printf("Size of SweepHand->sweep_time                 : %5zu Bytes\n", sizeof((SweepHand *)0)->sweep_time);
+  printf("-----------------------------------------------------------\n");
+  printf("Size of SweepHand                               %5zu Bytes\n", sizeof(SweepHand));
+
+
   // -- SkiplistNode Information
   printf("\n");
   /* Directions for Traversal.  Left-To-Right Mentality. */
@@ -119,22 +185,242 @@ int main() {
   printf("Size of SkiplistNode                            %5zu Bytes\n", sizeof(SkiplistNode));
 
 
+  // -- FatNode Information
+  printf("\n");
+  printf("Size of FatNode->keys                         : %5zu Bytes\n", sizeof((FatNode *)0)->keys);
+  printf("Size of FatNode->slots                        : %5zu Bytes\n", sizeof((FatNode *)0)->slots);
+  printf("Size of FatNode->left                         : %5zu Bytes\n", sizeof((FatNode *)0)->left);
+  printf("Size of FatNode->right                        : %5zu Bytes\n", sizeof((FatNode *)0)->right);
+  printf("Size of FatNode->count                        : %5zu Bytes\n", sizeof((FatNode *)0)->count);
+  printf("Size of FatNode->level                        : %5zu Bytes\n", sizeof((FatNode *)0)->level);
+  printf("-----------------------------------------------------------\n");
+  printf("Size of FatNode                                 %5zu Bytes\n", sizeof(FatNode));
+
+
+  // -- RatioController Information
+  printf("\n");
+  printf("Size of RatioController->adaptive             : %5zu Bytes\n", sizeof((RatioController *)0)->adaptive);
+  printf("Size of RatioController->raw_ratio            : %5zu Bytes\n", sizeof((RatioController *)0)->raw_ratio);
+  printf("Size of RatioController->step                 : %5zu Bytes\n", sizeof((RatioController *)0)->step);
+  printf("Size of RatioController->restore_cost         : %5zu Bytes\n", sizeof((RatioController *)0)->restore_cost);
+  printf("Size of RatioController->miss_penalty         : %5zu Bytes\n", sizeof((RatioController *)0)->miss_penalty);
+  printf("Size of RatioController->miss_bytes           : %5zu Bytes\n", sizeof((RatioController *)0)->miss_bytes);
+  printf("Size of RatioController->miss_ns_sum          : %5zu Bytes\n", sizeof((RatioController *)0)->miss_ns_sum);
+  printf("Size of RatioController->miss_bytes_sum       : %5zu Bytes\n", sizeof((RatioController *)0)->miss_bytes_sum);
+  printf("Size of RatioController->misses               : %5zu Bytes\n", sizeof((RatioController *)0)->misses);
+  printf("Size of RatioController->checked_at           : %5zu Bytes\n", sizeof((RatioController *)0)->checked_at);
+  printf("Size of RatioController->last_restore_cost    : %5zu Bytes\n", sizeof((RatioController *)0)->last_restore_cost);
+  printf("Size of RatioController->last_evictions       : %5zu Bytes\n", sizeof((RatioController *)0)->last_evictions);
+  printf("Size of RatioController->last_cost            : %5zu Bytes\n", sizeof((RatioController *)0)->last_cost);
+  printf("Size of RatioController->intervals            : %5zu Bytes\n", sizeof((RatioController *)0)->intervals);
+  printf("Size of RatioController->adjustments          : %5zu Bytes\n", sizeof((RatioController *)0)->adjustments);
+  printf("Size of RatioController->log                  : %5zu Bytes\n", sizeof((RatioController *)0)->log);
+  printf("-----------------------------------------------------------\n");
+  printf("Size of RatioController                         %5zu Bytes\n", sizeof(RatioController));
+
+
+  // -- GhostEntry Information
+  printf("\n");
+  printf("Size of GhostEntry->id                        : %5zu Bytes\n", sizeof((GhostEntry *)0)->id);
+  printf("Size of GhostEntry->size                      : %5zu Bytes\n", sizeof((GhostEntry *)0)->size);
+  printf("-----------------------------------------------------------\n");
+  printf("Size of GhostEntry                              %5zu Bytes\n", sizeof(GhostEntry));
+
+
+  // -- GhostList Information
+  printf("\n");
+  printf("Size of GhostList->lock                       : %5zu Bytes\n", sizeof((GhostList *)0)->lock);
+  printf("Size of GhostList->ring                       : %5zu Bytes\n", sizeof((GhostList *)0)->ring);
+  printf("Size of GhostList->slots                      : %5zu Bytes\n", sizeof((GhostList *)0)->slots);
+  printf("Size of GhostList->ring_mask                  : %5zu Bytes\n", sizeof((GhostList *)0)->ring_mask);
+  printf("Size of GhostList->slot_mask                  : %5zu Bytes\n", sizeof((GhostList *)0)->slot_mask);
+  printf("Size of GhostList->head                       : %5zu Bytes\n", sizeof((GhostList *)0)->head);
+  printf("Size of GhostList->tail                       : %5zu Bytes\n", sizeof((GhostList *)0)->tail);
+  printf("Size of GhostList->bytes                      : %5zu Bytes\n", sizeof((GhostList *)0)->bytes);
+  printf("Size of GhostList->max_bytes                  : %5zu Bytes\n", sizeof((GhostList *)0)->max_bytes);
+  printf("Size of GhostList->hits                       : %5zu Bytes\n", sizeof((GhostList *)0)->hits);
+  printf("Size of GhostList->inserts                    : %5zu Bytes\n", sizeof((GhostList *)0)->inserts);
+  printf("-----------------------------------------------------------\n");
+  printf("Size of GhostList                               %5zu Bytes\n", sizeof(GhostList));
+
+
+  // -- AdmissionFilter Information
+  printf("\n");
+  printf("Size of AdmissionFilter->sketch               : %5zu Bytes\n", sizeof((AdmissionFilter *)0)->sketch);
+  printf("Size of AdmissionFilter->doorkeeper           : %5zu Bytes\n", sizeof((AdmissionFilter *)0)->doorkeeper);
+  printf("Size of AdmissionFilter->width_mask           : %5zu Bytes\n", sizeof((AdmissionFilter *)0)->width_mask);
+  printf("Size of AdmissionFilter->doorkeeper_mask      : %5zu Bytes\n", sizeof((AdmissionFilter *)0)->doorkeeper_mask);
+  printf("Size of AdmissionFilter->sample_size          : %5zu Bytes\n", sizeof((AdmissionFilter *)0)->sample_size);
+  printf("Size of AdmissionFilter->additions            : %5zu Bytes\n", sizeof((AdmissionFilter *)0)->additions);
+  printf("Size of AdmissionFilter->resets               : %5zu Bytes\n", sizeof((AdmissionFilter *)0)->resets);
+  printf("Size of AdmissionFilter->admitted             : %5zu Bytes\n", sizeof((AdmissionFilter *)0)->admitted);
+  printf("Size of AdmissionFilter->rejected             : %5zu Bytes\n", sizeof((AdmissionFilter *)0)->rejected);
+  printf("Size of AdmissionFilter->memory               : %5zu Bytes\n", sizeof((AdmissionFilter *)0)->memory);
+  printf("-----------------------------------------------------------\n");
+  printf("Size of AdmissionFilter                         %5zu Bytes\n", sizeof(AdmissionFilter));
+
+
+  // -- FrequencyWindows Information
+  printf("\n");
+  printf("Size of FrequencyWindows->window              : %5zu Bytes\n", sizeof((FrequencyWindows *)0)->window);
+  printf("Size of FrequencyWindows->length_ns           : %5zu Bytes\n", sizeof((FrequencyWindows *)0)->length_ns);
+  printf("Size of FrequencyWindows->length_hits         : %5zu Bytes\n", sizeof((FrequencyWindows *)0)->length_hits);
+  printf("Size of FrequencyWindows->decay_percent       : %5zu Bytes\n", sizeof((FrequencyWindows *)0)->decay_percent);
+  printf("Size of FrequencyWindows->decay               : %5zu Bytes\n", sizeof((FrequencyWindows *)0)->decay);
+  printf("Size of FrequencyWindows->started             : %5zu Bytes\n", sizeof((FrequencyWindows *)0)->started);
+  printf("Size of FrequencyWindows->lock                : %5zu Bytes\n", sizeof((FrequencyWindows *)0)->lock);
+  printf("Size of FrequencyWindows->hits                : %5zu Bytes\n", sizeof((FrequencyWindows *)0)->hits);
+  printf("Size of FrequencyWindows->hot_hits            : %5zu Bytes\n", sizeof((FrequencyWindows *)0)->hot_hits);
+  printf("Size of FrequencyWindows->buckets             : %5zu Bytes\n", sizeof((FrequencyWindows *)0)->buckets);
+  printf("Size of FrequencyWindows->hot_threshold       : %5zu Bytes\n", sizeof((FrequencyWindows *)0)->hot_threshold);
+  printf("Size of FrequencyWindows->hot_buffers         : %5zu Bytes\n", sizeof((FrequencyWindows *)0)->hot_buffers);
+  printf("Size of FrequencyWindows->zipf_exponent       : %5zu Bytes\n", sizeof((FrequencyWindows *)0)->zipf_exponent);
+  printf("Size of FrequencyWindows->predicted_share     : %5zu Bytes\n", sizeof((FrequencyWindows *)0)->predicted_share);
+  printf("Size of FrequencyWindows->actual_share        : %5zu Bytes\n", sizeof((FrequencyWindows *)0)->actual_share);
+  printf("Size of FrequencyWindows->share_error         : %5zu Bytes\n", sizeof((FrequencyWindows *)0)->share_error);
+  printf("Size of FrequencyWindows->scored              : %5zu Bytes\n", sizeof((FrequencyWindows *)0)->scored);
+  printf("Size of FrequencyWindows->rotations           : %5zu Bytes\n", sizeof((FrequencyWindows *)0)->rotations);
+  printf("Size of FrequencyWindows->spared              : %5zu Bytes\n", sizeof((FrequencyWindows *)0)->spared);
+  printf("-----------------------------------------------------------\n");
+  printf("Size of FrequencyWindows                        %5zu Bytes\n", sizeof(FrequencyWindows));
+
+
+  // -- SpillRecord Information
+  printf("\n");
+  printf("Size of SpillRecord->id                       : %5zu Bytes\n", sizeof((SpillRecord *)0)->id);
+  printf("Size of SpillRecord->data_length              : %5zu Bytes\n", sizeof((SpillRecord *)0)->data_length);
+  printf("Size of SpillRecord->comp_length              : %5zu Bytes\n", sizeof((SpillRecord *)0)->comp_length);
+  printf("Size of SpillRecord->codec_id                 : %5zu Bytes\n", sizeof((SpillRecord *)0)->codec_id);
+  printf("-----------------------------------------------------------\n");
+  printf("Size of SpillRecord                             %5zu Bytes\n", sizeof(SpillRecord));
+
+
+  // -- SpillEntry Information
+  printf("\n");
+  printf("Size of SpillEntry->id                        : %5zu Bytes\n", sizeof((SpillEntry *)0)->id);
+  printf("Size of SpillEntry->offset                    : %5zu Bytes\n", sizeof((SpillEntry *)0)->offset);
+  printf("Size of SpillEntry->segment                   : %5zu Bytes\n", sizeof((SpillEntry *)0)->segment);
+  printf("Size of SpillEntry->length                    : %5zu Bytes\n", sizeof((SpillEntry *)0)->length);
+  printf("Size of SpillEntry->dict_id                   : %5zu Bytes\n", sizeof((SpillEntry *)0)->dict_id);
+  printf("-----------------------------------------------------------\n");
+  printf("Size of SpillEntry                              %5zu Bytes\n", sizeof(SpillEntry));
+
+
+  // -- SpillSegment Information
+  printf("\n");
+  printf("Size of SpillSegment->used                    : %5zu Bytes\n", sizeof((SpillSegment *)0)->used);
+  printf("Size of SpillSegment->live                    : %5zu Bytes\n", sizeof((SpillSegment *)0)->live);
+  printf("-----------------------------------------------------------\n");
+  printf("Size of SpillSegment                            %5zu Bytes\n", sizeof(SpillSegment));
+
+
+  // -- SpillTier Information
+  printf("\n");
+  printf("Size of SpillTier->lock                       : %5zu Bytes\n", sizeof((SpillTier *)0)->lock);
+  printf("Size of SpillTier->fd                         : %5zu Bytes\n", sizeof((SpillTier *)0)->fd);
+  printf("Size of SpillTier->path                       : %5zu Bytes\n", sizeof((SpillTier *)0)->path);
+  printf("Size of SpillTier->segments                   : %5zu Bytes\n", sizeof((SpillTier *)0)->segments);
+  printf("Size of SpillTier->segment_count              : %5zu Bytes\n", sizeof((SpillTier *)0)->segment_count);
+  printf("Size of SpillTier->open_segment               : %5zu Bytes\n", sizeof((SpillTier *)0)->open_segment);
+  printf("Size of SpillTier->batch                      : %5zu Bytes\n", sizeof((SpillTier *)0)->batch);
+  printf("Size of SpillTier->scratch                    : %5zu Bytes\n", sizeof((SpillTier *)0)->scratch);
+  printf("Size of SpillTier->slots                      : %5zu Bytes\n", sizeof((SpillTier *)0)->slots);
+  printf("Size of SpillTier->slot_mask                  : %5zu Bytes\n", sizeof((SpillTier *)0)->slot_mask);
+  printf("Size of SpillTier->entries                    : %5zu Bytes\n", sizeof((SpillTier *)0)->entries);
+  printf("Size of SpillTier->live_bytes                 : %5zu Bytes\n", sizeof((SpillTier *)0)->live_bytes);
+  printf("Size of SpillTier->spills                     : %5zu Bytes\n", sizeof((SpillTier *)0)->spills);
+  printf("Size of SpillTier->refused                    : %5zu Bytes\n", sizeof((SpillTier *)0)->refused);
+  printf("Size of SpillTier->hits                       : %5zu Bytes\n", sizeof((SpillTier *)0)->hits);
+  printf("Size of SpillTier->misses                     : %5zu Bytes\n", sizeof((SpillTier *)0)->misses);
+  printf("Size of SpillTier->writes                     : %5zu Bytes\n", sizeof((SpillTier *)0)->writes);
+  printf("Size of SpillTier->reads                      : %5zu Bytes\n", sizeof((SpillTier *)0)->reads);
+  printf("Size of SpillTier->cleanings                  : %5zu Bytes\n", sizeof((SpillTier *)0)->cleanings);
+  printf("Size of SpillTier->moved                      : %5zu Bytes\n", sizeof((SpillTier *)0)->moved);
+  printf("Size of SpillTier->expired                    : %5zu Bytes\n", sizeof((SpillTier *)0)->expired);
+  printf("-----------------------------------------------------------\n");
+  printf("Size of SpillTier                               %5zu Bytes\n", sizeof(SpillTier));
+
+
+  // -- PolicyTier Information
+  printf("\n");
+  printf("Size of PolicyTier->hot_count                 : %5zu Bytes\n", sizeof((PolicyTier *)0)->hot_count);
+  printf("Size of PolicyTier->cold_count                : %5zu Bytes\n", sizeof((PolicyTier *)0)->cold_count);
+  printf("Size of PolicyTier->target                    : %5zu Bytes\n", sizeof((PolicyTier *)0)->target);
+  printf("Size of PolicyTier->hot_hand                  : %5zu Bytes\n", sizeof((PolicyTier *)0)->hot_hand);
+  printf("Size of PolicyTier->cold_hand                 : %5zu Bytes\n", sizeof((PolicyTier *)0)->cold_hand);
+  printf("Size of PolicyTier->ghosts                    : %5zu Bytes\n", sizeof((PolicyTier *)0)->ghosts);
+  printf("Size of PolicyTier->hot_ghosts                : %5zu Bytes\n", sizeof((PolicyTier *)0)->hot_ghosts);
+  printf("Size of PolicyTier->queue_lock                : %5zu Bytes\n", sizeof((PolicyTier *)0)->queue_lock);
+  printf("Size of PolicyTier->queue                     : %5zu Bytes\n", sizeof((PolicyTier *)0)->queue);
+  printf("Size of PolicyTier->queue_head                : %5zu Bytes\n", sizeof((PolicyTier *)0)->queue_head);
+  printf("Size of PolicyTier->queue_tail                : %5zu Bytes\n", sizeof((PolicyTier *)0)->queue_tail);
+  printf("Size of PolicyTier->queue_mask                : %5zu Bytes\n", sizeof((PolicyTier *)0)->queue_mask);
+  printf("Size of PolicyTier->promotions                : %5zu Bytes\n", sizeof((PolicyTier *)0)->promotions);
+  printf("Size of PolicyTier->demotions                 : %5zu Bytes\n", sizeof((PolicyTier *)0)->demotions);
+  printf("-----------------------------------------------------------\n");
+  printf("Size of PolicyTier                              %5zu Bytes\n", sizeof(PolicyTier));
+
+
+  // -- PolicyData Information
+  printf("\n");
+  printf("Size of PolicyData->tiers                     : %5zu Bytes\n", sizeof((PolicyData *)0)->tiers);
+  printf("-----------------------------------------------------------\n");
+  printf("Size of PolicyData                              %5zu Bytes\n", sizeof(PolicyData));
+
+
+  // -- ClockRing Information
+  printf("\n");
+  printf("Size of ClockRing->sentinel                   : %5zu Bytes\n", sizeof((ClockRing *)0)->sentinel);
+  printf("Size of ClockRing->hand                       : %5zu Bytes\n", sizeof((ClockRing *)0)->hand);
+  printf("Size of ClockRing->count                      : %5zu Bytes\n", sizeof((ClockRing *)0)->count);
+  printf("Size of ClockRing->inflation                  : %5zu Bytes\n", sizeof((ClockRing *)0)->inflation);
+  printf("Size of ClockRing->lock                       : %5zu Bytes\n", sizeof((ClockRing *)0)->lock);
+  printf("-----------------------------------------------------------\n");
+  printf("Size of ClockRing                               %5zu Bytes\n", sizeof(ClockRing));
+
+
+  // -- ClockData Information
+  printf("\n");
+  printf("Size of ClockData->rings                      : %5zu Bytes\n", sizeof((ClockData *)0)->rings);
+  printf("-----------------------------------------------------------\n");
+  printf("Size of ClockData                               %5zu Bytes\n", sizeof(ClockData));
+
+
+  // -- HashSlot Information
+  printf("\n");
+  printf("Size of HashSlot->id                          : %5zu Bytes\n", sizeof((HashSlot *)0)->id);
+  printf("Size of HashSlot->target                      : %5zu Bytes\n", sizeof((HashSlot *)0)->target);
+  printf("-----------------------------------------------------------\n");
+  printf("Size of HashSlot                                %5zu Bytes\n", sizeof(HashSlot));
+
+
   // -- Buffer Information
   printf("\n");
   /* Tracking for the list we're part of. */
   printf("Size of Buffer->next                          : %5zu Bytes\n", sizeof((Buffer *)0)->next);
+  printf("Size of Buffer->ring_prev                     : %5zu Bytes\n", sizeof((Buffer *)0)->ring_prev);
+  printf("Size of Buffer->ring_next                     : %5zu Bytes\n", sizeof((Buffer *)0)->ring_next);
   /* Attributes for typical buffer organization and management. */
   printf("Size of Buffer->id                            : %5zu Bytes\n", sizeof((Buffer *)0)->id);
   printf("Size of Buffer->ref_count                     : %5zu Bytes\n", sizeof((Buffer *)0)->ref_count);
+  printf("Size of Buffer->frequency                     : %5zu Bytes\n", sizeof((Buffer *)0)->frequency);
   printf("Size of Buffer->flags                         : %5zu Bytes\n", sizeof((Buffer *)0)->flags);
   printf("Size of Buffer->popularity                    : %5zu Bytes\n", sizeof((Buffer *)0)->popularity);
+  printf("Size of Buffer->policy_state                  : %5zu Bytes\n", sizeof((Buffer *)0)->policy_state);
+  printf("Size of Buffer->window_stamp                  : %5zu Bytes\n", sizeof((Buffer *)0)->window_stamp);
   printf("Size of Buffer->lock                          : %5zu Bytes\n", sizeof((Buffer *)0)->lock);
   /* Cost values for each buffer when pulled from disk or compressed/decompressed. */
   printf("Size of Buffer->comp_cost                     : %5zu Bytes\n", sizeof((Buffer *)0)->comp_cost);
   printf("Size of Buffer->comp_hits                     : %5zu Bytes\n", sizeof((Buffer *)0)->comp_hits);
+  printf("Size of Buffer->window_hits                   : %5zu Bytes\n", sizeof((Buffer *)0)->window_hits);
   /* The actual payload we want to cache (i.e.: the page). */
   printf("Size of Buffer->data_length                   : %5zu Bytes\n", sizeof((Buffer *)0)->data_length);
   printf("Size of Buffer->comp_length                   : %5zu Bytes\n", sizeof((Buffer *)0)->comp_length);
+  printf("Size of Buffer->dict_id                       : %5zu Bytes\n", sizeof((Buffer *)0)->dict_id);
+  printf("Size of Buffer->codec_id                      : %5zu Bytes\n", sizeof((Buffer *)0)->codec_id);
+  printf("Size of Buffer->codec_level                   : %5zu Bytes\n", sizeof((Buffer *)0)->codec_level);
+  printf("Size of Buffer->last_comp_length              : %5zu Bytes\n", sizeof((Buffer *)0)->last_comp_length);
+  printf("Size of Buffer->priority                      : %5zu Bytes\n", sizeof((Buffer *)0)->priority);
   printf("Size of Buffer->data                          : %5zu Bytes\n", sizeof((Buffer *)0)->data);
   printf("-----------------------------------------------------------\n");
   printf("Size of Buffer                                  %5zu Bytes\n", sizeof(Buffer));
@@ -146,6 +432,7 @@ int main() {
   printf("| Worker        | %7zu Bytes |\n", sizeof(Worker));
   printf("| List          | %7zu Bytes |\n", sizeof(List));
   printf("| Compressor    | %7zu Bytes |\n", sizeof(Compressor));
+  printf("| SweepHand     | %7zu Bytes |\n", sizeof(SweepHand));
   printf("| SkiplistNode  | %7zu Bytes |\n", sizeof(SkiplistNode));
   printf("| Buffer        | %7zu Bytes |\n", sizeof(Buffer));
   printf("+---------------+---------------+\n");
@@ -0,0 +1,410 @@
+/*
+ * spill.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: Kyle Harper
+ * Description: See spill.h.  The index only knows where an ID's newest record is, so a segment never has to be parsed except when
+ *              it's cleaned; anything the index doesn't point back at is dead.  Only the open segment lives in memory.
+ */
+
+/* Include Headers */
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <jemalloc/jemalloc.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "spill.h"
+
+
+/* Extern the error codes we'll use. */
+extern const int E_OK;
+extern const int E_GENERIC;
+extern const int E_BUFFER_NOT_FOUND;
+extern const int E_NO_MEMORY;
+
+
+/* Fibonacci hashing spreads sequential IDs across the index, the same as ghost lists. */
+#define SPILL_HASH(spill, id) ((uint32_t)(((uint64_t)(id) * 0x9E3779B97F4A7C15ull) >> 32) & (spill)->slot_mask)
+
+
+
+/* spill__initialize
+ * Creates (or truncates) the spill file at path and builds an empty tier that keeps at most max_bytes of it.
+ */
+int spill__initialize(SpillTier **spill, const char *path, uint64_t max_bytes) {
+  uint32_t segment_count = max_bytes / SPILL_SEGMENT_SIZE;
+  if(segment_count < SPILL_MIN_SEGMENTS)
+    segment_count = SPILL_MIN_SEGMENTS;
+  // Size the index for twice the records we expect the file to hold, so its load stays under 50%.
+  uint64_t entries = SPILL_MIN_ENTRIES;
+  while(entries < (1ull << 31) && entries < (uint64_t)segment_count * SPILL_SEGMENT_SIZE / SPILL_EXPECTED_SIZE * 2)
+    entries <<= 1;
+
+  *spill = (SpillTier *)calloc(1, sizeof(SpillTier));
+  if(*spill == NULL)
+    return E_NO_MEMORY;
+  (*spill)->segments = (SpillSegment *)calloc(segment_count, sizeof(SpillSegment));
+  (*spill)->batch = (uint8_t *)malloc(SPILL_SEGMENT_SIZE);
+  (*spill)->scratch = (uint8_t *)malloc(SPILL_SEGMENT_SIZE);
+  (*spill)->slots = (SpillEntry *)malloc(entries * sizeof(SpillEntry));
+  (*spill)->path = (char *)malloc(strlen(path) + 1);
+  if((*spill)->segments == NULL || (*spill)->batch == NULL || (*spill)->scratch == NULL || (*spill)->slots == NULL || (*spill)->path == NULL) {
+    free((*spill)->segments);
+    free((*spill)->batch);
+    free((*spill)->scratch);
+    free((*spill)->slots);
+    free((*spill)->path);
+    free(*spill);
+    return E_NO_MEMORY;
+  }
+  strcpy((*spill)->path, path);
+  (*spill)->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+  if((*spill)->fd < 0) {
+    free((*spill)->segments);
+    free((*spill)->batch);
+    free((*spill)->scratch);
+    free((*spill)->slots);
+    free((*spill)->path);
+    free(*spill);
+    return E_GENERIC;
+  }
+  for(uint64_t i=0; i<entries; i++) {
+    (*spill)->slots[i].id = BUFFER_ID_MAX;
+    (*spill)->slots[i].dict_id = DICT_NONE;
+  }
+  (*spill)->slot_mask = entries - 1;
+  (*spill)->segment_count = segment_count;
+  (*spill)->open_segment = SPILL_NONE;
+  pthread_mutex_init(&(*spill)->lock, NULL);
+  return E_OK;
+}
+
+
+/* spill__destroy
+ * Closes and removes the spill file, then frees the tier.  Whatever was in it is gone, along with its references on dictionaries.
+ */
+void spill__destroy(SpillTier *spill) {
+  if(spill == NULL)
+    return;
+  for(uint32_t i=0; i<=spill->slot_mask; i++)
+    if(spill->slots[i].id != BUFFER_ID_MAX)
+      dict__release(spill->slots[i].dict_id);
+  close(spill->fd);
+  unlink(spill->path);
+  pthread_mutex_destroy(&spill->lock);
+  free(spill->segments);
+  free(spill->batch);
+  free(spill->scratch);
+  free(spill->slots);
+  free(spill->path);
+  free(spill);
+  return;
+}
+
+
+/* spill__put
+ * Appends the image of a buffer leaving the compressed tier.  image is comp_length bytes, or data_length if comp_length is 0 (the
+ * list has no compressor).  Any older record for id is dead from here on.  Returns E_NO_MEMORY if the tier can't take it, in which
+ * case the buffer is simply gone, the same as without a spill tier.  A record takes its own reference on dict_id, so the image can
+ * still be decompressed after the buffer it came from is freed.  codec_id goes in the record, since lists don't all use one codec.
+ */
+int spill__put(SpillTier *spill, bufferid_t id, const void *image, uint32_t data_length, uint32_t comp_length, uint8_t codec_id, uint8_t dict_id) {
+  const uint32_t IMAGE_LENGTH = comp_length != 0 ? comp_length : data_length;
+  const uint32_t LENGTH = sizeof(SpillRecord) + IMAGE_LENGTH;
+  int rv = E_OK;
+  pthread_mutex_lock(&spill->lock);
+  spill__drop_locked(spill, id);
+  if(LENGTH > SPILL_SEGMENT_SIZE || spill->entries >= (spill->slot_mask + 1) / 2) {
+    spill->refused++;
+    pthread_mutex_unlock(&spill->lock);
+    return E_NO_MEMORY;
+  }
+
+  // Roll over to a fresh segment when the open one can't fit this record.
+  if(spill->open_segment == SPILL_NONE || spill->segments[spill->open_segment].used + LENGTH > SPILL_SEGMENT_SIZE) {
+    rv = spill__seal(spill);
+    if(rv == E_OK)
+      rv = spill__open_segment(spill, LENGTH);
+    if(rv != E_OK) {
+      spill->refused++;
+      pthread_mutex_unlock(&spill->lock);
+      return rv;
+    }
+  }
+
+  SpillSegment *segment = &spill->segments[spill->open_segment];
+  const SpillRecord RECORD = {id, data_length, comp_length, codec_id};
+  memcpy(spill->batch + segment->used, &RECORD, sizeof(SpillRecord));
+  memcpy(spill->batch + segment->used + sizeof(SpillRecord), image, IMAGE_LENGTH);
+  uint32_t i = SPILL_HASH(spill, id);
+  while(spill->slots[i].id != BUFFER_ID_MAX)
+    i = (i + 1) & spill->slot_mask;
+  spill->slots[i].id = id;
+  spill->slots[i].offset = segment->used;
+  spill->slots[i].segment = spill->open_segment;
+  spill->slots[i].length = LENGTH;
+  spill->slots[i].dict_id = dict_id;
+  dict__retain(dict_id);
+  segment->used += LENGTH;
+  segment->live += LENGTH;
+  spill->live_bytes += LENGTH;
+  spill->entries++;
+  spill->spills++;
+  pthread_mutex_unlock(&spill->lock);
+  return E_OK;
+}
+
+
+/* spill__take
+ * Removes id's record from the tier and hands it back as a new, unlisted buffer in *buf.  If ->comp_length is set the data is still
+ * compressed (but ->flags doesn't say so; it isn't in a list), and the caller decompresses it.  Returns E_BUFFER_NOT_FOUND if the
+ * tier doesn't have it.
+ */
+int spill__take(SpillTier *spill, bufferid_t id, Buffer **buf) {
+  pthread_mutex_lock(&spill->lock);
+  int64_t slot = spill__find_slot(spill, id);
+  if(slot < 0) {
+    spill->misses++;
+    pthread_mutex_unlock(&spill->lock);
+    return E_BUFFER_NOT_FOUND;
+  }
+  const SpillEntry ENTRY = spill->slots[slot];
+  uint8_t *record = (uint8_t *)malloc(ENTRY.length);
+  if(record == NULL) {
+    pthread_mutex_unlock(&spill->lock);
+    return E_NO_MEMORY;
+  }
+  // Records in the open segment haven't been written yet.  Everything else is one pread.
+  if(ENTRY.segment == spill->open_segment) {
+    memcpy(record, spill->batch + ENTRY.offset, ENTRY.length);
+  } else {
+    if(pread(spill->fd, record, ENTRY.length, (off_t)ENTRY.segment * SPILL_SEGMENT_SIZE + ENTRY.offset) != (ssize_t)ENTRY.length) {
+      free(record);
+      pthread_mutex_unlock(&spill->lock);
+      return E_GENERIC;
+    }
+    spill->reads++;
+  }
+  spill->segments[ENTRY.segment].live -= ENTRY.length;
+  spill->live_bytes -= ENTRY.length;
+  spill->entries--;
+  spill->hits++;
+  // The record's dictionary reference goes to the buffer rather than being released.
+  spill->slots[slot].dict_id = DICT_NONE;
+  spill__unlink(spill, slot);
+  pthread_mutex_unlock(&spill->lock);
+
+  // Slide the image down over the header so it can be the buffer's data as is.
+  SpillRecord header;
+  memcpy(&header, record, sizeof(SpillRecord));
+  memmove(record, record + sizeof(SpillRecord), ENTRY.length - sizeof(SpillRecord));
+  int rv = buffer__initialize(buf, id, 0, NULL, NULL);
+  if(rv != E_OK) {
+    dict__release(ENTRY.dict_id);
+    free(record);
+    return rv;
+  }
+  (*buf)->data = record;
+  (*buf)->data_length = header.data_length;
+  (*buf)->comp_length = header.comp_length;
+  (*buf)->last_comp_length = header.comp_length;
+  (*buf)->dict_id = ENTRY.dict_id;
+  (*buf)->codec_id = header.codec_id;
+  return E_OK;
+}
+
+
+/* spill__drop
+ * Forgets id's record, if there is one.  list__add() calls this so a stale image can't outlive a fresh copy of the buffer.
+ */
+void spill__drop(SpillTier *spill, bufferid_t id) {
+  // Most adds are for IDs that were never spilled; a dirty read of the count skips the lock for all of them while the tier is empty.
+  if(spill->entries == 0)
+    return;
+  pthread_mutex_lock(&spill->lock);
+  spill__drop_locked(spill, id);
+  pthread_mutex_unlock(&spill->lock);
+  return;
+}
+
+
+/* spill__drop_locked
+ * spill__drop() for callers already holding the tier's lock.
+ */
+void spill__drop_locked(SpillTier *spill, bufferid_t id) {
+  int64_t slot = spill__find_slot(spill, id);
+  if(slot < 0)
+    return;
+  spill->segments[spill->slots[slot].segment].live -= spill->slots[slot].length;
+  spill->live_bytes -= spill->slots[slot].length;
+  spill->entries--;
+  spill__unlink(spill, slot);
+  return;
+}
+
+
+/* spill__seal
+ * Writes the open segment to the file, if there is one, and leaves no segment open.  Caller MUST hold the tier's lock.
+ */
+int spill__seal(SpillTier *spill) {
+  if(spill->open_segment == SPILL_NONE)
+    return E_OK;
+  const uint32_t SEGMENT = spill->open_segment;
+  const uint32_t USED = spill->segments[SEGMENT].used;
+  spill->open_segment = SPILL_NONE;
+  ssize_t written = 0, rv = 0;
+  while(written < USED) {
+    rv = pwrite(spill->fd, spill->batch + written, USED - written, (off_t)SEGMENT * SPILL_SEGMENT_SIZE + written);
+    if(rv < 0 && errno == EINTR)
+      continue;
+    if(rv <= 0)
+      break;
+    written += rv;
+  }
+  spill->writes++;
+  // A segment we couldn't write is as good as lost.
+  if(written < USED) {
+    spill__expire(spill, SEGMENT);
+    return E_GENERIC;
+  }
+  return E_OK;
+}
+
+
+/* spill__open_segment
+ * Opens a segment to append to, with room for at least needed bytes.  Takes a free one if there is one; otherwise cleans the sealed
+ * segment with the fewest live bytes into it.  Caller MUST hold the tier's lock, and no segment may be open.
+ */
+int spill__open_segment(SpillTier *spill, uint32_t needed) {
+  uint32_t sparsest = 0;
+  for(uint32_t i=0; i<spill->segment_count; i++) {
+    if(spill->segments[i].used == 0) {
+      spill->open_segment = i;
+      return E_OK;
+    }
+    if(spill->segments[i].live < spill->segments[sparsest].live)
+      sparsest = i;
+  }
+  return spill__clean(spill, sparsest, needed);
+}
+
+
+/* spill__clean
+ * Reuses a sealed segment as the open one.  Its live records are read back and copied to the front of the batch, so they survive
+ * and the dead space between them is reclaimed.  If they wouldn't leave room for needed more bytes, they're expired instead:  the
+ * file is full of live data and something has to go.  Caller MUST hold the tier's lock.
+ */
+int spill__clean(SpillTier *spill, uint32_t segment, uint32_t needed) {
+  SpillSegment *victim = &spill->segments[segment];
+  const uint32_t OLD_USED = victim->used;
+  bool keep = victim->live + needed <= SPILL_SEGMENT_SIZE;
+  if(keep && victim->live > 0 && pread(spill->fd, spill->scratch, OLD_USED, (off_t)segment * SPILL_SEGMENT_SIZE) != (ssize_t)OLD_USED)
+    keep = false;
+  if(!keep)
+    spill__expire(spill, segment);
+  spill->cleanings++;
+  spill->open_segment = segment;
+  if(!keep || victim->live == 0) {
+    victim->used = 0;
+    victim->live = 0;
+    return E_OK;
+  }
+
+  // Walk the old records.  The ones the index still points at get copied forward and re-pointed; live doesn't change.
+  SpillRecord header;
+  int64_t slot = -1;
+  uint32_t offset = 0, length = 0;
+  victim->used = 0;
+  while(offset + sizeof(SpillRecord) <= OLD_USED) {
+    memcpy(&header, spill->scratch + offset, sizeof(SpillRecord));
+    length = sizeof(SpillRecord) + (header.comp_length != 0 ? header.comp_length : header.data_length);
+    slot = spill__find_slot(spill, header.id);
+    if(slot >= 0 && spill->slots[slot].segment == segment && spill->slots[slot].offset == offset) {
+      memcpy(spill->batch + victim->used, spill->scratch + offset, length);
+      spill->slots[slot].offset = victim->used;
+      victim->used += length;
+      spill->moved++;
+    }
+    offset += length;
+  }
+  return E_OK;
+}
+
+
+/* spill__expire
+ * Forgets every record in a segment.  Backward-shift deletes can pull a later slot into the one we just emptied, so we only move
+ * on when the current slot is one we're keeping.  Caller MUST hold the tier's lock.
+ */
+void spill__expire(SpillTier *spill, uint32_t segment) {
+  uint32_t i = 0;
+  while(i <= spill->slot_mask) {
+    if(spill->slots[i].id == BUFFER_ID_MAX || spill->slots[i].segment != segment) {
+      i++;
+      continue;
+    }
+    spill->live_bytes -= spill->slots[i].length;
+    spill->entries--;
+    spill->expired++;
+    spill__unlink(spill, i);
+  }
+  spill->segments[segment].live = 0;
+  return;
+}
+
+
+/* spill__find_slot
+ * Returns the index slot holding id, or -1.  Caller MUST hold the tier's lock.
+ */
+int64_t spill__find_slot(SpillTier *spill, bufferid_t id) {
+  uint32_t i = SPILL_HASH(spill, id);
+  while(spill->slots[i].id != BUFFER_ID_MAX) {
+    if(spill->slots[i].id == id)
+      return i;
+    i = (i + 1) & spill->slot_mask;
+  }
+  return -1;
+}
+
+
+/* spill__unlink
+ * Empties an index slot and shifts later members of its probe run back, the same as ghost__unlink().  Caller MUST hold the tier's
+ * lock and have already taken the record's bytes off its segment.  The record's dictionary reference is released here, since every
+ * way out of the index comes through.
+ */
+void spill__unlink(SpillTier *spill, uint32_t slot) {
+  uint32_t hole = slot, next = slot, home = 0;
+  dict__release(spill->slots[hole].dict_id);
+  spill->slots[hole].id = BUFFER_ID_MAX;
+  spill->slots[hole].dict_id = DICT_NONE;
+  for(;;) {
+    next = (next + 1) & spill->slot_mask;
+    if(spill->slots[next].id == BUFFER_ID_MAX)
+      return;
+    // An entry can fill the hole unless its home slot sits cyclically in (hole, next].
+    home = SPILL_HASH(spill, spill->slots[next].id);
+    if((next > hole && (home <= hole || home > next)) || (next < hole && home <= hole && home > next)) {
+      spill->slots[hole] = spill->slots[next];
+      spill->slots[next].id = BUFFER_ID_MAX;
+      spill->slots[next].dict_id = DICT_NONE;
+      hole = next;
+    }
+  }
+}
+
+
+/* spill__show
+ * Prints spill tier statistics for list__show_structure() and the manager.
+ */
+void spill__show(SpillTier *spill) {
+  printf("Spill tier                      : %s, %'"PRIu32" segments of %'d bytes.  %'"PRIu32" records, %'"PRIu64" live bytes\n", spill->path, spill->segment_count, SPILL_SEGMENT_SIZE, spill->entries, spill->live_bytes);
+  printf("  Traffic                       : %'"PRIu64" spilled (%'"PRIu64" refused), %'"PRIu64" restored of %'"PRIu64" asked for.  %'"PRIu64" segment writes, %'"PRIu64" preads\n",
+         spill->spills, spill->refused, spill->hits, spill->hits + spill->misses, spill->writes, spill->reads);
+  printf("  Cleaning                      : %'"PRIu64" segments cleaned, %'"PRIu64" records moved, %'"PRIu64" expired\n", spill->cleanings, spill->moved, spill->expired);
+  return;
+}
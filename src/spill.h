@@ -0,0 +1,103 @@
+/*
+ * spill.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: Kyle Harper
+ * Description: Spill tier.  A third tier behind raw and compressed:  compressed buffers the sweeper evicts are appended, image and
+ *              all, to a log-structured file instead of vanishing.  The file is cut into fixed-size segments.  Records go into
+ *              an in-memory copy of the open segment and hit the disk in one sequential write once it fills.  An open-addressing
+ *              hash maps each ID to its newest record, so getting a buffer back is one pread (or none, if its segment is still
+ *              open) plus a decompress.
+ *
+ *              Records that are taken back, dropped, or spilled again leave dead bytes behind.  When no segment is free, the
+ *              sealed segment with the fewest live bytes is cleaned:  its live records are copied into the new open segment and
+ *              the rest of it is reused.  If even that segment is too full to make room, its records are expired instead.
+ */
+
+#ifndef SRC_SPILL_H_
+#define SRC_SPILL_H_
+
+/* Includes */
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "buffer.h"
+
+
+/* Limits. */
+#define SPILL_SEGMENT_SIZE    (1 << 20)           /* Bytes per segment, and per write. */
+#define SPILL_MIN_SEGMENTS    4                   /* Fewest segments a spill file is cut into, whatever max_bytes says. */
+#define SPILL_DEFAULT_BYTES   (256 * 1024 * 1024) /* File size for -S when no size is given. */
+#define SPILL_MIN_ENTRIES     1024                /* Smallest index we bother building. */
+#define SPILL_EXPECTED_SIZE   2048                /* Guess at an average record, used to size the index. */
+#define SPILL_NONE            UINT32_MAX          /* Segment number for "no segment". */
+
+
+/* What precedes each image in a segment. */
+typedef struct spillrecord SpillRecord;
+struct spillrecord {
+  bufferid_t id;                  /* The buffer the image belongs to. */
+  uint32_t data_length;           /* Bytes in the page once decompressed. */
+  uint32_t comp_length;           /* Bytes in the image.  0 if the image is the raw page (data_length bytes). */
+  uint8_t codec_id;               /* Compressor that made the image (Buffer->codec_id). */
+};
+
+/* Where an ID's newest record lives.  Slots with id BUFFER_ID_MAX are empty. */
+typedef struct spillentry SpillEntry;
+struct spillentry {
+  bufferid_t id;                  /* The buffer ID, or BUFFER_ID_MAX for an empty slot. */
+  uint32_t offset;                /* Byte offset of the record within its segment. */
+  uint32_t segment;               /* Segment the record is in. */
+  uint32_t length;                /* Bytes the record takes up, header included. */
+  uint8_t dict_id;                /* Dictionary the image was compressed with.  The entry holds a reference on it (see dict.h). */
+};
+
+typedef struct spillsegment SpillSegment;
+struct spillsegment {
+  uint32_t used;                  /* Bytes written into the segment.  0 when it's free. */
+  uint32_t live;                  /* Bytes of records the index still points at. */
+};
+
+typedef struct spilltier SpillTier;
+struct spilltier {
+  pthread_mutex_t lock;           /* Spills come from the sweeper and restores from readers; one lock covers it all, I/O included. */
+  int fd;                         /* The spill file. */
+  char *path;                     /* Where it lives.  Unlinked on destroy. */
+  SpillSegment *segments;         /* Usage of every segment in the file. */
+  uint32_t segment_count;         /* Segments in the file. */
+  uint32_t open_segment;          /* Segment being filled in ->batch, or SPILL_NONE. */
+  uint8_t *batch;                 /* The open segment's bytes.  Written in one go when it's sealed. */
+  uint8_t *scratch;               /* A segment's worth of room to read a segment being cleaned into. */
+  SpillEntry *slots;              /* Index by ID.  Linear probing with backward-shift deletes. */
+  uint32_t slot_mask;             /* Index slots - 1.  A power of 2. */
+  uint32_t entries;               /* Records the index points at. */
+  uint64_t live_bytes;            /* Sum of ->live over all segments. */
+  uint64_t spills;                /* Images spill__put() took. */
+  uint64_t refused;               /* Images spill__put() turned away:  too big, or the index was full. */
+  uint64_t hits;                  /* spill__take() calls that found their ID. */
+  uint64_t misses;                /* spill__take() calls that didn't. */
+  uint64_t writes;                /* Segments written to the file. */
+  uint64_t reads;                 /* preads that brought a record back. */
+  uint64_t cleanings;             /* Segments cleaned to make room. */
+  uint64_t moved;                 /* Live records copied forward by cleaning. */
+  uint64_t expired;               /* Live records lost because cleaning couldn't keep them. */
+};
+
+
+/* Prototypes */
+int spill__initialize(SpillTier **spill, const char *path, uint64_t max_bytes);
+void spill__destroy(SpillTier *spill);
+int spill__put(SpillTier *spill, bufferid_t id, const void *image, uint32_t data_length, uint32_t comp_length, uint8_t codec_id, uint8_t dict_id);
+int spill__take(SpillTier *spill, bufferid_t id, Buffer **buf);
+void spill__drop(SpillTier *spill, bufferid_t id);
+void spill__drop_locked(SpillTier *spill, bufferid_t id);
+int spill__seal(SpillTier *spill);
+int spill__open_segment(SpillTier *spill, uint32_t needed);
+int spill__clean(SpillTier *spill, uint32_t segment, uint32_t needed);
+void spill__expire(SpillTier *spill, uint32_t segment);
+int64_t spill__find_slot(SpillTier *spill, bufferid_t id);
+void spill__unlink(SpillTier *spill, uint32_t slot);
+void spill__show(SpillTier *spill);
+
+
+#endif /* SRC_SPILL_H_ */
@@ -13,11 +13,21 @@
 #include <unistd.h>
 #include <locale.h>
 #include <inttypes.h>
+#include <math.h>
 #include "list.h"
+#include "admit.h"
+#include "arena.h"
 #include "buffer.h"
+#include "dict.h"
+#include "ghost.h"
 #include "options.h"
+#include "policy.h"
+#include "spill.h"
 #include "tests.h"
+#include "window.h"
 #include "lz4/lz4.h"
+#include "zlib/zlib.h"
+#include "zstd/zstd.h"
 #include "error.h"
 
 
@@ -25,13 +35,36 @@
 #define BILLION 1000000000L
 #define MILLION    1000000L
 
+/* Phases of the index benchmark. */
+#define INDEX_BENCH_ADD     0
+#define INDEX_BENCH_SEARCH  1
+#define INDEX_BENCH_REMOVE  2
+
 extern const int E_OK;
 extern const int E_BAD_CLI;
 extern const int E_BUFFER_NOT_FOUND;
+extern const int E_BUFFER_NOT_ADMITTED;
 extern const int E_GENERIC;
+extern const int E_BAD_ARGS;
 
 extern const int BUFFER_OVERHEAD;
 
+extern const int NO_COMPRESSOR_ID;
+extern const int LZ4_COMPRESSOR_ID;
+extern const int ZLIB_COMPRESSOR_ID;
+extern const int ZSTD_COMPRESSOR_ID;
+extern const int ADAPTIVE_COMPRESSOR_ID;
+extern const int INDEX_LOCKING;
+extern const int INDEX_LOCK_FREE;
+extern const int INDEX_FAT_NODE;
+extern const int INDEX_HASH;
+extern const int POLICY_CLOCK;
+extern const int POLICY_GDSF;
+extern const int HAVE_PIN;
+extern const int NEED_PIN;
+extern const int SCAN_HAVE_PIN;
+extern const int SCAN_NO_PROMOTE;
+
 //extern const int KEEP_DATA;
 extern const int DESTROY_DATA;
 
@@ -41,13 +74,32 @@ extern Options opts;
 
 void tests__show_available() {
   printf("Available Tests (case-sensitive)\n");
+  printf("             admission :  TinyLFU sketch counts and aging, and list__add() turning one-time buffers away from a full raw list.\n");
   printf("                   all :  Run all tests.\n");
+  printf("                 arena :  Exact-size placement of compressed images in arena segments, and compaction giving sparse ones back.\n");
+  printf("                codecs :  Entropy probe and per-page lz4/zstd choice for -c adaptive, and images keeping their own codec.\n");
   printf("           compression :  Test basic compression and buffer compression.\n");
+  printf(" compression_benchmark :  Pages/sec for one-shot compress/decompress calls vs reused per-thread contexts, per codec.  (Not part of 'all')\n");
+  printf("          dictionaries :  Trained zlib/zstd dictionaries shrinking small pages, holding the comp tier more, and retraining on drift.\n");
+  printf("              demotion :  Raw victims that aren't worth compressing get evicted instead, and buffers remember their compressed size.\n");
   printf("              elements :  Basic building of Buffer elements and adding/removing from a list.\n");
+  printf("                  gdsf :  GreedyDual-Size-Frequency credits, and the hand taking big, cheap-to-restore pages before small or dear ones.\n");
+  printf("                ghosts :  Ghost list aging, hits, and hash consistency under random inserts and takes.\n");
+  printf("       index_benchmark :  Add/search/remove throughput of the locking, lock-free, and fat node indexes.  (Not part of 'all')\n");
   printf("                    io :  Read pages from disk and store information in Buffers.\n");
+  printf("  interleaved_lookups :  Sequential vs sorted vs interleaved (AMAC) batched lookups on a list bigger than the LLC.  (Not part of 'all')\n");
+  printf("        lookup_latency :  Point lookup latency of the ordered indexes vs the hash index at 1M and 10M buffers.  (Not part of 'all')\n");
   printf("          move_buffers :  Purposely puts lists into conditions that trigger sweeping/pushing/popping.\n");
   printf("               options :  Shows the value of all options; great for debugging CLI issues.\n");
+  printf("           pin_scaling :  List pin/unpin throughput with 1 to 64 readers while a writer keeps taking the write lock.  (Not part of 'all')\n");
+  printf("              policies :  Each replacement policy keeps a hot set through a stream of one-time buffers, and its tiers add up.\n");
+  printf("                  scan :  Range scans over a list with some buffers compressed, with and without promotion.\n");
+  printf("                 spill :  A log-structured spill file cleaning and expiring segments, and a list restoring evicted pages from it.\n");
+  printf("           sweep_hands :  Reclamation bandwidth (bytes/sec) with 1 to max_hands sweep hands splitting the raw tier by ID.\n");
+  printf("          sweep_slices :  The sweeper reaches the low watermark in slices bounded by a victim count or a time budget.\n");
   printf("synchronized_readwrite :  Extensive test proving asynchronous behavior is safe.\n");
+  printf("            watermarks :  The sweeper reclaims in the background past the high watermark, so adds rarely wait on it.\n");
+  printf("               windows :  Frequency folding and decay per window, Zipf fits, and the clock sparing a hot set sized from them.\n");
   printf("\n");
   return;
 }
@@ -66,39 +118,127 @@ void tests__run_test(List *raw_list, char **pages) {
   }
   /* ALL tests... */
   if(strcmp(opts.test, "all") == 0) {
+    printf("RUNNING TEST: tests__admission\n");
+    tests__admission();
     printf("RUNNING TEST: tests__compression\n");
     tests__compression();
+    printf("RUNNING TEST: tests__demotion\n");
+    tests__demotion();
     printf("RUNNING TEST: tests__elements\n");
     tests__elements(raw_list);
+    printf("RUNNING TEST: tests__ghosts\n");
+    tests__ghosts();
     printf("RUNNING TEST: tests__io\n");
     tests__io(pages);
     printf("RUNNING TEST: tests__move_buffers\n");
     tests__move_buffers(raw_list, pages);
+    printf("RUNNING TEST: tests__policies\n");
+    tests__policies();
+    printf("RUNNING TEST: tests__scan\n");
+    tests__scan();
     printf("RUNNING TEST: tests__options\n");
     tests__options(opts);
     printf("RUNNING TEST: tests__synchronized_readwrite\n");
     tests__synchronized_readwrite(raw_list);
+    printf("RUNNING TEST: tests__watermarks\n");
+    tests__watermarks();
+    printf("RUNNING TEST: tests__sweep_slices\n");
+    tests__sweep_slices();
+    printf("RUNNING TEST: tests__sweep_hands\n");
+    tests__sweep_hands();
+    printf("RUNNING TEST: tests__windows\n");
+    tests__windows();
+    printf("RUNNING TEST: tests__gdsf\n");
+    tests__gdsf();
+    printf("RUNNING TEST: tests__spill\n");
+    tests__spill();
+    printf("RUNNING TEST: tests__arena\n");
+    tests__arena();
+    printf("RUNNING TEST: tests__dictionaries\n");
+    tests__dictionaries();
+    printf("RUNNING TEST: tests__codecs\n");
+    tests__codecs();
     ran_test++;
   }
 
+  /* tests__admission */
+  if(strcmp(opts.test, "admission") == 0) {
+    printf("RUNNING TEST: tests__admission\n");
+    tests__admission();
+    ran_test++;
+  }
   /* tests__compression */
   if(strcmp(opts.test, "compression") == 0) {
     printf("RUNNING TEST: tests__compression\n");
     tests__compression();
     ran_test++;
   }
+  /* tests__compression_benchmark */
+  if(strcmp(opts.test, "compression_benchmark") == 0) {
+    printf("RUNNING TEST: tests__compression_benchmark\n");
+    tests__compression_benchmark(pages);
+    ran_test++;
+  }
+  /* tests__demotion */
+  if(strcmp(opts.test, "demotion") == 0) {
+    printf("RUNNING TEST: tests__demotion\n");
+    tests__demotion();
+    ran_test++;
+  }
   /* tests__elements */
   if(strcmp(opts.test, "elements") == 0) {
     printf("RUNNING TEST: tests__elements\n");
     tests__elements(raw_list);
     ran_test++;
   }
+  /* tests__ghosts */
+  if(strcmp(opts.test, "ghosts") == 0) {
+    printf("RUNNING TEST: tests__ghosts\n");
+    tests__ghosts();
+    ran_test++;
+  }
+  /* tests__index_benchmark */
+  if(strcmp(opts.test, "index_benchmark") == 0) {
+    printf("RUNNING TEST: tests__index_benchmark\n");
+    tests__index_benchmark();
+    ran_test++;
+  }
   /* tests__io */
   if(strcmp(opts.test, "io") == 0) {
     printf("RUNNING TEST: tests__io\n");
     tests__io(pages);
     ran_test++;
   }
+  /* tests__interleaved_lookups */
+  if(strcmp(opts.test, "interleaved_lookups") == 0) {
+    printf("RUNNING TEST: tests__interleaved_lookups\n");
+    tests__interleaved_lookups();
+    ran_test++;
+  }
+  /* tests__lookup_latency */
+  if(strcmp(opts.test, "lookup_latency") == 0) {
+    printf("RUNNING TEST: tests__lookup_latency\n");
+    tests__lookup_latency();
+    ran_test++;
+  }
+  /* tests__pin_scaling */
+  if(strcmp(opts.test, "pin_scaling") == 0) {
+    printf("RUNNING TEST: tests__pin_scaling\n");
+    tests__pin_scaling();
+    ran_test++;
+  }
+  /* tests__policies */
+  if(strcmp(opts.test, "policies") == 0) {
+    printf("RUNNING TEST: tests__policies\n");
+    tests__policies();
+    ran_test++;
+  }
+  /* tests__scan */
+  if(strcmp(opts.test, "scan") == 0) {
+    printf("RUNNING TEST: tests__scan\n");
+    tests__scan();
+    ran_test++;
+  }
   /* tests__move_buffers */
   if(strcmp(opts.test, "move_buffers") == 0) {
     printf("RUNNING TEST: tests__move_buffers\n");
@@ -118,6 +258,69 @@ void tests__run_test(List *raw_list, char **pages) {
     ran_test++;
   }
 
+  /* tests__codecs */
+  if(strcmp(opts.test, "codecs") == 0) {
+    printf("RUNNING TEST: tests__codecs\n");
+    tests__codecs();
+    ran_test++;
+  }
+
+  /* tests__dictionaries */
+  if(strcmp(opts.test, "dictionaries") == 0) {
+    printf("RUNNING TEST: tests__dictionaries\n");
+    tests__dictionaries();
+    ran_test++;
+  }
+
+  /* tests__arena */
+  if(strcmp(opts.test, "arena") == 0) {
+    printf("RUNNING TEST: tests__arena\n");
+    tests__arena();
+    ran_test++;
+  }
+
+  /* tests__spill */
+  if(strcmp(opts.test, "spill") == 0) {
+    printf("RUNNING TEST: tests__spill\n");
+    tests__spill();
+    ran_test++;
+  }
+
+  /* tests__gdsf */
+  if(strcmp(opts.test, "gdsf") == 0) {
+    printf("RUNNING TEST: tests__gdsf\n");
+    tests__gdsf();
+    ran_test++;
+  }
+
+  /* tests__windows */
+  if(strcmp(opts.test, "windows") == 0) {
+    printf("RUNNING TEST: tests__windows\n");
+    tests__windows();
+    ran_test++;
+  }
+
+  /* tests__sweep_hands */
+  if(strcmp(opts.test, "sweep_hands") == 0) {
+    printf("RUNNING TEST: tests__sweep_hands\n");
+    tests__sweep_hands();
+    ran_test++;
+  }
+
+  /* tests__sweep_slices */
+  if(strcmp(opts.test, "sweep_slices") == 0) {
+    printf("RUNNING TEST: tests__sweep_slices\n");
+    tests__sweep_slices();
+    ran_test++;
+  }
+
+  /* tests__watermarks */
+  if(strcmp(opts.test, "watermarks") == 0) {
+    printf("RUNNING TEST: tests__watermarks\n");
+    tests__watermarks();
+    ran_test++;
+  }
+
   /* Stop Timer and Leave */
   clock_gettime(CLOCK_MONOTONIC, &end);
   int test_ms = (BILLION *(end.tv_sec - start.tv_sec) + end.tv_nsec - start.tv_nsec) / MILLION;
@@ -267,7 +470,8 @@ void tests__elements(List *list) {
       show_error(E_GENERIC, "One or more of the extended options passed in ended up 0, this means you sent a 0 or bad input:\n");
   }
   opts.max_memory = BUFFER_OVERHEAD * element_count;
-  list->max_raw_size = opts.max_memory;
+  // Every element has to fit under the high watermark, or the sweeper starts taking them away.  This test is about the index.
+  list->max_raw_size = opts.max_memory * 100 / list->watermark_high + BUFFER_OVERHEAD;
 
   // Add all the buffers.
   printf("Step 1.  Adding %d dummy buffers to the list in with random IDs.\n", element_count);
@@ -294,15 +498,40 @@ void tests__elements(List *list) {
   printf("Got the buffer, it's ref count is %"PRIu16".\n", buf->ref_count);
   __sync_fetch_and_add(&buf->ref_count, -1);
 
+  // Search for a batch of random IDs (some missing, some repeated) and make sure each one agrees with a plain search.
+  printf("\nStep 4.  Searching for a batch of buffers and comparing with single searches.\n");
+  const int BATCH_SIZE = 500;
+  bufferid_t ids[BATCH_SIZE];
+  Buffer *bufs[BATCH_SIZE];
+  int results[BATCH_SIZE];
+  for(int i=0; i<BATCH_SIZE; i++)
+    ids[i] = i % 10 == 0 ? 1 : rand() % (element_count * 10);
+  // Once sorted, once interleaved (which only changes anything for the locking skiplist).
+  for(int interleave=0; interleave<=8; interleave+=8) {
+    list->search_interleave = interleave;
+    list__search_many(list, ids, BATCH_SIZE, bufs, results, 0);
+    for(int i=0; i<BATCH_SIZE; i++) {
+      rv = list__search(list, &buf, ids[i], 0);
+      if (rv != results[i] || (rv == E_OK && buf != bufs[i]))
+        show_error(E_GENERIC, "Batched search disagreed with list__search for ID %"PRIu32" (rv %d vs %d).\n", ids[i], results[i], rv);
+      if (rv == E_OK) {
+        __sync_fetch_and_add(&buf->ref_count, -1);
+        __sync_fetch_and_add(&bufs[i]->ref_count, -1);
+      }
+    }
+    printf("All %d batched lookups matched (interleave %d).\n", BATCH_SIZE, interleave);
+  }
+  list->search_interleave = 0;
+
   // Remove the buffers.
-  printf("\nStep 4.  Removing all the dummy buffers.\n");
+  printf("\nStep 5.  Removing all the dummy buffers.\n");
   while(list->head->next != list->head) {
     __sync_fetch_and_add(&list->head->next->ref_count, 1);
     list__remove(list, list->head->next);
   }
 
   // Display the statistics of the list again.
-  printf("\nStep 5.  Showing list statistics.\n");
+  printf("\nStep 6.  Showing list statistics.\n");
   list__show_structure(list);
 
   printf("Test 'elements': All Passed\n");
@@ -310,6 +539,992 @@ void tests__elements(List *list) {
 }
 
 
+/* tests__ghosts
+ * Fills a ghost list past its capacity to make sure the oldest ghosts age out by bytes and by ring size, checks that takes count
+ * hits and leave holes behind, then churns it with random inserts and takes and checks the ring and hash still agree.
+ */
+void tests__ghosts() {
+  const uint32_t SIZE = 100, CAPACITY = 500, ROUNDS = 200000, ID_RANGE = 4000;
+  GhostList *ghosts = NULL;
+  uint64_t live = 0, live_bytes = 0, used_slots = 0;
+  int rv = E_OK;
+
+  rv = ghost__initialize(&ghosts, (uint64_t)SIZE * CAPACITY, SIZE);
+  if (rv != E_OK)
+    show_error(E_GENERIC, "Unable to initialize a ghost list.  rv was %d", rv);
+
+  printf("Step 1.  Inserting %"PRIu32" ghosts into a list that only holds %"PRIu32".\n", CAPACITY * 3, CAPACITY);
+  for(bufferid_t id=1; id<=CAPACITY * 3; id++)
+    ghost__insert(ghosts, id, SIZE);
+  if (ghosts->bytes != (uint64_t)SIZE * CAPACITY)
+    show_error(E_GENERIC, "Ghost list holds %"PRIu64" bytes, expected %"PRIu64".", ghosts->bytes, (uint64_t)SIZE * CAPACITY);
+  for(bufferid_t id=1; id<=CAPACITY * 3; id++)
+    if ((ghost__find_slot(ghosts, id) >= 0) != (id > CAPACITY * 2))
+      show_error(E_GENERIC, "Ghost %"PRIu32" should%s have aged out.", id, id > CAPACITY * 2 ? " not" : "");
+  printf("Oldest %"PRIu32" aged out, newest %"PRIu32" remain.\n", CAPACITY * 2, CAPACITY);
+
+  printf("\nStep 2.  Taking every other ghost, then taking them again.\n");
+  for(bufferid_t id=CAPACITY * 2 + 1; id<=CAPACITY * 3; id+=2)
+    if (!ghost__take(ghosts, id, true))
+      show_error(E_GENERIC, "Ghost %"PRIu32" wasn't found.", id);
+  for(bufferid_t id=CAPACITY * 2 + 1; id<=CAPACITY * 3; id+=2)
+    if (ghost__take(ghosts, id, true))
+      show_error(E_GENERIC, "Ghost %"PRIu32" was taken twice.", id);
+  if (ghosts->hits != CAPACITY / 2 || ghosts->bytes != (uint64_t)SIZE * CAPACITY / 2)
+    show_error(E_GENERIC, "Expected %"PRIu32" hits and %"PRIu64" bytes, got %"PRIu64" and %"PRIu64".", CAPACITY / 2, (uint64_t)SIZE * CAPACITY / 2, ghosts->hits, ghosts->bytes);
+  if (ghost__take(ghosts, CAPACITY * 2 + 2, false) == false || ghosts->hits != CAPACITY / 2)
+    show_error(E_GENERIC, "A take without counting hits either missed or counted one.");
+  printf("Took %"PRIu64" ghosts; none could be taken twice.\n", ghosts->hits);
+
+  printf("\nStep 3.  Re-inserting the oldest remaining ghost moves it to the front.\n");
+  ghost__insert(ghosts, CAPACITY * 2 + 4, SIZE);
+  for(bufferid_t id=CAPACITY * 3 + 1; id<CAPACITY * 4; id++)
+    ghost__insert(ghosts, id, SIZE);
+  if (ghost__find_slot(ghosts, CAPACITY * 2 + 4) < 0 || ghost__find_slot(ghosts, CAPACITY * 2 + 6) >= 0)
+    show_error(E_GENERIC, "Re-inserted ghost didn't move to the front of the ring.");
+  printf("Ghost %"PRIu32" survived while its old neighbors aged out.\n", CAPACITY * 2 + 4);
+
+  printf("\nStep 4.  Churning with %"PRIu32" random inserts and takes of various sizes.\n", ROUNDS);
+  srand(42);
+  for(uint32_t i=0; i<ROUNDS; i++) {
+    bufferid_t id = rand() % ID_RANGE;
+    if (rand() % 3 == 0) {
+      ghost__take(ghosts, id, true);
+      if (ghost__find_slot(ghosts, id) >= 0)
+        show_error(E_GENERIC, "Ghost %"PRIu32" is still findable after being taken.", id);
+    } else {
+      ghost__insert(ghosts, id, 1 + rand() % (SIZE * 2));
+      if (ghost__find_slot(ghosts, id) < 0)
+        show_error(E_GENERIC, "Ghost %"PRIu32" isn't findable right after being inserted.", id);
+    }
+  }
+  for(uint64_t pos=ghosts->tail; pos<ghosts->head; pos++) {
+    GhostEntry *entry = &ghosts->ring[pos & ghosts->ring_mask];
+    if (entry->id == BUFFER_ID_MAX)
+      continue;
+    int64_t slot = ghost__find_slot(ghosts, entry->id);
+    if (slot < 0 || ghosts->slots[slot] - 1 != (pos & ghosts->ring_mask))
+      show_error(E_GENERIC, "Ghost %"PRIu32" in the ring doesn't hash back to its own position.", entry->id);
+    live++;
+    live_bytes += entry->size;
+  }
+  for(uint32_t i=0; i<=ghosts->slot_mask; i++)
+    if (ghosts->slots[i] != GHOST_EMPTY)
+      used_slots++;
+  if (used_slots != live || live_bytes != ghosts->bytes || ghosts->bytes > ghosts->max_bytes)
+    show_error(E_GENERIC, "Ring and hash disagree: %"PRIu64" live ghosts, %"PRIu64" hash slots, %"PRIu64" bytes counted, %"PRIu64" recorded.", live, used_slots, live_bytes, ghosts->bytes);
+  printf("%"PRIu64" live ghosts (%"PRIu64" bytes) all hash back to their ring positions.\n", live, live_bytes);
+
+  ghost__destroy(ghosts);
+  printf("Test 'ghosts': All Passed\n");
+  return;
+}
+
+
+/* tests__admission
+ * Checks the sketch and doorkeeper count accesses the way TinyLFU should, and that aging halves them.  Then streams one-time
+ * buffers past a small hot set twice, once without a filter and once with one, and makes sure the filter turns the stream away
+ * (with the caller keeping its copy) so the hot set stays put and the sweeper has less to compress.
+ */
+void tests__admission() {
+  const uint32_t PAGE_SIZE = 4096, HOT = 32, STREAM = 4000, RAW_PAGES = 128, COMP_PAGES = 256;
+  AdmissionFilter *filter = NULL;
+  List *list = NULL;
+  Buffer *buf = NULL;
+  void *data = NULL;
+  uint64_t compressions[2] = {0, 0};
+  uint32_t hot_misses = 0, not_admitted = 0;
+  uint8_t estimate = 0;
+  int rv = E_OK;
+
+  printf("Step 1.  Counting accesses.\n");
+  rv = admit__initialize(&filter, 1000 * 100, 100);
+  if (rv != E_OK)
+    show_error(E_GENERIC, "Unable to initialize an admission filter.  rv was %d", rv);
+  admit__record(filter, 7);
+  if (admit__estimate(filter, 7) != 1)
+    show_error(E_GENERIC, "One access should only reach the doorkeeper (estimate 1), got %"PRIu8".", admit__estimate(filter, 7));
+  for(int i=0; i<5; i++)
+    admit__record(filter, 7);
+  if (admit__estimate(filter, 7) != 6)
+    show_error(E_GENERIC, "Six accesses should estimate 6, got %"PRIu8".", admit__estimate(filter, 7));
+  if (admit__estimate(filter, 8) != 0)
+    show_error(E_GENERIC, "An ID never recorded should estimate 0, got %"PRIu8".", admit__estimate(filter, 8));
+  for(int i=0; i<100; i++)
+    admit__record(filter, 9);
+  if (admit__estimate(filter, 9) != ADMIT_COUNTER_MAX + 1)
+    show_error(E_GENERIC, "Counters should saturate at %d (estimate %d), got %"PRIu8".", ADMIT_COUNTER_MAX, ADMIT_COUNTER_MAX + 1, admit__estimate(filter, 9));
+  if (!admit__allow(filter, 7, 8) || admit__allow(filter, 8, 7) || admit__allow(filter, 7, 7))
+    show_error(E_GENERIC, "admit__allow() should only let a candidate in over a less popular victim.");
+  printf("Estimates: 1 access -> 1, 6 accesses -> 6, none -> 0, 100 accesses -> %d.  Ties go to the victim.\n", ADMIT_COUNTER_MAX + 1);
+
+  printf("\nStep 2.  Recording %"PRIu64" one-time accesses to trigger aging.\n", filter->sample_size);
+  for(bufferid_t id=1000; filter->resets == 0; id++)
+    admit__record(filter, id);
+  estimate = admit__estimate(filter, 7);
+  if (estimate < 2 || estimate > 3)
+    show_error(E_GENERIC, "After aging, 5 sketch counts should halve to 2 with no doorkeeper bit (estimate 2, maybe 3 from collisions), got %"PRIu8".", estimate);
+  printf("Aged %"PRIu64" time(s); ID 7 now estimates %"PRIu8".  Sketch and doorkeeper use %'"PRIu64" bytes.\n", filter->resets, estimate, filter->memory);
+  admit__destroy(filter);
+
+  for(int pass=0; pass<2; pass++) {
+    printf("\nStep %d.  %"PRIu32" hot buffers read between each of %"PRIu32" one-time buffers, %s.\n", pass + 3, HOT, STREAM, pass == 0 ? "admitting everything" : "through an admission filter");
+    rv = list__initialize(&list, 1, LZ4_COMPRESSOR_ID, 1, (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * (RAW_PAGES + COMP_PAGES), opts.index_mode, POLICY_CLOCK);
+    if (rv != E_OK)
+      show_error(E_GENERIC, "Unable to initialize a list for the admission test.  rv was %d", rv);
+    list->max_raw_size = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * RAW_PAGES;
+    list->max_comp_size = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE / 32) * COMP_PAGES;
+    if (pass == 1 && admit__initialize(&list->admission, (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * (RAW_PAGES + COMP_PAGES), BUFFER_OVERHEAD + PAGE_SIZE) != E_OK)
+      show_error(E_GENERIC, "Unable to initialize the list's admission filter.");
+
+    hot_misses = 0;
+    not_admitted = 0;
+    for(bufferid_t id=0; id<HOT + STREAM; id++) {
+      data = malloc(PAGE_SIZE);
+      memset(data, id % 251, PAGE_SIZE);
+      memcpy(data, &id, sizeof(bufferid_t));
+      buffer__initialize(&buf, id, PAGE_SIZE, data, NULL);
+      rv = list__add(list, buf, NEED_PIN);
+      if (rv == E_BUFFER_NOT_ADMITTED) {
+        // Still ours, and still intact.
+        if (memcmp(buf->data, &id, sizeof(bufferid_t)) != 0)
+          show_error(E_GENERIC, "Buffer %"PRIu32" was changed even though it wasn't admitted.", id);
+        buffer__destroy(buf, DESTROY_DATA);
+        not_admitted++;
+      } else if (rv != E_OK) {
+        show_error(E_GENERIC, "Failed to add buffer %"PRIu32" to the list.  rv was %d", id, rv);
+      }
+      if (id < HOT)
+        continue;
+      for(bufferid_t hot_id=(id % HOT) / 8 * 8; hot_id<(id % HOT) / 8 * 8 + 8; hot_id++) {
+        rv = list__search(list, &buf, hot_id, NEED_PIN);
+        if (rv == E_OK) {
+          __sync_fetch_and_add(&buf->ref_count, -1);
+          continue;
+        }
+        hot_misses++;
+        data = malloc(PAGE_SIZE);
+        memcpy(data, &hot_id, sizeof(bufferid_t));
+        buffer__initialize(&buf, hot_id, PAGE_SIZE, data, NULL);
+        if (list__add(list, buf, NEED_PIN) != E_OK)
+          buffer__destroy(buf, DESTROY_DATA);
+      }
+    }
+    compressions[pass] = list->compressions;
+    printf("Hot set misses: %"PRIu32" of %"PRIu32" reads.  %"PRIu32" buffers not admitted.  %"PRIu64" compressions, %"PRIu64" evictions.\n", hot_misses, STREAM * 8, not_admitted, list->compressions, list->evictions);
+    if (pass == 0 && not_admitted != 0)
+      show_error(E_GENERIC, "A list without a filter turned %"PRIu32" buffers away.", not_admitted);
+    if (pass == 1 && not_admitted < STREAM / 2)
+      show_error(E_GENERIC, "The filter only turned away %"PRIu32" of %"PRIu32" one-time buffers.", not_admitted, STREAM);
+    if (hot_misses > STREAM * 8 / 20)
+      show_error(E_GENERIC, "The hot set missed %"PRIu32" times, more than 5%% of reads.", hot_misses);
+    list__destroy(list);
+  }
+  if (compressions[1] >= compressions[0])
+    show_error(E_GENERIC, "The filter should have saved compressions (%"PRIu64" with it, %"PRIu64" without).", compressions[1], compressions[0]);
+
+  printf("Test 'admission': All Passed\n");
+  return;
+}
+
+
+/* tests__demotion
+ * Checks list__worth_compressing() weighs space saved, restores, and time the way it says it does, and that a buffer remembers its
+ * compressed size across a restore.  Then streams pages through a small list where every odd page is random (incompressible):  the
+ * compressors should send those straight out instead of into the comp tier, while the even pages compress as usual.
+ */
+void tests__demotion() {
+  const uint32_t PAGE_SIZE = 4096, STREAM = 2000, RAW_PAGES = 64, COMP_PAGES = 256;
+  List *list = NULL;
+  Buffer *buf = NULL;
+  void *data = NULL;
+  void *compressed_data = NULL;
+  uint64_t restorations = 0;
+  uint32_t found = 0;
+  int rv = E_OK;
+
+  rv = list__initialize(&list, 1, LZ4_COMPRESSOR_ID, 1, (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * (RAW_PAGES + COMP_PAGES), opts.index_mode, POLICY_CLOCK);
+  if (rv != E_OK)
+    show_error(E_GENERIC, "Unable to initialize a list for the demotion test.  rv was %d", rv);
+  list->max_raw_size = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * RAW_PAGES;
+  list->max_comp_size = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE / 32) * COMP_PAGES;
+
+  printf("Step 1.  Deciding compress vs. drop for a %"PRIu32" byte page.\n", PAGE_SIZE);
+  buffer__initialize(&buf, 1, 0, NULL, NULL);
+  buf->data_length = PAGE_SIZE;
+  if (!list__worth_compressing(list, buf, 0))
+    show_error(E_GENERIC, "A page that was never compressed has to be tried.");
+  if (!list__worth_compressing(list, buf, PAGE_SIZE / 4))
+    show_error(E_GENERIC, "A page that compresses 4:1 should be worth compressing.");
+  if (list__worth_compressing(list, buf, PAGE_SIZE - 64) || list__worth_compressing(list, buf, PAGE_SIZE + 16))
+    show_error(E_GENERIC, "A page that barely compresses (or grows) shouldn't be kept compressed.");
+  buf->comp_hits = 4;
+  if (!list__worth_compressing(list, buf, PAGE_SIZE * 15 / 16))
+    show_error(E_GENERIC, "A page restored 4 times should earn a place with only 1/16 saved.");
+  buf->comp_cost = (2 * 4 + 1) * RATIO_MISS_PENALTY;
+  if (list__worth_compressing(list, buf, PAGE_SIZE / 4))
+    show_error(E_GENERIC, "A page that costs as much to decompress as to reload shouldn't be compressed.");
+  list->compressor_id = NO_COMPRESSOR_ID;
+  if (!list__worth_compressing(list, buf, PAGE_SIZE + 16))
+    show_error(E_GENERIC, "Without a compressor everything should qualify.");
+  list->compressor_id = LZ4_COMPRESSOR_ID;
+  buffer__destroy(buf, DESTROY_DATA);
+  printf("Unknown and 4:1 pages compress, nearly-incompressible and slow ones don't, restored pages get a looser bar.\n");
+
+  printf("\nStep 2.  Compressed size survives a restore.\n");
+  data = malloc(PAGE_SIZE);
+  memset(data, 7, PAGE_SIZE);
+  buffer__initialize(&buf, 1, PAGE_SIZE, data, NULL);
+  if (buffer__compress(buf, &compressed_data, LZ4_COMPRESSOR_ID, 1, codec__thread_context(), NULL) != E_OK)
+    show_error(E_GENERIC, "Failed to compress a buffer.");
+  free(buf->data);
+  buf->data = compressed_data;
+  const uint32_t COMP_LENGTH = buf->comp_length;
+  if (buffer__decompress(buf, codec__thread_context()) != E_OK)
+    show_error(E_GENERIC, "Failed to decompress a buffer.");
+  if (buf->comp_length != 0 || buf->last_comp_length != COMP_LENGTH)
+    show_error(E_GENERIC, "Expected comp_length 0 and last_comp_length %"PRIu32" after restoring, got %"PRIu32" and %"PRIu32".", COMP_LENGTH, buf->comp_length, buf->last_comp_length);
+  buffer__destroy(buf, DESTROY_DATA);
+  printf("Compressed to %"PRIu32" bytes, and still remembers it after decompressing.\n", COMP_LENGTH);
+
+  printf("\nStep 3.  Streaming %"PRIu32" pages, every odd one random, through %"PRIu32" raw pages.\n", STREAM, RAW_PAGES);
+  srand(42);
+  for(bufferid_t id=0; id<STREAM; id++) {
+    data = malloc(PAGE_SIZE);
+    memset(data, id % 251, PAGE_SIZE);
+    if (id % 2 == 1)
+      for(uint32_t i=0; i<PAGE_SIZE; i++)
+        ((uint8_t *)data)[i] = rand();
+    memcpy(data, &id, sizeof(bufferid_t));
+    buffer__initialize(&buf, id, PAGE_SIZE, data, NULL);
+    if (list__add(list, buf, NEED_PIN) != E_OK)
+      show_error(E_GENERIC, "Failed to add buffer %"PRIu32" to the list.", id);
+  }
+  // Let the sweeper and compressors finish before checking the books.
+  for(int i=0; i<100 && list->raw_count + list->comp_count + list->evictions != STREAM; i++)
+    usleep(10000);
+  printf("%"PRIu64" compressions, %"PRIu64" victims evicted instead, %"PRIu64" evictions.  %"PRIu32" raw, %"PRIu32" compressed.\n", list->compressions, list->compression_skips, list->evictions, list->raw_count, list->comp_count);
+  if (list->raw_count + list->comp_count + list->evictions != STREAM)
+    show_error(E_GENERIC, "%"PRIu32" raw + %"PRIu32" compressed + %"PRIu64" evicted doesn't add up to the %"PRIu32" pages added.", list->raw_count, list->comp_count, list->evictions, STREAM);
+  if (list->compression_skips < (STREAM - RAW_PAGES) / 2 - RAW_PAGES || list->compression_skips > STREAM / 2)
+    show_error(E_GENERIC, "Expected about %"PRIu32" random pages to be evicted instead of compressed, got %"PRIu64".", (STREAM - RAW_PAGES) / 2, list->compression_skips);
+
+  printf("\nStep 4.  Searching every page; only the even ones should need a restore.\n");
+  restorations = list->restorations;
+  for(bufferid_t id=1; id<STREAM; id+=2) {
+    if (list__search(list, &buf, id, NEED_PIN) != E_OK)
+      continue;
+    __sync_fetch_and_add(&buf->ref_count, -1);
+  }
+  if (list->restorations != restorations)
+    show_error(E_GENERIC, "%"PRIu64" random pages were kept compressed.", list->restorations - restorations);
+  for(bufferid_t id=0; id<STREAM; id+=2) {
+    if (list__search(list, &buf, id, NEED_PIN) != E_OK)
+      continue;
+    if (memcmp(buf->data, &id, sizeof(bufferid_t)) != 0)
+      show_error(E_GENERIC, "Buffer %"PRIu32" came back with the wrong page.", id);
+    if (buf->last_comp_length == 0 && list->restorations > restorations + found)
+      show_error(E_GENERIC, "Restored buffer %"PRIu32" forgot its compressed size.", id);
+    found = list->restorations - restorations;
+    __sync_fetch_and_add(&buf->ref_count, -1);
+  }
+  if (found == 0)
+    show_error(E_GENERIC, "None of the even pages were compressed; the test isn't testing anything.");
+  printf("%"PRIu32" even pages restored, no odd ones.\n", found);
+  list__destroy(list);
+
+  printf("Test 'demotion': All Passed\n");
+  return;
+}
+
+
+/* tests__policies
+ * Runs every replacement policy through the same workload:  a small hot set that's read over and over while a stream of one-time
+ * buffers pours through both tiers, so the sweeper keeps compressing and evicting.  Whatever the policy, the hot set should ride
+ * it out.  Once the sweeper settles, each tier's hot and cold counts have to add up to the list's own raw and comp counts.
+ */
+void tests__policies() {
+  const uint32_t PAGE_SIZE = 4096, HOT = 32, STREAM = 4000, RAW_PAGES = 128, COMP_PAGES = 256;
+  const char *TIER_NAMES[TIER_COUNT] = {"raw", "comp"};
+  List *list = NULL;
+  Buffer *buf = NULL;
+  void *data = NULL;
+  uint32_t hot_misses = 0, matched = 0, strays = 0;
+  int rv = E_OK;
+
+  for(int policy_id=0; policy_id<POLICY_COUNT; policy_id++) {
+    printf("%sStep %d.  Policy '%s':  %"PRIu32" hot buffers read between each of %"PRIu32" one-time buffers.\n", policy_id == 0 ? "" : "\n", policy_id + 1, POLICIES[policy_id].name, HOT, STREAM);
+    rv = list__initialize(&list, 1, LZ4_COMPRESSOR_ID, 1, (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * (RAW_PAGES + COMP_PAGES), opts.index_mode, policy_id);
+    if (rv != E_OK)
+      show_error(E_GENERIC, "Unable to initialize a list for the policies test.  rv was %d", rv);
+    list->max_raw_size = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * RAW_PAGES;
+    list->max_comp_size = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE / 32) * COMP_PAGES;
+
+    hot_misses = 0;
+    for(bufferid_t id=0; id<HOT + STREAM; id++) {
+      data = malloc(PAGE_SIZE);
+      memset(data, id % 251, PAGE_SIZE);
+      memcpy(data, &id, sizeof(bufferid_t));
+      buffer__initialize(&buf, id, PAGE_SIZE, data, NULL);
+      if (list__add(list, buf, NEED_PIN) != E_OK)
+        show_error(E_GENERIC, "Failed to add buffer %"PRIu32" to the list.", id);
+      if (id < HOT)
+        continue;
+      // Read the whole hot set a few times per HOT one-time buffers.  Anything that got evicted gets loaded again.
+      for(bufferid_t hot_id=(id % HOT) / 8 * 8; hot_id<(id % HOT) / 8 * 8 + 8; hot_id++) {
+        rv = list__search(list, &buf, hot_id, NEED_PIN);
+        if (rv == E_OK) {
+          if (memcmp(buf->data, &hot_id, sizeof(bufferid_t)) != 0)
+            show_error(E_GENERIC, "Hot buffer %"PRIu32" came back with the wrong page.", hot_id);
+          __sync_fetch_and_add(&buf->ref_count, -1);
+          continue;
+        }
+        hot_misses++;
+        data = malloc(PAGE_SIZE);
+        memset(data, hot_id % 251, PAGE_SIZE);
+        memcpy(data, &hot_id, sizeof(bufferid_t));
+        buffer__initialize(&buf, hot_id, PAGE_SIZE, data, NULL);
+        list__add(list, buf, NEED_PIN);
+      }
+    }
+    printf("Hot set misses: %"PRIu32" of %"PRIu32" reads.  %"PRIu64" compressions, %"PRIu64" restorations, %"PRIu64" evictions.\n", hot_misses, STREAM * 8, list->compressions, list->restorations, list->evictions);
+    if (list->evictions == 0)
+      show_error(E_GENERIC, "The stream never pushed anything out of the comp tier; the test isn't testing anything.");
+    if (hot_misses > STREAM * 8 / 20)
+      show_error(E_GENERIC, "Policy '%s' missed on the hot set %"PRIu32" times, more than 5%% of reads.", POLICIES[policy_id].name, hot_misses);
+
+    // Policies have to agree with the list once the sweeper and compressors go idle.  The clock's rings (GDSF uses them too) also
+    // have to hold only buffers of their own tier.
+    if (policy_id == POLICY_CLOCK || policy_id == POLICY_GDSF) {
+      ClockData *cd = (ClockData *)list->policy_data;
+      for(int i=0; i<100; i++) {
+        matched = 0;
+        if (cd->rings[TIER_RAW].count == (int64_t)list->raw_count)
+          matched++;
+        if (cd->rings[TIER_COMP].count == (int64_t)list->comp_count)
+          matched++;
+        if (matched == TIER_COUNT)
+          break;
+        usleep(10000);
+      }
+      for(int tier=0; tier<TIER_COUNT; tier++) {
+        strays = 0;
+        pthread_mutex_lock(&cd->rings[tier].lock);
+        for(buf=cd->rings[tier].sentinel.ring_next; buf!=&cd->rings[tier].sentinel; buf=buf->ring_next)
+          if (((buf->flags & compressed) != 0) != (tier == TIER_COMP))
+            strays++;
+        pthread_mutex_unlock(&cd->rings[tier].lock);
+        printf("  %-4s ring: %'"PRId64" buffers.\n", TIER_NAMES[tier], cd->rings[tier].count);
+        if (strays != 0)
+          show_error(E_GENERIC, "The clock's %s ring holds %"PRIu32" buffers from the other tier.", TIER_NAMES[tier], strays);
+      }
+      if (matched != TIER_COUNT)
+        show_error(E_GENERIC, "Clock rings don't match the list's %"PRIu32" raw and %"PRIu32" comp buffers.", list->raw_count, list->comp_count);
+    } else {
+      PolicyData *pd = (PolicyData *)list->policy_data;
+      for(int i=0; i<100; i++) {
+        matched = 0;
+        if (pd->tiers[TIER_RAW].hot_count + pd->tiers[TIER_RAW].cold_count == (int64_t)list->raw_count)
+          matched++;
+        if (pd->tiers[TIER_COMP].hot_count + pd->tiers[TIER_COMP].cold_count == (int64_t)list->comp_count)
+          matched++;
+        if (matched == TIER_COUNT)
+          break;
+        usleep(10000);
+      }
+      for(int tier=0; tier<TIER_COUNT; tier++)
+        printf("  %-4s tier: %'"PRId64" hot + %'"PRId64" cold.\n", TIER_NAMES[tier], pd->tiers[tier].hot_count, pd->tiers[tier].cold_count);
+      if (matched != TIER_COUNT)
+        show_error(E_GENERIC, "Policy '%s' counts don't match the list's %"PRIu32" raw and %"PRIu32" comp buffers.", POLICIES[policy_id].name, list->raw_count, list->comp_count);
+    }
+    list__destroy(list);
+  }
+
+  printf("Test 'policies': All Passed\n");
+  return;
+}
+
+
+/* tests__gdsf
+ * Checks GDSF credits against hand-worked values for fixed hits, sizes, and reload costs.  Then fills a raw tier with pages that
+ * are cheap or dear to decompress, small or big, and makes sure the hand takes the big cheap ones first and never a dear one while
+ * cheap ones are left.
+ */
+void tests__gdsf() {
+  const uint32_t SMALL = 4096, BIG = 16384, COUNT = 32, CHEAP_NS = 2000, DEAR_NS = 200000;
+  List *list = NULL;
+  Buffer *buf = NULL, *other = NULL;
+  Buffer *victims[3 * COUNT];
+  uint64_t bytes_selected = 0;
+  uint32_t credit = 0, big_credit = 0, victim_count = 0;
+  int rv = E_OK;
+
+  rv = list__initialize(&list, 1, LZ4_COMPRESSOR_ID, 1, 1024 * 1024 * 1024, opts.index_mode, POLICY_GDSF);
+  if (rv != E_OK)
+    show_error(E_GENERIC, "Unable to initialize a list for the gdsf test.  rv was %d", rv);
+
+  printf("Step 1.  Credits for pages of different sizes, costs, and popularity.\n");
+  // Each page takes 8k in its tier (overhead included) unless noted, and a miss costs 100us per 8k page.  A credit is
+  // (hits + 1) * (ns of reload + 1) * 1024 / bytes, where popularity p stands for p * (p + 1) / 2 hits.
+  buffer__initialize(&buf, 1, 0, NULL, NULL);
+  buffer__initialize(&other, 2, 0, NULL, NULL);
+  buf->data_length = 8192;
+  buf->comp_length = 8192 - BUFFER_OVERHEAD;
+  other->data_length = 32768;
+  other->comp_length = 8192 - BUFFER_OVERHEAD;
+  list->controller.miss_penalty = 100000;
+  list->controller.miss_bytes = 8192;
+  credit = policy__gdsf_credit(list, buf, TIER_COMP);
+  big_credit = policy__gdsf_credit(list, other, TIER_COMP);
+  printf("8k vs 32k page, compressed to 8k:  %"PRIu32" vs %"PRIu32".\n", credit, big_credit);
+  if (credit != 12500 || big_credit != 50000)
+    show_error(E_GENERIC, "Reloading an 8k page costs 100us and a 32k one 400us, so 100,001 * 1024 / 8192 = 12,500 and 50,000.");
+  buf->popularity = 1;
+  if (policy__gdsf_credit(list, buf, TIER_COMP) != 25000)
+    show_error(E_GENERIC, "Popularity 1 is 1 hit, so 2 * 100,001 * 1024 / 8192 = 25,000, not %"PRIu32".", policy__gdsf_credit(list, buf, TIER_COMP));
+  buf->popularity = 2;
+  if (policy__gdsf_credit(list, buf, TIER_COMP) != 50000)
+    show_error(E_GENERIC, "Popularity 2 is 3 hits, so 4 * 100,001 * 1024 / 8192 = 50,000, not %"PRIu32".", policy__gdsf_credit(list, buf, TIER_COMP));
+  buf->popularity = 0;
+  buf->data_length = 8192 - BUFFER_OVERHEAD;
+  buf->comp_hits = 1;
+  buf->comp_cost = 3 * CHEAP_NS;
+  other->data_length = 8192 - BUFFER_OVERHEAD;
+  other->comp_hits = 1;
+  other->comp_cost = 3 * DEAR_NS;
+  printf("Fast vs slow decompress, raw 8k:  %"PRIu32" vs %"PRIu32".\n", policy__gdsf_credit(list, buf, TIER_RAW), policy__gdsf_credit(list, other, TIER_RAW));
+  if (policy__gdsf_credit(list, buf, TIER_RAW) != 250 || policy__gdsf_credit(list, other, TIER_RAW) != 25000)
+    show_error(E_GENERIC, "Decompressing costs a third of comp_cost after 1 hit, so 2,001 * 1024 / 8192 = 250 and 200,001 * 1024 / 8192 = 25,000.");
+  other->data_length = 32768 - BUFFER_OVERHEAD;
+  if (policy__gdsf_credit(list, other, TIER_RAW) != 6250)
+    show_error(E_GENERIC, "The same cost over a 32k raw page is 200,001 * 1024 / 32768 = 6,250, not %"PRIu32".", policy__gdsf_credit(list, other, TIER_RAW));
+  // A page that was never restored is charged the list's average restore.
+  buf->comp_hits = 0;
+  list->restorations = 4;
+  list->controller.restore_cost = 4 * CHEAP_NS;
+  if (policy__gdsf_credit(list, buf, TIER_RAW) != 250)
+    show_error(E_GENERIC, "Four restores costing 8us in all average 2us, so 2,001 * 1024 / 8192 = 250, not %"PRIu32".", policy__gdsf_credit(list, buf, TIER_RAW));
+  list->restorations = 0;
+  list->controller.restore_cost = 0;
+  buffer__destroy(buf, DESTROY_DATA);
+  buffer__destroy(other, DESTROY_DATA);
+
+  printf("\nStep 2.  %"PRIu32" each of small cheap, small dear, and big cheap raw pages; asking for half the big ones' bytes.\n", COUNT);
+  for(bufferid_t id=0; id<3 * COUNT; id++) {
+    buffer__initialize(&buf, id, 0, NULL, NULL);
+    buf->data_length = id % 3 == 2 ? BIG : SMALL;
+    buf->data = malloc(buf->data_length);
+    memset(buf->data, id % 251, buf->data_length);
+    buf->comp_hits = 1;
+    buf->comp_cost = 3 * (id % 3 == 1 ? DEAR_NS : CHEAP_NS);
+    if (list__add(list, buf, NEED_PIN) != E_OK)
+      show_error(E_GENERIC, "Failed to add buffer %"PRIu32" to the list.", id);
+  }
+  victim_count = list->policy->select_victims(list, TIER_RAW, (uint64_t)(BUFFER_OVERHEAD + BIG) * COUNT / 2, victims, 3 * COUNT, &bytes_selected);
+  for(uint32_t i=0; i<victim_count; i++) {
+    if (victims[i]->id % 3 != 2)
+      show_error(E_GENERIC, "Buffer %"PRIu32" (%s, %s) was taken while big cheap ones were left.", victims[i]->id, victims[i]->data_length == BIG ? "big" : "small", victims[i]->id % 3 == 1 ? "dear" : "cheap");
+    victims[i]->flags &= ~pending_sweep;
+  }
+  printf("%"PRIu32" victims, %"PRIu64" bytes, all big and cheap.  L is now %"PRIu32".\n", victim_count, bytes_selected, ((ClockData *)list->policy_data)->rings[TIER_RAW].inflation);
+  if (victim_count != COUNT / 2)
+    show_error(E_GENERIC, "Expected %"PRIu32" victims, got %"PRIu32".", COUNT / 2, victim_count);
+  list__destroy(list);
+
+  printf("Test 'gdsf': All Passed\n");
+  return;
+}
+
+
+/* tests__scan
+ * Builds a list of even IDs with recognizable pages, compresses every third one the same way the compressors do, and then makes
+ * sure list__scan() visits exactly the right buffers in order, hands back the right page contents, and only restores compressed
+ * buffers when it's supposed to.
+ */
+void tests__scan() {
+  const uint32_t ELEMENTS = 1000, PAGE_SIZE = 4096;
+  const bufferid_t LO = 101, HI = 1501;
+  List *list = NULL;
+  Buffer *buf = NULL;
+  void *data = NULL, *compressed_data = NULL;
+  void *scratch = malloc(PAGE_SIZE);
+  ScanState state;
+  uint32_t compressed_in_range = 0, comp_count = 0;
+  uint64_t restorations = 0;
+  int rv = E_OK;
+
+  rv = list__initialize(&list, 1, LZ4_COMPRESSOR_ID, 1, 1024 * 1024 * 1024, opts.index_mode, opts.policy_id);
+  if (rv != E_OK)
+    show_error(E_GENERIC, "Unable to initialize a list for the scan test.  rv was %d", rv);
+  list->max_raw_size = 512 * 1024 * 1024;
+  list->max_comp_size = 512 * 1024 * 1024;
+
+  printf("Step 1.  Adding %d buffers with even IDs and compressing every third one.\n", ELEMENTS);
+  for(bufferid_t id=2; id<=ELEMENTS * 2; id+=2) {
+    data = malloc(PAGE_SIZE);
+    memset(data, id % 251, PAGE_SIZE);
+    memcpy(data, &id, sizeof(bufferid_t));
+    buffer__initialize(&buf, id, PAGE_SIZE, data, NULL);
+    if(list__add(list, buf, NEED_PIN) != E_OK)
+      show_error(E_GENERIC, "Failed to add buffer %"PRIu32" to the list.", id);
+  }
+  for(bufferid_t id=6; id<=ELEMENTS * 2; id+=6) {
+    if(list__search(list, &buf, id, NEED_PIN) != E_OK)
+      show_error(E_GENERIC, "Failed to find buffer %"PRIu32" to compress it.", id);
+    if(buffer__compress(buf, &compressed_data, LZ4_COMPRESSOR_ID, 1, codec__thread_context(), NULL) != E_OK)
+      show_error(E_GENERIC, "Failed to compress buffer %"PRIu32".", id);
+    buf->flags |= compressing;
+    list__update(list, &buf, compressed_data, buf->comp_length, NEED_PIN);
+    buf->flags |= compressed;
+    buffer__release_pin(buf);
+    // The sweeper does this accounting for the compressors; do it ourselves.
+    list->raw_count--;
+    list->comp_count++;
+    list->current_raw_size -= BUFFER_OVERHEAD + PAGE_SIZE;
+    list->current_comp_size += BUFFER_OVERHEAD + buf->comp_length;
+    if(id >= LO && id <= HI)
+      compressed_in_range++;
+  }
+  printf("List has %"PRIu32" raw and %"PRIu32" compressed buffers (%"PRIu32" compressed in %"PRIu32"-%"PRIu32").\n", list->raw_count, list->comp_count, compressed_in_range, LO, HI);
+
+  printf("\nStep 2.  Scanning %"PRIu32"-%"PRIu32" without promoting anything.\n", LO, HI);
+  memset(&state, 0, sizeof(ScanState));
+  comp_count = list->comp_count;
+  restorations = list->restorations;
+  rv = list__scan(list, LO, HI, tests__scan_callback, &state, scratch, SCAN_NO_PROMOTE);
+  if (rv != E_OK || state.visited != (HI - LO + 1) / 2 || state.bad_pages != 0)
+    show_error(E_GENERIC, "No-promote scan failed.  rv %d, visited %"PRIu32" (wanted %"PRIu32"), %"PRIu32" bad pages.", rv, state.visited, (HI - LO + 1) / 2, state.bad_pages);
+  if (list->comp_count != comp_count || list->restorations != restorations)
+    show_error(E_GENERIC, "No-promote scan changed the compressed count from %"PRIu32" to %"PRIu32".", comp_count, list->comp_count);
+  printf("Visited %"PRIu32" buffers in order with correct pages; nothing was restored.\n", state.visited);
+
+  printf("\nStep 3.  Scanning %"PRIu32"-%"PRIu32" again, promoting compressed buffers.\n", LO, HI);
+  memset(&state, 0, sizeof(ScanState));
+  rv = list__scan(list, LO, HI, tests__scan_callback, &state, NULL, 0);
+  if (rv != E_OK || state.visited != (HI - LO + 1) / 2 || state.bad_pages != 0)
+    show_error(E_GENERIC, "Promoting scan failed.  rv %d, visited %"PRIu32", %"PRIu32" bad pages.", rv, state.visited, state.bad_pages);
+  if (list->comp_count != comp_count - compressed_in_range || list->restorations != restorations + compressed_in_range)
+    show_error(E_GENERIC, "Promoting scan should have restored %"PRIu32" buffers but restored %"PRIu64".", compressed_in_range, list->restorations - restorations);
+  printf("Visited %"PRIu32" buffers and restored the %"PRIu32" compressed ones.\n", state.visited, compressed_in_range);
+
+  printf("\nStep 4.  Stopping early, scanning an empty range, and scanning everything.\n");
+  memset(&state, 0, sizeof(ScanState));
+  state.stop_after = 10;
+  rv = list__scan(list, 0, BUFFER_ID_MAX - 1, tests__scan_callback, &state, scratch, SCAN_NO_PROMOTE);
+  if (rv != E_GENERIC || state.visited != 10)
+    show_error(E_GENERIC, "Scan should have stopped after 10 buffers with E_GENERIC.  rv %d, visited %"PRIu32".", rv, state.visited);
+  memset(&state, 0, sizeof(ScanState));
+  rv = list__scan(list, ELEMENTS * 2 + 1, ELEMENTS * 4, tests__scan_callback, &state, scratch, SCAN_NO_PROMOTE);
+  if (rv != E_OK || state.visited != 0)
+    show_error(E_GENERIC, "Scan past the end of the list visited %"PRIu32" buffers.", state.visited);
+  memset(&state, 0, sizeof(ScanState));
+  list__update_ref(list, 1);
+  rv = list__scan(list, 0, BUFFER_ID_MAX - 1, tests__scan_callback, &state, scratch, SCAN_NO_PROMOTE | SCAN_HAVE_PIN);
+  list__update_ref(list, -1);
+  if (rv != E_OK || state.visited != ELEMENTS || state.bad_pages != 0)
+    show_error(E_GENERIC, "Full scan visited %"PRIu32" of %"PRIu32" buffers (%"PRIu32" bad pages).", state.visited, ELEMENTS, state.bad_pages);
+
+  list__destroy(list);
+  free(scratch);
+  printf("Test 'scan': All Passed\n");
+  return;
+}
+int tests__scan_callback(Buffer *buf, void *data, void *arg) {
+  ScanState *state = (ScanState *)arg;
+  if(buf->id <= state->last_id)
+    state->bad_pages++;
+  if(*(bufferid_t *)data != buf->id || ((unsigned char *)data)[buf->data_length - 1] != buf->id % 251)
+    state->bad_pages++;
+  state->last_id = buf->id;
+  state->visited++;
+  if(state->stop_after != 0 && state->visited >= state->stop_after)
+    return E_GENERIC;
+  return E_OK;
+}
+
+
+/* tests__index_benchmark
+ * Builds a fresh list for each index mode and times concurrent add, search, and remove phases.  Compression is off and memory is
+ * plentiful so sweeps never run; this measures the index and nothing else.
+ */
+void tests__index_benchmark() {
+  IndexBenchOpts ibopts;
+  ibopts.element_count       = 1000000;
+  ibopts.worker_count        = opts.workers;
+  ibopts.searches_per_worker = 1000000;
+  if(opts.extended_test_options != NULL && strcmp(opts.extended_test_options, "") != 0) {
+    printf("Extended options were found; updating test values with options specified: %s\n", opts.extended_test_options);
+    char *token = NULL;
+    token = strtok(opts.extended_test_options, ","); if(token != NULL) ibopts.element_count       = atoi(token);
+    token = strtok(NULL, ",");                       if(token != NULL) ibopts.worker_count        = atoi(token);
+    token = strtok(NULL, ",");                       if(token != NULL) ibopts.searches_per_worker = atoi(token);
+    if (ibopts.element_count == 0 || ibopts.worker_count == 0 || ibopts.searches_per_worker == 0)
+      show_error(E_GENERIC, "One or more of the extended options passed in ended up 0, this means you sent a 0 or bad input:\n"
+                            "Elements: %d\nWorkers: %d\nSearches Per Worker: %d", ibopts.element_count, ibopts.worker_count, ibopts.searches_per_worker);
+  }
+  // Round the element count down so every worker owns the same number of IDs.
+  ibopts.element_count -= ibopts.element_count % ibopts.worker_count;
+  if (ibopts.element_count == 0)
+    show_error(E_GENERIC, "The element count must be at least the worker count (%d).", ibopts.worker_count);
+
+  const int MODES[3] = {INDEX_LOCKING, INDEX_LOCK_FREE, INDEX_FAT_NODE};
+  const char *MODE_NAMES[3] = {"locking", "lockfree", "fatnode"};
+  const char *PHASE_NAMES[3] = {"add", "search", "remove"};
+  const uint64_t MAX_MEMORY = 4 * (uint64_t)BUFFER_OVERHEAD * ibopts.element_count;
+  IndexBenchWorker ibworkers[ibopts.worker_count];
+  pthread_t workers[ibopts.worker_count];
+  struct timespec start, end;
+  uint64_t elapsed_ns = 0, ops = 0, misses = 0;
+  int rv = E_OK;
+
+  setlocale(LC_NUMERIC, "");
+  printf("Benchmarking %'d elements with %d workers (%'d searches each).\n", ibopts.element_count, ibopts.worker_count, ibopts.searches_per_worker);
+  for(int m=0; m<3; m++) {
+    rv = list__initialize(&ibopts.list, 1, NO_COMPRESSOR_ID, 1, MAX_MEMORY, MODES[m], POLICY_CLOCK);
+    if (rv != E_OK)
+      show_error(E_GENERIC, "Unable to initialize a list for index mode %s.  rv was %d", MODE_NAMES[m], rv);
+    for(int phase=INDEX_BENCH_ADD; phase<=INDEX_BENCH_REMOVE; phase++) {
+      ibopts.phase = phase;
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      for(uint32_t i=0; i<ibopts.worker_count; i++) {
+        ibworkers[i].ibopts = &ibopts;
+        ibworkers[i].id = i;
+        ibworkers[i].misses = 0;
+        pthread_create(&workers[i], NULL, (void *) &tests__index_benchmark_worker, &ibworkers[i]);
+      }
+      misses = 0;
+      for(uint32_t i=0; i<ibopts.worker_count; i++) {
+        pthread_join(workers[i], NULL);
+        misses += ibworkers[i].misses;
+      }
+      clock_gettime(CLOCK_MONOTONIC, &end);
+      elapsed_ns = BILLION * (end.tv_sec - start.tv_sec) + end.tv_nsec - start.tv_nsec;
+      ops = (phase == INDEX_BENCH_SEARCH ? (uint64_t)ibopts.searches_per_worker * ibopts.worker_count : ibopts.element_count);
+      printf("%-8s  %-6s : %'14.0f ops/sec  (%'"PRIu64" ops in %'"PRIu64" ms)\n", MODE_NAMES[m], PHASE_NAMES[phase], 1.0 * ops * BILLION / elapsed_ns, ops, elapsed_ns / MILLION);
+      // Every ID is owned by exactly one worker, so nothing should ever be missing or left behind.
+      if (misses != 0)
+        show_error(E_GENERIC, "Index mode %s had %"PRIu64" misses during the %s phase.", MODE_NAMES[m], misses, PHASE_NAMES[phase]);
+      if (phase == INDEX_BENCH_ADD && ibopts.list->raw_count != ibopts.element_count)
+        show_error(E_GENERIC, "Index mode %s has %d buffers after adding %d.", MODE_NAMES[m], ibopts.list->raw_count, ibopts.element_count);
+      if (phase == INDEX_BENCH_REMOVE && (ibopts.list->raw_count != 0 || ibopts.list->head->next != ibopts.list->head))
+        show_error(E_GENERIC, "Index mode %s still has %d buffers after removing all of them.", MODE_NAMES[m], ibopts.list->raw_count);
+    }
+    if (MODES[m] & INDEX_LOCK_FREE)
+      printf("%-8s  epoch  : %'"PRIu64" retired, %'"PRIu64" reclaimed, %'"PRIu64" advances\n", MODE_NAMES[m], ibopts.list->epoch->retired, ibopts.list->epoch->reclaimed, ibopts.list->epoch->advances);
+    if (MODES[m] & INDEX_FAT_NODE)
+      printf("%-8s  nodes  : %'"PRIu64" search retries, %'"PRIu64" search misses\n", MODE_NAMES[m], ibopts.list->fat_retries, ibopts.list->fat_misses);
+    list__destroy(ibopts.list);
+  }
+
+  printf("Test 'index_benchmark': all passed\n");
+  return;
+}
+void tests__index_benchmark_worker(IndexBenchWorker *ibworker) {
+  IndexBenchOpts *ibopts = ibworker->ibopts;
+  const uint32_t PER_WORKER = ibopts->element_count / ibopts->worker_count;
+  uint32_t seed = ibworker->id;
+  bufferid_t id = 0;
+  Buffer *buf = NULL;
+
+  // Hold one list pin for the whole phase like a real worker would.
+  list__update_ref(ibopts->list, 1);
+  if(ibopts->phase == INDEX_BENCH_SEARCH) {
+    for(uint32_t i=0; i<ibopts->searches_per_worker; i++) {
+      id = rand_r(&seed) % ibopts->element_count + 1;
+      if(list__search(ibopts->list, &buf, id, HAVE_PIN) != E_OK) {
+        ibworker->misses++;
+        continue;
+      }
+      __sync_fetch_and_add(&buf->ref_count, -1);
+    }
+  } else {
+    // Walk this worker's IDs (every worker_count'th) in a scrambled order so inserts land all over the list.
+    for(uint32_t i=0; i<PER_WORKER; i++) {
+      id = (bufferid_t)(((uint64_t)i * 2654435761u) % PER_WORKER) * ibopts->worker_count + ibworker->id + 1;
+      if(ibopts->phase == INDEX_BENCH_ADD) {
+        buffer__initialize(&buf, id, 0, NULL, NULL);
+        if(list__add(ibopts->list, buf, HAVE_PIN) != E_OK) {
+          ibworker->misses++;
+          free(buf);
+        }
+        continue;
+      }
+      if(list__search(ibopts->list, &buf, id, HAVE_PIN) != E_OK) {
+        ibworker->misses++;
+        continue;
+      }
+      list__remove(ibopts->list, buf);
+    }
+  }
+  list__update_ref(ibopts->list, -1);
+  pthread_exit(0);
+}
+
+
+/* tests__interleaved_lookups
+ * Builds one big locking list (big enough to blow through the LLC by default) and times the same random IDs three ways:  one
+ * list__search() per ID, list__search_many() with sorted finger walks, and list__search_many() with several interleave widths.
+ */
+void tests__interleaved_lookups() {
+  uint32_t element_count = 4000000;
+  uint32_t lookups = 2000000;
+  uint32_t batch_size = 64;
+  if(opts.extended_test_options != NULL && strcmp(opts.extended_test_options, "") != 0) {
+    printf("Extended options were found; updating test values with options specified: %s\n", opts.extended_test_options);
+    char *token = NULL;
+    token = strtok(opts.extended_test_options, ","); if(token != NULL) element_count = atoi(token);
+    token = strtok(NULL, ",");                       if(token != NULL) lookups       = atoi(token);
+    token = strtok(NULL, ",");                       if(token != NULL) batch_size    = atoi(token);
+    if (element_count == 0 || lookups == 0 || batch_size == 0)
+      show_error(E_GENERIC, "One or more of the extended options passed in ended up 0, this means you sent a 0 or bad input:\n"
+                            "Elements: %d\nLookups: %d\nBatch Size: %d", element_count, lookups, batch_size);
+  }
+  // Round lookups down to whole batches.
+  lookups -= lookups % batch_size;
+  if (lookups == 0)
+    show_error(E_GENERIC, "The number of lookups must be at least the batch size (%d).", batch_size);
+
+  const int WIDTHS[5] = {0, 4, 8, 16, 32};
+  List *list = NULL;
+  Buffer *buf = NULL;
+  Buffer *bufs[batch_size];
+  bufferid_t *ids = (bufferid_t *)malloc(sizeof(bufferid_t) * lookups);
+  int results[batch_size];
+  struct timespec start, end;
+  uint64_t elapsed_ns = 0, misses = 0;
+  uint32_t seed = element_count;
+  int rv = E_OK;
+
+  setlocale(LC_NUMERIC, "");
+  rv = list__initialize(&list, 1, NO_COMPRESSOR_ID, 1, 4 * (uint64_t)BUFFER_OVERHEAD * element_count, INDEX_LOCKING, POLICY_CLOCK);
+  if (rv != E_OK)
+    show_error(E_GENERIC, "Unable to initialize a list for the interleaved lookups.  rv was %d", rv);
+  list__update_ref(list, 1);
+  for(uint32_t i=0; i<element_count; i++) {
+    buffer__initialize(&buf, (bufferid_t)(((uint64_t)i * 2654435761u) % element_count) + 1, 0, NULL, NULL);
+    if(list__add(list, buf, HAVE_PIN) != E_OK)
+      show_error(E_GENERIC, "Failed to add buffer %"PRIu32" to the list.", buf->id);
+  }
+  for(uint32_t i=0; i<lookups; i++)
+    ids[i] = rand_r(&seed) % element_count + 1;
+  printf("Timing %'"PRIu32" lookups against %'"PRIu32" buffers (%'.0f MB of buffers and nodes) in batches of %'"PRIu32".\n",
+         lookups, element_count, 1.0 * BUFFER_OVERHEAD * element_count / MILLION, batch_size);
+
+  // Pass -1 is plain list__search(); the rest are list__search_many() with each interleave width (0 means sorted).
+  for(int pass=-1; pass<5; pass++) {
+    misses = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if(pass < 0) {
+      for(uint32_t i=0; i<lookups; i++) {
+        if(list__search(list, &buf, ids[i], HAVE_PIN) != E_OK) {
+          misses++;
+          continue;
+        }
+        __sync_fetch_and_add(&buf->ref_count, -1);
+      }
+    } else {
+      list->search_interleave = WIDTHS[pass];
+      for(uint32_t i=0; i<lookups; i+=batch_size) {
+        list__search_many(list, &ids[i], batch_size, bufs, results, HAVE_PIN);
+        for(uint32_t j=0; j<batch_size; j++) {
+          if(results[j] != E_OK) {
+            misses++;
+            continue;
+          }
+          __sync_fetch_and_add(&bufs[j]->ref_count, -1);
+        }
+      }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    elapsed_ns = BILLION * (end.tv_sec - start.tv_sec) + end.tv_nsec - start.tv_nsec;
+    if(pass < 0)
+      printf("%-24s : %8.1f ns/lookup  %'14.0f lookups/sec\n", "sequential list__search", 1.0 * elapsed_ns / lookups, 1.0 * lookups * BILLION / elapsed_ns);
+    else if(WIDTHS[pass] == 0)
+      printf("%-24s : %8.1f ns/lookup  %'14.0f lookups/sec\n", "batched, sorted", 1.0 * elapsed_ns / lookups, 1.0 * lookups * BILLION / elapsed_ns);
+    else
+      printf("batched, interleave %-4d : %8.1f ns/lookup  %'14.0f lookups/sec\n", WIDTHS[pass], 1.0 * elapsed_ns / lookups, 1.0 * lookups * BILLION / elapsed_ns);
+    if (misses != 0)
+      show_error(E_GENERIC, "Missed %"PRIu64" lookups for IDs that all exist.", misses);
+  }
+  list__update_ref(list, -1);
+  list__destroy(list);
+  free(ids);
+
+  printf("Test 'interleaved_lookups': all passed\n");
+  return;
+}
+
+
+/* tests__lookup_latency
+ * Builds lists with each ordered index plus the hash index, then times the same random point lookups through both.  Both indexes
+ * are maintained on every write, so flipping INDEX_HASH off for the first pass just sends list__search() to the ordered one.
+ */
+void tests__lookup_latency() {
+  uint32_t sizes[2] = {1000000, 10000000};
+  uint32_t lookups = 2000000;
+  if(opts.extended_test_options != NULL && strcmp(opts.extended_test_options, "") != 0) {
+    printf("Extended options were found; updating test values with options specified: %s\n", opts.extended_test_options);
+    char *token = NULL;
+    token = strtok(opts.extended_test_options, ","); if(token != NULL) sizes[0] = atoi(token);
+    token = strtok(NULL, ",");                       if(token != NULL) sizes[1] = atoi(token);
+    token = strtok(NULL, ",");                       if(token != NULL) lookups  = atoi(token);
+    if (sizes[0] == 0 || sizes[1] == 0 || lookups == 0)
+      show_error(E_GENERIC, "One or more of the extended options passed in ended up 0, this means you sent a 0 or bad input:\n"
+                            "Small List: %d\nLarge List: %d\nLookups: %d", sizes[0], sizes[1], lookups);
+  }
+
+  const int MODES[2] = {INDEX_LOCKING, INDEX_FAT_NODE};
+  const char *MODE_NAMES[2] = {"locking", "fatnode"};
+  const char *PASS_NAMES[2] = {"ordered", "+hash"};
+  List *list = NULL;
+  Buffer *buf = NULL;
+  struct timespec start, end;
+  uint64_t elapsed_ns = 0, misses = 0;
+  uint32_t seed = 0;
+  int rv = E_OK;
+
+  setlocale(LC_NUMERIC, "");
+  for(int s=0; s<2; s++) {
+    for(int m=0; m<2; m++) {
+      rv = list__initialize(&list, 1, NO_COMPRESSOR_ID, 1, 4 * (uint64_t)BUFFER_OVERHEAD * sizes[s], MODES[m] | INDEX_HASH, POLICY_CLOCK);
+      if (rv != E_OK)
+        show_error(E_GENERIC, "Unable to initialize a list for index mode %s+hash.  rv was %d", MODE_NAMES[m], rv);
+      list__update_ref(list, 1);
+      for(uint32_t i=0; i<sizes[s]; i++) {
+        buffer__initialize(&buf, (bufferid_t)(((uint64_t)i * 2654435761u) % sizes[s]) + 1, 0, NULL, NULL);
+        if(list__add(list, buf, HAVE_PIN) != E_OK)
+          show_error(E_GENERIC, "Failed to add buffer %"PRIu32" to the %s+hash list.", buf->id, MODE_NAMES[m]);
+      }
+      for(int pass=0; pass<2; pass++) {
+        if(pass == 0)
+          list->index_mode &= ~INDEX_HASH;
+        else
+          list->index_mode |= INDEX_HASH;
+        // Same seed for both passes so they chase the exact same IDs.
+        seed = sizes[s];
+        misses = 0;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for(uint32_t i=0; i<lookups; i++) {
+          if(list__search(list, &buf, rand_r(&seed) % sizes[s] + 1, HAVE_PIN) != E_OK) {
+            misses++;
+            continue;
+          }
+          __sync_fetch_and_add(&buf->ref_count, -1);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        elapsed_ns = BILLION * (end.tv_sec - start.tv_sec) + end.tv_nsec - start.tv_nsec;
+        printf("%'11"PRIu32" buffers  %-8s %-8s : %8.1f ns/lookup  %'14.0f lookups/sec\n", sizes[s], MODE_NAMES[m], PASS_NAMES[pass], 1.0 * elapsed_ns / lookups, 1.0 * lookups * BILLION / elapsed_ns);
+        if (misses != 0)
+          show_error(E_GENERIC, "Index mode %s (%s) missed %"PRIu64" lookups for IDs that all exist.", MODE_NAMES[m], PASS_NAMES[pass], misses);
+      }
+      list__update_ref(list, -1);
+      list__destroy(list);
+    }
+  }
+
+  printf("Test 'lookup_latency': all passed\n");
+  return;
+}
+
+
+/* tests__pin_scaling
+ * Times readers doing pin, search, unpin loops against one small list at 1, 2, 4, ... up to max_readers threads.  A writer takes
+ * the write lock every few ms for the whole run and checks that no reader holds a pin while it owns the list.
+ */
+void tests__pin_scaling() {
+  PinScalingOpts psopts;
+  uint32_t max_readers = 64;
+  psopts.pins_per_reader = 1000000;
+  psopts.writer_delay_us = 1000;
+  if(opts.extended_test_options != NULL && strcmp(opts.extended_test_options, "") != 0) {
+    printf("Extended options were found; updating test values with options specified: %s\n", opts.extended_test_options);
+    char *token = NULL;
+    token = strtok(opts.extended_test_options, ","); if(token != NULL) max_readers             = atoi(token);
+    token = strtok(NULL, ",");                       if(token != NULL) psopts.pins_per_reader = atoi(token);
+    token = strtok(NULL, ",");                       if(token != NULL) psopts.writer_delay_us = atoi(token);
+    if (max_readers == 0 || psopts.pins_per_reader == 0 || psopts.writer_delay_us == 0)
+      show_error(E_GENERIC, "One or more of the extended options passed in ended up 0, this means you sent a 0 or bad input:\n"
+                            "Max Readers: %d\nPins Per Reader: %d\nWriter Delay (us): %d", max_readers, psopts.pins_per_reader, psopts.writer_delay_us);
+  }
+
+  const uint32_t ELEMENTS = 1024;
+  pthread_t readers[max_readers], writer;
+  struct timespec start, end;
+  uint64_t elapsed_ns = 0, ops = 0;
+  Buffer *buf = NULL;
+  int rv = E_OK;
+
+  rv = list__initialize(&psopts.list, 1, NO_COMPRESSOR_ID, 1, 4 * (uint64_t)BUFFER_OVERHEAD * ELEMENTS, opts.index_mode, opts.policy_id);
+  if (rv != E_OK)
+    show_error(E_GENERIC, "Unable to initialize a list for the pin scaling test.  rv was %d", rv);
+  for(uint32_t i=1; i<=ELEMENTS; i++) {
+    buffer__initialize(&buf, i, 0, NULL, NULL);
+    if(list__add(psopts.list, buf, NEED_PIN) != E_OK)
+      show_error(E_GENERIC, "Failed to add buffer %"PRIu32" to the pin scaling list.", i);
+  }
+
+  setlocale(LC_NUMERIC, "");
+  printf("Each reader does %'"PRIu32" pin/search/unpin rounds; a writer takes the write lock every %'"PRIu32" us.\n", psopts.pins_per_reader, psopts.writer_delay_us);
+  // Double the readers each round, finishing with exactly max_readers even when it isn't a power of 2.
+  for(uint32_t count=1; count<=max_readers; count = (count == max_readers ? count + 1 : (count * 2 > max_readers ? max_readers : count * 2))) {
+    psopts.writer_active = 1;
+    psopts.write_locks = 0;
+    psopts.violations = 0;
+    psopts.misses = 0;
+    pthread_create(&writer, NULL, (void *) &tests__pin_scaling_writer, &psopts);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(uint32_t i=0; i<count; i++)
+      pthread_create(&readers[i], NULL, (void *) &tests__pin_scaling_reader, &psopts);
+    for(uint32_t i=0; i<count; i++)
+      pthread_join(readers[i], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    psopts.writer_active = 0;
+    pthread_join(writer, NULL);
+    elapsed_ns = BILLION * (end.tv_sec - start.tv_sec) + end.tv_nsec - start.tv_nsec;
+    ops = (uint64_t)count * psopts.pins_per_reader;
+    printf("%3"PRIu32" readers : %'14.0f pins/sec  (%'7.1f ns/pin per reader, %'"PRIu64" write locks)\n", count, 1.0 * ops * BILLION / elapsed_ns, 1.0 * elapsed_ns * count / ops, psopts.write_locks);
+    if (psopts.violations != 0)
+      show_error(E_GENERIC, "The writer saw readers holding list pins %"PRIu64" times while it owned the write lock.", psopts.violations);
+    if (psopts.misses != 0)
+      show_error(E_GENERIC, "Readers missed %"PRIu64" searches for IDs that all exist.", psopts.misses);
+    if (list__pin_count(psopts.list) != 0)
+      show_error(E_GENERIC, "The list has %"PRId64" pins left after all readers finished.", list__pin_count(psopts.list));
+  }
+  list__destroy(psopts.list);
+
+  printf("Test 'pin_scaling': all passed\n");
+  return;
+}
+void tests__pin_scaling_reader(PinScalingOpts *psopts) {
+  const uint32_t ELEMENTS = psopts->list->raw_count;
+  uint32_t seed = (uint32_t)(uintptr_t)&seed;
+  uint64_t misses = 0;
+  Buffer *buf = NULL;
+
+  for(uint32_t i=0; i<psopts->pins_per_reader; i++) {
+    list__update_ref(psopts->list, 1);
+    if(list__search(psopts->list, &buf, rand_r(&seed) % ELEMENTS + 1, HAVE_PIN) == E_OK)
+      __sync_fetch_and_add(&buf->ref_count, -1);
+    else
+      misses++;
+    list__update_ref(psopts->list, -1);
+  }
+  __sync_fetch_and_add(&psopts->misses, misses);
+  pthread_exit(0);
+}
+void tests__pin_scaling_writer(PinScalingOpts *psopts) {
+  while(__atomic_load_n(&psopts->writer_active, __ATOMIC_SEQ_CST) != 0) {
+    list__acquire_write_lock(psopts->list);
+    if(list__pin_count(psopts->list) != 0)
+      psopts->violations++;
+    psopts->write_locks++;
+    list__release_write_lock(psopts->list);
+    usleep(psopts->writer_delay_us);
+  }
+  pthread_exit(0);
+}
+
+
 /*
  * IO either works or doesn't.  You'll get an error on CLI if you mess up options or provide bad data.  This function will simply
  * attempt to read a file into a buffer with buffer__initialize(valid_id, valid_path).  Requires a pointer to the pages array and
@@ -420,7 +1635,9 @@ void tests__compression() {
   buf->data_length = src_size;
   memcpy(buf->data, src, buf->data_length);
   void *compressed_data = NULL;
-  rv = buffer__compress(buf, &compressed_data, opts.compressor_id, opts.compressor_level);
+  // Adaptive isn't a compressor of its own; try the one it gives cold pages.
+  const int COMPRESSOR_ID = opts.compressor_id == ADAPTIVE_COMPRESSOR_ID ? ZSTD_COMPRESSOR_ID : opts.compressor_id;
+  rv = buffer__compress(buf, &compressed_data, COMPRESSOR_ID, opts.compressor_level, codec__thread_context(), NULL);
   if (rv != 0)
     show_error(E_GENERIC, "The rv was non-zero, indicating an error from buffer__compress: %d\n", rv);
   // Since we're single-threaded in this test, we can just free buf->data and swap compressed data to it.  Normally this requires list__update().
@@ -428,7 +1645,7 @@ void tests__compression() {
   buf->data = compressed_data;
   printf("Compression gave an OK response.    comp_time is %d ns, comp_hits is %d, data_legnth is %d, and comp_length is %d bytes\n", buf->comp_cost, buf->comp_hits, buf->data_length, buf->comp_length);
   memset(new_src, 0, src_size);
-  rv = buffer__decompress(buf, opts.compressor_id);
+  rv = buffer__decompress(buf, codec__thread_context());
   if (rv != 0)
     show_error(E_GENERIC, "The rv was non-zero, indicating an error from buffer__decompress: %d\n", rv);
   if (memcmp(src, buf->data, src_size) != 0)
@@ -436,6 +1653,29 @@ void tests__compression() {
   printf("Decompression gave an OK response.  comp_time is %d ns, comp_hits is %d, data_legnth is %d, and comp_length is %d bytes\n", buf->comp_cost, buf->comp_hits, buf->data_length, buf->comp_length);
   printf("Test 4: passed\n");
 
+  /* Test 5:  One context should serve every codec, over and over, without its state leaking from one page into the next. */
+  const int CODECS[3] = {LZ4_COMPRESSOR_ID, ZLIB_COMPRESSOR_ID, ZSTD_COMPRESSOR_ID};
+  CodecContext *ctx = NULL;
+  if (codec__initialize(&ctx) != E_OK)
+    show_error(E_GENERIC, "Unable to initialize a codec context.");
+  for(int round=0; round<3; round++) {
+    for(int c=0; c<3; c++) {
+      buf->comp_length = 0;
+      rv = buffer__compress(buf, &compressed_data, CODECS[c], opts.compressor_level, ctx, NULL);
+      if (rv != E_OK)
+        show_error(E_GENERIC, "Compressor %d failed with a reused context on round %d: %d\n", CODECS[c], round, rv);
+      free(buf->data);
+      buf->data = compressed_data;
+      rv = buffer__decompress(buf, ctx);
+      if (rv != E_OK || memcmp(src, buf->data, src_size) != 0)
+        show_error(E_GENERIC, "Compressor %d didn't round trip with a reused context on round %d: %d\n", CODECS[c], round, rv);
+    }
+  }
+  if (ctx->compressions != 9 || ctx->decompressions != 9)
+    show_error(E_GENERIC, "The context should have seen 9 compressions and 9 decompressions, not %"PRIu64" and %"PRIu64".", ctx->compressions, ctx->decompressions);
+  codec__destroy(ctx);
+  printf("Test 5: passed\n");
+
   /* All Done */
   printf("Test 'compression': all passed!\n");
 
@@ -443,6 +1683,160 @@ void tests__compression() {
 }
 
 
+/* tests__compression_benchmark
+ * Compresses and decompresses the sample pages with each codec, first the way buffer__compress() used to (one-shot calls that set up
+ * compressor state for every page), then through buffer__compress() and buffer__decompress_into() with one reused CodecContext.
+ * Both sides allocate the compressed image per page, like the compressors do.
+ */
+void tests__compression_benchmark(char **pages) {
+  uint32_t page_count = opts.page_count > 2000 ? 2000 : opts.page_count;
+  uint32_t rounds = 500;
+  if(opts.extended_test_options != NULL && strcmp(opts.extended_test_options, "") != 0) {
+    printf("Extended options were found; updating test values with options specified: %s\n", opts.extended_test_options);
+    char *token = NULL;
+    token = strtok(opts.extended_test_options, ","); if(token != NULL) page_count = atoi(token);
+    token = strtok(NULL, ",");                       if(token != NULL) rounds     = atoi(token);
+    if (page_count == 0 || page_count > opts.page_count || rounds == 0)
+      show_error(E_GENERIC, "Pages must be 1 to %"PRIu32" and rounds at least 1.  Got %"PRIu32" and %"PRIu32".", opts.page_count, page_count, rounds);
+  }
+
+  const int CODECS[3] = {LZ4_COMPRESSOR_ID, ZLIB_COMPRESSOR_ID, ZSTD_COMPRESSOR_ID};
+  const char *CODEC_NAMES[3] = {"lz4", "zlib", "zstd"};
+  Buffer *bufs[page_count];
+  void *images[page_count];
+  uint32_t image_lengths[page_count];
+  uint32_t max_length = 0;
+  uint64_t page_bytes = 0, comp_bytes = 0, elapsed_ns[4];
+  struct timespec start, end;
+  CodecContext *ctx = NULL;
+  void *scratch = NULL, *image = NULL;
+  uLongf length = 0;
+  int rv = E_OK;
+
+  for(uint32_t i=0; i<page_count; i++) {
+    if (buffer__initialize(&bufs[i], i, 0, NULL, pages[i]) != E_OK)
+      show_error(E_GENERIC, "Unable to read page %s.", pages[i]);
+    page_bytes += bufs[i]->data_length;
+    if (bufs[i]->data_length > max_length)
+      max_length = bufs[i]->data_length;
+  }
+  scratch = malloc(max_length);
+  if (codec__initialize(&ctx) != E_OK || scratch == NULL)
+    show_error(E_GENERIC, "Unable to set up the benchmark.");
+
+  setlocale(LC_NUMERIC, "");
+  printf("Benchmarking %'"PRIu32" pages (%'"PRIu64" bytes) x %'"PRIu32" rounds at level %d.\n", page_count, page_bytes, rounds, opts.compressor_level);
+  printf("%-5s  %15s  %15s  %15s  %15s  %7s\n", "", "one-shot comp", "context comp", "one-shot decomp", "context decomp", "ratio");
+  for(int c=0; c<3; c++) {
+    // One-shot compression, just as buffer__compress() used to do it.  Keep the last round's images to decompress.
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(uint32_t r=0; r<rounds; r++) {
+      for(uint32_t i=0; i<page_count; i++) {
+        if (r != 0)
+          free(images[i]);
+        if (CODECS[c] == LZ4_COMPRESSOR_ID) {
+          length = LZ4_compressBound(bufs[i]->data_length);
+          images[i] = malloc(length);
+          rv = LZ4_compress_default(bufs[i]->data, images[i], bufs[i]->data_length, length);
+          length = rv;
+        }
+        if (CODECS[c] == ZLIB_COMPRESSOR_ID) {
+          length = compressBound(bufs[i]->data_length);
+          images[i] = malloc(length);
+          rv = compress2(images[i], &length, bufs[i]->data, bufs[i]->data_length, opts.compressor_level) == Z_OK ? 1 : 0;
+        }
+        if (CODECS[c] == ZSTD_COMPRESSOR_ID) {
+          length = ZSTD_compressBound(bufs[i]->data_length);
+          images[i] = malloc(length);
+          length = ZSTD_compress(images[i], length, bufs[i]->data, bufs[i]->data_length, opts.compressor_level);
+          rv = ZSTD_isError(length) ? 0 : 1;
+        }
+        if (rv < 1)
+          show_error(E_GENERIC, "One-shot %s compression failed on page %"PRIu32".", CODEC_NAMES[c], i);
+        image_lengths[i] = length;
+      }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    elapsed_ns[0] = BILLION * (end.tv_sec - start.tv_sec) + end.tv_nsec - start.tv_nsec;
+
+    // One-shot decompression.
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(uint32_t r=0; r<rounds; r++) {
+      for(uint32_t i=0; i<page_count; i++) {
+        if (CODECS[c] == LZ4_COMPRESSOR_ID)
+          rv = LZ4_decompress_safe(images[i], scratch, image_lengths[i], bufs[i]->data_length) < 0 ? 0 : 1;
+        if (CODECS[c] == ZLIB_COMPRESSOR_ID) {
+          length = bufs[i]->data_length;
+          rv = uncompress(scratch, &length, images[i], image_lengths[i]) == Z_OK ? 1 : 0;
+        }
+        if (CODECS[c] == ZSTD_COMPRESSOR_ID)
+          rv = ZSTD_isError(ZSTD_decompress(scratch, bufs[i]->data_length, images[i], image_lengths[i])) ? 0 : 1;
+        if (rv < 1)
+          show_error(E_GENERIC, "One-shot %s decompression failed on page %"PRIu32".", CODEC_NAMES[c], i);
+      }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    elapsed_ns[2] = BILLION * (end.tv_sec - start.tv_sec) + end.tv_nsec - start.tv_nsec;
+    for(uint32_t i=0; i<page_count; i++)
+      free(images[i]);
+
+    // Compression through buffer__compress() with the reused context.
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(uint32_t r=0; r<rounds; r++) {
+      for(uint32_t i=0; i<page_count; i++) {
+        if (r != 0)
+          free(images[i]);
+        bufs[i]->comp_length = 0;
+        images[i] = NULL;
+        if (buffer__compress(bufs[i], &images[i], CODECS[c], opts.compressor_level, ctx, NULL) != E_OK)
+          show_error(E_GENERIC, "Context %s compression failed on page %"PRIu32".", CODEC_NAMES[c], i);
+      }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    elapsed_ns[1] = BILLION * (end.tv_sec - start.tv_sec) + end.tv_nsec - start.tv_nsec;
+
+    // Decompression through buffer__decompress_into(), which needs the image in ->data.  Swap it in and back out.
+    comp_bytes = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(uint32_t r=0; r<rounds; r++) {
+      for(uint32_t i=0; i<page_count; i++) {
+        image = bufs[i]->data;
+        bufs[i]->data = images[i];
+        rv = buffer__decompress_into(bufs[i], scratch, ctx);
+        bufs[i]->data = image;
+        if (rv != E_OK)
+          show_error(E_GENERIC, "Context %s decompression failed on page %"PRIu32".", CODEC_NAMES[c], i);
+      }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    elapsed_ns[3] = BILLION * (end.tv_sec - start.tv_sec) + end.tv_nsec - start.tv_nsec;
+    for(uint32_t i=0; i<page_count; i++) {
+      // The context path has to give back exactly what it was given.
+      image = bufs[i]->data;
+      bufs[i]->data = images[i];
+      buffer__decompress_into(bufs[i], scratch, ctx);
+      bufs[i]->data = image;
+      if (memcmp(scratch, bufs[i]->data, bufs[i]->data_length) != 0)
+        show_error(E_GENERIC, "Page %"PRIu32" didn't survive a %s round trip through the context.", i, CODEC_NAMES[c]);
+      comp_bytes += bufs[i]->comp_length;
+      bufs[i]->comp_length = 0;
+      free(images[i]);
+    }
+    printf("%-5s", CODEC_NAMES[c]);
+    for(int t=0; t<4; t++)
+      printf("  %'11.0f p/s", 1.0 * page_count * rounds * BILLION / elapsed_ns[t]);
+    printf("  %6.2fx\n", 1.0 * page_bytes / comp_bytes);
+  }
+
+  for(uint32_t i=0; i<page_count; i++)
+    buffer__destroy(bufs[i], DESTROY_DATA);
+  codec__destroy(ctx);
+  free(scratch);
+  printf("Test 'compression_benchmark': all passed\n");
+  return;
+}
+
+
 /*
  * Make sure that we can create a list, try to put too many buffers in it, and have it offload things as expected.
  */
@@ -506,8 +1900,9 @@ void tests__move_buffers(List *list, char **pages) {
   printf("Test 3 Passed:  Will running out of comp space remove buffers when swept?\n\n");
 
   // -- TEST 4:  Can we move items back to the raw list after they've been compressed?
+  /* Leave the comp space room for everything this time, or the sweeper can evict the buffer we pick before we search for it. */
   list->max_raw_size = total_bytes >> 1;
-  list->max_comp_size = total_bytes >> 3;
+  list->max_comp_size = total_bytes >> 1;
   for (uint i = 0; i < opts.page_count; i++) {
     buffer__initialize(&buf, i, 0, NULL, pages[i]);
     buf->popularity = MAX_POPULARITY/(i+1);
@@ -517,10 +1912,14 @@ void tests__move_buffers(List *list, char **pages) {
   Buffer *test4_buf = list->head->next;
   while(test4_buf->comp_length == 0 && test4_buf != list->head)
     test4_buf = test4_buf->next;
+  if(test4_buf == list->head)
+    show_error(E_GENERIC, "Test 4 couldn't find a compressed buffer to restore.");
   bufferid_t test4_id = test4_buf->id;
   list__search(list, &test4_buf, test4_id, 0);
+  if(test4_buf->comp_length != 0 || (test4_buf->flags & compressed))
+    show_error(E_GENERIC, "Test 4 searched for buffer %"PRIu32" but it's still compressed.", test4_id);
+  // The buffer is still in the list, so just let go of the pin; list__destroy() will take care of it.
   __sync_fetch_and_add(&test4_buf->ref_count, -1);
-  buffer__destroy(test4_buf, DESTROY_DATA);
   printf("Test 4 Passed:  Can we restore items from the offload list when searching finds them there?\n\n");
 
   printf("Test 'move_buffers': all passed\n");
@@ -528,6 +1927,586 @@ void tests__move_buffers(List *list, char **pages) {
 }
 
 
+/* tests__watermarks
+ * Fills a list just past its high watermark and makes sure the sweeper reclaims down to the low watermark on its own without
+ * anyone waiting on it.  Then streams pages through the list twice:  once with the watermarks pinned at 100% and no overcommit (the
+ * old behavior, where every add past max waits on a sweep) and once with the defaults, which should stall far less.  Each page
+ * takes LOAD_US to "load", like a real miss would; a loop that adds as fast as it can will outrun any sweeper.
+ */
+void tests__watermarks() {
+  const uint32_t PAGE_SIZE = 4096, STREAM = 2000, RAW_PAGES = 100, COMP_PAGES = 400, LOAD_US = 20;
+  const uint64_t RAW_MAX = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * RAW_PAGES;
+  List *list = NULL;
+  Buffer *buf = NULL;
+  void *data = NULL;
+  uint64_t stalls[2] = {0, 0};
+  bufferid_t id = 0;
+  int rv = E_OK;
+
+  printf("Step 1.  Filling %"PRIu32" raw pages past the %d%% high watermark.\n", RAW_PAGES, WATERMARK_HIGH);
+  rv = list__initialize(&list, 1, LZ4_COMPRESSOR_ID, 1, (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * (RAW_PAGES + COMP_PAGES), opts.index_mode, POLICY_CLOCK);
+  if (rv != E_OK)
+    show_error(E_GENERIC, "Unable to initialize a list for the watermarks test.  rv was %d", rv);
+  list->max_raw_size = RAW_MAX;
+  list->max_comp_size = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE / 32) * COMP_PAGES;
+  // One more add after crossing the mark, since adds check before they grow the tier.
+  for(id=0; id<RAW_PAGES && list->current_raw_size <= list__watermark(RAW_MAX, WATERMARK_HIGH) + BUFFER_OVERHEAD + PAGE_SIZE; id++) {
+    data = malloc(PAGE_SIZE);
+    memset(data, id % 251, PAGE_SIZE);
+    buffer__initialize(&buf, id, PAGE_SIZE, data, NULL);
+    if (list__add(list, buf, NEED_PIN) != E_OK)
+      show_error(E_GENERIC, "Failed to add buffer %"PRIu32" to the list.", id);
+  }
+  for(int i=0; i<100 && list->current_raw_size > list__watermark(RAW_MAX, WATERMARK_LOW); i++)
+    usleep(10000);
+  printf("Added %"PRIu32" pages.  %"PRIu64" sweeps, %"PRIu64" stalls, raw tier at %"PRIu64"%% of max.\n", id, list->sweeps, list->stalls, 100 * list->current_raw_size / RAW_MAX);
+  if (list->sweeps == 0 || list->current_raw_size > list__watermark(RAW_MAX, WATERMARK_LOW))
+    show_error(E_GENERIC, "The sweeper didn't bring the raw tier down to the low watermark on its own.");
+  if (list->stalls != 0 || list->current_raw_size > RAW_MAX)
+    show_error(E_GENERIC, "Nobody should have waited on the sweeper before the raw tier was full.");
+  list__destroy(list);
+
+  for(int pass=0; pass<2; pass++) {
+    printf("\nStep %d.  Streaming %"PRIu32" pages with %s.\n", pass + 2, STREAM, pass == 0 ? "watermarks at 100% and no overcommit" : "the default watermarks");
+    rv = list__initialize(&list, 1, LZ4_COMPRESSOR_ID, 1, (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * (RAW_PAGES + COMP_PAGES), opts.index_mode, POLICY_CLOCK);
+    if (rv != E_OK)
+      show_error(E_GENERIC, "Unable to initialize a list for the watermarks test.  rv was %d", rv);
+    list->max_raw_size = RAW_MAX;
+    list->max_comp_size = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE / 32) * COMP_PAGES;
+    if (pass == 0) {
+      list->watermark_high = 100;
+      list->watermark_low = 100;
+      list->overcommit = 0;
+    }
+    for(id=0; id<STREAM; id++) {
+      data = malloc(PAGE_SIZE);
+      memset(data, id % 251, PAGE_SIZE);
+      usleep(LOAD_US);
+      buffer__initialize(&buf, id, PAGE_SIZE, data, NULL);
+      if (list__add(list, buf, NEED_PIN) != E_OK)
+        show_error(E_GENERIC, "Failed to add buffer %"PRIu32" to the list.", id);
+      if (list->current_raw_size > list__watermark(RAW_MAX, 100 + list->overcommit) + BUFFER_OVERHEAD + PAGE_SIZE)
+        show_error(E_GENERIC, "The raw tier grew to %"PRIu64" bytes, past max plus overcommit.", list->current_raw_size);
+    }
+    stalls[pass] = list->stalls;
+    printf("%"PRIu64" sweeps.  %"PRIu64" stalls totaling %'"PRIu64" ns.\n", list->sweeps, list->stalls, list->stall_time);
+    if (pass == 0 && (list->stalls == 0 || list->stall_time == 0))
+      show_error(E_GENERIC, "Without watermarks every trip past max should have been a stall.");
+    list__destroy(list);
+  }
+  if (stalls[1] * 4 > stalls[0])
+    show_error(E_GENERIC, "The watermarks should have cut the stalls to under a quarter (%"PRIu64" with them, %"PRIu64" without).", stalls[1], stalls[0]);
+
+  printf("Test 'watermarks': All Passed\n");
+  return;
+}
+
+
+/* tests__sweep_slices
+ * Fills a list past its high watermark (with the low watermark far below it, so one sweep has a lot to do) and makes sure the
+ * sweeper gets there in slices.  First with a victim budget, where no slice may take more than SLICE_VICTIMS victims, then with a
+ * time budget, where the same work has to take more than one slice.  The comp tier is big enough that nothing gets evicted.
+ */
+void tests__sweep_slices() {
+  const uint32_t PAGE_SIZE = 4096, RAW_PAGES = 1000, COMP_PAGES = 2000, SLICE_VICTIMS = 8;
+  const uint64_t RAW_MAX = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * RAW_PAGES, SLICE_NS = 100000;
+  List *list = NULL;
+  Buffer *buf = NULL;
+  void *data = NULL;
+  bufferid_t id = 0;
+  int rv = E_OK;
+
+  for(int pass=0; pass<2; pass++) {
+    printf("%sStep %d.  Filling %"PRIu32" raw pages past the high watermark with slices of at most ", pass == 0 ? "" : "\n", pass + 1, RAW_PAGES);
+    if (pass == 0)
+      printf("%"PRIu32" victims.\n", SLICE_VICTIMS);
+    else
+      printf("%'"PRIu64" ns.\n", SLICE_NS);
+    rv = list__initialize(&list, 1, LZ4_COMPRESSOR_ID, 1, (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * (RAW_PAGES + COMP_PAGES), opts.index_mode, POLICY_CLOCK);
+    if (rv != E_OK)
+      show_error(E_GENERIC, "Unable to initialize a list for the sweep_slices test.  rv was %d", rv);
+    list->max_raw_size = RAW_MAX;
+    list->max_comp_size = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE / 32) * COMP_PAGES;
+    list->watermark_low = 50;
+    list->slice_victims = pass == 0 ? SLICE_VICTIMS : 0;
+    list->slice_budget_ns = pass == 0 ? 0 : SLICE_NS;
+    for(id=0; id<RAW_PAGES && list->current_raw_size <= list__watermark(RAW_MAX, WATERMARK_HIGH) + BUFFER_OVERHEAD + PAGE_SIZE; id++) {
+      data = malloc(PAGE_SIZE);
+      memset(data, id % 251, PAGE_SIZE);
+      buffer__initialize(&buf, id, PAGE_SIZE, data, NULL);
+      if (list__add(list, buf, NEED_PIN) != E_OK)
+        show_error(E_GENERIC, "Failed to add buffer %"PRIu32" to the list.", id);
+    }
+    for(int i=0; i<500 && list->current_raw_size > list__watermark(RAW_MAX, 50); i++)
+      usleep(10000);
+    printf("Added %"PRIu32" pages.  %"PRIu64" compressions in %"PRIu64" slices, raw tier at %"PRIu64"%% of max.  Slice times:\n", id, list->compressions, list->slices, 100 * list->current_raw_size / RAW_MAX);
+    list__show_latencies(list->sweep_slices, "  ");
+    if (list->current_raw_size > list__watermark(RAW_MAX, 50))
+      show_error(E_GENERIC, "The sweeper didn't bring the raw tier down to the low watermark.");
+    if (list->evictions != 0)
+      show_error(E_GENERIC, "Nothing should have been evicted; the comp tier has plenty of room.");
+    if (pass == 0 && list->compressions > list->slices * SLICE_VICTIMS)
+      show_error(E_GENERIC, "%"PRIu64" slices took %"PRIu64" victims, more than %"PRIu32" each.", list->slices, list->compressions, SLICE_VICTIMS);
+    if (list->slices < 2 || list->sweep_unfinished != 0)
+      show_error(E_GENERIC, "A sweep this big should have taken several slices and then finished.");
+    list__destroy(list);
+  }
+
+  printf("Test 'sweep_slices': All Passed\n");
+  return;
+}
+
+
+/* tests__sweep_hands
+ * Reclamation bandwidth with 1, 2, 4... sweep hands, up to max_hands.  Each round fills a list's raw tier to just under max with the
+ * sweeper held off, then drops the watermarks so one sweep has to take it from full down to 10%, and times how long that takes.
+ * The compressor pool is max_hands wide every round so only the hands change.  Every hand has to reclaim something from its range.
+ * Extended options (-X) are max_hands,pages.
+ */
+void tests__sweep_hands() {
+  uint32_t max_hands = 4, pages = 4000;
+  if(opts.extended_test_options != NULL && strcmp(opts.extended_test_options, "") != 0) {
+    printf("Extended options were found; updating test values with options specified: %s\n", opts.extended_test_options);
+    char *token = NULL;
+    token = strtok(opts.extended_test_options, ","); if(token != NULL) max_hands = atoi(token);
+    token = strtok(NULL, ",");                       if(token != NULL) pages     = atoi(token);
+    if (max_hands == 0 || max_hands > MAX_SWEEP_HANDS || pages == 0)
+      show_error(E_GENERIC, "One or more of the extended options passed in was 0, too big, or bad input:\n"
+                            "Max Hands: %"PRIu32" (1 - %d)\nPages: %"PRIu32, max_hands, MAX_SWEEP_HANDS, pages);
+  }
+
+  const uint32_t PAGE_SIZE = 4096;
+  const uint64_t RAW_MAX = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * pages;
+  struct timespec start, end;
+  uint64_t elapsed_ns = 0, freed = 0, before = 0;
+  uint32_t seed = 1;
+  List *list = NULL;
+  Buffer *buf = NULL;
+  unsigned char *data = NULL;
+  int rv = E_OK;
+
+  setlocale(LC_NUMERIC, "");
+  printf("Sweeping %'"PRIu32" pages of %'"PRIu32" bytes from full down to 10%% with %"PRIu32" compressors.\n", pages, PAGE_SIZE, max_hands);
+  // Double the hands each round, finishing with exactly max_hands even when it isn't a power of 2.
+  for(uint32_t hands=1; hands<=max_hands; hands = (hands == max_hands ? hands + 1 : (hands * 2 > max_hands ? max_hands : hands * 2))) {
+    rv = list__initialize(&list, max_hands, LZ4_COMPRESSOR_ID, 1, RAW_MAX * 2, opts.index_mode, POLICY_CLOCK);
+    if (rv != E_OK)
+      show_error(E_GENERIC, "Unable to initialize a list for the sweep hands test.  rv was %d", rv);
+    list->max_raw_size = RAW_MAX;
+    list->max_comp_size = RAW_MAX;
+    list->watermark_high = 100;
+    list->watermark_low = 100;
+    list->overcommit = 0;
+    if (list__set_hands(list, hands) != E_OK)
+      show_error(E_GENERIC, "Unable to give the list %"PRIu32" sweep hands.", hands);
+    for(uint32_t id=0; id<pages && list->current_raw_size + BUFFER_OVERHEAD + PAGE_SIZE <= RAW_MAX; id++) {
+      // Something for the compressor to chew on, but still compressible.
+      data = malloc(PAGE_SIZE);
+      for(uint32_t i=0; i<PAGE_SIZE; i++)
+        data[i] = 'a' + rand_r(&seed) % 16;
+      buffer__initialize(&buf, id, PAGE_SIZE, data, NULL);
+      if (list__add(list, buf, NEED_PIN) != E_OK)
+        show_error(E_GENERIC, "Failed to add buffer %"PRIu32" to the list.", id);
+    }
+
+    before = list->current_raw_size;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    list->watermark_low = 10;
+    list->watermark_high = 50;
+    list__wake_sweeper(list);
+    for(int i=0; i<100000 && list->current_raw_size > list__watermark(RAW_MAX, 10); i++)
+      usleep(100);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    elapsed_ns = BILLION * (end.tv_sec - start.tv_sec) + end.tv_nsec - start.tv_nsec;
+    freed = before - list->current_raw_size;
+    printf("%3"PRIu32" hands : %'16.0f bytes/sec  (%'"PRIu64" bytes in %'"PRIu64" ns).  Per hand:", hands, 1.0 * freed * BILLION / elapsed_ns, freed, elapsed_ns);
+    for(uint32_t i=0; i<hands; i++)
+      printf(" %'"PRIu64, list->hands[i].total_freed);
+    printf("\n");
+    if (list->current_raw_size > list__watermark(RAW_MAX, 10))
+      show_error(E_GENERIC, "The sweeper didn't bring the raw tier down to 10%% with %"PRIu32" hands.", hands);
+    for(uint32_t i=0; i<hands; i++)
+      if (list->hands[i].total_freed == 0)
+        show_error(E_GENERIC, "Hand %"PRIu32" of %"PRIu32" didn't reclaim anything from its range.", i, hands);
+    list__destroy(list);
+  }
+
+  printf("Test 'sweep_hands': All Passed\n");
+  return;
+}
+
+
+/* tests__spill
+ * Runs a spill tier in /tmp through records being taken back and spilled again until its segments have to be cleaned, then
+ * overfills it so cleaning has to expire some.  Finally streams pages through a list small enough that most of them leave the
+ * compressed tier, and makes sure every one of them comes back from the spill file intact.
+ */
+void tests__spill() {
+  const uint32_t IMAGE = 3000, RECORDS = 1000, ROUNDS = 3, PAGE_SIZE = 4096, STREAM = 2000, RAW_PAGES = 64, COMP_PAGES = 256;
+  char path[64];
+  SpillTier *spill = NULL;
+  List *list = NULL;
+  Buffer *buf = NULL;
+  uint8_t image[IMAGE];
+  uint8_t last_round[RECORDS];
+  void *data = NULL;
+  uint64_t spills = 0, restored = 0;
+  uint32_t found = 0;
+  int rv = E_OK;
+
+  snprintf(path, sizeof(path), "/tmp/tyche_spill_test.%d", (int)getpid());
+  rv = spill__initialize(&spill, path, (uint64_t)SPILL_MIN_SEGMENTS * SPILL_SEGMENT_SIZE);
+  if (rv != E_OK)
+    show_error(E_GENERIC, "Unable to create the spill file %s.  rv was %d", path, rv);
+
+  printf("Step 1.  Spilling %"PRIu32" records of %"PRIu32" bytes into %d segments, then taking every 4th back.\n", RECORDS, IMAGE, SPILL_MIN_SEGMENTS);
+  for(bufferid_t id=0; id<RECORDS; id++) {
+    memset(image, id % 251, IMAGE);
+    if (spill__put(spill, id, image, 4 * IMAGE, IMAGE, LZ4_COMPRESSOR_ID, DICT_NONE) != E_OK)
+      show_error(E_GENERIC, "The spill tier refused record %"PRIu32".", id);
+  }
+  for(bufferid_t id=0; id<RECORDS; id+=4) {
+    if (spill__take(spill, id, &buf) != E_OK)
+      show_error(E_GENERIC, "Record %"PRIu32" wasn't in the spill tier.", id);
+    if (buf->data_length != 4 * IMAGE || buf->comp_length != IMAGE || buf->codec_id != LZ4_COMPRESSOR_ID || ((uint8_t *)buf->data)[0] != id % 251 || ((uint8_t *)buf->data)[IMAGE - 1] != id % 251)
+      show_error(E_GENERIC, "Record %"PRIu32" came back wrong.", id);
+    buffer__destroy(buf, DESTROY_DATA);
+  }
+  if (spill__take(spill, 0, &buf) != E_BUFFER_NOT_FOUND)
+    show_error(E_GENERIC, "A record that was taken shouldn't be there anymore.");
+  printf("%"PRIu64" segment writes, %"PRIu64" preads, %"PRIu32" records left.\n", spill->writes, spill->reads, spill->entries);
+  if (spill->writes == 0 || spill->reads == 0)
+    show_error(E_GENERIC, "Expected full segments to be written and taken records to be read back.");
+
+  printf("\nStep 2.  Spilling 2/3 of the other %"PRIu32" again, %"PRIu32" times; dead copies have to be cleaned out.\n", RECORDS - RECORDS / 4, ROUNDS);
+  memset(last_round, 0, sizeof(last_round));
+  for(uint32_t round=1; round<=ROUNDS; round++) {
+    for(bufferid_t id=0; id<RECORDS; id++) {
+      if (id % 4 == 0 || id % 3 == round % 3)
+        continue;
+      last_round[id] = round;
+      memset(image, (id + round) % 251, IMAGE);
+      if (spill__put(spill, id, image, 4 * IMAGE, IMAGE, LZ4_COMPRESSOR_ID, DICT_NONE) != E_OK)
+        show_error(E_GENERIC, "The spill tier refused record %"PRIu32" in round %"PRIu32".", id, round);
+    }
+  }
+  printf("%"PRIu64" cleanings moved %"PRIu64" records and expired %"PRIu64".  %"PRIu64" live bytes.\n", spill->cleanings, spill->moved, spill->expired, spill->live_bytes);
+  if (spill->cleanings == 0 || spill->moved == 0 || spill->expired != 0)
+    show_error(E_GENERIC, "The live records fit, so cleaning should have made room by moving them rather than expiring any.");
+  for(bufferid_t id=0; id<RECORDS; id++) {
+    if (id % 4 == 0)
+      continue;
+    if (spill__take(spill, id, &buf) != E_OK)
+      show_error(E_GENERIC, "Record %"PRIu32" was lost.", id);
+    if (((uint8_t *)buf->data)[0] != (id + last_round[id]) % 251 || ((uint8_t *)buf->data)[IMAGE - 1] != (id + last_round[id]) % 251)
+      show_error(E_GENERIC, "Record %"PRIu32" came back with an old image.", id);
+    buffer__destroy(buf, DESTROY_DATA);
+  }
+  if (spill->entries != 0 || spill->live_bytes != 0)
+    show_error(E_GENERIC, "Took everything back but %"PRIu32" records (%"PRIu64" bytes) are still live.", spill->entries, spill->live_bytes);
+
+  printf("\nStep 3.  Spilling %"PRIu32" records, twice what the file holds.\n", 2 * SPILL_MIN_SEGMENTS * SPILL_SEGMENT_SIZE / IMAGE);
+  for(bufferid_t id=0; id<2 * SPILL_MIN_SEGMENTS * SPILL_SEGMENT_SIZE / IMAGE; id++) {
+    memset(image, id % 251, IMAGE);
+    if (spill__put(spill, id, image, 4 * IMAGE, IMAGE, LZ4_COMPRESSOR_ID, DICT_NONE) != E_OK)
+      show_error(E_GENERIC, "The spill tier refused record %"PRIu32".", id);
+  }
+  printf("%"PRIu64" records expired, %"PRIu32" kept.\n", spill->expired, spill->entries);
+  if (spill->expired == 0 || spill->live_bytes > (uint64_t)SPILL_MIN_SEGMENTS * SPILL_SEGMENT_SIZE)
+    show_error(E_GENERIC, "An overfull spill tier has to expire records to stay in its file.");
+  if (spill__take(spill, 2 * SPILL_MIN_SEGMENTS * SPILL_SEGMENT_SIZE / IMAGE - 1, &buf) != E_OK)
+    show_error(E_GENERIC, "The newest record should never be the one expired.");
+  buffer__destroy(buf, DESTROY_DATA);
+  spill__destroy(spill);
+  if (access(path, F_OK) == 0)
+    show_error(E_GENERIC, "The spill file %s should be gone after spill__destroy().", path);
+
+  printf("\nStep 4.  Streaming %"PRIu32" pages through %"PRIu32" raw and %"PRIu32" compressed pages with a spill tier behind them.\n", STREAM, RAW_PAGES, COMP_PAGES);
+  rv = list__initialize(&list, 1, LZ4_COMPRESSOR_ID, 1, (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * (RAW_PAGES + COMP_PAGES), opts.index_mode, POLICY_CLOCK);
+  if (rv != E_OK)
+    show_error(E_GENERIC, "Unable to initialize a list for the spill test.  rv was %d", rv);
+  list->max_raw_size = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * RAW_PAGES;
+  list->max_comp_size = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE / 32) * COMP_PAGES;
+  rv = spill__initialize(&list->spill, path, (uint64_t)SPILL_MIN_SEGMENTS * SPILL_SEGMENT_SIZE);
+  if (rv != E_OK)
+    show_error(E_GENERIC, "Unable to create the spill file %s.  rv was %d", path, rv);
+  for(bufferid_t id=0; id<STREAM; id++) {
+    data = malloc(PAGE_SIZE);
+    memset(data, id % 251, PAGE_SIZE);
+    memcpy(data, &id, sizeof(bufferid_t));
+    buffer__initialize(&buf, id, PAGE_SIZE, data, NULL);
+    if (list__add(list, buf, NEED_PIN) != E_OK)
+      show_error(E_GENERIC, "Failed to add buffer %"PRIu32" to the list.", id);
+  }
+  for(int i=0; i<100 && list->raw_count + list->comp_count + list->evictions != STREAM; i++)
+    usleep(10000);
+  spills = list->spill->spills;
+  printf("%"PRIu64" evictions, %"PRIu64" spilled.  %"PRIu32" raw, %"PRIu32" compressed.\n", list->evictions, spills, list->raw_count, list->comp_count);
+  if (list->evictions == 0 || spills != list->evictions)
+    show_error(E_GENERIC, "Every compressed eviction should have spilled.");
+
+  printf("\nStep 5.  Searching every page.  The evicted ones should come back from the spill file.\n");
+  for(bufferid_t id=0; id<STREAM; id++) {
+    if (list__search(list, &buf, id, NEED_PIN) != E_OK)
+      continue;
+    if (memcmp(buf->data, &id, sizeof(bufferid_t)) != 0 || ((uint8_t *)buf->data)[PAGE_SIZE - 1] != id % 251)
+      show_error(E_GENERIC, "Buffer %"PRIu32" came back with the wrong page.", id);
+    found++;
+    __sync_fetch_and_add(&buf->ref_count, -1);
+  }
+  restored = list->spill->hits;
+  printf("%"PRIu32" of %"PRIu32" pages found, %"PRIu64" of them restored from the spill tier.\n", found, STREAM, restored);
+  if (found != STREAM || restored < spills)
+    show_error(E_GENERIC, "Expected all %"PRIu32" pages, and at least the %"PRIu64" that spilled to come back from the spill tier.", STREAM, spills);
+  list__destroy(list);
+
+  printf("Test 'spill': All Passed\n");
+  return;
+}
+
+
+/* tests__arena
+ * Stores images of assorted sizes in an arena, frees most of them, and makes sure compaction gives the memory back without losing or
+ * mixing up what's left.  Then streams pages through a list and compares what the compressed tier holds against what each image
+ * would have cost in a compressBound()-sized malloc of its own.
+ */
+void tests__arena() {
+  const uint32_t IMAGES = 2000, PAGE_SIZE = 4096, STREAM = 3000, RAW_PAGES = 64, COMP_PAGES = 2048;
+  CompArena *arena = NULL;
+  List *list = NULL;
+  Buffer *owners[IMAGES];
+  Buffer *buf = NULL;
+  uint8_t image[PAGE_SIZE];
+  void *data = NULL;
+  uint64_t malloc_bytes = 0, charged = 0;
+  uint32_t length = 0, found = 0;
+  int rv = E_OK;
+
+  rv = arena__initialize(&arena, &charged);
+  if (rv != E_OK)
+    show_error(E_GENERIC, "Unable to initialize an arena.  rv was %d", rv);
+
+  printf("Step 1.  Storing %"PRIu32" images of 200 to 3,000 bytes.\n", IMAGES);
+  srand(42);
+  for(bufferid_t id=0; id<IMAGES; id++) {
+    length = 200 + rand() % 2801;
+    memset(image, id % 251, length);
+    buffer__initialize(&owners[id], id, 0, NULL, NULL);
+    owners[id]->data = arena__store(arena, image, length);
+    if (owners[id]->data == NULL)
+      show_error(E_GENERIC, "The arena refused image %"PRIu32".", id);
+    owners[id]->comp_length = length;
+    owners[id]->flags |= in_arena;
+    arena__adopt(owners[id]->data, owners[id]);
+  }
+  printf("%'"PRIu32" segments, %'"PRIu64" bytes resident for %'"PRIu64" bytes of images.\n", arena->segment_count, arena__resident(arena), arena->image_bytes);
+  if (arena__resident(arena) - arena->live_bytes >= ARENA_SEGMENT_SIZE || arena->image_bytes * 100 < arena->live_bytes * 95)
+    show_error(E_GENERIC, "Images are placed at their exact size, so only the open segment's tail and the headers should go unused.");
+
+  printf("\nStep 2.  Freeing 3 of every 4, then compacting.\n");
+  for(bufferid_t id=0; id<IMAGES; id++)
+    if (id % 4 != 0)
+      buffer__free_data(owners[id]);
+  const uint64_t SPARSE = arena__resident(arena);
+  const uint64_t DEAD = charged;
+  if (DEAD == 0 || DEAD != arena->dead_bytes)
+    show_error(E_GENERIC, "Freed images are still resident, so their %"PRIu64" bytes should be charged until compaction.", arena->dead_bytes);
+  arena__compact(arena, UINT32_MAX, ARENA_COMPACT_PERCENT);
+  printf("%'"PRIu64" bytes resident before compacting, %'"PRIu64" after.  %'"PRIu64" segments compacted, %'"PRIu64" images moved.\n", SPARSE, arena__resident(arena), arena->compactions, arena->moved);
+  printf("%'"PRIu64" dead bytes were charged before compacting, %'"PRIu64" after.\n", DEAD, charged);
+  if (arena->compactions == 0 || arena__resident(arena) * 2 > SPARSE)
+    show_error(E_GENERIC, "With 3/4 of the images gone, compaction should give back at least half the memory.");
+  if (charged != arena->dead_bytes || charged * 2 > DEAD)
+    show_error(E_GENERIC, "Compaction gave the memory back, so it should have taken at least half the dead bytes off the charge.");
+  for(bufferid_t id=0; id<IMAGES; id+=4) {
+    if (((ArenaImage *)owners[id]->data - 1)->owner != owners[id] || ((uint8_t *)owners[id]->data)[0] != id % 251 || ((uint8_t *)owners[id]->data)[owners[id]->comp_length - 1] != id % 251)
+      show_error(E_GENERIC, "Image %"PRIu32" was lost or mixed up by compaction.", id);
+    buffer__destroy(owners[id], DESTROY_DATA);
+  }
+  for(bufferid_t id=0; id<IMAGES; id++)
+    if (id % 4 != 0)
+      buffer__destroy(owners[id], DESTROY_DATA);
+  if (arena->segment_count > 1 || arena->live_bytes != 0)
+    show_error(E_GENERIC, "Everything was freed, but %"PRIu32" segments and %"PRIu64" live bytes are left.", arena->segment_count, arena->live_bytes);
+  arena__destroy(arena);
+
+  printf("\nStep 3.  Streaming %"PRIu32" pages (a quarter of each random) through %"PRIu32" raw and room for %"PRIu32" compressed.\n", STREAM, RAW_PAGES, COMP_PAGES);
+  rv = list__initialize(&list, 1, LZ4_COMPRESSOR_ID, 1, (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * (RAW_PAGES + COMP_PAGES), opts.index_mode, POLICY_CLOCK);
+  if (rv != E_OK)
+    show_error(E_GENERIC, "Unable to initialize a list for the arena test.  rv was %d", rv);
+  list->max_raw_size = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * RAW_PAGES;
+  list->max_comp_size = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * COMP_PAGES;
+  for(bufferid_t id=0; id<STREAM; id++) {
+    data = malloc(PAGE_SIZE);
+    memset(data, id % 251, PAGE_SIZE);
+    for(uint32_t i=0; i<PAGE_SIZE / 4; i++)
+      ((uint8_t *)data)[i] = rand();
+    memcpy(data, &id, sizeof(bufferid_t));
+    buffer__initialize(&buf, id, PAGE_SIZE, data, NULL);
+    if (list__add(list, buf, NEED_PIN) != E_OK)
+      show_error(E_GENERIC, "Failed to add buffer %"PRIu32" to the list.", id);
+  }
+  for(int i=0; i<100 && list->raw_count + list->comp_count + list->evictions != STREAM; i++)
+    usleep(10000);
+  malloc_bytes = (uint64_t)list->comp_count * LZ4_compressBound(PAGE_SIZE);
+  printf("%'"PRIu32" compressed buffers.  The arena holds them in %'"PRIu64" bytes; separate mallocs would take %'"PRIu64".\n", list->comp_count, arena__resident(list->arena), malloc_bytes);
+  if (list->comp_count == 0 || arena__resident(list->arena) * 2 > malloc_bytes)
+    show_error(E_GENERIC, "Pages that compress to about 1/4 should take well under half the memory they would in bound-sized mallocs.");
+
+  printf("\nStep 4.  Restoring every other page to punch holes, compacting, then checking every page.\n");
+  for(bufferid_t id=0; id<STREAM; id+=2) {
+    if (list__search(list, &buf, id, NEED_PIN) != E_OK)
+      continue;
+    __sync_fetch_and_add(&buf->ref_count, -1);
+  }
+  arena__compact(list->arena, UINT32_MAX, ARENA_COMPACT_PERCENT);
+  for(bufferid_t id=0; id<STREAM; id++) {
+    if (list__search(list, &buf, id, NEED_PIN) != E_OK)
+      continue;
+    if (memcmp(buf->data, &id, sizeof(bufferid_t)) != 0 || ((uint8_t *)buf->data)[PAGE_SIZE - 1] != id % 251)
+      show_error(E_GENERIC, "Buffer %"PRIu32" came back with the wrong page.", id);
+    found++;
+    __sync_fetch_and_add(&buf->ref_count, -1);
+  }
+  printf("%'"PRIu32" pages found intact.  %'"PRIu64" segments compacted, %'"PRIu64" images moved, %'"PRIu64" left for a busy owner.\n", found, list->arena->compactions, list->arena->moved, list->arena->busy);
+  if (found == 0)
+    show_error(E_GENERIC, "No pages were found; the test isn't testing anything.");
+  list__destroy(list);
+
+  printf("Test 'arena': All Passed\n");
+  return;
+}
+
+
+/* tests__windows
+ * Checks a buffer's frequency folds and decays per window the way it should, and that the Zipf fit recovers the exponent of
+ * synthetic Zipf hit counts closely enough to size a hot set.  Then reads a small hot set between one-time buffers on a list with
+ * windows on, and makes sure the hot set stays put, the clock spares it, and the hot set's share of hits was predicted well.
+ */
+void tests__windows() {
+  const uint32_t PAGE_SIZE = 4096, HOT = 64, READS = 4, STREAM = 4000, RAW_PAGES = 128, COMP_PAGES = 256, RANKS = 1000;
+  const double EXPONENTS[2] = {0.8, 1.2};
+  double harmonic[HOT], target = 0;
+  bufferid_t hot_id = 0;
+  uint32_t seed = 1;
+  FrequencyWindows *windows = NULL;
+  List *list = NULL;
+  Buffer *buf = NULL, *other = NULL;
+  void *data = NULL;
+  int64_t buckets[WINDOW_BUCKETS];
+  uint64_t hits[RANKS], distinct = 0, hot_set = 0;
+  double exponent = 0, predicted = 0, actual = 0, total = 0;
+  uint32_t hot_misses[2] = {0, 0};
+  int rv = E_OK;
+
+  printf("Step 1.  Folding and decaying a buffer's hits, 8 hits per window, keeping 50%% each rotation.\n");
+  rv = window__initialize(&windows, 0, 8, 50);
+  if (rv != E_OK)
+    show_error(E_GENERIC, "Unable to initialize popularity windows.  rv was %d", rv);
+  buffer__initialize(&buf, 1, PAGE_SIZE, NULL, NULL);
+  buffer__initialize(&other, 2, PAGE_SIZE, NULL, NULL);
+  for(int i=0; i<8; i++)
+    window__hit(windows, buf);
+  if (windows->rotations != 1 || window__frequency(windows, buf) != 8 * WINDOW_SCALE / 2)
+    show_error(E_GENERIC, "8 hits in one window should fold to a frequency of %d after 1 rotation, got %"PRIu16" after %"PRIu64".", 8 * WINDOW_SCALE / 2, buf->frequency, windows->rotations);
+  for(int i=0; i<16; i++)
+    window__hit(windows, other);
+  window__hit(windows, buf);
+  if (windows->rotations != 3 || buf->frequency != 8 * WINDOW_SCALE / 8 || buf->window_hits != 1)
+    show_error(E_GENERIC, "Two windows without hits should decay a frequency of %d to %d, got %"PRIu16".", 8 * WINDOW_SCALE / 2, 8 * WINDOW_SCALE / 8, buf->frequency);
+  printf("8 hits -> frequency %d.  Two empty windows later -> %"PRIu16".\n", 8 * WINDOW_SCALE / 2, buf->frequency);
+  buffer__destroy(buf, DESTROY_DATA);
+  buffer__destroy(other, DESTROY_DATA);
+  window__destroy(windows);
+
+  printf("\nStep 2.  Fitting Zipf curves to %"PRIu32" buffers' hits.\n", RANKS);
+  for(int e=0; e<2; e++) {
+    memset(buckets, 0, sizeof(buckets));
+    total = 0;
+    for(uint32_t rank=1; rank<=RANKS; rank++) {
+      hits[rank - 1] = (uint64_t)(4000 / pow(rank, EXPONENTS[e]));
+      if (hits[rank - 1] == 0)
+        continue;
+      buckets[63 - __builtin_clzll(hits[rank - 1])]++;
+      total += hits[rank - 1];
+    }
+    exponent = window__fit_zipf(buckets, &distinct);
+    hot_set = window__zipf_hot_set(exponent, distinct, WINDOW_HOT_SHARE / 100.0, &predicted);
+    actual = 0;
+    for(uint64_t i=0; i<hot_set && i<RANKS; i++)
+      actual += hits[i];
+    actual /= total;
+    printf("s = %.1f:  fit s = %.2f.  Hot set of %"PRIu64" of %"PRIu64" buffers should take %.1f%% of hits, took %.1f%%.\n", EXPONENTS[e], exponent, hot_set, distinct, 100 * predicted, 100 * actual);
+    if (exponent < EXPONENTS[e] - 0.15 || exponent > EXPONENTS[e] + 0.15)
+      show_error(E_GENERIC, "The fit should have been within 0.15 of %.1f, got %.2f.", EXPONENTS[e], exponent);
+    if (actual < predicted - 0.08 || actual > predicted + 0.08)
+      show_error(E_GENERIC, "The hot set took %.1f%% of hits, more than 8 points off the %.1f%% predicted.", 100 * actual, 100 * predicted);
+  }
+
+  for(uint32_t rank=1; rank<=HOT; rank++)
+    harmonic[rank - 1] = (rank == 1 ? 0 : harmonic[rank - 2]) + 1.0 / rank;
+  for(int pass=0; pass<2; pass++) {
+    printf("\nStep %d.  %"PRIu32" Zipf-read hot buffers, %"PRIu32" reads after each of %"PRIu32" one-time buffers, %s.\n", pass + 3, HOT, READS, STREAM, pass == 0 ? "without windows" : "with windows of 2000 hits");
+    seed = 1;
+    rv = list__initialize(&list, 1, LZ4_COMPRESSOR_ID, 1, (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * (RAW_PAGES + COMP_PAGES), opts.index_mode, POLICY_CLOCK);
+    if (rv != E_OK)
+      show_error(E_GENERIC, "Unable to initialize a list for the windows test.  rv was %d", rv);
+    list->max_raw_size = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * RAW_PAGES;
+    list->max_comp_size = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE / 32) * COMP_PAGES;
+    if (pass == 1 && window__initialize(&list->windows, 0, 2000, 50) != E_OK)
+      show_error(E_GENERIC, "Unable to initialize the list's popularity windows.");
+    hot_misses[pass] = 0;
+    for(bufferid_t id=0; id<HOT + STREAM; id++) {
+      data = malloc(PAGE_SIZE);
+      memset(data, id % 251, PAGE_SIZE);
+      memcpy(data, &id, sizeof(bufferid_t));
+      buffer__initialize(&buf, id, PAGE_SIZE, data, NULL);
+      if (list__add(list, buf, NEED_PIN) != E_OK)
+        show_error(E_GENERIC, "Failed to add buffer %"PRIu32" to the list.", id);
+      // One read of the new buffer, so one-time buffers show up in the windows' tail.
+      if (list__search(list, &buf, id, NEED_PIN) == E_OK)
+        __sync_fetch_and_add(&buf->ref_count, -1);
+      if (id < HOT)
+        continue;
+      for(uint32_t read=0; read<READS; read++) {
+        // Rank r is read in proportion to 1/r.
+        target = (double)rand_r(&seed) / RAND_MAX * harmonic[HOT - 1];
+        for(hot_id=0; hot_id<HOT - 1 && harmonic[hot_id] < target; hot_id++);
+        rv = list__search(list, &buf, hot_id, NEED_PIN);
+        if (rv == E_OK) {
+          __sync_fetch_and_add(&buf->ref_count, -1);
+          continue;
+        }
+        hot_misses[pass]++;
+        data = malloc(PAGE_SIZE);
+        memcpy(data, &hot_id, sizeof(bufferid_t));
+        buffer__initialize(&buf, hot_id, PAGE_SIZE, data, NULL);
+        if (list__add(list, buf, NEED_PIN) != E_OK)
+          buffer__destroy(buf, DESTROY_DATA);
+      }
+    }
+    printf("Hot set misses: %"PRIu32" of %"PRIu32" reads.\n", hot_misses[pass], STREAM * READS);
+    windows = list->windows;
+    if (windows != NULL) {
+      printf("%"PRIu64" rotations, fit s = %.2f, %"PRIu64" spared.  Hot set of %"PRIu64" buffers should take %.1f%% of hits; mean error %.1f points over %"PRIu64" windows.\n",
+             windows->rotations, windows->zipf_exponent, windows->spared, windows->hot_buffers, 100 * windows->predicted_share, windows->scored == 0 ? 0.0 : 100 * windows->share_error / windows->scored, windows->scored);
+      if (windows->rotations < STREAM * (READS + 1) / 2000 - 1 || windows->scored == 0 || windows->zipf_exponent == 0)
+        show_error(E_GENERIC, "Windows should have rotated every 2000 hits and fit each one.");
+      if (windows->spared == 0)
+        show_error(E_GENERIC, "The clock never spared a buffer in the hot set.");
+      if (windows->share_error / windows->scored > 0.2)
+        show_error(E_GENERIC, "The hot set's share of hits was off by %.1f points on average, more than 20.", 100 * windows->share_error / windows->scored);
+    }
+    list__destroy(list);
+  }
+  if (hot_misses[1] > STREAM * READS / 20 || hot_misses[1] > hot_misses[0])
+    show_error(E_GENERIC, "With windows the hot set missed %"PRIu32" times (%"PRIu32" without), more than 5%% of reads or more than without.", hot_misses[1], hot_misses[0]);
+
+  printf("Test 'windows': All Passed\n");
+  return;
+}
+
+
 /* tests__options
  * Simple test to make sure options get set correctly.  I'm not sure this will ever be useful.
  */
@@ -545,10 +2524,17 @@ void tests__options() {
   printf("opts->fixed_ratio .......... = %"PRIi8"\n",        opts.fixed_ratio);
   printf("opts->workers .............. = %"PRIu16"\n",       opts.workers);
   printf("opts->cput_count ........... = %"PRIu16"\n",       opts.cpu_count);
+  printf("opts->watermark_high ....... = %"PRIu8"\n",        opts.watermark_high);
+  printf("opts->watermark_low ........ = %"PRIu8"\n",        opts.watermark_low);
+  printf("opts->overcommit ........... = %"PRIu8"\n",        opts.overcommit);
+  printf("opts->slice_budget_ns ...... = %"PRIu64"\n",       opts.slice_budget_ns);
+  printf("opts->slice_victims ........ = %"PRIu32"\n",       opts.slice_victims);
+  printf("opts->sweep_hands .......... = %"PRIu8"\n",        opts.sweep_hands);
   /* Tyche Management */
   printf("opts->duration ............. = %"PRIu16"\n",       opts.duration);
   printf("opts->compressor_id ........ = %d\n",              opts.compressor_id);
   printf("opts->compressor_level ..... = %d\n",              opts.compressor_level);
+  printf("opts->index_mode ........... = %d\n",              opts.index_mode);
   printf("opts->min_pages_retrieved .. = %d\n",              opts.min_pages_retrieved);
   printf("opts->max_pages_retrieved .. = %d\n",              opts.max_pages_retrieved);
   printf("opts->bias_percent ......... = %3.2f (%4.2f%%)\n", opts.bias_percent,     100.0 * opts.bias_percent);
@@ -564,3 +2550,418 @@ void tests__options() {
 
   return;
 }
+
+
+/* tests__dictionary_page
+ * Fills a page with rows the way a table would:  the same column names and a small vocabulary of values in every page, but never the
+ * same rows.  Each page alone is too small for the compressor to learn much.  schema picks one of two tables, so pages can drift
+ * away from what a dictionary was trained on.
+ */
+void tests__dictionary_page(uint8_t *page, uint32_t size, uint32_t seed, uint8_t schema) {
+  const char *FIRST[] = {"James", "Mary", "Robert", "Patricia", "John", "Jennifer", "Michael", "Linda"};
+  const char *LAST[] = {"Smith", "Johnson", "Williams", "Brown", "Jones", "Garcia", "Miller", "Davis"};
+  const char *CITY[] = {"Springfield", "Riverside", "Franklin", "Greenville", "Bristol", "Clinton", "Fairview", "Salem"};
+  const char *STATUS[] = {"PENDING", "SHIPPED", "DELIVERED", "RETURNED"};
+  const char *LEVEL[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+  const char *HOST[] = {"db-primary-01", "db-replica-02", "api-gateway-03", "cache-node-04"};
+  const char *MESSAGE[] = {"connection pool exhausted, retrying", "checkpoint complete", "slow query detected on index scan", "replication lag above threshold"};
+  char row[256];
+  unsigned int state = seed * 2654435761u + schema;
+  uint32_t used = 0;
+  int length = 0;
+  memset(page, 0, size);
+  for(;;) {
+    if (schema == 0)
+      length = snprintf(row, sizeof(row), "{\"order_id\":%d,\"customer\":\"%s %s\",\"city\":\"%s\",\"sku\":\"SKU-%04d\",\"quantity\":%d,\"status\":\"%s\"}\n",
+                        rand_r(&state) % 10000000, FIRST[rand_r(&state) % 8], LAST[rand_r(&state) % 8], CITY[rand_r(&state) % 8], rand_r(&state) % 10000,
+                        1 + rand_r(&state) % 20, STATUS[rand_r(&state) % 4]);
+    else
+      length = snprintf(row, sizeof(row), "2026-10-%02d %02d:%02d:%02d level=%s host=%s pid=%d msg=\"%s\" latency_ms=%d\n",
+                        1 + rand_r(&state) % 28, rand_r(&state) % 24, rand_r(&state) % 60, rand_r(&state) % 60, LEVEL[rand_r(&state) % 4],
+                        HOST[rand_r(&state) % 4], rand_r(&state) % 65536, MESSAGE[rand_r(&state) % 4], rand_r(&state) % 5000);
+    if (used + length > size)
+      break;
+    memcpy(page + used, row, length);
+    used += length;
+  }
+  return;
+}
+
+
+/* tests__dictionaries
+ * Trains a dictionary from sample pages and makes sure it shrinks pages it never saw with both zlib and zstd, and that an image keeps
+ * its dictionary alive through the spill tier.  Then streams the same pages through a list with and without dictionaries to see the
+ * compressed tier hold more of them.  Finally drifts a trainer onto a different kind of page and makes sure it retrains without
+ * breaking the images compressed with the old dictionary.
+ */
+void tests__dictionaries() {
+  const uint32_t PAGE_SIZE = 8192, HELD_OUT = 256, KEPT = 16, STREAM = 4000, RAW_PAGES = 64, COMP_PAGES = 512;
+  const int CODECS[] = {ZLIB_COMPRESSOR_ID, ZSTD_COMPRESSOR_ID};
+  const char *NAMES[] = {"zlib", "zstd"};
+  CodecContext *ctx = codec__thread_context();
+  DictTrainer *trainer = NULL;
+  Dictionary *dict = NULL;
+  SpillTier *spill = NULL;
+  List *list = NULL;
+  Buffer *plain = NULL, *trained = NULL, *buf = NULL;
+  Buffer *kept[KEPT];
+  uint8_t *samples = (uint8_t *)malloc(DICT_SAMPLE_PAGES * PAGE_SIZE);
+  uint8_t *content = (uint8_t *)malloc(DICT_DEFAULT_SIZE);
+  uint32_t lengths[DICT_SAMPLE_PAGES];
+  uint8_t page[PAGE_SIZE], check[PAGE_SIZE];
+  void *compressed_data = NULL;
+  void *data = NULL;
+  char path[64];
+  uint64_t plain_bytes = 0, trained_bytes = 0;
+  uint32_t size = 0, comp_counts[2], evictions[2];
+  uint8_t old_id = DICT_NONE;
+  int rv = E_OK;
+
+  printf("Step 1.  Training a %d byte dictionary from %d pages of %"PRIu32" bytes.\n", DICT_DEFAULT_SIZE, DICT_SAMPLE_PAGES, PAGE_SIZE);
+  for(uint32_t i=0; i<DICT_SAMPLE_PAGES; i++) {
+    tests__dictionary_page(samples + i * PAGE_SIZE, PAGE_SIZE, i, 0);
+    lengths[i] = PAGE_SIZE;
+  }
+  size = dict__build(samples, lengths, DICT_SAMPLE_PAGES, content, DICT_DEFAULT_SIZE);
+  printf("Built %'"PRIu32" bytes.\n", size);
+  if (size < DICT_MIN_SIZE || size > DICT_DEFAULT_SIZE)
+    show_error(E_GENERIC, "Expected a dictionary of %d to %d bytes, not %"PRIu32".", DICT_MIN_SIZE, DICT_DEFAULT_SIZE, size);
+
+  printf("\nStep 2.  Compressing %"PRIu32" pages it never saw, with and without it.\n", HELD_OUT);
+  for(int c=0; c<2; c++) {
+    rv = dict__register(content, size, CODECS[c], 1, &dict);
+    if (rv != E_OK)
+      show_error(E_GENERIC, "Unable to register the dictionary for %s.  rv was %d", NAMES[c], rv);
+    plain_bytes = 0;
+    trained_bytes = 0;
+    for(uint32_t i=0; i<HELD_OUT; i++) {
+      tests__dictionary_page(page, PAGE_SIZE, 100000 + i, 0);
+      data = malloc(PAGE_SIZE);
+      memcpy(data, page, PAGE_SIZE);
+      buffer__initialize(&plain, i, PAGE_SIZE, data, NULL);
+      data = malloc(PAGE_SIZE);
+      memcpy(data, page, PAGE_SIZE);
+      buffer__initialize(&trained, i, PAGE_SIZE, data, NULL);
+      if (buffer__compress(plain, &compressed_data, CODECS[c], 1, ctx, NULL) != E_OK)
+        show_error(E_GENERIC, "%s couldn't compress page %"PRIu32" without a dictionary.", NAMES[c], i);
+      free(plain->data);
+      plain->data = compressed_data;
+      if (buffer__compress(trained, &compressed_data, CODECS[c], 1, ctx, dict) != E_OK)
+        show_error(E_GENERIC, "%s couldn't compress page %"PRIu32" with the dictionary.", NAMES[c], i);
+      free(trained->data);
+      trained->data = compressed_data;
+      if (trained->dict_id != dict->id || plain->dict_id != DICT_NONE || dict->refs != 2)
+        show_error(E_GENERIC, "The image should record and hold the dictionary it used (id %"PRIu8", refs %"PRIu32").", trained->dict_id, dict->refs);
+      if (buffer__decompress_into(trained, check, ctx) != E_OK || memcmp(page, check, PAGE_SIZE) != 0)
+        show_error(E_GENERIC, "%s page %"PRIu32" didn't come back intact from its dictionary.", NAMES[c], i);
+      plain_bytes += plain->comp_length;
+      trained_bytes += trained->comp_length;
+      buffer__destroy(plain, DESTROY_DATA);
+      buffer__destroy(trained, DESTROY_DATA);
+    }
+    printf("%s:  %'"PRIu64" bytes without, %'"PRIu64" with (%.2fx vs %.2fx).\n", NAMES[c], plain_bytes, trained_bytes, 1.0 * HELD_OUT * PAGE_SIZE / plain_bytes, 1.0 * HELD_OUT * PAGE_SIZE / trained_bytes);
+    if (trained_bytes * 100 > plain_bytes * 90)
+      show_error(E_GENERIC, "The dictionary should save %s at least 10%% on pages like the ones it was trained on.", NAMES[c]);
+    if (dict->refs != 1)
+      show_error(E_GENERIC, "Every image is gone, so only our own reference should be left, not %"PRIu32".", dict->refs);
+    old_id = dict->id;
+    dict__release(dict->id);
+    if (dict__find(old_id) != NULL)
+      show_error(E_GENERIC, "Releasing the last reference should have freed dictionary %"PRIu8".", old_id);
+  }
+
+  printf("\nStep 3.  Spilling an image, then dropping its buffer and our reference; the spill record has to keep the dictionary.\n");
+  snprintf(path, sizeof(path), "/tmp/tyche_dict_test.%d", (int)getpid());
+  rv = spill__initialize(&spill, path, (uint64_t)SPILL_MIN_SEGMENTS * SPILL_SEGMENT_SIZE);
+  if (rv != E_OK)
+    show_error(E_GENERIC, "Unable to create the spill file %s.  rv was %d", path, rv);
+  dict__register(content, size, ZSTD_COMPRESSOR_ID, 1, &dict);
+  old_id = dict->id;
+  tests__dictionary_page(page, PAGE_SIZE, 200000, 0);
+  data = malloc(PAGE_SIZE);
+  memcpy(data, page, PAGE_SIZE);
+  buffer__initialize(&trained, 1, PAGE_SIZE, data, NULL);
+  buffer__compress(trained, &compressed_data, ZSTD_COMPRESSOR_ID, 1, ctx, dict);
+  free(trained->data);
+  trained->data = compressed_data;
+  if (spill__put(spill, 1, trained->data, trained->data_length, trained->comp_length, trained->codec_id, trained->dict_id) != E_OK)
+    show_error(E_GENERIC, "The spill tier refused the image.");
+  buffer__destroy(trained, DESTROY_DATA);
+  dict__release(old_id);
+  if (dict__find(old_id) == NULL || dict->refs != 1)
+    show_error(E_GENERIC, "The spill record should be holding the dictionary's only reference.");
+  if (spill__take(spill, 1, &buf) != E_OK || buf->dict_id != old_id)
+    show_error(E_GENERIC, "The image should come back from the spill tier with its dictionary id.");
+  if (buffer__decompress_into(buf, check, ctx) != E_OK || memcmp(page, check, PAGE_SIZE) != 0)
+    show_error(E_GENERIC, "The spilled image didn't come back intact.");
+  buffer__destroy(buf, DESTROY_DATA);
+  spill__destroy(spill);
+  if (dict__find(old_id) != NULL)
+    show_error(E_GENERIC, "The dictionary should be gone with the last image that used it.");
+  printf("Dictionary %"PRIu8" lived as long as the spilled image and no longer.\n", old_id);
+
+  printf("\nStep 4.  Streaming %"PRIu32" pages through %"PRIu32" raw pages and a compressed tier of %"PRIu32" pages' worth at 4:1, with zstd.\n", STREAM, RAW_PAGES, COMP_PAGES);
+  for(int run=0; run<2; run++) {
+    rv = list__initialize(&list, 1, ZSTD_COMPRESSOR_ID, 1, (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * (RAW_PAGES + COMP_PAGES), opts.index_mode, POLICY_CLOCK);
+    if (rv != E_OK)
+      show_error(E_GENERIC, "Unable to initialize a list for the dictionaries test.  rv was %d", rv);
+    list->max_raw_size = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * RAW_PAGES;
+    list->max_comp_size = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE / 4) * COMP_PAGES;
+    if (run == 1 && dict__initialize(&list->dictionaries, DICT_DEFAULT_SIZE, ZSTD_COMPRESSOR_ID, 1) != E_OK)
+      show_error(E_GENERIC, "Unable to initialize a dictionary trainer.");
+    for(bufferid_t id=0; id<STREAM; id++) {
+      data = malloc(PAGE_SIZE);
+      tests__dictionary_page(data, PAGE_SIZE, id, 0);
+      buffer__initialize(&buf, id, PAGE_SIZE, data, NULL);
+      if (list__add(list, buf, NEED_PIN) != E_OK)
+        show_error(E_GENERIC, "Failed to add buffer %"PRIu32" to the list.", id);
+    }
+    for(int i=0; i<100 && list->raw_count + list->comp_count + list->evictions != STREAM; i++)
+      usleep(10000);
+    comp_counts[run] = list->comp_count;
+    evictions[run] = list->evictions;
+    printf("%s:  %'"PRIu32" compressed buffers, %'"PRIu64" evictions.\n", run == 0 ? "Without dictionaries" : "With dictionaries   ", list->comp_count, list->evictions);
+    if (run == 1) {
+      if (list->dictionaries->trainings == 0)
+        show_error(E_GENERIC, "The sweeper should have trained a dictionary once %d pages were sampled.", DICT_SAMPLE_PAGES);
+      // Every page has to come back intact, whichever dictionary (or none) it was compressed with.
+      for(bufferid_t id=0; id<STREAM; id++) {
+        if (list__search(list, &buf, id, NEED_PIN) != E_OK)
+          continue;
+        tests__dictionary_page(page, PAGE_SIZE, id, 0);
+        if (memcmp(buf->data, page, PAGE_SIZE) != 0)
+          show_error(E_GENERIC, "Buffer %"PRIu32" came back with the wrong page.", id);
+        __sync_fetch_and_add(&buf->ref_count, -1);
+      }
+    }
+    list__destroy(list);
+  }
+  if (comp_counts[1] <= comp_counts[0] || evictions[1] >= evictions[0])
+    show_error(E_GENERIC, "Dictionaries should let the compressed tier hold more pages and evict fewer.");
+
+  printf("\nStep 5.  Drifting a trainer from one kind of page to another after %d pages.\n", DICT_DRIFT_PAGES);
+  if (dict__initialize(&trainer, DICT_DEFAULT_SIZE, ZSTD_COMPRESSOR_ID, 1) != E_OK)
+    show_error(E_GENERIC, "Unable to initialize a dictionary trainer.");
+  for(uint32_t round=0; round<2; round++) {
+    // Sample and train, the way the compressors and sweeper would.
+    for(uint32_t i=0; i<DICT_SAMPLE_PAGES; i++) {
+      tests__dictionary_page(page, PAGE_SIZE, 300000 + i, round);
+      dict__sample(trainer, page, PAGE_SIZE);
+    }
+    if (dict__train(trainer) != E_OK || trainer->current == NULL || trainer->trainings != round + 1 || trainer->sampling != 0)
+      show_error(E_GENERIC, "The trainer should have trained dictionary #%"PRIu32" from its samples.", round + 1);
+    if (round == 1 && trainer->current->id == old_id)
+      show_error(E_GENERIC, "Retraining should have made a new dictionary.");
+    old_id = trainer->current->id;
+    // Compress a window of the kind of page it was trained on, then a window of the other kind.
+    for(uint32_t i=0; i<2 * DICT_DRIFT_PAGES; i++) {
+      tests__dictionary_page(page, PAGE_SIZE, 400000 + i, i < DICT_DRIFT_PAGES ? round : 1);
+      data = malloc(PAGE_SIZE);
+      memcpy(data, page, PAGE_SIZE);
+      buffer__initialize(&buf, i, PAGE_SIZE, data, NULL);
+      dict = dict__current(trainer);
+      if (buffer__compress(buf, &compressed_data, ZSTD_COMPRESSOR_ID, 1, ctx, dict) != E_OK)
+        show_error(E_GENERIC, "Couldn't compress page %"PRIu32".", i);
+      dict__record(trainer, dict, buf->data_length, buf->comp_length);
+      dict__release(dict->id);
+      free(buf->data);
+      buf->data = compressed_data;
+      if (round == 0 && i < KEPT)
+        kept[i] = buf;
+      else
+        buffer__destroy(buf, DESTROY_DATA);
+    }
+    printf("Dictionary %"PRIu8":  first window %.2fx.  %'"PRIu64" drifts, sampling is %s.\n", old_id, trainer->current->baseline_ratio, trainer->drifts, trainer->sampling ? "on" : "off");
+    if (round == 0 && (trainer->drifts != 1 || trainer->sampling != 1))
+      show_error(E_GENERIC, "Pages of another kind should have compressed worse and started sampling for a new dictionary.");
+    if (round == 1 && trainer->drifts != 1)
+      show_error(E_GENERIC, "A dictionary trained on the new kind of page shouldn't drift on it.");
+  }
+  // The first dictionary is gone from the trainer, but the images compressed with it still need it.
+  for(uint32_t i=0; i<KEPT; i++) {
+    tests__dictionary_page(page, PAGE_SIZE, 400000 + i, 0);
+    if (kept[i]->dict_id == trainer->current->id || buffer__decompress_into(kept[i], check, ctx) != E_OK || memcmp(page, check, PAGE_SIZE) != 0)
+      show_error(E_GENERIC, "Image %"PRIu32" lost its dictionary to the retraining.", i);
+  }
+  old_id = kept[0]->dict_id;
+  if (dict__find(old_id) == NULL || dict__find(old_id)->refs != KEPT)
+    show_error(E_GENERIC, "The old dictionary should be held by exactly the %"PRIu32" images still using it.", KEPT);
+  for(uint32_t i=0; i<KEPT; i++)
+    buffer__destroy(kept[i], DESTROY_DATA);
+  if (dict__find(old_id) != NULL)
+    show_error(E_GENERIC, "The old dictionary should be gone with its last image.");
+  printf("%"PRIu32" images kept the old dictionary alive through the retraining, and it went with them.\n", KEPT);
+  dict__destroy(trainer);
+  free(samples);
+  free(content);
+
+  printf("Test 'dictionaries': All Passed\n");
+  return;
+}
+
+
+/* tests__codec_page
+ * Fills a page for tests__codecs().  noisy pages have every other 64-byte run replaced with random bytes, so they still compress
+ * some, just not well.
+ */
+void tests__codec_page(uint8_t *page, uint32_t size, uint32_t seed, bool noisy) {
+  unsigned int state = seed * 40503u + 7;
+  tests__dictionary_page(page, size, seed, seed % 2);
+  if (!noisy)
+    return;
+  for(uint32_t i=64; i<size; i+=128)
+    for(uint32_t j=i; j<i+64 && j<size; j++)
+      page[j] = rand_r(&state) % 256;
+  return;
+}
+
+
+/* tests__codecs
+ * Checks the entropy probe and the per-page codec choice for adaptive lists, that images carry their own codec through a restore,
+ * a copy, and the spill tier, and then streams a mix of cold text pages and noisy pages through an adaptive list.  Both codecs should
+ * get used, every page has to come back intact, and the per-codec tallies have to add up.
+ */
+void tests__codecs() {
+  const uint32_t PAGE_SIZE = 8192, STREAM = 2000, RAW_PAGES = 64, COMP_PAGES = 512;
+  CodecContext *ctx = codec__thread_context();
+  Compressor comp;
+  SpillTier *spill = NULL;
+  List *list = NULL;
+  Buffer *buf = NULL, *copy = NULL;
+  uint8_t page[PAGE_SIZE], check[PAGE_SIZE];
+  void *compressed_data = NULL;
+  void *data = NULL;
+  char path[64];
+  double entropy[3];
+  int level = 0, rv = E_OK;
+  uint64_t pages = 0;
+
+  printf("Step 1.  Probing the entropy of a blank page, a text page, and a noisy one.\n");
+  memset(page, 0, PAGE_SIZE);
+  entropy[0] = codec__entropy(page, PAGE_SIZE);
+  tests__codec_page(page, PAGE_SIZE, 1, false);
+  entropy[1] = codec__entropy(page, PAGE_SIZE);
+  tests__codec_page(page, PAGE_SIZE, 1, true);
+  entropy[2] = codec__entropy(page, PAGE_SIZE);
+  printf("%.2f, %.2f, and %.2f bits per byte.\n", entropy[0], entropy[1], entropy[2]);
+  if (entropy[0] != 0.0 || entropy[1] > CODEC_COLD_ENTROPY || entropy[2] <= CODEC_COLD_ENTROPY)
+    show_error(E_GENERIC, "A blank page should probe at 0, text at or under %.1f, and a noisy page over it.", CODEC_COLD_ENTROPY);
+
+  printf("\nStep 2.  Choosing codecs for cold, noisy, hot, and previously compressed pages.\n");
+  memset(&comp, 0, sizeof(Compressor));
+  comp.compressor_id = ZLIB_COMPRESSOR_ID;
+  comp.compressor_level = 1;
+  tests__codec_page(page, PAGE_SIZE, 2, false);
+  data = malloc(PAGE_SIZE);
+  memcpy(data, page, PAGE_SIZE);
+  buffer__initialize(&buf, 1, PAGE_SIZE, data, NULL);
+  if (list__choose_codec(&comp, buf, &level) != ZLIB_COMPRESSOR_ID || level != 1)
+    show_error(E_GENERIC, "A list with one compressor should always get it, at its own level.");
+  comp.compressor_id = ADAPTIVE_COMPRESSOR_ID;
+  if (list__choose_codec(&comp, buf, &level) != ZSTD_COMPRESSOR_ID || level != CODEC_COLD_LEVEL)
+    show_error(E_GENERIC, "A cold text page should get zstd at level %d.", CODEC_COLD_LEVEL);
+  buf->comp_hits = CODEC_HOT_RESTORES;
+  if (list__choose_codec(&comp, buf, &level) != LZ4_COMPRESSOR_ID || level != 1)
+    show_error(E_GENERIC, "A page restored %d times should get lz4.", CODEC_HOT_RESTORES);
+  buf->comp_hits = 0;
+  buf->last_comp_length = PAGE_SIZE / 4;
+  if (list__choose_codec(&comp, buf, &level) != ZSTD_COMPRESSOR_ID)
+    show_error(E_GENERIC, "A page that compressed 4:1 last time should get zstd.");
+  buf->last_comp_length = PAGE_SIZE * 3 / 4;
+  if (list__choose_codec(&comp, buf, &level) != LZ4_COMPRESSOR_ID)
+    show_error(E_GENERIC, "A page that barely compressed last time should get lz4, whatever the probe thinks.");
+  buf->last_comp_length = 0;
+  tests__codec_page(buf->data, PAGE_SIZE, 2, true);
+  if (list__choose_codec(&comp, buf, &level) != LZ4_COMPRESSOR_ID)
+    show_error(E_GENERIC, "A noisy page nobody has compressed yet should get lz4.");
+  buffer__destroy(buf, DESTROY_DATA);
+  printf("Cold text gets zstd; hot, noisy, and poorly compressing pages get lz4.\n");
+
+  printf("\nStep 3.  Images remember their codec through a copy, a restore, and the spill tier.\n");
+  tests__codec_page(page, PAGE_SIZE, 3, false);
+  data = malloc(PAGE_SIZE);
+  memcpy(data, page, PAGE_SIZE);
+  buffer__initialize(&buf, 1, PAGE_SIZE, data, NULL);
+  if (buffer__compress(buf, &compressed_data, ADAPTIVE_COMPRESSOR_ID, 1, ctx, NULL) != E_BAD_ARGS)
+    show_error(E_GENERIC, "Adaptive isn't a codec; buffer__compress() should refuse it.");
+  if (buffer__compress(buf, &compressed_data, ZSTD_COMPRESSOR_ID, CODEC_COLD_LEVEL, ctx, NULL) != E_OK)
+    show_error(E_GENERIC, "Couldn't compress a page with zstd.");
+  free(buf->data);
+  buf->data = compressed_data;
+  if (buf->codec_id != ZSTD_COMPRESSOR_ID || buf->codec_level != CODEC_COLD_LEVEL || ctx->last_ns == 0)
+    show_error(E_GENERIC, "The image should record zstd at level %d and the context its time, not codec %"PRIu8" at %"PRIi8".", CODEC_COLD_LEVEL, buf->codec_id, buf->codec_level);
+  buffer__initialize(&copy, 2, 0, NULL, NULL);
+  buffer__copy(buf, copy, true);
+  if (copy->codec_id != ZSTD_COMPRESSOR_ID || buffer__decompress_into(copy, check, ctx) != E_OK || memcmp(page, check, PAGE_SIZE) != 0)
+    show_error(E_GENERIC, "A copied image should decompress with the codec it was copied with.");
+  buffer__destroy(copy, DESTROY_DATA);
+  snprintf(path, sizeof(path), "/tmp/tyche_codec_test.%d", (int)getpid());
+  rv = spill__initialize(&spill, path, (uint64_t)SPILL_MIN_SEGMENTS * SPILL_SEGMENT_SIZE);
+  if (rv != E_OK)
+    show_error(E_GENERIC, "Unable to create the spill file %s.  rv was %d", path, rv);
+  if (spill__put(spill, 1, buf->data, buf->data_length, buf->comp_length, buf->codec_id, buf->dict_id) != E_OK)
+    show_error(E_GENERIC, "The spill tier refused the image.");
+  if (buffer__decompress(buf, ctx) != E_OK || memcmp(page, buf->data, PAGE_SIZE) != 0 || buf->codec_id != NO_COMPRESSOR_ID)
+    show_error(E_GENERIC, "The restored page should be intact and have no codec.");
+  buffer__destroy(buf, DESTROY_DATA);
+  if (spill__take(spill, 1, &buf) != E_OK || buf->codec_id != ZSTD_COMPRESSOR_ID || buffer__decompress(buf, ctx) != E_OK || memcmp(page, buf->data, PAGE_SIZE) != 0)
+    show_error(E_GENERIC, "The spilled image should come back knowing it's zstd.");
+  buffer__destroy(buf, DESTROY_DATA);
+  spill__destroy(spill);
+  printf("zstd image survived all three.\n");
+
+  printf("\nStep 4.  Streaming %"PRIu32" text and noisy pages through an adaptive list with %"PRIu32" raw pages and %"PRIu32" compressed.\n", STREAM, RAW_PAGES, COMP_PAGES);
+  rv = list__initialize(&list, 1, ADAPTIVE_COMPRESSOR_ID, 1, (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * (RAW_PAGES + COMP_PAGES), opts.index_mode, POLICY_CLOCK);
+  if (rv != E_OK)
+    show_error(E_GENERIC, "Unable to initialize a list for the codecs test.  rv was %d", rv);
+  list->max_raw_size = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE) * RAW_PAGES;
+  list->max_comp_size = (uint64_t)(BUFFER_OVERHEAD + PAGE_SIZE / 2) * COMP_PAGES;
+  for(bufferid_t id=0; id<STREAM; id++) {
+    data = malloc(PAGE_SIZE);
+    tests__codec_page(data, PAGE_SIZE, id, id % 3 == 0);
+    buffer__initialize(&buf, id, PAGE_SIZE, data, NULL);
+    if (list__add(list, buf, NEED_PIN) != E_OK)
+      show_error(E_GENERIC, "Failed to add buffer %"PRIu32" to the list.", id);
+  }
+  for(int i=0; i<100 && list->raw_count + list->comp_count + list->evictions != STREAM; i++)
+    usleep(10000);
+  // Every page has to come back intact, whichever codec it got.
+  for(bufferid_t id=0; id<STREAM; id++) {
+    if (list__search(list, &buf, id, NEED_PIN) != E_OK)
+      continue;
+    tests__codec_page(page, PAGE_SIZE, id, id % 3 == 0);
+    if (memcmp(buf->data, page, PAGE_SIZE) != 0)
+      show_error(E_GENERIC, "Buffer %"PRIu32" came back with the wrong page.", id);
+    __sync_fetch_and_add(&buf->ref_count, -1);
+  }
+  for(int i=0; i<CODEC_SLOTS; i++) {
+    if (list->codec_stats[i].compressions == 0 && list->codec_stats[i].decompressions == 0)
+      continue;
+    char label[32];
+    snprintf(label, sizeof(label), "%-5s", codec__name(i));
+    codec__show(&list->codec_stats[i], label);
+  }
+  // The reads above restore pages and set off sweeps.  A sweep tallies each page's codec as it compresses it, but only counts its
+  // compressions once the whole batch is back, so give the last one a moment to settle.
+  for(int i=0; i<100; i++) {
+    pages = 0;
+    for(int j=0; j<CODEC_SLOTS; j++)
+      pages += list->codec_stats[j].compressions;
+    if (pages == list->compressions)
+      break;
+    usleep(10000);
+  }
+  if (list->codec_stats[LZ4_COMPRESSOR_ID].compressions == 0 || list->codec_stats[ZSTD_COMPRESSOR_ID].compressions == 0)
+    show_error(E_GENERIC, "An adaptive list fed text and noisy pages should have used both lz4 and zstd.");
+  if (pages != list->compressions || list->codec_stats[ZLIB_COMPRESSOR_ID].compressions != 0)
+    show_error(E_GENERIC, "The per-codec tallies (%"PRIu64" pages) should add up to the list's %"PRIu64" compressions, with none from zlib.", pages, list->compressions);
+  if (list->codec_stats[ZSTD_COMPRESSOR_ID].decompressions == 0 || list->codec_stats[LZ4_COMPRESSOR_ID].decompressions == 0)
+    show_error(E_GENERIC, "Reading everything back should have decompressed pages of both codecs.");
+  // Text is what zstd got, so it should have done better by its pages than lz4 did by the noisy ones.
+  if (list->codec_stats[ZSTD_COMPRESSOR_ID].data_bytes * list->codec_stats[LZ4_COMPRESSOR_ID].comp_bytes <= list->codec_stats[LZ4_COMPRESSOR_ID].data_bytes * list->codec_stats[ZSTD_COMPRESSOR_ID].comp_bytes)
+    show_error(E_GENERIC, "zstd's pages should have compressed better than lz4's.");
+  list__destroy(list);
+
+  printf("Test 'codecs': All Passed\n");
+  return;
+}
@@ -23,16 +23,78 @@ struct readwriteopts {
   uint32_t sleep_delay;
 };
 
+/* Tracks what tests__scan_callback() saw during a list__scan(). */
+typedef struct scanstate ScanState;
+struct scanstate {
+  bufferid_t last_id;
+  uint32_t visited;
+  uint32_t stop_after;
+  uint32_t bad_pages;
+};
+
+/* Shared settings for the index benchmark.  Each worker gets its own IndexBenchWorker so it can report back. */
+typedef struct indexbenchopts IndexBenchOpts;
+struct indexbenchopts {
+  List *list;
+  uint32_t element_count;
+  uint32_t worker_count;
+  uint32_t searches_per_worker;
+  int phase;
+};
+typedef struct indexbenchworker IndexBenchWorker;
+struct indexbenchworker {
+  IndexBenchOpts *ibopts;
+  uint32_t id;
+  uint64_t misses;
+};
+
+/* Shared settings and results for the pin scaling test. */
+typedef struct pinscalingopts PinScalingOpts;
+struct pinscalingopts {
+  List *list;
+  uint32_t pins_per_reader;
+  uint32_t writer_delay_us;
+  uint8_t writer_active;
+  uint64_t write_locks;
+  uint64_t violations;
+  uint64_t misses;
+};
+
 void tests__show_available();
 void tests__run_test(List *raw_list, char **pages);
 void tests__options();
 void tests__move_buffers(List *raw_list, char **pages);
 void tests__io(char **pages);
 void tests__compression();
+void tests__compression_benchmark(char **pages);
 void tests__synchronized_readwrite(List *raw_list);
 void tests__wake_up(List *raw_list);
 void tests__read(ReadWriteOpts *rwopts);
 void tests__chaos(ReadWriteOpts *rwopts);
 void tests__elements(List *raw_list);
+void tests__ghosts();
+void tests__admission();
+void tests__demotion();
+void tests__policies();
+void tests__gdsf();
+void tests__scan();
+void tests__watermarks();
+void tests__sweep_slices();
+void tests__sweep_hands();
+void tests__windows();
+void tests__spill();
+void tests__arena();
+void tests__dictionaries();
+void tests__dictionary_page(uint8_t *page, uint32_t size, uint32_t seed, uint8_t schema);
+void tests__codecs();
+void tests__codec_page(uint8_t *page, uint32_t size, uint32_t seed, bool noisy);
+int tests__scan_callback(Buffer *buf, void *data, void *arg);
+void tests__index_benchmark();
+void tests__index_benchmark_worker(IndexBenchWorker *ibworker);
+void tests__interleaved_lookups();
+void tests__lookup_latency();
+void tests__pin_scaling();
+void tests__pin_scaling_reader(PinScalingOpts *psopts);
+void tests__pin_scaling_writer(PinScalingOpts *psopts);
 
 #endif /* SRC_TESTS_H_ */
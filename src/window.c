@@ -0,0 +1,269 @@
+/*
+ * window.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: Kyle Harper
+ * Description: See window.h.  A hit is a stamp compare, a couple of relaxed atomic adds, and, when a buffer's hit count crosses a
+ *              power of 2, one bucket move.  Everything else waits for a rotation, which whoever records the last hit of a window
+ *              does under ->lock.  Buffers fold their old counts in lazily, so rotating never walks the list.
+ */
+
+/* Include Headers */
+#include <jemalloc/jemalloc.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <time.h>
+#include "window.h"
+
+
+/* Extern the error codes we'll use. */
+extern const int E_OK;
+extern const int E_NO_MEMORY;
+
+
+/* We need to know what one billion is for clock timing. */
+#define BILLION 1000000000L
+
+
+
+/* window__now
+ * CLOCK_MONOTONIC in ns.
+ */
+uint64_t window__now() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * BILLION + now.tv_nsec;
+}
+
+
+/* window__initialize
+ * Builds windows that rotate every length_ns ns, or every length_hits hits if length_ns is 0.  Buffers keep decay_percent of their
+ * frequency each rotation.
+ */
+int window__initialize(FrequencyWindows **windows, uint64_t length_ns, uint64_t length_hits, uint8_t decay_percent) {
+  *windows = (FrequencyWindows *)calloc(1, sizeof(FrequencyWindows));
+  if(*windows == NULL)
+    return E_NO_MEMORY;
+  (*windows)->length_ns = length_ns;
+  (*windows)->length_hits = length_ns == 0 ? length_hits : 0;
+  (*windows)->decay_percent = decay_percent;
+  (*windows)->decay[0] = 1 << 16;
+  for(int i=1; i<WINDOW_MAX_AGE; i++)
+    (*windows)->decay[i] = (uint32_t)((uint64_t)(*windows)->decay[i - 1] * decay_percent / 100);
+  (*windows)->hot_threshold = WINDOW_HOT_NONE;
+  (*windows)->started = window__now();
+  pthread_mutex_init(&(*windows)->lock, NULL);
+  return E_OK;
+}
+
+
+/* window__destroy
+ * Frees windows.
+ */
+void window__destroy(FrequencyWindows *windows) {
+  if(windows == NULL)
+    return;
+  pthread_mutex_destroy(&windows->lock);
+  free(windows);
+  return;
+}
+
+
+/* window__fold
+ * Brings buf up to the current window:  its hits in the window it last stamped go into its frequency, which then decays once for
+ * every window since.  Only whoever wins the stamp does the math, so racing hits and hands never fold twice.
+ */
+void window__fold(FrequencyWindows *windows, Buffer *buf) {
+  const uint8_t WINDOW = windows->window;
+  const uint8_t STAMP = buf->window_stamp;
+  if(STAMP == WINDOW || !__sync_bool_compare_and_swap(&buf->window_stamp, STAMP, WINDOW))
+    return;
+  const uint8_t AGE = WINDOW - STAMP;
+  uint64_t frequency = ((uint64_t)buf->frequency * windows->decay[1] + (uint64_t)buf->window_hits * WINDOW_SCALE * ((1 << 16) - windows->decay[1])) >> 16;
+  frequency = (frequency * windows->decay[AGE - 1]) >> 16;
+  buf->frequency = frequency > UINT16_MAX ? UINT16_MAX : (uint16_t)frequency;
+  buf->window_hits = 0;
+  return;
+}
+
+
+/* window__hit
+ * Counts a hit on buf in the current window and rotates if that was the window's last.
+ */
+void window__hit(FrequencyWindows *windows, Buffer *buf) {
+  window__fold(windows, buf);
+  if(buf->frequency >= windows->hot_threshold)
+    __atomic_add_fetch(&windows->hot_hits, 1, __ATOMIC_RELAXED);
+  const uint16_t HITS = buf->window_hits;
+  if(HITS < UINT16_MAX) {
+    buf->window_hits = HITS + 1;
+    // Crossing a power of 2 moves the buffer up a bucket.
+    if((HITS & (HITS + 1)) == 0) {
+      const int BUCKET = 31 - __builtin_clz(HITS + 1);
+      __atomic_add_fetch(&windows->buckets[BUCKET], 1, __ATOMIC_RELAXED);
+      if(BUCKET > 0)
+        __atomic_sub_fetch(&windows->buckets[BUCKET - 1], 1, __ATOMIC_RELAXED);
+    }
+  }
+  const uint64_t WINDOW_HITS = __atomic_add_fetch(&windows->hits, 1, __ATOMIC_RELAXED);
+  if(windows->length_hits != 0 ? WINDOW_HITS >= windows->length_hits : WINDOW_HITS % WINDOW_CLOCK_HITS == 0 && window__now() - windows->started >= windows->length_ns)
+    window__rotate(windows);
+  return;
+}
+
+
+/* window__frequency
+ * buf's frequency as of the start of the current window.  The sweeper's hands call this, which also keeps buffers nobody hits from
+ * going WINDOW_MAX_AGE windows without a fold and wrapping their stamp.
+ */
+uint16_t window__frequency(FrequencyWindows *windows, Buffer *buf) {
+  window__fold(windows, buf);
+  return buf->frequency;
+}
+
+
+/* window__is_hot
+ * Whether buf is in the hot set the last rotation sized.
+ */
+bool window__is_hot(FrequencyWindows *windows, Buffer *buf) {
+  return window__frequency(windows, buf) >= windows->hot_threshold;
+}
+
+
+/* window__rotate
+ * Closes the current window.  Scores the hot set it opened with, fits a Zipf curve to how its hits were spread, and sizes the next
+ * hot set from the fit.  Someone else already rotating (or having just rotated) is as good as us doing it.
+ */
+void window__rotate(FrequencyWindows *windows) {
+  if(pthread_mutex_trylock(&windows->lock) != 0)
+    return;
+  const uint64_t NOW = window__now();
+  const uint64_t HITS = windows->hits;
+  if(windows->length_hits != 0 ? HITS < windows->length_hits : NOW - windows->started < windows->length_ns) {
+    pthread_mutex_unlock(&windows->lock);
+    return;
+  }
+  int64_t buckets[WINDOW_BUCKETS];
+  for(int i=0; i<WINDOW_BUCKETS; i++)
+    buckets[i] = __atomic_exchange_n(&windows->buckets[i], 0, __ATOMIC_RELAXED);
+  const uint64_t HOT_HITS = __atomic_exchange_n(&windows->hot_hits, 0, __ATOMIC_RELAXED);
+  __atomic_store_n(&windows->hits, 0, __ATOMIC_RELAXED);
+
+  // Score the prediction this window opened with.
+  if(windows->hot_threshold != WINDOW_HOT_NONE && HITS > 0) {
+    windows->actual_share = (double)HOT_HITS / HITS;
+    windows->share_error += fabs(windows->predicted_share - windows->actual_share);
+    windows->scored++;
+  }
+
+  // Fit the next one.  The hot set is the top hot_buffers by rank; its threshold is the bottom of the bucket the last of them is in.
+  uint64_t distinct = 0, ranked = 0;
+  const double EXPONENT = window__fit_zipf(buckets, &distinct);
+  uint16_t threshold = WINDOW_HOT_NONE;
+  windows->zipf_exponent = EXPONENT;
+  windows->hot_buffers = 0;
+  windows->predicted_share = 0;
+  if(EXPONENT > 0) {
+    windows->hot_buffers = window__zipf_hot_set(EXPONENT, distinct, WINDOW_HOT_SHARE / 100.0, &windows->predicted_share);
+    for(int i=WINDOW_BUCKETS - 1; i>=0; i--) {
+      ranked += buckets[i] > 0 ? buckets[i] : 0;
+      if(ranked >= windows->hot_buffers) {
+        threshold = (uint16_t)((WINDOW_SCALE << i) > UINT16_MAX - 1 ? UINT16_MAX - 1 : WINDOW_SCALE << i);
+        break;
+      }
+    }
+  }
+  windows->hot_threshold = threshold;
+  windows->rotations++;
+  windows->started = NOW;
+  __atomic_add_fetch(&windows->window, 1, __ATOMIC_RELEASE);
+  pthread_mutex_unlock(&windows->lock);
+  return;
+}
+
+
+/* window__fit_zipf
+ * Least-squares fit of log(hits) = c - s * log(rank) over the buckets, one point per non-empty bucket:  its middle rank against the
+ * geometric middle of its hit range.  Sets *distinct to the number of buffers hit.  Returns s, or 0 without at least 2 points.
+ */
+double window__fit_zipf(const int64_t *buckets, uint64_t *distinct) {
+  double sum_x = 0, sum_y = 0, sum_xx = 0, sum_xy = 0, x = 0, y = 0;
+  int points = 0;
+  *distinct = 0;
+  for(int i=WINDOW_BUCKETS - 1; i>=0; i--) {
+    if(buckets[i] <= 0)
+      continue;
+    x = log(*distinct + (buckets[i] + 1) / 2.0);
+    y = i == 0 ? 0 : (i + 0.5) * M_LN2;
+    sum_x += x;
+    sum_y += y;
+    sum_xx += x * x;
+    sum_xy += x * y;
+    points++;
+    *distinct += buckets[i];
+  }
+  if(points < 2 || points * sum_xx == sum_x * sum_x)
+    return 0;
+  const double SLOPE = (points * sum_xy - sum_x * sum_y) / (points * sum_xx - sum_x * sum_x);
+  return SLOPE < 0 ? -SLOPE : 0;
+}
+
+
+/* window__zipf_share
+ * Share of all hits the top k of distinct buffers take under Zipf with this exponent:  H(k,s) / H(distinct,s), with the generalized
+ * harmonic numbers approximated by their integral plus the trapezoid correction.
+ */
+double window__zipf_share(double exponent, double k, double distinct) {
+  double harmonic_k = 0, harmonic_n = 0;
+  if(fabs(exponent - 1) < 1e-6) {
+    harmonic_k = log(k) + 0.5 * (1 + 1 / k);
+    harmonic_n = log(distinct) + 0.5 * (1 + 1 / distinct);
+  } else {
+    harmonic_k = (pow(k, 1 - exponent) - 1) / (1 - exponent) + 0.5 * (1 + pow(k, -exponent));
+    harmonic_n = (pow(distinct, 1 - exponent) - 1) / (1 - exponent) + 0.5 * (1 + pow(distinct, -exponent));
+  }
+  return harmonic_k / harmonic_n;
+}
+
+
+/* window__zipf_hot_set
+ * The fewest of distinct buffers that take share of the hits under Zipf with this exponent.  A bisection, since the share only grows
+ * with k.  *predicted_share gets what they're expected to take.
+ */
+uint64_t window__zipf_hot_set(double exponent, uint64_t distinct, double share, double *predicted_share) {
+  uint64_t low = 1, high = distinct, middle = 0;
+  if(distinct == 0) {
+    *predicted_share = 0;
+    return 0;
+  }
+  while(low < high) {
+    middle = low + (high - low) / 2;
+    if(window__zipf_share(exponent, middle, distinct) >= share)
+      high = middle;
+    else
+      low = middle + 1;
+  }
+  *predicted_share = window__zipf_share(exponent, low, distinct);
+  return low;
+}
+
+
+/* window__show
+ * Prints window statistics for list__show_structure() and the manager.
+ */
+void window__show(FrequencyWindows *windows) {
+  if(windows->length_hits != 0)
+    printf("Popularity windows              : every %'"PRIu64" hits, keeping %"PRIu8"%% each rotation.  %'"PRIu64" rotations\n", windows->length_hits, windows->decay_percent, windows->rotations);
+  else
+    printf("Popularity windows              : every %'"PRIu64" ms, keeping %"PRIu8"%% each rotation.  %'"PRIu64" rotations\n", windows->length_ns / 1000000, windows->decay_percent, windows->rotations);
+  printf("  Zipf fit                      : s = %.2f.  Hot set of %'"PRIu64" buffers (frequency >= %.1f hits/window) should take %.1f%% of hits\n",
+         windows->zipf_exponent, windows->hot_buffers, windows->hot_threshold == WINDOW_HOT_NONE ? 0.0 : (double)windows->hot_threshold / WINDOW_SCALE, 100 * windows->predicted_share);
+  printf("  Hot set accuracy              : last window %.1f%% of hits, mean error %.1f points over %'"PRIu64" windows.  %'"PRIu64" spared by the clock\n",
+         100 * windows->actual_share, windows->scored == 0 ? 0.0 : 100 * windows->share_error / windows->scored, windows->scored, windows->spared);
+  return;
+}
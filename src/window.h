@@ -0,0 +1,76 @@
+/*
+ * window.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: Kyle Harper
+ * Description: Rotating popularity windows (TODO item 1a).  Time is cut into windows that end every length_ns nanoseconds or every
+ *              length_hits hits, whichever the list was given.  Each buffer stamps the window it was last hit in and counts its hits
+ *              there; the first hit in a later window folds that count into Buffer->frequency, an exponential moving average of
+ *              hits per window that keeps decay_percent of its old value each rotation.  So how fast popularity fades depends on the
+ *              clock (or the request rate), not on how often the sweeper's hand happens to come by.
+ *
+ *              Each rotation fits a Zipf curve (frequency ~ rank^-s) to how the closing window's hits were spread over buffers, and
+ *              uses it to size the hot set:  the fewest buffers that should take WINDOW_HOT_SHARE% of the next window's hits.  The
+ *              clock hand leaves buffers in the hot set alone for its first few laps.  The next rotation checks how many hits really
+ *              landed on them, which is how accurate the estimate was.
+ */
+
+#ifndef SRC_WINDOW_H_
+#define SRC_WINDOW_H_
+
+/* Includes */
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "buffer.h"
+
+
+/* Limits and tuning. */
+#define WINDOW_SCALE          16          /* Buffer->frequency is hits per window times this. */
+#define WINDOW_BUCKETS        16          /* Buffers are bucketed by log2 of their hits in the current window. */
+#define WINDOW_MAX_AGE        256         /* Window stamps are a byte; this many windows without a hit is as old as it gets. */
+#define WINDOW_HOT_SHARE      80          /* Percent of a window's hits the hot set is sized to take. */
+#define WINDOW_CLOCK_HITS     64          /* Timed windows only look at the clock once per this many hits. */
+#define WINDOW_HOT_NONE       UINT16_MAX  /* hot_threshold while there's no hot set, e.g.:  before the first rotation. */
+
+
+typedef struct frequencywindows FrequencyWindows;
+struct frequencywindows {
+  uint8_t window;                         /* The current window.  Buffers compare their stamp to it; it wraps. */
+  uint64_t length_ns;                     /* Rotate when a window is this old.  0 when windows are counted in hits. */
+  uint64_t length_hits;                   /* Rotate after this many hits.  0 when windows are timed. */
+  uint8_t decay_percent;                  /* Share of a buffer's frequency it keeps each rotation. */
+  uint32_t decay[WINDOW_MAX_AGE];         /* decay_percent^i in 16.16 fixed point. */
+  uint64_t started;                       /* CLOCK_MONOTONIC ns the current window opened at. */
+  pthread_mutex_t lock;                   /* Held while rotating.  Hits never take it. */
+  uint64_t hits;                          /* Hits in the current window. */
+  uint64_t hot_hits;                      /* Hits in the current window on buffers in the hot set when it opened. */
+  int64_t buckets[WINDOW_BUCKETS];        /* Buffers with 2^i to 2^(i+1)-1 hits in the current window.  Racy, so signed. */
+  uint16_t hot_threshold;                 /* Buffers whose frequency is at least this are in the hot set. */
+  uint64_t hot_buffers;                   /* How many buffers the last rotation expected in the hot set. */
+  double zipf_exponent;                   /* s from the last rotation's fit.  0 until a window had enough spread to fit. */
+  double predicted_share;                 /* Share of the current window's hits the hot set should take, per the fit. */
+  double actual_share;                    /* Share the hot set really took in the last closed window. */
+  double share_error;                     /* Sum of |predicted - actual| over scored windows. */
+  uint64_t scored;                        /* Windows that had a prediction to score. */
+  uint64_t rotations;                     /* Windows closed. */
+  uint64_t spared;                        /* Times a clock hand passed over a hot buffer it would otherwise have taken. */
+};
+
+
+/* Prototypes */
+int window__initialize(FrequencyWindows **windows, uint64_t length_ns, uint64_t length_hits, uint8_t decay_percent);
+void window__destroy(FrequencyWindows *windows);
+uint64_t window__now();
+void window__fold(FrequencyWindows *windows, Buffer *buf);
+void window__hit(FrequencyWindows *windows, Buffer *buf);
+uint16_t window__frequency(FrequencyWindows *windows, Buffer *buf);
+bool window__is_hot(FrequencyWindows *windows, Buffer *buf);
+void window__rotate(FrequencyWindows *windows);
+double window__fit_zipf(const int64_t *buckets, uint64_t *distinct);
+uint64_t window__zipf_hot_set(double exponent, uint64_t distinct, double share, double *predicted_share);
+double window__zipf_share(double exponent, double k, double distinct);
+void window__show(FrequencyWindows *windows);
+
+
+#endif /* SRC_WINDOW_H_ */